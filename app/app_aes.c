@@ -1249,3 +1249,254 @@ end:
 }
 
 #endif
+
+static EVP_CIPHER_CTX *app_aes_mct_init(ACVP_SYM_CIPHER_TC *tc) {
+    EVP_CIPHER_CTX *cipher_ctx = NULL;
+    unsigned char *iv = tc->cipher == ACVP_AES_ECB ? NULL : tc->iv;
+    int direction = tc->direction == ACVP_SYM_CIPH_DIR_ENCRYPT ? 1 : 0;
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    EVP_CIPHER *cipher = NULL;
+    OSSL_PARAM params[3];
+    const char *mode = NULL;
+    char alg_name[32];
+    unsigned int padding = 0, use_bits = 1;
+    int n = 0;
+
+    switch (tc->cipher) {
+    case ACVP_AES_ECB:
+        mode = "ECB";
+        break;
+    case ACVP_AES_CBC:
+        mode = "CBC";
+        break;
+    case ACVP_AES_OFB:
+        mode = "OFB";
+        break;
+    case ACVP_AES_CFB1:
+        mode = "CFB1";
+        break;
+    case ACVP_AES_CFB8:
+        mode = "CFB8";
+        break;
+    case ACVP_AES_CFB128:
+        mode = "CFB";
+        break;
+    case ACVP_AES_CTR:
+        mode = "CTR";
+        break;
+    default:
+        printf("Error: Unsupported AES mode for the MCT handler\n");
+        return NULL;
+    }
+    if (tc->key_len != 128 && tc->key_len != 192 && tc->key_len != 256) {
+        printf("Unsupported AES key length\n");
+        return NULL;
+    }
+    snprintf(alg_name, sizeof(alg_name), "AES-%u-%s", tc->key_len, mode);
+
+    cipher = EVP_CIPHER_fetch(NULL, alg_name, NULL);
+    if (!cipher) {
+        printf("Unable to fetch AES cipher\n");
+        return NULL;
+    }
+    params[n++] = OSSL_PARAM_construct_uint(OSSL_CIPHER_PARAM_PADDING, &padding);
+    if (tc->cipher == ACVP_AES_CFB1) {
+        params[n++] = OSSL_PARAM_construct_uint(OSSL_CIPHER_PARAM_USE_BITS, &use_bits);
+    }
+    params[n] = OSSL_PARAM_construct_end();
+
+    cipher_ctx = EVP_CIPHER_CTX_new();
+    if (!cipher_ctx || EVP_CipherInit_ex2(cipher_ctx, cipher, tc->key, iv, direction, params) != 1) {
+        printf("Error initializing MCT cipher CTX\n");
+        if (cipher_ctx) EVP_CIPHER_CTX_free(cipher_ctx);
+        cipher_ctx = NULL;
+    }
+    EVP_CIPHER_free(cipher);
+#else
+    const EVP_CIPHER *cipher = NULL;
+
+    switch (tc->cipher) {
+    case ACVP_AES_ECB:
+        cipher = tc->key_len == 128 ? EVP_aes_128_ecb() :
+                 tc->key_len == 192 ? EVP_aes_192_ecb() :
+                 tc->key_len == 256 ? EVP_aes_256_ecb() : NULL;
+        break;
+    case ACVP_AES_CBC:
+        cipher = tc->key_len == 128 ? EVP_aes_128_cbc() :
+                 tc->key_len == 192 ? EVP_aes_192_cbc() :
+                 tc->key_len == 256 ? EVP_aes_256_cbc() : NULL;
+        break;
+    case ACVP_AES_OFB:
+        cipher = tc->key_len == 128 ? EVP_aes_128_ofb() :
+                 tc->key_len == 192 ? EVP_aes_192_ofb() :
+                 tc->key_len == 256 ? EVP_aes_256_ofb() : NULL;
+        break;
+    case ACVP_AES_CFB1:
+        cipher = tc->key_len == 128 ? EVP_aes_128_cfb1() :
+                 tc->key_len == 192 ? EVP_aes_192_cfb1() :
+                 tc->key_len == 256 ? EVP_aes_256_cfb1() : NULL;
+        break;
+    case ACVP_AES_CFB8:
+        cipher = tc->key_len == 128 ? EVP_aes_128_cfb8() :
+                 tc->key_len == 192 ? EVP_aes_192_cfb8() :
+                 tc->key_len == 256 ? EVP_aes_256_cfb8() : NULL;
+        break;
+    case ACVP_AES_CFB128:
+        cipher = tc->key_len == 128 ? EVP_aes_128_cfb128() :
+                 tc->key_len == 192 ? EVP_aes_192_cfb128() :
+                 tc->key_len == 256 ? EVP_aes_256_cfb128() : NULL;
+        break;
+    case ACVP_AES_CTR:
+        cipher = tc->key_len == 128 ? EVP_aes_128_ctr() :
+                 tc->key_len == 192 ? EVP_aes_192_ctr() :
+                 tc->key_len == 256 ? EVP_aes_256_ctr() : NULL;
+        break;
+    default:
+        break;
+    }
+    if (!cipher) {
+        printf("Error: Unsupported AES mode or key length for the MCT handler\n");
+        return NULL;
+    }
+
+    cipher_ctx = EVP_CIPHER_CTX_new();
+    if (!cipher_ctx || EVP_CipherInit_ex(cipher_ctx, cipher, NULL, tc->key, iv, direction) != 1) {
+        printf("Error initializing MCT cipher CTX\n");
+        if (cipher_ctx) EVP_CIPHER_CTX_free(cipher_ctx);
+        return NULL;
+    }
+    EVP_CIPHER_CTX_set_padding(cipher_ctx, 0);
+    if (tc->cipher == ACVP_AES_CFB1) {
+        EVP_CIPHER_CTX_set_flags(cipher_ctx, EVP_CIPH_FLAG_LENGTH_BITS);
+    }
+#endif
+    return cipher_ctx;
+}
+
+/*
+ * Runs a whole Monte Carlo inner loop on one cipher context. Each input is
+ * picked from the earlier outputs the same way libacvp picks it between calls
+ * to app_aes_handler(), so only the outputs need to go back.
+ */
+int app_aes_mct_handler(ACVP_TEST_CASE *test_case) {
+    ACVP_SYM_CIPHER_TC *tc = NULL;
+    EVP_CIPHER_CTX *cipher_ctx = NULL;
+    const unsigned char *in = NULL;
+    unsigned char *out = NULL, bit = 0;
+    unsigned int j = 0, out_len = 16;
+    int len = 0;
+
+    if (!test_case) {
+        return 1;
+    }
+    tc = test_case->tc.symmetric;
+    if (!tc || !tc->mct_out) {
+        return 1;
+    }
+    if (tc->cipher == ACVP_AES_CFB1 || tc->cipher == ACVP_AES_CFB8) {
+        out_len = 1;
+    }
+
+    cipher_ctx = app_aes_mct_init(tc);
+    if (!cipher_ctx) {
+        return 1;
+    }
+
+    in = tc->direction == ACVP_SYM_CIPH_DIR_ENCRYPT ? tc->pt : tc->ct;
+    for (j = 0; j < tc->mct_count; j++) {
+        out = tc->mct_out + (size_t)j * out_len;
+        *out = 0; /* CFB1 only writes the top bit */
+        /* For CFB1 the length is in bits */
+        if (EVP_CipherUpdate(cipher_ctx, out, &len, in, out_len) != 1) {
+            printf("Error in AES MCT inner loop\n");
+            EVP_CIPHER_CTX_free(cipher_ctx);
+            return 1;
+        }
+
+        switch (tc->cipher) {
+        case ACVP_AES_ECB:
+            in = out;
+            break;
+        case ACVP_AES_CFB8:
+            in = j < 16 ? &tc->iv[j] : out - 16;
+            break;
+        case ACVP_AES_CFB1:
+            bit = j < 128 ? (unsigned char)(tc->iv[j / 8] << (j % 8)) & 0x80 : out[-128] & 0x80;
+            in = &bit;
+            break;
+        default:
+            /* CBC, OFB and CFB128: the IV, then the output before last */
+            in = j == 0 ? tc->iv : out - 16;
+            break;
+        }
+    }
+    tc->mct_out_len = out_len;
+
+    EVP_CIPHER_CTX_free(cipher_ctx);
+    return 0;
+}
+
+/*
+ * Runs a batch of AFT test cases from one test group on a single cipher
+ * context, only re-keying it between test cases rather than fetching the
+ * cipher and setting up a new context for each one.
+ */
+int app_aes_batch_handler(ACVP_TEST_CASE *test_cases, unsigned int count) {
+    ACVP_SYM_CIPHER_TC *tc = NULL;
+    EVP_CIPHER_CTX *cipher_ctx = NULL;
+    const unsigned char *in = NULL;
+    unsigned char *out = NULL, *iv = NULL;
+    unsigned int i = 0, in_len = 0;
+    int len = 0, final_len = 0, direction = 0, rc = 1;
+
+    if (!test_cases || !count) {
+        return 1;
+    }
+
+    for (i = 0; i < count; i++) {
+        tc = test_cases[i].tc.symmetric;
+        if (!tc) {
+            goto end;
+        }
+        if (!cipher_ctx) {
+            cipher_ctx = app_aes_mct_init(tc);
+            if (!cipher_ctx) {
+                goto end;
+            }
+        } else {
+            /* Same mode, key length and direction; only the key and IV change */
+            iv = tc->cipher == ACVP_AES_ECB ? NULL : tc->iv;
+            direction = tc->direction == ACVP_SYM_CIPH_DIR_ENCRYPT ? 1 : 0;
+            if (EVP_CipherInit_ex(cipher_ctx, NULL, NULL, tc->key, iv, direction) != 1) {
+                printf("Error re-keying cipher in AES batch\n");
+                goto end;
+            }
+        }
+
+        if (tc->direction == ACVP_SYM_CIPH_DIR_ENCRYPT) {
+            in = tc->pt;
+            in_len = tc->pt_len;
+            out = tc->ct;
+        } else {
+            in = tc->ct;
+            in_len = tc->ct_len;
+            out = tc->pt;
+        }
+        if (EVP_CipherUpdate(cipher_ctx, out, &len, in, in_len) != 1 ||
+                EVP_CipherFinal_ex(cipher_ctx, out + len, &final_len) != 1) {
+            printf("Error in AES batch (tcId %u)\n", tc->tc_id);
+            goto end;
+        }
+        if (tc->direction == ACVP_SYM_CIPH_DIR_ENCRYPT) {
+            tc->ct_len = tc->pt_len;
+        } else {
+            tc->pt_len = tc->ct_len;
+        }
+        tc->batch_rv = 0;
+    }
+    rc = 0;
+
+end:
+    if (cipher_ctx) EVP_CIPHER_CTX_free(cipher_ctx);
+    return rc;
+}
@@ -9,6 +9,7 @@
 
 
 #include <stdio.h>
+#include <stdlib.h>
 #include "ketopt.h"
 #include "app_lcl.h"
 #include "acvp/acvp.h"
@@ -38,6 +39,10 @@ static void print_usage(int code) {
     printf("      --status(default)\n");
     printf("      --info\n");
     printf("      --verbose\n");
+    printf("Log messages can be handed off to a background thread so processing does not wait on\n");
+    printf("terminal or file output, and stdout can be flushed less often:\n");
+    printf("      --log_async\n");
+    printf("      --log_flush <every|batch|none>\n");
     printf("\n");
     if (code >= ACVP_LOG_LVL_VERBOSE) {
         printf("-The warn logging level logs events that should be acted upon but do not halt\n");
@@ -84,6 +89,10 @@ static void print_usage(int code) {
     printf("      memory-limited platforms. This can be set (in GiB) using:\n");
     printf("            --set_max_hash_size <GiB value>\n");
     printf("      Setting 0 will disable LDT and only use the typical hash message sizes in the KiB range.\n");
+    printf("      Alternatively, --stream_hash_ldt has libacvp pass LDT messages in pieces, using no extra memory.\n");
+    printf("      --hash_batch digests SHA-2 AFT groups several messages at a time with the app's own portable\n");
+    printf("      multi-lane SHA-2 instead of OpenSSL. It shows how to use libacvp's batch interface; do not use\n");
+    printf("      it when testing OpenSSL.\n");
     printf("\n");
 
     if (code >= ACVP_LOG_LVL_VERBOSE) {
@@ -118,6 +127,29 @@ static void print_usage(int code) {
     printf("      -r <file>\n");
     printf("      -p <file>\n");
     printf("\n");
+    printf("To write vector request/response files without whitespace (smaller and faster for large sessions):\n");
+    printf("      --compact_json\n");
+    printf("\n");
+    printf("To record how long each vector set spends in each processing phase and save it to a file:\n");
+    printf("      --timing <file>\n");
+    printf("   Add --timing_trace to write Chrome trace event format instead of a JSON summary\n");
+    printf("\n");
+    printf("To print vector set and test case progress with an estimated time remaining:\n");
+    printf("      --progress\n");
+    printf("\n");
+    printf("To report the memory libacvp holds overall and per vector set at the end of the session:\n");
+    printf("      --mem_stats\n");
+    printf("   Add --mem_budget <MB> to defer vector sets that would take it past that many megabytes\n");
+    printf("\n");
+    printf("To record crypto handler call counts and latency histograms per algorithm and save them to a file:\n");
+    printf("      --handler_stats <file>\n");
+    printf("\n");
+    printf("To run the Monte Carlo tests of each vector set on several threads at once:\n");
+    printf("      --mct_threads <n>\n");
+    printf("\n");
+    printf("To generate the keys for RSA SigGen test groups ahead of time on several threads:\n");
+    printf("      --rsa_threads <n>\n");
+    printf("\n");
     printf("To upload vector responses from file:\n");
     printf("      --vector_upload <file>\n");
     printf("      -u <file>\n");
@@ -237,6 +269,19 @@ static ko_longopt_t longopts[] = {
     { "debug", ko_no_argument, 417 },
     { "get_registration", ko_no_argument, 418 },
     { "set_max_hash_size", ko_required_argument, 419 },
+    { "compact_json", ko_no_argument, 420 },
+    { "timing", ko_required_argument, 421 },
+    { "timing_trace", ko_no_argument, 422 },
+    { "handler_stats", ko_required_argument, 423 },
+    { "log_async", ko_no_argument, 424 },
+    { "log_flush", ko_required_argument, 425 },
+    { "progress", ko_no_argument, 426 },
+    { "mem_stats", ko_no_argument, 427 },
+    { "mem_budget", ko_required_argument, 428 },
+    { "stream_hash_ldt", ko_no_argument, 429 },
+    { "hash_batch", ko_no_argument, 430 },
+    { "mct_threads", ko_required_argument, 431 },
+    { "rsa_threads", ko_required_argument, 432 },
 #if OPENSSL_VERSION_NUMBER >= 0x30000000L
     { "disable_fips", ko_no_argument, 500 },
 #endif
@@ -298,6 +343,7 @@ static int check_option_length(const char *opt, int c, int maxAllowed) {
 int ingest_cli(APP_CONFIG *cfg, int argc, char **argv) {
     ketopt_t opt = KETOPT_INIT;
     int c = 0, diff = 0, len = 0, print_ver = 0, ldt_manually_set = 0;
+    char *end = NULL;
 
     cfg->empty_alg = 1;
 
@@ -585,6 +631,94 @@ int ingest_cli(APP_CONFIG *cfg, int argc, char **argv) {
             ldt_manually_set = 1;
             break;
 
+        case 420:
+            cfg->compact_json = 1;
+            break;
+
+        case 421:
+            cfg->timing = 1;
+            if (!check_option_length(opt.arg, c, JSON_FILENAME_LENGTH)) {
+                return 1;
+            }
+            strcpy_s(cfg->timing_file, JSON_FILENAME_LENGTH + 1, opt.arg);
+            break;
+
+        case 422:
+            cfg->timing_trace = 1;
+            break;
+
+        case 423:
+            cfg->handler_stats = 1;
+            if (!check_option_length(opt.arg, c, JSON_FILENAME_LENGTH)) {
+                return 1;
+            }
+            strcpy_s(cfg->handler_stats_file, JSON_FILENAME_LENGTH + 1, opt.arg);
+            break;
+
+        case 424:
+            cfg->log_async = 1;
+            break;
+
+        case 425:
+            len = strnlen_s(opt.arg, JSON_FILENAME_LENGTH + 1);
+            strncmp_s(opt.arg, len, "every", 5, &diff);
+            if (len == 5 && !diff) {
+                cfg->log_flush = ACVP_LOG_FLUSH_EVERY;
+                break;
+            }
+            strncmp_s(opt.arg, len, "batch", 5, &diff);
+            if (len == 5 && !diff) {
+                cfg->log_flush = ACVP_LOG_FLUSH_BATCH;
+                break;
+            }
+            strncmp_s(opt.arg, len, "none", 4, &diff);
+            if (len == 4 && !diff) {
+                cfg->log_flush = ACVP_LOG_FLUSH_NONE;
+                break;
+            }
+            printf("Invalid --log_flush policy (must be every, batch or none)\n");
+            return 1;
+
+        case 426:
+            cfg->progress = 1;
+            break;
+
+        case 427:
+            cfg->mem_stats = 1;
+            break;
+
+        case 428:
+            cfg->mem_budget_mb = strtoul(opt.arg, &end, 10);
+            if (end == opt.arg || *end != '\0' || !cfg->mem_budget_mb) {
+                printf("Invalid --mem_budget (must be a whole number of megabytes)\n");
+                return 1;
+            }
+            break;
+
+        case 429:
+            cfg->stream_ldt = 1;
+            break;
+
+        case 430:
+            cfg->hash_batch = 1;
+            break;
+
+        case 431:
+            cfg->mct_threads = strtoul(opt.arg, &end, 10);
+            if (end == opt.arg || *end != '\0' || !cfg->mct_threads) {
+                printf("Invalid --mct_threads (must be a whole number of threads)\n");
+                return 1;
+            }
+            break;
+
+        case 432:
+            cfg->rsa_threads = strtoul(opt.arg, &end, 10);
+            if (end == opt.arg || *end != '\0' || !cfg->rsa_threads) {
+                printf("Invalid --rsa_threads (must be a whole number of threads)\n");
+                return 1;
+            }
+            break;
+
 #if OPENSSL_VERSION_NUMBER >= 0x30000000L
         case 500:
             cfg->disable_fips = 1;
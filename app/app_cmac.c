@@ -242,3 +242,134 @@ end:
     return rv;
 }
 
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+/*
+ * Runs a batch of CMAC test cases from one group through a single fetched
+ * CMAC and context. The cipher is only passed to init when it changes (the
+ * AES key length can differ from one test case to the next); otherwise just
+ * the key is reset.
+ */
+int app_cmac_batch_handler(ACVP_TEST_CASE *test_cases, unsigned int count) {
+    ACVP_CMAC_TC *tc = NULL;
+    EVP_MAC *mac = NULL;
+    EVP_MAC_CTX *cmac_ctx = NULL;
+    OSSL_PARAM params[2];
+    const char *alg_name = NULL, *cur_name = NULL;
+    unsigned char mac_compare[16] = { 0 };
+    unsigned char full_key[32] = { 0 };
+    size_t mac_cmp_len = 0;
+    unsigned int i = 0;
+    int key_len = 0, j = 0, diff = 0, rc = 1;
+
+    if (!test_cases || !count) {
+        return rc;
+    }
+
+    mac = EVP_MAC_fetch(NULL, "CMAC", NULL);
+    if (!mac) {
+        printf("Error: unable to fetch CMAC");
+        goto end;
+    }
+    cmac_ctx = EVP_MAC_CTX_new(mac);
+    if (!cmac_ctx) {
+        printf("Error: unable to create CMAC CTX");
+        goto end;
+    }
+
+    for (i = 0; i < count; i++) {
+        tc = test_cases[i].tc.cmac;
+        if (!tc || !tc->key || !tc->mac || !tc->msg) {
+            goto end;
+        }
+
+        alg_name = NULL;
+        switch (acvp_get_cmac_alg(tc->cipher)) {
+        case ACVP_SUB_CMAC_AES:
+            switch (tc->key_len * 8) {
+            case 128:
+                alg_name = "aes-128-cbc";
+                break;
+            case 192:
+                alg_name = "aes-192-cbc";
+                break;
+            case 256:
+                alg_name = "aes-256-cbc";
+                break;
+            default:
+                break;
+            }
+            key_len = tc->key_len;
+            memcpy_s(full_key, sizeof(full_key), tc->key, key_len);
+            break;
+        case ACVP_SUB_CMAC_TDES:
+            alg_name = "des-ede3-cbc";
+            for (j = 0; j < 8; j++) {
+                full_key[j] = tc->key[j];
+                full_key[j + 8] = tc->key2[j];
+                full_key[j + 16] = tc->key3[j];
+            }
+            key_len = 24;
+            break;
+        default:
+            break;
+        }
+        if (!alg_name) {
+            printf("Error: Unsupported CMAC algorithm requested by ACVP server\n");
+            goto end;
+        }
+
+        if (alg_name != cur_name) {
+            params[0] = OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_CIPHER, (char *)alg_name, 0);
+            params[1] = OSSL_PARAM_construct_end();
+            cur_name = alg_name;
+            if (!EVP_MAC_init(cmac_ctx, full_key, key_len, params)) {
+                printf("\nCrypto module error, EVP_MAC_init failed\n");
+                goto end;
+            }
+        } else if (!EVP_MAC_init(cmac_ctx, full_key, key_len, NULL)) {
+            printf("\nCrypto module error, EVP_MAC_init failed\n");
+            goto end;
+        }
+
+        if (!EVP_MAC_update(cmac_ctx, tc->msg, tc->msg_len)) {
+            printf("\nCrypto module error, EVP_MAC_update failed\n");
+            goto end;
+        }
+
+        if (tc->verify) {
+            if (!EVP_MAC_final(cmac_ctx, mac_compare, &mac_cmp_len, sizeof(mac_compare))) {
+                printf("\nCrypto module error, EVP_MAC_final failed\n");
+                goto end;
+            }
+            memcmp_s(tc->mac, tc->mac_len, mac_compare, mac_cmp_len, &diff);
+            tc->ver_disposition = diff ? ACVP_TEST_DISPOSITION_FAIL : ACVP_TEST_DISPOSITION_PASS;
+        } else {
+            if (!EVP_MAC_final(cmac_ctx, tc->mac, &mac_cmp_len, CMAC_BUF_MAX)) {
+                printf("\nCrypto module error, EVP_MAC_final failed\n");
+                goto end;
+            }
+            tc->mac_len = (int)mac_cmp_len;
+        }
+    }
+    rc = 0;
+
+end:
+    if (cmac_ctx) EVP_MAC_CTX_free(cmac_ctx);
+    if (mac) EVP_MAC_free(mac);
+    return rc;
+}
+#else
+int app_cmac_batch_handler(ACVP_TEST_CASE *test_cases, unsigned int count) {
+    unsigned int i = 0;
+
+    if (!test_cases || !count) {
+        return 1;
+    }
+    for (i = 0; i < count; i++) {
+        if (app_cmac_handler(&test_cases[i])) {
+            return 1;
+        }
+    }
+    return 0;
+}
+#endif
@@ -221,3 +221,94 @@ err:
     return 1;
 }
 
+
+/*
+ * Runs a whole Monte Carlo inner loop on one cipher context, for the modes
+ * whose next input follows from the inputs and outputs alone (ECB, CBC and
+ * CFB64). iv_ret_after is returned as after the last operation.
+ */
+int app_des_mct_handler(ACVP_TEST_CASE *test_case) {
+    ACVP_SYM_CIPHER_TC *tc = NULL;
+    EVP_CIPHER_CTX *cipher_ctx = NULL;
+    const EVP_CIPHER *cipher = NULL;
+    const unsigned char *in = NULL;
+    unsigned char *out = NULL, *iv = NULL;
+    unsigned char next[8];
+    unsigned int j = 0, n = 0;
+    int encrypt = 0;
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    unsigned char ctx_iv[8] = { 0 };
+#else
+    const unsigned char *ctx_iv = NULL;
+#endif
+
+    if (!test_case) {
+        return 1;
+    }
+    tc = test_case->tc.symmetric;
+    if (!tc || !tc->mct_out || !tc->iv_ret_after) {
+        return 1;
+    }
+    if (tc->key_len != 192) {
+        printf("Unsupported DES key length\n");
+        return 1;
+    }
+
+    switch (tc->cipher) {
+    case ACVP_TDES_ECB:
+        cipher = EVP_des_ede3_ecb();
+        break;
+    case ACVP_TDES_CBC:
+        iv = tc->iv;
+        cipher = EVP_des_ede3_cbc();
+        break;
+    case ACVP_TDES_CFB64:
+        iv = tc->iv;
+        cipher = EVP_des_ede3_cfb64();
+        break;
+    default:
+        printf("Error: Unsupported DES mode for the MCT handler\n");
+        return 1;
+    }
+    encrypt = tc->direction == ACVP_SYM_CIPH_DIR_ENCRYPT;
+
+    cipher_ctx = EVP_CIPHER_CTX_new();
+    if (!cipher_ctx || EVP_CipherInit_ex(cipher_ctx, cipher, NULL, tc->key, iv, encrypt) != 1) {
+        printf("Error initializing MCT cipher CTX\n");
+        if (cipher_ctx) EVP_CIPHER_CTX_free(cipher_ctx);
+        return 1;
+    }
+    EVP_CIPHER_CTX_set_padding(cipher_ctx, 0);
+
+    in = encrypt ? tc->pt : tc->ct;
+    for (j = 0; j < tc->mct_count; j++) {
+        out = tc->mct_out + (size_t)j * 8;
+        EVP_Cipher(cipher_ctx, out, in, 8);
+
+        if (tc->cipher == ACVP_TDES_ECB || !encrypt) {
+            if (tc->cipher == ACVP_TDES_CFB64) {
+                /* The next ciphertext is this one xor the plaintext it gave */
+                for (n = 0; n < 8; n++) {
+                    next[n] = in[n] ^ out[n];
+                }
+                in = next;
+            } else {
+                in = out;
+            }
+        } else {
+            /* CBC and CFB64 encrypt: the IV, then the output before last */
+            in = j == 0 ? tc->iv : out - 8;
+        }
+    }
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    EVP_CIPHER_CTX_get_updated_iv(cipher_ctx, (void *)ctx_iv, 8);
+#else
+    ctx_iv = EVP_CIPHER_CTX_iv(cipher_ctx);
+#endif
+    memcpy_s(tc->iv_ret_after, 8, ctx_iv, 8);
+    tc->mct_out_len = 8;
+
+    EVP_CIPHER_CTX_free(cipher_ctx);
+    return 0;
+}
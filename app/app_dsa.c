@@ -20,57 +20,102 @@
 
 #define DSA_MAX_SEED 1024
 
-/* Re-use these when possible to speed up test cases */
-static EVP_PKEY_CTX *group_param_ctx = NULL;
-static EVP_PKEY_CTX *group_pctx = NULL;
-static EVP_PKEY *group_param_key = NULL;
-static EVP_PKEY *group_pkey = NULL;
-static int dsa_current_siggen_tg = 0;
-static int dsa_current_keygen_tg = 0;
-
-void app_dsa_cleanup(void) {
-    if (group_param_ctx) EVP_PKEY_CTX_free(group_param_ctx);
-    group_param_ctx = NULL;
-    if (group_pctx) EVP_PKEY_CTX_free(group_pctx);
-    group_pctx = NULL;
-    if (group_param_key) EVP_PKEY_free(group_param_key);
-    group_param_key = NULL;
-    if (group_pkey) EVP_PKEY_free(group_pkey);
-    group_pkey = NULL;
+/*
+ * The domain parameters a KeyGen or SigGen test group shares, and the key a
+ * SigGen group signs with, kept in the group cache under the group's tg_id
+ */
+typedef struct app_dsa_group_t {
+    EVP_PKEY *param_key;
+    EVP_PKEY_CTX *pctx;
+    EVP_PKEY *pkey;
+} APP_DSA_GROUP;
+
+static void app_dsa_group_free(void *value) {
+    APP_DSA_GROUP *group = value;
+
+    if (group->param_key) EVP_PKEY_free(group->param_key);
+    if (group->pctx) EVP_PKEY_CTX_free(group->pctx);
+    if (group->pkey) EVP_PKEY_free(group->pkey);
+    free(group);
 }
 
-static int init_group_pkey_paramgen(int l, int n) {
+static int init_group_pkey_paramgen(APP_DSA_GROUP *group, int l, int n) {
     int rv = 1;
-    group_param_ctx = EVP_PKEY_CTX_new_from_name(NULL, "DSA", NULL);
-    if (!group_param_ctx) {
+    EVP_PKEY_CTX *param_ctx = NULL;
+
+    param_ctx = EVP_PKEY_CTX_new_from_name(NULL, "DSA", NULL);
+    if (!param_ctx) {
         printf("Error initializing param CTX in DSA keygen\n");
         goto err;
     }
-    if (EVP_PKEY_paramgen_init(group_param_ctx) != 1) {
+    if (EVP_PKEY_paramgen_init(param_ctx) != 1) {
         printf("Error initializing param CTX in DSA keygen\n");
         goto err;
     }
 
-    if (EVP_PKEY_CTX_set_dsa_paramgen_bits(group_param_ctx, l) != 1 ||
-            EVP_PKEY_CTX_set_dsa_paramgen_q_bits(group_param_ctx, n) != 1) {
+    if (EVP_PKEY_CTX_set_dsa_paramgen_bits(param_ctx, l) != 1 ||
+            EVP_PKEY_CTX_set_dsa_paramgen_q_bits(param_ctx, n) != 1) {
         printf("Error setting keygen params in DSA\n");
         goto err;
     }
-    if (EVP_PKEY_paramgen(group_param_ctx, &group_param_key) != 1) {
+    if (EVP_PKEY_paramgen(param_ctx, &group->param_key) != 1) {
         printf("Error generating param key in DSA keygen\n");
         goto err;
     }
-    group_pctx = EVP_PKEY_CTX_new_from_pkey(NULL, group_param_key, NULL);
-    if (!group_pctx) {
+    group->pctx = EVP_PKEY_CTX_new_from_pkey(NULL, group->param_key, NULL);
+    if (!group->pctx) {
         printf("Error creating group_pkey CTX in DSA keygen\n");
         goto err;
     }
-    if (EVP_PKEY_keygen_init(group_pctx) != 1) {
+    if (EVP_PKEY_keygen_init(group->pctx) != 1) {
         printf("Error initializing keygen in DSA keygen\n");
         goto err;
     }
     rv = 0;
 err:
+    if (param_ctx) EVP_PKEY_CTX_free(param_ctx);
+    return rv;
+}
+
+int app_dsa_group_handler(ACVP_GROUP_EVENT event, ACVP_TEST_CASE *test_case) {
+    int rv = 1;
+    ACVP_DSA_TC *tc = NULL;
+    APP_DSA_GROUP *group = NULL;
+
+    if (!test_case || !test_case->tc.dsa) {
+        return 1;
+    }
+    tc = test_case->tc.dsa;
+    if (tc->mode != ACVP_DSA_MODE_KEYGEN && tc->mode != ACVP_DSA_MODE_SIGGEN) {
+        return 0;
+    }
+    if (event == ACVP_GROUP_END) {
+        acvp_group_cache_remove(test_case->group_cache, &tc->tg_id, sizeof(tc->tg_id));
+        return 0;
+    }
+
+    group = calloc(1, sizeof(APP_DSA_GROUP));
+    if (!group) {
+        printf("Error allocating group params in DSA\n");
+        return 1;
+    }
+    if (init_group_pkey_paramgen(group, tc->l, tc->n)) {
+        printf("Error initiating group params in DSA\n");
+        goto err;
+    }
+    if (tc->mode == ACVP_DSA_MODE_SIGGEN && EVP_PKEY_keygen(group->pctx, &group->pkey) != 1) {
+        printf("Error generating group_pkey in DSA siggen\n");
+        goto err;
+    }
+    if (acvp_group_cache_set(test_case->group_cache, &tc->tg_id, sizeof(tc->tg_id),
+                             group, app_dsa_group_free) != ACVP_SUCCESS) {
+        printf("Error caching group params in DSA\n");
+        goto err;
+    }
+    group = NULL;
+    rv = 0;
+err:
+    if (group) app_dsa_group_free(group);
     return rv;
 }
 
@@ -90,20 +135,19 @@ int app_dsa_handler(ACVP_TEST_CASE *test_case) {
     EVP_PKEY *pkey = NULL;
     EVP_MD_CTX *sig_ctx = NULL;
     DSA_SIG *sig_obj = NULL;
+    APP_DSA_GROUP *group = NULL;
 
     tc = test_case->tc.dsa;
     switch (tc->mode) {
     case ACVP_DSA_MODE_KEYGEN:
-        if (dsa_current_keygen_tg != tc->tg_id) {
-            dsa_current_keygen_tg = tc->tg_id;
-            app_dsa_cleanup();
-            if (init_group_pkey_paramgen(tc->l, tc->n)) {
-                printf("Error initiating group params in DSA keygen\n");
-                goto err;
-            }
+        /* The group handler generated the group's domain parameters */
+        group = acvp_group_cache_get(test_case->group_cache, &tc->tg_id, sizeof(tc->tg_id));
+        if (!group) {
+            printf("No params for the test group in DSA keygen\n");
+            goto err;
         }
 
-        if (EVP_PKEY_keygen(group_pctx, &pkey) != 1) {
+        if (EVP_PKEY_keygen(group->pctx, &pkey) != 1) {
             printf("Error generating group_pkey in DSA keygen\n");
             goto err;
         }
@@ -294,38 +338,32 @@ int app_dsa_handler(ACVP_TEST_CASE *test_case) {
         }
         break;
     case ACVP_DSA_MODE_SIGGEN:
-        if (dsa_current_siggen_tg != tc->tg_id) {
-            dsa_current_siggen_tg = tc->tg_id;
-            app_dsa_cleanup();
-
-            if (init_group_pkey_paramgen(tc->l, tc->n)) {
-                printf("Error initiating group params in DSA siggen\n");
-            }
-            if (EVP_PKEY_keygen(group_pctx, &group_pkey) != 1) {
-                printf("Error generating group_pkey in DSA siggen\n");
-                goto err;
-            }
+        /* The group handler generated the group's key */
+        group = acvp_group_cache_get(test_case->group_cache, &tc->tg_id, sizeof(tc->tg_id));
+        if (!group) {
+            printf("No key for the test group in DSA siggen\n");
+            goto err;
         }
 
-        if (EVP_PKEY_get_bn_param(group_pkey, OSSL_PKEY_PARAM_FFC_P, &p) == 1) {
+        if (EVP_PKEY_get_bn_param(group->pkey, OSSL_PKEY_PARAM_FFC_P, &p) == 1) {
             tc->p_len = BN_bn2bin(p, tc->p);
         } else {
             printf("Error getting 'p' in DSA siggen\n");
             goto err;
         }
-        if (EVP_PKEY_get_bn_param(group_pkey, OSSL_PKEY_PARAM_FFC_Q, &q) == 1) {
+        if (EVP_PKEY_get_bn_param(group->pkey, OSSL_PKEY_PARAM_FFC_Q, &q) == 1) {
             tc->q_len = BN_bn2bin(q, tc->q);
         } else {
             printf("Error getting 'q' in DSA siggen\n");
             goto err;
         }
-        if (EVP_PKEY_get_bn_param(group_pkey, OSSL_PKEY_PARAM_FFC_G, &g) == 1) {
+        if (EVP_PKEY_get_bn_param(group->pkey, OSSL_PKEY_PARAM_FFC_G, &g) == 1) {
             tc->g_len = BN_bn2bin(g, tc->g);
         } else {
             printf("Error getting 'g' in DSA siggen\n");
             goto err;
         }
-        if (EVP_PKEY_get_bn_param(group_pkey, OSSL_PKEY_PARAM_PUB_KEY, &pub_key) == 1) {
+        if (EVP_PKEY_get_bn_param(group->pkey, OSSL_PKEY_PARAM_PUB_KEY, &pub_key) == 1) {
             tc->y_len = BN_bn2bin(pub_key, tc->y);
         } else {
             printf("Error getting 'y' in DSA siggen\n");
@@ -342,7 +380,7 @@ int app_dsa_handler(ACVP_TEST_CASE *test_case) {
             printf("Error initializing sign CTX for DSA siggen\n");
             goto err;
         }
-        if (EVP_DigestSignInit_ex(sig_ctx, NULL, md, NULL, NULL, group_pkey, NULL) != 1) {
+        if (EVP_DigestSignInit_ex(sig_ctx, NULL, md, NULL, NULL, group->pkey, NULL) != 1) {
             printf("Error initializing signing for DSA siggen\n");
             goto err;
         }
@@ -514,5 +552,13 @@ int app_dsa_handler(ACVP_TEST_CASE *test_case) {
     }
     return 1;
 }
+
+int app_dsa_group_handler(ACVP_GROUP_EVENT event, ACVP_TEST_CASE *test_case) {
+    if (!test_case) {
+        return -1;
+    }
+    (void)event;
+    return 1;
+}
 #endif
 
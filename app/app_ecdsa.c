@@ -18,19 +18,94 @@
 #include <openssl/ec.h>
 #include "safe_lib.h"
 
-static BIGNUM *ecdsa_group_Qx = NULL;
-static BIGNUM *ecdsa_group_Qy = NULL;
-static int ecdsa_current_tg = 0;
-
-static EVP_PKEY *group_pkey = NULL;
-
-void app_ecdsa_cleanup(void) {
-    if (ecdsa_group_Qx) BN_free(ecdsa_group_Qx);
-    ecdsa_group_Qx = NULL;
-    if (ecdsa_group_Qy) BN_free(ecdsa_group_Qy);
-    ecdsa_group_Qy = NULL;
-    if (group_pkey) EVP_PKEY_free(group_pkey);
-    group_pkey = NULL;
+/* The key a SigGen test group signs with, kept in the group cache under the group's tg_id */
+typedef struct app_ecdsa_group_t {
+    EVP_PKEY *pkey;
+    BIGNUM *qx;
+    BIGNUM *qy;
+} APP_ECDSA_GROUP;
+
+static void app_ecdsa_group_free(void *value) {
+    APP_ECDSA_GROUP *group = value;
+
+    if (group->pkey) EVP_PKEY_free(group->pkey);
+    if (group->qx) BN_free(group->qx);
+    if (group->qy) BN_free(group->qy);
+    free(group);
+}
+
+int app_ecdsa_group_handler(ACVP_GROUP_EVENT event, ACVP_TEST_CASE *test_case) {
+    int rv = 1, nid = NID_undef;
+    const char *curve = NULL;
+    ACVP_ECDSA_TC *tc = NULL;
+    ACVP_SUB_ECDSA alg;
+    EVP_PKEY_CTX *pkey_ctx = NULL;
+    APP_ECDSA_GROUP *group = NULL;
+
+    if (!test_case || !test_case->tc.ecdsa) {
+        return 1;
+    }
+    tc = test_case->tc.ecdsa;
+    alg = acvp_get_ecdsa_alg(tc->cipher);
+    if (alg != ACVP_SUB_ECDSA_SIGGEN && alg != ACVP_SUB_DET_ECDSA_SIGGEN) {
+        return 0;
+    }
+    if (event == ACVP_GROUP_END) {
+        acvp_group_cache_remove(test_case->group_cache, &tc->tg_id, sizeof(tc->tg_id));
+        return 0;
+    }
+
+    nid = get_nid_for_curve(tc->curve);
+    if (nid == NID_undef) {
+        printf("Invalid curve provided for ECDSA\n");
+        return 1;
+    }
+    curve = OSSL_EC_curve_nid2name(nid);
+    if (!curve) {
+        printf("Unable to lookup curve name for ECDSA\n");
+        return 1;
+    }
+
+    /* Generate the key every test case of the group signs with */
+    group = calloc(1, sizeof(APP_ECDSA_GROUP));
+    if (!group) {
+        printf("Error allocating group key in ECDSA siggen\n");
+        return 1;
+    }
+    pkey_ctx = EVP_PKEY_CTX_new_from_name(NULL, "EC", NULL);
+    if (!pkey_ctx) {
+        printf("Error creating pkey CTX in ECDSA siggen\n");
+        goto err;
+    }
+    if (EVP_PKEY_keygen_init(pkey_ctx) != 1) {
+        printf("Error initializing keygen in ECDSA siggen\n");
+        goto err;
+    }
+    if (EVP_PKEY_CTX_set_group_name(pkey_ctx, curve) != 1) {
+        printf("Error setting curve for ECDSA siggen\n");
+        goto err;
+    }
+    if (EVP_PKEY_generate(pkey_ctx, &group->pkey) != 1) {
+        printf("Error generating pkey in ECDSA siggen\n");
+        goto err;
+    }
+    EVP_PKEY_get_bn_param(group->pkey, "qx", &group->qx);
+    EVP_PKEY_get_bn_param(group->pkey, "qy", &group->qy);
+    if (!group->qx || !group->qy) {
+        printf("Error retrieving params from pkey in ECDSA siggen\n");
+        goto err;
+    }
+    if (acvp_group_cache_set(test_case->group_cache, &tc->tg_id, sizeof(tc->tg_id),
+                             group, app_ecdsa_group_free) != ACVP_SUCCESS) {
+        printf("Error caching group key in ECDSA siggen\n");
+        goto err;
+    }
+    group = NULL;
+    rv = 0;
+err:
+    if (group) app_ecdsa_group_free(group);
+    if (pkey_ctx) EVP_PKEY_CTX_free(pkey_ctx);
+    return rv;
 }
 
 int app_ecdsa_handler(ACVP_TEST_CASE *test_case) {
@@ -51,6 +126,7 @@ int app_ecdsa_handler(ACVP_TEST_CASE *test_case) {
     BIGNUM *qx = NULL, *qy = NULL, *d = NULL;
     const BIGNUM *out_r = NULL, *out_s = NULL;
     BIGNUM *in_r = NULL, *in_s = NULL;
+    APP_ECDSA_GROUP *group = NULL;
     if (!test_case) {
         printf("No test case found\n");
         return 1;
@@ -161,42 +237,21 @@ int app_ecdsa_handler(ACVP_TEST_CASE *test_case) {
         break;
     case ACVP_SUB_ECDSA_SIGGEN:
     case ACVP_SUB_DET_ECDSA_SIGGEN:
-        if (ecdsa_current_tg != tc->tg_id) {
-            ecdsa_current_tg = tc->tg_id;
-            /* First, generate key for every test group */
-            pkey_ctx = EVP_PKEY_CTX_new_from_name(NULL, "EC", NULL);
-            if (!pkey_ctx) {
-                printf("Error creating pkey CTX in ECDSA siggen\n");
-                goto err;
-            }
-            if (EVP_PKEY_keygen_init(pkey_ctx) != 1) {
-                printf("Error initializing keygen in ECDSA siggen\n");
-                goto err;
-            }
-            if (EVP_PKEY_CTX_set_group_name(pkey_ctx, curve) != 1) {
-                printf("Error setting curve for ECDSA siggen\n");
-                goto err;
-            }
-            if (EVP_PKEY_generate(pkey_ctx, &group_pkey) != 1) {
-                printf("Error generating pkey in ECDSA siggen\n");
-                goto err;
-            }
-            EVP_PKEY_get_bn_param(group_pkey, "qx", &ecdsa_group_Qx);
-            EVP_PKEY_get_bn_param(group_pkey, "qy", &ecdsa_group_Qy);
-            if (!ecdsa_group_Qx || !ecdsa_group_Qy) {
-                printf("Error retrieving params from pkey in ECDSA siggen\n");
-                goto err;
-            }
+        /* The group handler generated the group's key */
+        group = acvp_group_cache_get(test_case->group_cache, &tc->tg_id, sizeof(tc->tg_id));
+        if (!group) {
+            printf("No key for the test group in ECDSA siggen\n");
+            goto err;
         }
 
-        /* Then, for each test case, generate a signature */
+        /* For each test case, generate a signature */
         if (!tc->is_component) {
             sig_ctx = EVP_MD_CTX_new();
             if (!sig_ctx) {
                 printf("Error initializing sign CTX for ECDSA siggen\n");
                 goto err;
             }
-            if (EVP_DigestSignInit_ex(sig_ctx, NULL, md, NULL, NULL, group_pkey, NULL) != 1) {
+            if (EVP_DigestSignInit_ex(sig_ctx, NULL, md, NULL, NULL, group->pkey, NULL) != 1) {
                 printf("Error initializing signing for ECDSA siggen\n");
                 goto err;
             }
@@ -223,7 +278,7 @@ int app_ecdsa_handler(ACVP_TEST_CASE *test_case) {
 #endif
                 if (pkey_ctx) EVP_PKEY_CTX_free(pkey_ctx);
                 pkey_ctx = NULL;
-                if (EVP_DigestSignInit_ex(sig_ctx, &pkey_ctx, md, NULL, NULL, group_pkey, NULL) != 1) {
+                if (EVP_DigestSignInit_ex(sig_ctx, &pkey_ctx, md, NULL, NULL, group->pkey, NULL) != 1) {
                     printf("Error initializing signing for DetECDSA siggen\n");
                     goto err;
                 }
@@ -235,7 +290,7 @@ int app_ecdsa_handler(ACVP_TEST_CASE *test_case) {
 
                 pkey_ctx = NULL; //freed with md ctx
             } else {
-                if (EVP_DigestSignInit_ex(sig_ctx, NULL, md, NULL, NULL, group_pkey, NULL) != 1) {
+                if (EVP_DigestSignInit_ex(sig_ctx, NULL, md, NULL, NULL, group->pkey, NULL) != 1) {
                     printf("Error initializing signing for ECDSA siggen\n");
                     goto err;
                 }
@@ -253,7 +308,7 @@ int app_ecdsa_handler(ACVP_TEST_CASE *test_case) {
                 goto err;
             }
         } else {
-            comp_ctx = EVP_PKEY_CTX_new_from_pkey(NULL, group_pkey, NULL);
+            comp_ctx = EVP_PKEY_CTX_new_from_pkey(NULL, group->pkey, NULL);
             if (!comp_ctx) {
                 printf("Error initializing sign CTX for ECDSA component siggen\n");
                 goto err;
@@ -289,8 +344,8 @@ int app_ecdsa_handler(ACVP_TEST_CASE *test_case) {
         /* and copy our values to the TC response */
         tc->r_len = BN_bn2bin(out_r, tc->r);
         tc->s_len = BN_bn2bin(out_s, tc->s);
-        tc->qx_len = BN_bn2bin(ecdsa_group_Qx, tc->qx);
-        tc->qy_len = BN_bn2bin(ecdsa_group_Qy, tc->qy);
+        tc->qx_len = BN_bn2bin(group->qx, tc->qx);
+        tc->qy_len = BN_bn2bin(group->qy, tc->qy);
         break;
     case ACVP_SUB_ECDSA_SIGVER:
         tc->ver_disposition = 0;
@@ -404,5 +459,13 @@ int app_ecdsa_handler(ACVP_TEST_CASE *test_case) {
     }
     return 1;
 }
+
+int app_ecdsa_group_handler(ACVP_GROUP_EVENT event, ACVP_TEST_CASE *test_case) {
+    if (!test_case) {
+        return -1;
+    }
+    (void)event;
+    return 1;
+}
 #endif
 
@@ -17,16 +17,89 @@
 #include <openssl/core_names.h>
 #include <openssl/err.h>
 
-static unsigned char *eddsa_group_q = NULL;
-static size_t group_q_len = 0;
-static EVP_PKEY *group_pkey = NULL;
-static int eddsa_current_tg = 0;
-
-void app_eddsa_cleanup(void) {
-    if (eddsa_group_q) free(eddsa_group_q);
-    eddsa_group_q = NULL;
-    if (group_pkey) EVP_PKEY_free(group_pkey);
-    group_pkey = NULL;
+/* The key a SigGen test group signs with, kept in the group cache under the group's tg_id */
+typedef struct app_eddsa_group_t {
+    EVP_PKEY *pkey;
+    unsigned char *q;
+    size_t q_len;
+} APP_EDDSA_GROUP;
+
+static void app_eddsa_group_free(void *value) {
+    APP_EDDSA_GROUP *group = value;
+
+    if (group->pkey) EVP_PKEY_free(group->pkey);
+    if (group->q) free(group->q);
+    free(group);
+}
+
+int app_eddsa_group_handler(ACVP_GROUP_EVENT event, ACVP_TEST_CASE *test_case) {
+    int rv = 1;
+    const char *curve = NULL;
+    ACVP_EDDSA_TC *tc = NULL;
+    EVP_PKEY_CTX *pkey_ctx = NULL;
+    APP_EDDSA_GROUP *group = NULL;
+
+    if (!test_case || !test_case->tc.eddsa) {
+        return 1;
+    }
+    tc = test_case->tc.eddsa;
+    if (acvp_get_eddsa_alg(tc->cipher) != ACVP_SUB_EDDSA_SIGGEN) {
+        return 0;
+    }
+    if (event == ACVP_GROUP_END) {
+        acvp_group_cache_remove(test_case->group_cache, &tc->tg_id, sizeof(tc->tg_id));
+        return 0;
+    }
+
+    curve = get_ed_curve_string(tc->curve);
+    if (!curve) {
+        printf("Unable to lookup curve name for EDDSA\n");
+        return 1;
+    }
+
+    /* Generate the key every test case of the group signs with */
+    group = calloc(1, sizeof(APP_EDDSA_GROUP));
+    if (!group) {
+        printf("Error allocating group key in EDDSA siggen\n");
+        return 1;
+    }
+    pkey_ctx = EVP_PKEY_CTX_new_from_name(NULL, curve, NULL);
+    if (!pkey_ctx) {
+        printf("Error creating pkey CTX in EDDSA siggen\n");
+        goto err;
+    }
+    if (EVP_PKEY_keygen_init(pkey_ctx) != 1) {
+        printf("Error initializing keygen in EDDSA siggen\n");
+        goto err;
+    }
+    if (EVP_PKEY_generate(pkey_ctx, &group->pkey) != 1) {
+        printf("Error generating pkey in EDDSA siggen\n");
+        goto err;
+    }
+    if (EVP_PKEY_get_octet_string_param(group->pkey, "pub", NULL, 0, &group->q_len) != 1) {
+        printf("Error getting 'q' in EDDSA siggen\n");
+        goto err;
+    }
+    group->q = calloc(group->q_len, sizeof(char));
+    if (!group->q) {
+        printf("Error allocating memory for 'q' in EDDSA siggen\n");
+        goto err;
+    }
+    if (EVP_PKEY_get_octet_string_param(group->pkey, "pub", group->q, group->q_len, &group->q_len) != 1) {
+        printf("Error getting 'q' in EDDSA siggen\n");
+        goto err;
+    }
+    if (acvp_group_cache_set(test_case->group_cache, &tc->tg_id, sizeof(tc->tg_id),
+                             group, app_eddsa_group_free) != ACVP_SUCCESS) {
+        printf("Error caching group key in EDDSA siggen\n");
+        goto err;
+    }
+    group = NULL;
+    rv = 0;
+err:
+    if (group) app_eddsa_group_free(group);
+    if (pkey_ctx) EVP_PKEY_CTX_free(pkey_ctx);
+    return rv;
 }
 
 int app_eddsa_handler(ACVP_TEST_CASE *test_case) {
@@ -43,6 +116,7 @@ int app_eddsa_handler(ACVP_TEST_CASE *test_case) {
     EVP_PKEY *pkey = NULL;
     OSSL_PARAM_BLD *pkey_pbld = NULL;
     OSSL_PARAM *params = NULL;
+    APP_EDDSA_GROUP *group = NULL;
 
     if (!test_case) {
         printf("No test case found\n");
@@ -157,40 +231,14 @@ int app_eddsa_handler(ACVP_TEST_CASE *test_case) {
         }
         break;
     case ACVP_SUB_EDDSA_SIGGEN:
-        if (eddsa_current_tg != tc->tg_id) {
-            eddsa_current_tg = tc->tg_id;
-            /* First, generate key for every test group */
-            pkey_ctx = EVP_PKEY_CTX_new_from_name(NULL, curve, NULL);
-            if (!pkey_ctx) {
-                printf("Error creating pkey CTX in EDDSA siggen\n");
-                goto err;
-            }
-            if (EVP_PKEY_keygen_init(pkey_ctx) != 1) {
-                printf("Error initializing keygen in EDDSA siggen\n");
-                goto err;
-            }
-            if (EVP_PKEY_generate(pkey_ctx, &group_pkey) != 1) {
-                printf("Error generating pkey in EDDSA siggen\n");
-                goto err;
-            }
-            if (EVP_PKEY_get_octet_string_param(group_pkey, "pub", NULL, 0, &group_q_len) == 1) {
-                if (eddsa_group_q) free(eddsa_group_q);
-                eddsa_group_q = calloc(group_q_len, sizeof(char));
-                if (!eddsa_group_q) {
-                    printf("Error allocating memory for 'q' in EDDSA keygen\n");
-                    goto err;
-                }
-                if (EVP_PKEY_get_octet_string_param(group_pkey, "pub", eddsa_group_q, group_q_len, &group_q_len) != 1) {
-                    printf("Error getting 'q' in EDDSA keygen\n");
-                    goto err;
-                }
-            } else {
-                printf("Error getting 'q' in EDDSA siggen\n");
-                goto err;
-            }
+        /* The group handler generated the group's key */
+        group = acvp_group_cache_get(test_case->group_cache, &tc->tg_id, sizeof(tc->tg_id));
+        if (!group) {
+            printf("No key for the test group in EDDSA siggen\n");
+            goto err;
         }
 
-        /* Then, for each test case, generate a signature */
+        /* For each test case, generate a signature */
         sig_ctx = EVP_MD_CTX_new();
         if (!sig_ctx) {
             printf("Error initializing sign CTX for EDDSA siggen\n");
@@ -211,7 +259,7 @@ int app_eddsa_handler(ACVP_TEST_CASE *test_case) {
             printf("Error generating parameters for pkey generation in EDDSA siggen\n");
             goto err;
         }
-        if (EVP_DigestSignInit_ex(sig_ctx, NULL, NULL, NULL, NULL, group_pkey, params) != 1) {
+        if (EVP_DigestSignInit_ex(sig_ctx, NULL, NULL, NULL, NULL, group->pkey, params) != 1) {
             printf("Error initializing signing for EDDSA siggen\n");
             goto err;
         }
@@ -228,8 +276,8 @@ int app_eddsa_handler(ACVP_TEST_CASE *test_case) {
         }
    
         /* and copy our values to the TC response */
-        tc->q_len = (int)group_q_len;
-        memcpy_s(tc->q, 8192, eddsa_group_q, group_q_len);
+        tc->q_len = (int)group->q_len;
+        memcpy_s(tc->q, 8192, group->q, group->q_len);
         tc->signature_len = (int)sig_len;
         memcpy_s(tc->signature, 8192, sig, sig_len);
         break;
@@ -324,5 +372,13 @@ int app_eddsa_handler(ACVP_TEST_CASE *test_case) {
     return 1;
 }
 
+int app_eddsa_group_handler(ACVP_GROUP_EVENT event, ACVP_TEST_CASE *test_case) {
+    if (!test_case) {
+        return -1;
+    }
+    (void)event;
+    return 1;
+}
+
 #endif
 
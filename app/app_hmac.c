@@ -17,6 +17,37 @@
 #include "app_lcl.h"
 #include "safe_lib.h"
 
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+static const char *app_hmac_md_name(ACVP_SUB_HMAC alg) {
+    switch (alg) {
+    case ACVP_SUB_HMAC_SHA1:
+        return ACVP_STR_SHA_1;
+    case ACVP_SUB_HMAC_SHA2_224:
+        return ACVP_STR_SHA2_224;
+    case ACVP_SUB_HMAC_SHA2_256:
+        return ACVP_STR_SHA2_256;
+    case ACVP_SUB_HMAC_SHA2_384:
+        return ACVP_STR_SHA2_384;
+    case ACVP_SUB_HMAC_SHA2_512:
+        return ACVP_STR_SHA2_512;
+    case ACVP_SUB_HMAC_SHA2_512_224:
+        return ACVP_STR_SHA2_512_224;
+    case ACVP_SUB_HMAC_SHA2_512_256:
+        return ACVP_STR_SHA2_512_256;
+    case ACVP_SUB_HMAC_SHA3_224:
+        return ACVP_STR_SHA3_224;
+    case ACVP_SUB_HMAC_SHA3_256:
+        return ACVP_STR_SHA3_256;
+    case ACVP_SUB_HMAC_SHA3_384:
+        return ACVP_STR_SHA3_384;
+    case ACVP_SUB_HMAC_SHA3_512:
+        return ACVP_STR_SHA3_512;
+    default:
+        return NULL;
+    }
+}
+#endif
+
 int app_hmac_handler(ACVP_TEST_CASE *test_case) {
     ACVP_HMAC_TC    *tc;
 #if OPENSSL_VERSION_NUMBER >= 0x30000000L
@@ -49,45 +80,10 @@ int app_hmac_handler(ACVP_TEST_CASE *test_case) {
     msg_len = tc->msg_len;
 
 #if OPENSSL_VERSION_NUMBER >= 0x30000000L
-    switch (alg) {
-    case ACVP_SUB_HMAC_SHA1:
-        md_name = ACVP_STR_SHA_1;
-        break;
-    case ACVP_SUB_HMAC_SHA2_224:
-        md_name = ACVP_STR_SHA2_224;
-        break;
-    case ACVP_SUB_HMAC_SHA2_256:
-        md_name = ACVP_STR_SHA2_256;
-        break;
-    case ACVP_SUB_HMAC_SHA2_384:
-        md_name = ACVP_STR_SHA2_384;
-        break;
-    case ACVP_SUB_HMAC_SHA2_512:
-        md_name = ACVP_STR_SHA2_512;
-        break;
-    case ACVP_SUB_HMAC_SHA2_512_224:
-        md_name = ACVP_STR_SHA2_512_224;
-        break;
-    case ACVP_SUB_HMAC_SHA2_512_256:
-        md_name = ACVP_STR_SHA2_512_256;
-        break;
-    case ACVP_SUB_HMAC_SHA3_224:
-        md_name = ACVP_STR_SHA3_224;
-        break;
-    case ACVP_SUB_HMAC_SHA3_256:
-        md_name = ACVP_STR_SHA3_256;
-        break;
-    case ACVP_SUB_HMAC_SHA3_384:
-        md_name = ACVP_STR_SHA3_384;
-        break;
-    case ACVP_SUB_HMAC_SHA3_512:
-        md_name = ACVP_STR_SHA3_512;
-        break;
-    default:
+    md_name = app_hmac_md_name(alg);
+    if (!md_name) {
         printf("Error: Unsupported hash algorithm requested by ACVP server\n");
         return rc;
-
-        break;
     }
 
     mac = EVP_MAC_fetch(NULL, "HMAC", NULL);
@@ -207,3 +203,88 @@ end:
     return rc;
 }
 
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+/*
+ * Runs a batch of HMAC test cases from one group through a single fetched
+ * HMAC and context. The digest is set on the first init; after that only
+ * the key changes, so there is nothing to look up or allocate per test case.
+ */
+int app_hmac_batch_handler(ACVP_TEST_CASE *test_cases, unsigned int count) {
+    ACVP_HMAC_TC *tc = NULL;
+    EVP_MAC *mac = NULL;
+    EVP_MAC_CTX *hmac_ctx = NULL;
+    OSSL_PARAM params[2];
+    const char *md_name = NULL;
+    size_t mac_len = 0;
+    unsigned int i = 0;
+    int rc = 1;
+
+    if (!test_cases || !count) {
+        return rc;
+    }
+
+    mac = EVP_MAC_fetch(NULL, "HMAC", NULL);
+    if (!mac) {
+        printf("Error: unable to fetch HMAC");
+        goto end;
+    }
+    hmac_ctx = EVP_MAC_CTX_new(mac);
+    if (!hmac_ctx) {
+        printf("Error: unable to create HMAC CTX");
+        goto end;
+    }
+
+    for (i = 0; i < count; i++) {
+        tc = test_cases[i].tc.hmac;
+        if (!tc) {
+            goto end;
+        }
+        if (!md_name) {
+            md_name = app_hmac_md_name(acvp_get_hmac_alg(tc->cipher));
+            if (!md_name) {
+                printf("Error: Unsupported hash algorithm requested by ACVP server\n");
+                goto end;
+            }
+            params[0] = OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, (char *)md_name, 0);
+            params[1] = OSSL_PARAM_construct_end();
+            if (!EVP_MAC_init(hmac_ctx, tc->key, tc->key_len, params)) {
+                printf("\nCrypto module error, EVP_MAC_init failed\n");
+                goto end;
+            }
+        } else if (!EVP_MAC_init(hmac_ctx, tc->key, tc->key_len, NULL)) {
+            printf("\nCrypto module error, EVP_MAC_init failed\n");
+            goto end;
+        }
+
+        if (!EVP_MAC_update(hmac_ctx, tc->msg, tc->msg_len)) {
+            printf("\nCrypto module error, EVP_MAC_update failed\n");
+            goto end;
+        }
+        if (!EVP_MAC_final(hmac_ctx, tc->mac, &mac_len, HMAC_BUF_MAX)) {
+            printf("\nCrypto module error, EVP_MAC_final failed\n");
+            goto end;
+        }
+        tc->mac_len = (unsigned int)mac_len;
+    }
+    rc = 0;
+
+end:
+    if (hmac_ctx) EVP_MAC_CTX_free(hmac_ctx);
+    if (mac) EVP_MAC_free(mac);
+    return rc;
+}
+#else
+int app_hmac_batch_handler(ACVP_TEST_CASE *test_cases, unsigned int count) {
+    unsigned int i = 0;
+
+    if (!test_cases || !count) {
+        return 1;
+    }
+    for (i = 0; i < count; i++) {
+        if (app_hmac_handler(&test_cases[i])) {
+            return 1;
+        }
+    }
+    return 0;
+}
+#endif
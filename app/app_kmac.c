@@ -147,6 +147,104 @@ end:
     if (mac_compare) free(mac_compare);
     return rv;
 }
+
+/*
+ * Runs a batch of KMAC test cases from one group through a single fetched
+ * KMAC and context. The output length and customization string can change
+ * from one test case to the next, so they are passed on every init.
+ */
+int app_kmac_batch_handler(ACVP_TEST_CASE *test_cases, unsigned int count) {
+    ACVP_KMAC_TC *tc = NULL;
+    EVP_MAC *mac = NULL;
+    EVP_MAC_CTX *kmac_ctx = NULL;
+    OSSL_PARAM params[4];
+    const char *alg_name = NULL;
+    unsigned char *mac_compare = NULL;
+    size_t mac_out_len = 0, mac_size = 0;
+    unsigned int i = 0;
+    int xof = 0, diff = 1, rc = 1;
+
+    if (!test_cases || !count || !test_cases[0].tc.kmac) {
+        return rc;
+    }
+
+    switch (acvp_get_kmac_alg(test_cases[0].tc.kmac->cipher)) {
+    case ACVP_SUB_KMAC_128:
+        alg_name = "KMAC-128";
+        break;
+    case ACVP_SUB_KMAC_256:
+        alg_name = "KMAC-256";
+        break;
+    default:
+        printf("Error: Unsupported KMAC algorithm requested by ACVP server\n");
+        return rc;
+    }
+
+    mac = EVP_MAC_fetch(NULL, alg_name, NULL);
+    if (!mac) {
+        printf("Error: unable to fetch KMAC");
+        goto end;
+    }
+    kmac_ctx = EVP_MAC_CTX_new(mac);
+    if (!kmac_ctx) {
+        printf("Error: unable to create KMAC CTX");
+        goto end;
+    }
+    mac_compare = calloc(KMAC_BUF_MAX, sizeof(unsigned char));
+    if (!mac_compare) {
+        printf("Error allocating memory in KMAC verify\n");
+        goto end;
+    }
+
+    for (i = 0; i < count; i++) {
+        tc = test_cases[i].tc.kmac;
+        if (!tc || !tc->key || !tc->msg || !tc->mac || !tc->mac_len ||
+                tc->mac_len > KMAC_BUF_MAX) {
+            printf("Missing key/msg/mac/maclen in KMAC test case\n");
+            goto end;
+        }
+
+        xof = tc->xof;
+        mac_size = (size_t)tc->mac_len;
+        params[0] = OSSL_PARAM_construct_int(OSSL_MAC_PARAM_XOF, &xof);
+        params[1] = OSSL_PARAM_construct_size_t(OSSL_MAC_PARAM_SIZE, &mac_size);
+        params[2] = OSSL_PARAM_construct_octet_string(OSSL_MAC_PARAM_CUSTOM,
+                                                      tc->hex_customization ?
+                                                      (void *)tc->custom_hex : (void *)tc->custom,
+                                                      tc->custom_len);
+        params[3] = OSSL_PARAM_construct_end();
+        if (!EVP_MAC_init(kmac_ctx, tc->key, tc->key_len, params)) {
+            printf("Crypto module error, EVP_MAC_init failed\n");
+            goto end;
+        }
+        if (!EVP_MAC_update(kmac_ctx, tc->msg, tc->msg_len)) {
+            printf("Crypto module error, EVP_MAC_update failed\n");
+            goto end;
+        }
+
+        if (tc->test_type == ACVP_KMAC_TEST_TYPE_MVT) {
+            if (!EVP_MAC_final(kmac_ctx, mac_compare, &mac_out_len, mac_size)) {
+                printf("\nCrypto module error, EVP_MAC_final failed\n");
+                goto end;
+            }
+            memcmp_s(tc->mac, tc->mac_len, mac_compare, mac_out_len, &diff);
+            tc->disposition = diff ? ACVP_TEST_DISPOSITION_FAIL : ACVP_TEST_DISPOSITION_PASS;
+        } else {
+            if (!EVP_MAC_final(kmac_ctx, tc->mac, &mac_out_len, mac_size) ||
+                    (int)mac_out_len != tc->mac_len) {
+                printf("\nCrypto module error, EVP_MAC_final failed\n");
+                goto end;
+            }
+        }
+    }
+    rc = 0;
+
+end:
+    if (kmac_ctx) EVP_MAC_CTX_free(kmac_ctx);
+    if (mac) EVP_MAC_free(mac);
+    if (mac_compare) free(mac_compare);
+    return rc;
+}
 #else
 
 int app_kmac_handler(ACVP_TEST_CASE *test_case) {
@@ -156,4 +254,11 @@ int app_kmac_handler(ACVP_TEST_CASE *test_case) {
     return 1;
 }
 
+int app_kmac_batch_handler(ACVP_TEST_CASE *test_cases, unsigned int count) {
+    if (!test_cases || !count) {
+        return -1;
+    }
+    return 1;
+}
+
 #endif
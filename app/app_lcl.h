@@ -53,6 +53,19 @@ typedef struct app_config {
     int save_to;
     int get_cost;
     int get_reg;
+    int compact_json;
+    int timing;
+    int timing_trace;
+    char timing_file[JSON_FILENAME_LENGTH + 1];
+    int handler_stats;
+    char handler_stats_file[JSON_FILENAME_LENGTH + 1];
+    int log_async;
+    int progress;
+    ACVP_LOG_FLUSH log_flush;
+    int mem_stats;
+    unsigned long mem_budget_mb;
+    unsigned int mct_threads;
+    unsigned int rsa_threads;
 #if OPENSSL_VERSION_NUMBER >= 0x30000000L
     int disable_fips;
 #endif
@@ -70,6 +83,8 @@ typedef struct app_config {
 
     /* limit in GiB of hash tasting supported on the platform */
     int max_ldt_size;
+    int stream_ldt; /* have libacvp feed hash LDTs to the module in pieces */
+    int hash_batch; /* digest SHA-2 AFT groups with the multi-lane code in app_sha_mb.c */
 
     /*
      * Algorithm Flags
@@ -105,11 +120,19 @@ void app_des_cleanup(void);
 int app_aes_handler(ACVP_TEST_CASE *test_case);
 int app_aes_handler_aead(ACVP_TEST_CASE *test_case);
 int app_aes_keywrap_handler(ACVP_TEST_CASE *test_case);
+int app_aes_mct_handler(ACVP_TEST_CASE *test_case);
+int app_aes_batch_handler(ACVP_TEST_CASE *test_cases, unsigned int count);
 int app_des_handler(ACVP_TEST_CASE *test_case);
+int app_des_mct_handler(ACVP_TEST_CASE *test_case);
 int app_sha_handler(ACVP_TEST_CASE *test_case);
+int app_sha_mct_handler(ACVP_TEST_CASE *test_case);
+int app_sha_batch_handler(ACVP_TEST_CASE *test_cases, unsigned int count);
 int app_hmac_handler(ACVP_TEST_CASE *test_case);
+int app_hmac_batch_handler(ACVP_TEST_CASE *test_cases, unsigned int count);
 int app_cmac_handler(ACVP_TEST_CASE *test_case);
+int app_cmac_batch_handler(ACVP_TEST_CASE *test_cases, unsigned int count);
 int app_kmac_handler(ACVP_TEST_CASE *test_case);
+int app_kmac_batch_handler(ACVP_TEST_CASE *test_cases, unsigned int count);
 
 #define ENGID1 "800002B805123456789ABCDEF0123456789ABCDEF0123456789ABCDEF0123456"
 #define ENGID2 "000002b87766554433221100"
@@ -126,10 +149,13 @@ int app_pbkdf_handler(ACVP_TEST_CASE *test_case);
 int app_kdf_tls12_handler(ACVP_TEST_CASE *test_case);
 int app_kdf_tls13_handler(ACVP_TEST_CASE *test_case);
 
-void app_dsa_cleanup(void);
 void app_rsa_cleanup(void);
-void app_ecdsa_cleanup(void);
-void app_eddsa_cleanup(void);
+int app_rsa_pool_start(unsigned int threads);
+
+int app_dsa_group_handler(ACVP_GROUP_EVENT event, ACVP_TEST_CASE *test_case);
+int app_rsa_group_handler(ACVP_GROUP_EVENT event, ACVP_TEST_CASE *test_case);
+int app_ecdsa_group_handler(ACVP_GROUP_EVENT event, ACVP_TEST_CASE *test_case);
+int app_eddsa_group_handler(ACVP_GROUP_EVENT event, ACVP_TEST_CASE *test_case);
 
 int app_dsa_handler(ACVP_TEST_CASE *test_case);
 int app_kas_ecc_handler(ACVP_TEST_CASE *test_case);
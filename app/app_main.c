@@ -69,6 +69,8 @@ const char *api_context;
 char value[JSON_STRING_LENGTH] = "same";
 
 int max_ldt_size;
+int stream_ldt;
+int hash_batch;
 
 #define CHECK_ENABLE_CAP_RV(rv) \
     if (rv != ACVP_SUCCESS) { \
@@ -184,6 +186,26 @@ static ACVP_RESULT progress(char *msg, ACVP_LOG_LVL level) {
     return ACVP_SUCCESS;
 }
 
+/* With --progress, libacvp calls this as vector sets and test cases complete. */
+static void progress_report(const ACVP_PROGRESS *p, void *arg) {
+    char eta[32];
+
+    (void)arg;
+    if (p->eta_seconds < 0) {
+        snprintf(eta, sizeof(eta), "unknown");
+    } else {
+        snprintf(eta, sizeof(eta), "%.0fs", p->eta_seconds);
+    }
+    if (p->vs_id) {
+        printf("[ACVP]: Progress: vector set %d/%d (vsId %d, %s), test case %d/%d, %.0fs elapsed, ETA %s\n",
+               p->vs_done + 1, p->vs_total, p->vs_id, p->algorithm ? p->algorithm : "",
+               p->tc_done, p->tc_total, p->elapsed_seconds, eta);
+    } else {
+        printf("[ACVP]: Progress: %d/%d vector sets done, %.0fs elapsed, ETA %s\n",
+               p->vs_done, p->vs_total, p->elapsed_seconds, eta);
+    }
+}
+
 static void app_cleanup(ACVP_CTX *ctx) {
     // Routines for libacvp
     acvp_cleanup(ctx);
@@ -192,14 +214,7 @@ static void app_cleanup(ACVP_CTX *ctx) {
     app_aes_cleanup();
     app_des_cleanup();
 #if OPENSSL_VERSION_NUMBER >= 0x30000000L
-#ifndef OPENSSL_NO_DSA
-    app_dsa_cleanup();
-#endif
     app_rsa_cleanup();
-    app_ecdsa_cleanup();
-#ifdef ACVP_FIPS186_5
-    app_eddsa_cleanup();
-#endif
 #endif
 }
 
@@ -222,6 +237,8 @@ int main(int argc, char **argv) {
     }
 
     max_ldt_size = cfg.max_ldt_size;
+    stream_ldt = cfg.stream_ldt;
+    hash_batch = cfg.hash_batch;
 
 #if OPENSSL_VERSION_NUMBER >= 0x30000000L
     if (!cfg.disable_fips) {
@@ -319,6 +336,39 @@ int main(int argc, char **argv) {
         acvp_mark_as_sample(ctx);
     }
 
+    if (cfg.compact_json) {
+        acvp_set_json_output_compact(ctx, 1);
+    }
+
+    if (cfg.timing) {
+        acvp_enable_phase_timing(ctx, 1);
+    }
+
+    if (cfg.handler_stats) {
+        acvp_enable_handler_stats(ctx, 1);
+    }
+
+    if (cfg.progress) {
+        acvp_set_progress_callback(ctx, &progress_report, NULL, 1000);
+    }
+
+    if (cfg.mem_stats) {
+        acvp_enable_mem_accounting(ctx, 1);
+    }
+
+    if (cfg.mem_budget_mb) {
+        acvp_set_mem_budget(ctx, (size_t)cfg.mem_budget_mb * 1024 * 1024);
+    }
+
+    if (cfg.mct_threads) {
+        acvp_set_mct_threads(ctx, cfg.mct_threads);
+    }
+
+    acvp_set_log_flush_policy(ctx, cfg.log_flush);
+    if (cfg.log_async) {
+        acvp_set_log_async(ctx, 1, 0);
+    }
+
     if (cfg.get) {
         rv = acvp_mark_as_get_only(ctx, cfg.get_string, cfg.save_to ? cfg.save_file : NULL);
         if (rv != ACVP_SUCCESS) {
@@ -418,6 +468,13 @@ int main(int argc, char **argv) {
         goto end;
     }
 
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    /* Start generating SigGen keys now, so they are ready by the time the vector sets are */
+    if (cfg.rsa && cfg.rsa_threads) {
+        app_rsa_pool_start(cfg.rsa_threads);
+    }
+#endif
+
     if (cfg.vector_req && cfg.vector_rsp) {
        rv = acvp_run_vectors_from_file(ctx, cfg.vector_req_file, cfg.vector_rsp_file);
        goto end;
@@ -500,6 +557,19 @@ int main(int argc, char **argv) {
     acvp_run(ctx, cfg.fips_validation);
 
 end:
+    /* Let queued log output finish before printing anything else */
+    acvp_log_flush(ctx);
+    if (cfg.timing && ctx) {
+        if (acvp_export_phase_timing(ctx, cfg.timing_file, cfg.timing_trace) == ACVP_SUCCESS) {
+            printf("Phase timing saved to %s\n", cfg.timing_file);
+        }
+    }
+    if (cfg.handler_stats && ctx) {
+        if (acvp_export_handler_stats(ctx, cfg.handler_stats_file) == ACVP_SUCCESS) {
+            printf("Crypto handler statistics saved to %s\n", cfg.handler_stats_file);
+        }
+    }
+
     /*
      * Free all memory associated with
      * both the application and libacvp.
@@ -569,6 +639,10 @@ static int enable_aes(ACVP_CTX *ctx) {
     /* Enable AES-ECB 128,192,256 bit key */
     rv = acvp_cap_sym_cipher_enable(ctx, ACVP_AES_ECB, &app_aes_handler);
     CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_sym_cipher_set_mct_handler(ctx, ACVP_AES_ECB, &app_aes_mct_handler);
+    CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_sym_cipher_set_batch_handler(ctx, ACVP_AES_ECB, &app_aes_batch_handler);
+    CHECK_ENABLE_CAP_RV(rv);
 
     rv = acvp_cap_sym_cipher_set_parm(ctx, ACVP_AES_ECB, ACVP_SYM_CIPH_PARM_DIR, ACVP_SYM_CIPH_DIR_BOTH);
     CHECK_ENABLE_CAP_RV(rv);
@@ -587,6 +661,10 @@ static int enable_aes(ACVP_CTX *ctx) {
     /* Enable AES-CBC 128 bit key */
     rv = acvp_cap_sym_cipher_enable(ctx, ACVP_AES_CBC, &app_aes_handler);
     CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_sym_cipher_set_mct_handler(ctx, ACVP_AES_CBC, &app_aes_mct_handler);
+    CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_sym_cipher_set_batch_handler(ctx, ACVP_AES_CBC, &app_aes_batch_handler);
+    CHECK_ENABLE_CAP_RV(rv);
 
     rv = acvp_cap_sym_cipher_set_parm(ctx, ACVP_AES_CBC, ACVP_SYM_CIPH_PARM_DIR, ACVP_SYM_CIPH_DIR_BOTH);
     CHECK_ENABLE_CAP_RV(rv);
@@ -651,6 +729,10 @@ static int enable_aes(ACVP_CTX *ctx) {
     /* Enable AES-CFB1 128,192,256 bit key */
     rv = acvp_cap_sym_cipher_enable(ctx, ACVP_AES_CFB1, &app_aes_handler);
     CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_sym_cipher_set_mct_handler(ctx, ACVP_AES_CFB1, &app_aes_mct_handler);
+    CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_sym_cipher_set_batch_handler(ctx, ACVP_AES_CFB1, &app_aes_batch_handler);
+    CHECK_ENABLE_CAP_RV(rv);
 
     rv = acvp_cap_sym_cipher_set_parm(ctx, ACVP_AES_CFB1, ACVP_SYM_CIPH_PARM_DIR, ACVP_SYM_CIPH_DIR_BOTH);
     CHECK_ENABLE_CAP_RV(rv);
@@ -669,6 +751,10 @@ static int enable_aes(ACVP_CTX *ctx) {
     /* Enable AES-CFB8 128,192,256 bit key */
     rv = acvp_cap_sym_cipher_enable(ctx, ACVP_AES_CFB8, &app_aes_handler);
     CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_sym_cipher_set_mct_handler(ctx, ACVP_AES_CFB8, &app_aes_mct_handler);
+    CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_sym_cipher_set_batch_handler(ctx, ACVP_AES_CFB8, &app_aes_batch_handler);
+    CHECK_ENABLE_CAP_RV(rv);
 
     rv = acvp_cap_sym_cipher_set_parm(ctx, ACVP_AES_CFB8, ACVP_SYM_CIPH_PARM_DIR, ACVP_SYM_CIPH_DIR_BOTH);
     CHECK_ENABLE_CAP_RV(rv);
@@ -687,6 +773,10 @@ static int enable_aes(ACVP_CTX *ctx) {
     /* Enable AES-CFB128 128,192,256 bit key */
     rv = acvp_cap_sym_cipher_enable(ctx, ACVP_AES_CFB128, &app_aes_handler);
     CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_sym_cipher_set_mct_handler(ctx, ACVP_AES_CFB128, &app_aes_mct_handler);
+    CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_sym_cipher_set_batch_handler(ctx, ACVP_AES_CFB128, &app_aes_batch_handler);
+    CHECK_ENABLE_CAP_RV(rv);
 
     rv = acvp_cap_sym_cipher_set_parm(ctx, ACVP_AES_CFB128, ACVP_SYM_CIPH_PARM_DIR, ACVP_SYM_CIPH_DIR_BOTH);
     CHECK_ENABLE_CAP_RV(rv);
@@ -705,6 +795,10 @@ static int enable_aes(ACVP_CTX *ctx) {
     /* Enable AES-OFB 128, 192, 256 bit key */
     rv = acvp_cap_sym_cipher_enable(ctx, ACVP_AES_OFB, &app_aes_handler);
     CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_sym_cipher_set_mct_handler(ctx, ACVP_AES_OFB, &app_aes_mct_handler);
+    CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_sym_cipher_set_batch_handler(ctx, ACVP_AES_OFB, &app_aes_batch_handler);
+    CHECK_ENABLE_CAP_RV(rv);
 
     rv = acvp_cap_sym_cipher_set_parm(ctx, ACVP_AES_OFB, ACVP_SYM_CIPH_PARM_DIR, ACVP_SYM_CIPH_DIR_BOTH);
     CHECK_ENABLE_CAP_RV(rv);
@@ -837,6 +931,8 @@ static int enable_aes(ACVP_CTX *ctx) {
     /* Enable AES-CTR 128, 192, 256 bit key */
     rv = acvp_cap_sym_cipher_enable(ctx, ACVP_AES_CTR, &app_aes_handler);
     CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_sym_cipher_set_batch_handler(ctx, ACVP_AES_CTR, &app_aes_batch_handler);
+    CHECK_ENABLE_CAP_RV(rv);
 
     rv = acvp_cap_sym_cipher_set_parm(ctx, ACVP_AES_CTR, ACVP_SYM_CIPH_PARM_DIR, ACVP_SYM_CIPH_DIR_BOTH);
     CHECK_ENABLE_CAP_RV(rv);
@@ -984,6 +1080,8 @@ static int enable_tdes(ACVP_CTX *ctx) {
     /* Enable 3DES-ECB */
     rv = acvp_cap_sym_cipher_enable(ctx, ACVP_TDES_ECB, &app_des_handler);
     CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_sym_cipher_set_mct_handler(ctx, ACVP_TDES_ECB, &app_des_mct_handler);
+    CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_sym_cipher_set_parm(ctx, ACVP_TDES_ECB, ACVP_SYM_CIPH_PARM_DIR, ACVP_SYM_CIPH_DIR_BOTH);
     CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_sym_cipher_set_parm(ctx, ACVP_TDES_ECB, ACVP_SYM_CIPH_PARM_KO, ACVP_SYM_CIPH_KO_ONE);
@@ -992,6 +1090,8 @@ static int enable_tdes(ACVP_CTX *ctx) {
     /* Enable 3DES-CBC */
     rv = acvp_cap_sym_cipher_enable(ctx, ACVP_TDES_CBC, &app_des_handler);
     CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_sym_cipher_set_mct_handler(ctx, ACVP_TDES_CBC, &app_des_mct_handler);
+    CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_sym_cipher_set_parm(ctx, ACVP_TDES_CBC, ACVP_SYM_CIPH_PARM_DIR, ACVP_SYM_CIPH_DIR_BOTH);
     CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_sym_cipher_set_parm(ctx, ACVP_TDES_CBC, ACVP_SYM_CIPH_PARM_KO, ACVP_SYM_CIPH_KO_ONE);
@@ -1047,6 +1147,8 @@ static int enable_tdes(ACVP_CTX *ctx) {
     /* Enable 3DES-CFB64 */
     rv = acvp_cap_sym_cipher_enable(ctx, ACVP_TDES_CFB64, &app_des_handler);
     CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_sym_cipher_set_mct_handler(ctx, ACVP_TDES_CFB64, &app_des_mct_handler);
+    CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_sym_cipher_set_parm(ctx, ACVP_TDES_CFB64, ACVP_SYM_CIPH_PARM_DIR, ACVP_SYM_CIPH_DIR_BOTH);
     CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_sym_cipher_set_parm(ctx, ACVP_TDES_CFB64, ACVP_SYM_CIPH_PARM_KO, ACVP_SYM_CIPH_KO_ONE);
@@ -1081,43 +1183,59 @@ static int enable_hash(ACVP_CTX *ctx) {
     /* Enable SHA-1 and SHA-2 */
     rv = acvp_cap_hash_enable(ctx, ACVP_HASH_SHA1, &app_sha_handler);
     CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_hash_set_mct_handler(ctx, ACVP_HASH_SHA1, &app_sha_mct_handler);
+    CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_hash_set_domain(ctx, ACVP_HASH_SHA1, ACVP_HASH_MESSAGE_LEN, 0, 65536, 8);
     CHECK_ENABLE_CAP_RV(rv);
 
     rv = acvp_cap_hash_enable(ctx, ACVP_HASH_SHA224, &app_sha_handler);
     CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_hash_set_mct_handler(ctx, ACVP_HASH_SHA224, &app_sha_mct_handler);
+    CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_hash_set_domain(ctx, ACVP_HASH_SHA224, ACVP_HASH_MESSAGE_LEN, 0, 65536, 8);
     CHECK_ENABLE_CAP_RV(rv);
 
     rv = acvp_cap_hash_enable(ctx, ACVP_HASH_SHA256, &app_sha_handler);
     CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_hash_set_mct_handler(ctx, ACVP_HASH_SHA256, &app_sha_mct_handler);
+    CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_hash_set_domain(ctx, ACVP_HASH_SHA256, ACVP_HASH_MESSAGE_LEN, 0, 65536, 8);
     CHECK_ENABLE_CAP_RV(rv);
 
     rv = acvp_cap_hash_enable(ctx, ACVP_HASH_SHA384, &app_sha_handler);
     CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_hash_set_mct_handler(ctx, ACVP_HASH_SHA384, &app_sha_mct_handler);
+    CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_hash_set_domain(ctx, ACVP_HASH_SHA384, ACVP_HASH_MESSAGE_LEN, 0, 65536, 8);
     CHECK_ENABLE_CAP_RV(rv);
 
     rv = acvp_cap_hash_enable(ctx, ACVP_HASH_SHA512, &app_sha_handler);
     CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_hash_set_mct_handler(ctx, ACVP_HASH_SHA512, &app_sha_mct_handler);
+    CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_hash_set_domain(ctx, ACVP_HASH_SHA512, ACVP_HASH_MESSAGE_LEN, 0, 65536, 8);
     CHECK_ENABLE_CAP_RV(rv);
 
     /* SHA2-512/224 and SHA2-512/256 */
     rv = acvp_cap_hash_enable(ctx, ACVP_HASH_SHA512_224, &app_sha_handler);
     CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_hash_set_mct_handler(ctx, ACVP_HASH_SHA512_224, &app_sha_mct_handler);
+    CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_hash_set_domain(ctx, ACVP_HASH_SHA512_224, ACVP_HASH_MESSAGE_LEN, 0, 65536, 8);
     CHECK_ENABLE_CAP_RV(rv);
 
     rv = acvp_cap_hash_enable(ctx, ACVP_HASH_SHA512_256, &app_sha_handler);
     CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_hash_set_mct_handler(ctx, ACVP_HASH_SHA512_256, &app_sha_mct_handler);
+    CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_hash_set_domain(ctx, ACVP_HASH_SHA512_256, ACVP_HASH_MESSAGE_LEN, 0, 65536, 8);
     CHECK_ENABLE_CAP_RV(rv);
 
     /* SHA3 and SHAKE */
     rv = acvp_cap_hash_enable(ctx, ACVP_HASH_SHA3_224, &app_sha_handler);
     CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_hash_set_mct_handler(ctx, ACVP_HASH_SHA3_224, &app_sha_mct_handler);
+    CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_hash_set_parm(ctx, ACVP_HASH_SHA3_224, ACVP_HASH_IN_BIT, 0);
     CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_hash_set_parm(ctx, ACVP_HASH_SHA3_224, ACVP_HASH_IN_EMPTY, 1);
@@ -1127,6 +1245,8 @@ static int enable_hash(ACVP_CTX *ctx) {
 
     rv = acvp_cap_hash_enable(ctx, ACVP_HASH_SHA3_256, &app_sha_handler);
     CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_hash_set_mct_handler(ctx, ACVP_HASH_SHA3_256, &app_sha_mct_handler);
+    CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_hash_set_parm(ctx, ACVP_HASH_SHA3_256, ACVP_HASH_IN_BIT, 0);
     CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_hash_set_parm(ctx, ACVP_HASH_SHA3_256, ACVP_HASH_IN_EMPTY, 1);
@@ -1136,6 +1256,8 @@ static int enable_hash(ACVP_CTX *ctx) {
 
     rv = acvp_cap_hash_enable(ctx, ACVP_HASH_SHA3_384, &app_sha_handler);
     CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_hash_set_mct_handler(ctx, ACVP_HASH_SHA3_384, &app_sha_mct_handler);
+    CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_hash_set_parm(ctx, ACVP_HASH_SHA3_384, ACVP_HASH_IN_BIT, 0);
     CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_hash_set_parm(ctx, ACVP_HASH_SHA3_384, ACVP_HASH_IN_EMPTY, 1);
@@ -1145,6 +1267,8 @@ static int enable_hash(ACVP_CTX *ctx) {
 
     rv = acvp_cap_hash_enable(ctx, ACVP_HASH_SHA3_512, &app_sha_handler);
     CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_hash_set_mct_handler(ctx, ACVP_HASH_SHA3_512, &app_sha_mct_handler);
+    CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_hash_set_parm(ctx, ACVP_HASH_SHA3_512, ACVP_HASH_IN_BIT, 0);
     CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_hash_set_parm(ctx, ACVP_HASH_SHA3_512, ACVP_HASH_IN_EMPTY, 1);
@@ -1154,6 +1278,8 @@ static int enable_hash(ACVP_CTX *ctx) {
 
     rv = acvp_cap_hash_enable(ctx, ACVP_HASH_SHAKE_128, &app_sha_handler);
     CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_hash_set_mct_handler(ctx, ACVP_HASH_SHAKE_128, &app_sha_mct_handler);
+    CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_hash_set_parm(ctx, ACVP_HASH_SHAKE_128, ACVP_HASH_IN_BIT, 0);
     CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_hash_set_parm(ctx, ACVP_HASH_SHAKE_128, ACVP_HASH_OUT_BIT, 0);
@@ -1166,6 +1292,8 @@ static int enable_hash(ACVP_CTX *ctx) {
 
     rv = acvp_cap_hash_enable(ctx, ACVP_HASH_SHAKE_256, &app_sha_handler);
     CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_hash_set_mct_handler(ctx, ACVP_HASH_SHAKE_256, &app_sha_mct_handler);
+    CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_hash_set_parm(ctx, ACVP_HASH_SHAKE_256, ACVP_HASH_IN_BIT, 0);
     CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_hash_set_parm(ctx, ACVP_HASH_SHAKE_256, ACVP_HASH_OUT_BIT, 0);
@@ -1175,6 +1303,12 @@ static int enable_hash(ACVP_CTX *ctx) {
     rv = acvp_cap_hash_set_domain(ctx, ACVP_HASH_SHAKE_256, ACVP_HASH_OUT_LENGTH, 16, 65536, 8);
     CHECK_ENABLE_CAP_RV(rv);
 
+    /* SHA-2 AFT groups through the portable multi-lane code, to exercise libacvp's batch path */
+    for (i = ACVP_HASH_SHA224; hash_batch && i <= ACVP_HASH_SHA512_256; i++) {
+        rv = acvp_cap_hash_set_batch_handler(ctx, i, &app_sha_batch_handler);
+        CHECK_ENABLE_CAP_RV(rv);
+    }
+
 #if OPENSSL_VERSION_NUMBER >= 0x30000080L /* 3.0.8 or greater */
     /* valid LDT increments are 1, 2, 4, and 8 GiB */
     for (i = 1; i <= max_ldt_size; i *= 2) {
@@ -1203,6 +1337,12 @@ static int enable_hash(ACVP_CTX *ctx) {
         CHECK_ENABLE_CAP_RV(rv);
 #endif
     }
+
+    /* Streamed LDTs need only one 256 KiB piece of the message in memory at a time */
+    for (i = ACVP_HASH_SHA1; stream_ldt && i <= ACVP_HASH_SHA3_512; i++) {
+        rv = acvp_cap_hash_set_ldt_streaming(ctx, i, 256 * 1024);
+        CHECK_ENABLE_CAP_RV(rv);
+    }
 #endif
 
 end:
@@ -1231,6 +1371,8 @@ static int enable_cmac(ACVP_CTX *ctx) {
     CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_cmac_set_parm(ctx, ACVP_CMAC_AES, ACVP_CMAC_KEYLEN, 256);
     CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_mac_set_batch_handler(ctx, ACVP_CMAC_AES, &app_cmac_batch_handler);
+    CHECK_ENABLE_CAP_RV(rv);
 
 #if OPENSSL_VERSION_NUMBER < 0x30000000L
     rv = acvp_cap_cmac_enable(ctx, ACVP_CMAC_TDES, &app_cmac_handler);
@@ -1247,6 +1389,8 @@ static int enable_cmac(ACVP_CTX *ctx) {
     CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_set_prereq(ctx, ACVP_CMAC_TDES, ACVP_PREREQ_TDES, value);
     CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_mac_set_batch_handler(ctx, ACVP_CMAC_TDES, &app_cmac_batch_handler);
+    CHECK_ENABLE_CAP_RV(rv);
 #endif
 end:
 
@@ -1271,6 +1415,8 @@ static int enable_kmac(ACVP_CTX *ctx) {
     /* OpenSSL 3.X supports hex customization strings, but they are not on the FIPS cert, so leaving disabled */
     rv = acvp_cap_kmac_set_parm(ctx, ACVP_KMAC_128, ACVP_KMAC_HEX_CUSTOM_SUPPORT, 0);
     CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_mac_set_batch_handler(ctx, ACVP_KMAC_128, &app_kmac_batch_handler);
+    CHECK_ENABLE_CAP_RV(rv);
 
     rv = acvp_cap_kmac_enable(ctx, ACVP_KMAC_256, &app_kmac_handler);
     CHECK_ENABLE_CAP_RV(rv);
@@ -1285,6 +1431,8 @@ static int enable_kmac(ACVP_CTX *ctx) {
     /* OpenSSL 3.X supports hex customization strings, but they are not on the FIPS cert, so leaving disabled */
     rv = acvp_cap_kmac_set_parm(ctx, ACVP_KMAC_256, ACVP_KMAC_HEX_CUSTOM_SUPPORT, 0);
     CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_mac_set_batch_handler(ctx, ACVP_KMAC_256, &app_kmac_batch_handler);
+    CHECK_ENABLE_CAP_RV(rv);
 end:
     return rv;
 }
@@ -1292,6 +1440,7 @@ end:
 
 static int enable_hmac(ACVP_CTX *ctx) {
     ACVP_RESULT rv = ACVP_SUCCESS;
+    int i = 0;
 
     rv = acvp_cap_hmac_enable(ctx, ACVP_HMAC_SHA1, &app_hmac_handler);
     CHECK_ENABLE_CAP_RV(rv);
@@ -1391,6 +1540,12 @@ static int enable_hmac(ACVP_CTX *ctx) {
     CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_set_prereq(ctx, ACVP_HMAC_SHA3_512, ACVP_PREREQ_SHA, value);
     CHECK_ENABLE_CAP_RV(rv);
+
+    /* Each group's test cases through one MAC context */
+    for (i = ACVP_HMAC_SHA1; i <= ACVP_HMAC_SHA3_512; i++) {
+        rv = acvp_cap_mac_set_batch_handler(ctx, i, &app_hmac_batch_handler);
+        CHECK_ENABLE_CAP_RV(rv);
+    }
 end:
 
     return rv;
@@ -2498,6 +2653,8 @@ static int enable_dsa(ACVP_CTX *ctx) {
 #ifndef ACVP_FIPS186_5
     rv = acvp_cap_dsa_enable(ctx, ACVP_DSA_KEYGEN, &app_dsa_handler);
     CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_set_group_handler(ctx, ACVP_DSA_KEYGEN, &app_dsa_group_handler);
+    CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_set_prereq(ctx, ACVP_DSA_KEYGEN, ACVP_PREREQ_SHA, value);
     CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_set_prereq(ctx, ACVP_DSA_KEYGEN, ACVP_PREREQ_DRBG, value);
@@ -2511,6 +2668,8 @@ static int enable_dsa(ACVP_CTX *ctx) {
 
     rv = acvp_cap_dsa_enable(ctx, ACVP_DSA_SIGGEN, &app_dsa_handler);
     CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_set_group_handler(ctx, ACVP_DSA_SIGGEN, &app_dsa_group_handler);
+    CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_set_prereq(ctx, ACVP_DSA_SIGGEN, ACVP_PREREQ_SHA, value);
     CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_set_prereq(ctx, ACVP_DSA_SIGGEN, ACVP_PREREQ_DRBG, value);
@@ -2717,6 +2876,8 @@ static int enable_rsa(ACVP_CTX *ctx) {
     /* Enable siggen */
     rv = acvp_cap_rsa_sig_enable(ctx, ACVP_RSA_SIGGEN, &app_rsa_sig_handler);
     CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_set_group_handler(ctx, ACVP_RSA_SIGGEN, &app_rsa_group_handler);
+    CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_set_prereq(ctx, ACVP_RSA_SIGGEN, ACVP_PREREQ_SHA, value);
     CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_set_prereq(ctx, ACVP_RSA_SIGGEN, ACVP_PREREQ_DRBG, value);
@@ -3166,6 +3327,8 @@ static int enable_ecdsa(ACVP_CTX *ctx) {
     /* Enable ECDSA sigGen... */
     rv = acvp_cap_ecdsa_enable(ctx, ACVP_ECDSA_SIGGEN, &app_ecdsa_handler);
     CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_set_group_handler(ctx, ACVP_ECDSA_SIGGEN, &app_ecdsa_group_handler);
+    CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_set_prereq(ctx, ACVP_ECDSA_SIGGEN, ACVP_PREREQ_SHA, value);
     CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_set_prereq(ctx, ACVP_ECDSA_SIGGEN, ACVP_PREREQ_DRBG, value);
@@ -3228,6 +3391,8 @@ static int enable_ecdsa(ACVP_CTX *ctx) {
     /* Enable ECDSA sigGen... */
     rv = acvp_cap_ecdsa_enable(ctx, ACVP_DET_ECDSA_SIGGEN, &app_ecdsa_handler);
     CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_set_group_handler(ctx, ACVP_DET_ECDSA_SIGGEN, &app_ecdsa_group_handler);
+    CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_set_prereq(ctx, ACVP_DET_ECDSA_SIGGEN, ACVP_PREREQ_SHA, value);
     CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_set_prereq(ctx, ACVP_DET_ECDSA_SIGGEN, ACVP_PREREQ_DRBG, value);
@@ -3352,6 +3517,8 @@ static int enable_eddsa(ACVP_CTX *ctx) {
 
     rv = acvp_cap_eddsa_enable(ctx, ACVP_EDDSA_SIGGEN, &app_eddsa_handler);
     CHECK_ENABLE_CAP_RV(rv);
+    rv = acvp_cap_set_group_handler(ctx, ACVP_EDDSA_SIGGEN, &app_eddsa_group_handler);
+    CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_eddsa_set_parm(ctx, ACVP_EDDSA_SIGGEN, ACVP_EDDSA_CURVE, ACVP_ED_CURVE_25519);
     CHECK_ENABLE_CAP_RV(rv);
     rv = acvp_cap_eddsa_set_parm(ctx, ACVP_EDDSA_SIGGEN, ACVP_EDDSA_CURVE, ACVP_ED_CURVE_448);
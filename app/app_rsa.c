@@ -17,17 +17,281 @@
 #include <openssl/param_build.h>
 #include "safe_lib.h"
 
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
 #define RSA_BUF_MAX 8192
+#define RSA_POOL_DEPTH_MAX 8
+
+/*
+ * SigGen key pool.
+ *
+ * Each SigGen test group signs with a newly generated key of the group's
+ * modulus, and at 3072 and 4096 bits generating it takes far longer than the
+ * signatures do. Nothing about the key depends on the group beyond its modulus,
+ * which is one of those the app registers, so when asked (--rsa_threads) worker
+ * threads generate keys for those moduli ahead of time and keep a few of each
+ * ready. A new group takes the oldest ready key of its modulus and the workers
+ * replace it, starting with the modulus most recently asked for, since groups
+ * of one modulus tend to follow each other. Without the pool, or when no key
+ * of the modulus is ready or on its way, the key is generated in the handler.
+ */
+static const unsigned int rsa_pool_moduli[] = { 2048, 3072, 4096 };
+#define RSA_POOL_MODULI (sizeof(rsa_pool_moduli) / sizeof(rsa_pool_moduli[0]))
+
+typedef struct app_rsa_pool_slot_t {
+    EVP_PKEY *ready[RSA_POOL_DEPTH_MAX]; /* oldest first, from head */
+    unsigned int head;
+    unsigned int count;
+    unsigned int pending;                /* being generated by a worker */
+} APP_RSA_POOL_SLOT;
+
+#ifndef _WIN32
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t ready;   /* a key was added, or the pool is stopping */
+    pthread_cond_t room;    /* a key was taken, or the pool is stopping */
+    pthread_t *workers;
+    unsigned int threads;
+    unsigned int depth;
+    unsigned int last;      /* slot most recently asked for */
+    int running;
+    int stop;
+    APP_RSA_POOL_SLOT slots[RSA_POOL_MODULI];
+} rsa_pool;
+#endif
+
+/* cb, if given, is called as the primes are searched for; returning 0 abandons the key */
+static EVP_PKEY *app_rsa_generate_key(unsigned int modulo, EVP_PKEY_gen_cb *cb) {
+    EVP_PKEY_CTX *pkey_ctx = NULL;
+    EVP_PKEY *pkey = NULL;
+
+    pkey_ctx = EVP_PKEY_CTX_new_from_name(NULL, "RSA", NULL);
+    if (!pkey_ctx) {
+        printf("Error initializing pkey ctx for RSA key generation\n");
+        return NULL;
+    }
+    if (EVP_PKEY_keygen_init(pkey_ctx) != 1) {
+        printf("Error initializing pkey in RSA ctx\n");
+        goto end;
+    }
+    EVP_PKEY_CTX_set_rsa_keygen_bits(pkey_ctx, modulo);
+    if (cb) {
+        EVP_PKEY_CTX_set_cb(pkey_ctx, cb);
+    }
+    if (EVP_PKEY_keygen(pkey_ctx, &pkey) != 1) {
+        pkey = NULL;
+    }
+end:
+    EVP_PKEY_CTX_free(pkey_ctx);
+    return pkey;
+}
+
+#ifndef _WIN32
+/* Lets a worker give up the key it is generating once the pool is stopping */
+static int app_rsa_pool_keep_going(EVP_PKEY_CTX *pkey_ctx) {
+    int stop = 0;
+
+    (void)pkey_ctx;
+    pthread_mutex_lock(&rsa_pool.lock);
+    stop = rsa_pool.stop;
+    pthread_mutex_unlock(&rsa_pool.lock);
+    return !stop;
+}
+
+/* Picks the slot a worker should fill next, or -1 if every slot is full. Called locked. */
+static int app_rsa_pool_pick(void) {
+    unsigned int i = 0, s = 0;
+
+    for (i = 0; i < RSA_POOL_MODULI; i++) {
+        s = (rsa_pool.last + i) % RSA_POOL_MODULI;
+        if (rsa_pool.slots[s].count + rsa_pool.slots[s].pending < rsa_pool.depth) {
+            return (int)s;
+        }
+    }
+    return -1;
+}
+
+static void *app_rsa_pool_worker(void *arg) {
+    APP_RSA_POOL_SLOT *slot = NULL;
+    EVP_PKEY *pkey = NULL;
+    int s = 0;
+
+    (void)arg;
+    pthread_mutex_lock(&rsa_pool.lock);
+    while (!rsa_pool.stop) {
+        s = app_rsa_pool_pick();
+        if (s < 0) {
+            pthread_cond_wait(&rsa_pool.room, &rsa_pool.lock);
+            continue;
+        }
+        slot = &rsa_pool.slots[s];
+        slot->pending++;
+        pthread_mutex_unlock(&rsa_pool.lock);
+
+        pkey = app_rsa_generate_key(rsa_pool_moduli[s], app_rsa_pool_keep_going);
+
+        pthread_mutex_lock(&rsa_pool.lock);
+        slot->pending--;
+        /* A waiting handler generates the key itself if this one failed */
+        pthread_cond_broadcast(&rsa_pool.ready);
+        if (!pkey) {
+            if (!rsa_pool.stop) {
+                printf("Error generating RSA key in the SigGen key pool; leaving it to the handler\n");
+            }
+            break;
+        }
+        if (rsa_pool.stop) {
+            EVP_PKEY_free(pkey);
+        } else {
+            slot->ready[(slot->head + slot->count) % RSA_POOL_DEPTH_MAX] = pkey;
+            slot->count++;
+        }
+        pkey = NULL;
+    }
+    pthread_mutex_unlock(&rsa_pool.lock);
+    return NULL;
+}
+#endif
+
+int app_rsa_pool_start(unsigned int threads) {
+#ifndef _WIN32
+    unsigned int i = 0;
+
+    if (rsa_pool.running || !threads) {
+        return 1;
+    }
+    memzero_s(&rsa_pool, sizeof(rsa_pool));
+    rsa_pool.workers = calloc(threads, sizeof(pthread_t));
+    if (!rsa_pool.workers) {
+        return 1;
+    }
+    rsa_pool.depth = threads > RSA_POOL_DEPTH_MAX ? RSA_POOL_DEPTH_MAX : threads;
+    pthread_mutex_init(&rsa_pool.lock, NULL);
+    pthread_cond_init(&rsa_pool.ready, NULL);
+    pthread_cond_init(&rsa_pool.room, NULL);
+    rsa_pool.running = 1;
+    for (i = 0; i < threads; i++) {
+        if (pthread_create(&rsa_pool.workers[i], NULL, app_rsa_pool_worker, NULL) != 0) {
+            printf("Unable to start RSA key generation thread %u; continuing with fewer\n", i);
+            break;
+        }
+        rsa_pool.threads++;
+    }
+    return 0;
+#else
+    (void)threads;
+    printf("RSA key generation threads are not supported on this platform; keys are generated as needed\n");
+    return 1;
+#endif
+}
+
+static void app_rsa_pool_stop(void) {
+#ifndef _WIN32
+    APP_RSA_POOL_SLOT *slot = NULL;
+    unsigned int i = 0;
+
+    if (!rsa_pool.running) {
+        return;
+    }
+    pthread_mutex_lock(&rsa_pool.lock);
+    rsa_pool.stop = 1;
+    pthread_cond_broadcast(&rsa_pool.room);
+    pthread_cond_broadcast(&rsa_pool.ready);
+    pthread_mutex_unlock(&rsa_pool.lock);
+    for (i = 0; i < rsa_pool.threads; i++) {
+        pthread_join(rsa_pool.workers[i], NULL);
+    }
+    for (i = 0; i < RSA_POOL_MODULI; i++) {
+        slot = &rsa_pool.slots[i];
+        while (slot->count) {
+            EVP_PKEY_free(slot->ready[slot->head]);
+            slot->head = (slot->head + 1) % RSA_POOL_DEPTH_MAX;
+            slot->count--;
+        }
+    }
+    pthread_cond_destroy(&rsa_pool.room);
+    pthread_cond_destroy(&rsa_pool.ready);
+    pthread_mutex_destroy(&rsa_pool.lock);
+    free(rsa_pool.workers);
+    memzero_s(&rsa_pool, sizeof(rsa_pool));
+#endif
+}
+
+/* Returns a new key of the given modulus, from the pool if it has (or is about to have) one */
+static EVP_PKEY *app_rsa_pool_take(unsigned int modulo) {
+#ifndef _WIN32
+    APP_RSA_POOL_SLOT *slot = NULL;
+    EVP_PKEY *pkey = NULL;
+    unsigned int s = 0;
+
+    if (rsa_pool.running) {
+        for (s = 0; s < RSA_POOL_MODULI; s++) {
+            if (rsa_pool_moduli[s] == modulo) break;
+        }
+    }
+    if (!rsa_pool.running || s == RSA_POOL_MODULI) {
+        return app_rsa_generate_key(modulo, NULL);
+    }
 
-int rsa_current_tg = 0;
-BIGNUM *group_n = NULL;
-EVP_PKEY *group_pkey = NULL;
+    slot = &rsa_pool.slots[s];
+    pthread_mutex_lock(&rsa_pool.lock);
+    rsa_pool.last = s;
+    while (!slot->count && slot->pending && !rsa_pool.stop) {
+        pthread_cond_wait(&rsa_pool.ready, &rsa_pool.lock);
+    }
+    if (slot->count) {
+        pkey = slot->ready[slot->head];
+        slot->head = (slot->head + 1) % RSA_POOL_DEPTH_MAX;
+        slot->count--;
+    }
+    pthread_cond_broadcast(&rsa_pool.room);
+    pthread_mutex_unlock(&rsa_pool.lock);
+    if (pkey) {
+        return pkey;
+    }
+#endif
+    return app_rsa_generate_key(modulo, NULL);
+}
 
 void app_rsa_cleanup(void) {
-    if (group_pkey) EVP_PKEY_free(group_pkey);
-    group_pkey = NULL;
-    if (group_n) BN_free(group_n);
-    group_n = NULL;
+    app_rsa_pool_stop();
+}
+
+static void app_rsa_group_free(void *value) {
+    EVP_PKEY_free(value);
+}
+
+/* Takes the key a SigGen test group signs with, kept in the group cache under the group's tg_id */
+int app_rsa_group_handler(ACVP_GROUP_EVENT event, ACVP_TEST_CASE *test_case) {
+    ACVP_RSA_SIG_TC *tc = NULL;
+    EVP_PKEY *pkey = NULL;
+
+    if (!test_case || !test_case->tc.rsa_sig) {
+        return 1;
+    }
+    tc = test_case->tc.rsa_sig;
+    if (tc->sig_mode != ACVP_RSA_SIGGEN) {
+        return 0;
+    }
+    if (event == ACVP_GROUP_END) {
+        acvp_group_cache_remove(test_case->group_cache, &tc->tg_id, sizeof(tc->tg_id));
+        return 0;
+    }
+
+    pkey = app_rsa_pool_take(tc->modulo);
+    if (!pkey) {
+        printf("Error generating pkey in RSA context\n");
+        return 1;
+    }
+    if (acvp_group_cache_set(test_case->group_cache, &tc->tg_id, sizeof(tc->tg_id),
+                             pkey, app_rsa_group_free) != ACVP_SUCCESS) {
+        printf("Error caching group key in RSA siggen\n");
+        EVP_PKEY_free(pkey);
+        return 1;
+    }
+    return 0;
 }
 
 int app_rsa_keygen_handler(ACVP_TEST_CASE *test_case) {
@@ -150,13 +414,13 @@ err:
 
 int app_rsa_sig_handler(ACVP_TEST_CASE *test_case) {
     EVP_MD_CTX *md_ctx = NULL;
-    EVP_PKEY *pkey = NULL;
+    EVP_PKEY *pkey = NULL, *group_pkey = NULL;
     EVP_PKEY_CTX *pkey_ctx = NULL;
     OSSL_PARAM_BLD *pkey_pbld = NULL, *sig_pbld = NULL;
     OSSL_PARAM *pkey_params = NULL, *sig_params = NULL;
     const char *padding = NULL, *md = NULL;
     int salt_len = -1;
-    BIGNUM *bn_e = NULL, *e = NULL, *n = NULL;
+    BIGNUM *e = NULL, *n = NULL;
     ACVP_RSA_SIG_TC *tc;
 
     int rv = 1;
@@ -173,12 +437,6 @@ int app_rsa_sig_handler(ACVP_TEST_CASE *test_case) {
         goto err;
     }
 
-    bn_e = BN_new();
-    if (!bn_e || !BN_set_word(bn_e, 0x10001)) {
-        printf("\nError: Issue with exponent in RSA Sig\n");
-        goto err;
-    }
-
     if (!tc->modulo) {
         printf("\nError: Issue with modulo in RSA Sig\n");
         goto err;
@@ -278,41 +536,19 @@ int app_rsa_sig_handler(ACVP_TEST_CASE *test_case) {
             tc->ver_disposition = 1;
         }
     } else {
-        if (rsa_current_tg != tc->tg_id) {
-            rsa_current_tg = tc->tg_id;
-
-            if (group_pkey) EVP_PKEY_free(group_pkey);
-            group_pkey = NULL;
-            if (group_n) BN_free(group_n);
-            group_n = NULL;
-
-            pkey_ctx = EVP_PKEY_CTX_new_from_name(NULL, "RSA", NULL);
-            if (!pkey_ctx) {
-                printf("Error initializing pkey ctx for RSA siggen\n");
-                goto err;
-            }
-            if (EVP_PKEY_keygen_init(pkey_ctx) != 1) {
-                printf("Error initializing pkey in RSA ctx\n");
-                goto err;
-            }
-            EVP_PKEY_CTX_set_rsa_keygen_bits(pkey_ctx, tc->modulo);
-
-            if (EVP_PKEY_keygen(pkey_ctx, &group_pkey) != 1) {
-                printf("Error generating pkey in RSA context\n");
-                goto err;
-            }
-            if (EVP_PKEY_get_bn_param(group_pkey, "e", &e) != 1) {
-                printf("Error retrieving e from generated pkey in RSA siggen\n");
-                goto err;
-            }
-            if (EVP_PKEY_get_bn_param(group_pkey, "n", &n) != 1) {
-                printf("Error retrieving n from generated pkey in RSA siggen\n");
-                goto err;
-            }
-            group_n = BN_dup(n);
-        } else {
-            e = BN_dup(bn_e);
-            n = BN_dup(group_n);
+        /* The group handler took the group's key */
+        group_pkey = acvp_group_cache_get(test_case->group_cache, &tc->tg_id, sizeof(tc->tg_id));
+        if (!group_pkey) {
+            printf("No key for the test group in RSA siggen\n");
+            goto err;
+        }
+        if (EVP_PKEY_get_bn_param(group_pkey, "e", &e) != 1) {
+            printf("Error retrieving e from generated pkey in RSA siggen\n");
+            goto err;
+        }
+        if (EVP_PKEY_get_bn_param(group_pkey, "n", &n) != 1) {
+            printf("Error retrieving n from generated pkey in RSA siggen\n");
+            goto err;
         }
         tc->e_len = BN_bn2bin(e, tc->e);
         tc->n_len = BN_bn2bin(n, tc->n);
@@ -359,7 +595,6 @@ err:
     if (sig_pbld) OSSL_PARAM_BLD_free(sig_pbld);
     if (pkey_params) OSSL_PARAM_free(pkey_params);
     if (sig_params) OSSL_PARAM_free(sig_params);
-    if (bn_e) BN_free(bn_e);
     if (e) BN_free(e);
     if (n) BN_free(n);
 
@@ -659,6 +894,14 @@ int app_rsa_sig_handler(ACVP_TEST_CASE *test_case) {
     return 1;
 }
 
+int app_rsa_group_handler(ACVP_GROUP_EVENT event, ACVP_TEST_CASE *test_case) {
+    if (!test_case) {
+        return -1;
+    }
+    (void)event;
+    return 1;
+}
+
 int app_rsa_sigprim_handler(ACVP_TEST_CASE *test_case) {
     if (!test_case) {
         return -1;
@@ -8,11 +8,46 @@
  */
 
 #include "app_lcl.h"
+#include "app_sha_mb.h"
 #include <openssl/evp.h>
 
 #include "safe_mem_lib.h"
 
 int app_sha_ldt_handler(ACVP_HASH_TC *tc, const EVP_MD *md);
+static int app_sha_ldt_stream_handler(ACVP_HASH_TC *tc, const EVP_MD *md);
+
+static const EVP_MD *app_sha_get_md(ACVP_SUB_HASH alg) {
+    switch (alg) {
+    case ACVP_SUB_HASH_SHA1:
+        return EVP_sha1();
+    case ACVP_SUB_HASH_SHA2_224:
+        return EVP_sha224();
+    case ACVP_SUB_HASH_SHA2_256:
+        return EVP_sha256();
+    case ACVP_SUB_HASH_SHA2_384:
+        return EVP_sha384();
+    case ACVP_SUB_HASH_SHA2_512:
+        return EVP_sha512();
+    case ACVP_SUB_HASH_SHA2_512_224:
+        return EVP_sha512_224();
+    case ACVP_SUB_HASH_SHA2_512_256:
+        return EVP_sha512_256();
+    case ACVP_SUB_HASH_SHA3_224:
+        return EVP_sha3_224();
+    case ACVP_SUB_HASH_SHA3_256:
+        return EVP_sha3_256();
+    case ACVP_SUB_HASH_SHA3_384:
+        return EVP_sha3_384();
+    case ACVP_SUB_HASH_SHA3_512:
+        return EVP_sha3_512();
+    case ACVP_SUB_HASH_SHAKE_128:
+        return EVP_shake128();
+    case ACVP_SUB_HASH_SHAKE_256:
+        return EVP_shake256();
+    default:
+        return NULL;
+    }
+}
 
 int app_sha_handler(ACVP_TEST_CASE *test_case) {
     ACVP_HASH_TC    *tc;
@@ -36,56 +71,14 @@ int app_sha_handler(ACVP_TEST_CASE *test_case) {
         return 1;
     }
 
-    switch (alg) {
-    case ACVP_SUB_HASH_SHA1:
-        md = EVP_sha1();
-        break;
-    case ACVP_SUB_HASH_SHA2_224:
-        md = EVP_sha224();
-        break;
-    case ACVP_SUB_HASH_SHA2_256:
-        md = EVP_sha256();
-        break;
-    case ACVP_SUB_HASH_SHA2_384:
-        md = EVP_sha384();
-        break;
-    case ACVP_SUB_HASH_SHA2_512:
-        md = EVP_sha512();
-        break;
-    case ACVP_SUB_HASH_SHA2_512_224:
-        md = EVP_sha512_224();
-        break;
-    case ACVP_SUB_HASH_SHA2_512_256:
-        md = EVP_sha512_256();
-        break;
-    case ACVP_SUB_HASH_SHA3_224:
-        md = EVP_sha3_224();
-        sha3 = 1;
-        break;
-    case ACVP_SUB_HASH_SHA3_256:
-        md = EVP_sha3_256();
-        sha3 = 1;
-        break;
-    case ACVP_SUB_HASH_SHA3_384:
-        md = EVP_sha3_384();
-        sha3 = 1;
-        break;
-    case ACVP_SUB_HASH_SHA3_512:
-        md = EVP_sha3_512();
-        sha3 = 1;
-        break;
-    case ACVP_SUB_HASH_SHAKE_128:
-        md = EVP_shake128();
-        shake = 1;
-        break;
-    case ACVP_SUB_HASH_SHAKE_256:
-        md = EVP_shake256();
-        shake = 1;
-        break;
-    default:
+    md = app_sha_get_md(alg);
+    if (!md) {
         printf("Error: Unsupported hash algorithm requested by ACVP server\n");
         return ACVP_NO_CAP;
     }
+    sha3 = alg == ACVP_SUB_HASH_SHA3_224 || alg == ACVP_SUB_HASH_SHA3_256 ||
+           alg == ACVP_SUB_HASH_SHA3_384 || alg == ACVP_SUB_HASH_SHA3_512;
+    shake = alg == ACVP_SUB_HASH_SHAKE_128 || alg == ACVP_SUB_HASH_SHAKE_256;
 
     if (!tc->md) {
         printf("\nCrypto module error, md memory not allocated by library\n");
@@ -93,7 +86,11 @@ int app_sha_handler(ACVP_TEST_CASE *test_case) {
     }
     md_ctx = EVP_MD_CTX_create();
     if (tc->test_type == ACVP_HASH_TEST_TYPE_LDT) {
-        rc = app_sha_ldt_handler(tc, md);
+        if (tc->ldt_stage != ACVP_HASH_LDT_NONE) {
+            rc = app_sha_ldt_stream_handler(tc, md);
+        } else {
+            rc = app_sha_ldt_handler(tc, md);
+        }
         goto end;
     } else if (tc->test_type == ACVP_HASH_TEST_TYPE_MCT && !sha3 && !shake) {
         /* If Monte Carlo we need to be able to init and then update
@@ -158,6 +155,49 @@ end:
     return rc;
 }
 
+/*
+ * Large data test fed in pieces by libacvp. The digest context is kept in
+ * tc->ldt_state from the INIT call until the FINAL call.
+ */
+static int app_sha_ldt_stream_handler(ACVP_HASH_TC *tc, const EVP_MD *md) {
+    EVP_MD_CTX *md_ctx = tc->ldt_state;
+    int rv = 1;
+
+    switch (tc->ldt_stage) {
+    case ACVP_HASH_LDT_INIT:
+        printf("Performing hash large data test in pieces (This may take time...)\n");
+        md_ctx = EVP_MD_CTX_create();
+        if (!md_ctx || !EVP_DigestInit_ex(md_ctx, md, NULL)) {
+            printf("\nCrypto module error, EVP_DigestInit_ex failed\n");
+            if (md_ctx) EVP_MD_CTX_destroy(md_ctx);
+            return 1;
+        }
+        tc->ldt_state = md_ctx;
+        return 0;
+    case ACVP_HASH_LDT_UPDATE:
+        if (!md_ctx || !EVP_DigestUpdate(md_ctx, tc->ldt_chunk, tc->ldt_chunk_len)) {
+            printf("\nCrypto module error, EVP_DigestUpdate failed\n");
+            return 1;
+        }
+        return 0;
+    case ACVP_HASH_LDT_FINAL:
+        if (!md_ctx) {
+            return 1;
+        }
+        if (!EVP_DigestFinal(md_ctx, tc->md, &tc->md_len)) {
+            printf("\nCrypto module error, EVP_DigestFinal failed\n");
+        } else {
+            rv = 0;
+        }
+        EVP_MD_CTX_destroy(md_ctx);
+        tc->ldt_state = NULL;
+        return rv;
+    case ACVP_HASH_LDT_NONE:
+    default:
+        return 1;
+    }
+}
+
 /**
  * 1) malloc buffer, concat full message, process with a single call;
  * 2) oneshot function or a single call to update; never multiple calls to update
@@ -165,23 +205,28 @@ end:
  */
 int app_sha_ldt_handler(ACVP_HASH_TC *tc, const EVP_MD *md) {
     unsigned char *large_data = NULL, *iter = NULL;
+    const unsigned char *data = NULL;
     int numcopies = 0, i = 0, rv = 1;
     EVP_MD_CTX *md_ctx = NULL;
 
     printf("Performing hash large data test (This may take time...)\n");
 
-    large_data = calloc(tc->exp_len, sizeof(unsigned char));
-    if (!large_data) {
-        printf("Error: Unable to allocate memory for large data test (Needed %llu bytes)\n", tc->exp_len);
-        return 1;
-    }
+    /* Where possible, map the message repeatedly instead of copying it out in full */
+    if (acvp_hash_ldt_map(tc, &data) != ACVP_SUCCESS) {
+        large_data = calloc(tc->exp_len, sizeof(unsigned char));
+        if (!large_data) {
+            printf("Error: Unable to allocate memory for large data test (Needed %llu bytes)\n", tc->exp_len);
+            return 1;
+        }
 
-    /* We have to copy the message into the buffer many times. Assume concatenation as it is the only mode currently */
-    numcopies = tc->exp_len / tc->msg_len;
-    iter = large_data;
-    for (i = 0; i < numcopies; i++) {
-        memcpy_s(iter, tc->exp_len - (i * tc->msg_len), tc->msg, tc->msg_len);
-        iter += tc->msg_len;
+        /* We have to copy the message into the buffer many times. Assume concatenation as it is the only mode currently */
+        numcopies = tc->exp_len / tc->msg_len;
+        iter = large_data;
+        for (i = 0; i < numcopies; i++) {
+            memcpy_s(iter, tc->exp_len - (i * tc->msg_len), tc->msg, tc->msg_len);
+            iter += tc->msg_len;
+        }
+        data = large_data;
     }
 
     md_ctx = EVP_MD_CTX_create();
@@ -192,7 +237,7 @@ int app_sha_ldt_handler(ACVP_HASH_TC *tc, const EVP_MD *md) {
     }
 
     /* Update MUST only be called once */
-    if (!EVP_DigestUpdate(md_ctx, large_data, tc->exp_len)) {
+    if (!EVP_DigestUpdate(md_ctx, data, tc->exp_len)) {
         printf("\nCrypto module error, EVP_DigestUpdate failed\n");
         goto end;
     }
@@ -203,7 +248,196 @@ int app_sha_ldt_handler(ACVP_HASH_TC *tc, const EVP_MD *md) {
 
     rv = 0;
 end:
+    acvp_hash_ldt_unmap(tc);
     if (large_data) free(large_data);
     if (md_ctx) EVP_MD_CTX_destroy(md_ctx);
     return rv;
 }
+
+/*
+ * Runs a whole hash Monte Carlo test from the seed on one digest context,
+ * leaving the digest that ends each outer iteration in tc->mct_md.
+ */
+int app_sha_mct_handler(ACVP_TEST_CASE *test_case) {
+    ACVP_HASH_TC *tc;
+    const EVP_MD *md;
+    EVP_MD_CTX *md_ctx = NULL;
+    unsigned char m[3][EVP_MAX_MD_SIZE];
+    unsigned char in[16];
+    unsigned char *out = NULL;
+    unsigned int i = 0, j = 0, oldest = 0, len = 0, out_len = 0;
+    unsigned int min_len = 0, range = 0;
+    int rc = 1;
+    ACVP_SUB_HASH alg;
+
+    if (!test_case) {
+        return 1;
+    }
+
+    tc = test_case->tc.hash;
+    if (!tc || !tc->msg || !tc->mct_md || !tc->mct_md_len) return rc;
+
+    alg = acvp_get_hash_alg(tc->cipher);
+    md = app_sha_get_md(alg);
+    if (!md) {
+        printf("Error: Unsupported hash algorithm requested by ACVP server\n");
+        return ACVP_NO_CAP;
+    }
+
+    md_ctx = EVP_MD_CTX_create();
+    if (!md_ctx) return rc;
+
+    if (alg == ACVP_SUB_HASH_SHAKE_128 || alg == ACVP_SUB_HASH_SHAKE_256) {
+        /* The message is the leftmost 128 bits of the previous output, zero padded */
+        min_len = tc->min_xof_bits / 8;
+        range = tc->max_xof_bits / 8 - min_len + 1;
+        out_len = tc->max_xof_bits / 8;
+        if (out_len > tc->mct_md_max || min_len < 2) goto end;
+        memzero_s(in, sizeof(in));
+        memcpy_s(in, sizeof(in), tc->msg, tc->msg_len < sizeof(in) ? tc->msg_len : sizeof(in));
+        for (i = 0; i < tc->mct_count; i++) {
+            out = tc->mct_md + (size_t)i * tc->mct_md_max;
+            for (j = 0; j < ACVP_HASH_MCT_INNER; j++) {
+                if (!EVP_DigestInit_ex(md_ctx, md, NULL) ||
+                    !EVP_DigestUpdate(md_ctx, in, sizeof(in)) ||
+                    !EVP_DigestFinalXOF(md_ctx, out, out_len)) {
+                    printf("\nCrypto module error, SHAKE MCT digest failed\n");
+                    goto end;
+                }
+                len = out_len;
+                memzero_s(in, sizeof(in));
+                memcpy_s(in, sizeof(in), out, len < sizeof(in) ? len : sizeof(in));
+                out_len = min_len + (((unsigned int)out[len - 2] << 8) | out[len - 1]) % range;
+            }
+            tc->mct_md_len[i] = len;
+        }
+    } else if (alg == ACVP_SUB_HASH_SHA3_224 || alg == ACVP_SUB_HASH_SHA3_256 ||
+               alg == ACVP_SUB_HASH_SHA3_384 || alg == ACVP_SUB_HASH_SHA3_512) {
+        /* Each digest is the next message */
+        const unsigned char *msg = tc->msg;
+
+        len = tc->msg_len;
+        for (i = 0; i < tc->mct_count; i++) {
+            out = tc->mct_md + (size_t)i * tc->mct_md_max;
+            for (j = 0; j < ACVP_HASH_MCT_INNER; j++) {
+                if (!EVP_DigestInit_ex(md_ctx, md, NULL) ||
+                    !EVP_DigestUpdate(md_ctx, msg, len) ||
+                    !EVP_DigestFinal_ex(md_ctx, m[0], &len)) {
+                    printf("\nCrypto module error, SHA3 MCT digest failed\n");
+                    goto end;
+                }
+                msg = m[0];
+            }
+            memcpy_s(out, tc->mct_md_max, m[0], len);
+            tc->mct_md_len[i] = len;
+        }
+    } else {
+        /*
+         * Each message is the last three digests, oldest first, and every
+         * outer iteration starts over from its final digest three times.
+         */
+        len = tc->msg_len;
+        if (len > sizeof(m[0]) || len != (unsigned int)EVP_MD_size(md)) goto end;
+        memcpy_s(m[0], sizeof(m[0]), tc->msg, len);
+        for (i = 0; i < tc->mct_count; i++) {
+            memcpy_s(m[1], sizeof(m[1]), m[0], len);
+            memcpy_s(m[2], sizeof(m[2]), m[0], len);
+            oldest = 0;
+            for (j = 0; j < ACVP_HASH_MCT_INNER; j++) {
+                if (!EVP_DigestInit_ex(md_ctx, md, NULL) ||
+                    !EVP_DigestUpdate(md_ctx, m[oldest], len) ||
+                    !EVP_DigestUpdate(md_ctx, m[(oldest + 1) % 3], len) ||
+                    !EVP_DigestUpdate(md_ctx, m[(oldest + 2) % 3], len) ||
+                    !EVP_DigestFinal_ex(md_ctx, m[oldest], &out_len)) {
+                    printf("\nCrypto module error, SHA MCT digest failed\n");
+                    goto end;
+                }
+                oldest = (oldest + 1) % 3;
+            }
+            /* The newest digest is the one just before the oldest */
+            memcpy_s(m[0], sizeof(m[0]), m[(oldest + 2) % 3], len);
+            memcpy_s(tc->mct_md + (size_t)i * tc->mct_md_max, tc->mct_md_max, m[0], len);
+            tc->mct_md_len[i] = len;
+        }
+    }
+
+    rc = 0;
+
+end:
+    if (md_ctx) EVP_MD_CTX_destroy(md_ctx);
+    return rc;
+}
+
+static int app_sha_get_mb_alg(ACVP_SUB_HASH alg, APP_SHA_MB_ALG *mb_alg) {
+    switch (alg) {
+    case ACVP_SUB_HASH_SHA2_224:
+        *mb_alg = APP_SHA_MB_SHA224;
+        return 1;
+    case ACVP_SUB_HASH_SHA2_256:
+        *mb_alg = APP_SHA_MB_SHA256;
+        return 1;
+    case ACVP_SUB_HASH_SHA2_384:
+        *mb_alg = APP_SHA_MB_SHA384;
+        return 1;
+    case ACVP_SUB_HASH_SHA2_512:
+        *mb_alg = APP_SHA_MB_SHA512;
+        return 1;
+    case ACVP_SUB_HASH_SHA2_512_224:
+        *mb_alg = APP_SHA_MB_SHA512_224;
+        return 1;
+    case ACVP_SUB_HASH_SHA2_512_256:
+        *mb_alg = APP_SHA_MB_SHA512_256;
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/*
+ * Digests a batch of AFT test cases. libacvp only batches messages that pad to
+ * the same number of blocks, so SHA-2 batches go through the multi-lane code a
+ * full set of lanes at a time; anything else is done one test case at a time.
+ */
+int app_sha_batch_handler(ACVP_TEST_CASE *test_cases, unsigned int count) {
+    ACVP_HASH_TC *tc = NULL;
+    APP_SHA_MB_ALG mb_alg = APP_SHA_MB_SHA256;
+    const unsigned char *msg[APP_SHA_MB_LANES];
+    unsigned int msg_len[APP_SHA_MB_LANES];
+    unsigned char *md[APP_SHA_MB_LANES];
+    unsigned int i = 0, j = 0, n = 0;
+
+    if (!test_cases || !count || !test_cases[0].tc.hash) {
+        return 1;
+    }
+
+    if (!app_sha_get_mb_alg(acvp_get_hash_alg(test_cases[0].tc.hash->cipher), &mb_alg)) {
+        for (i = 0; i < count; i++) {
+            if (app_sha_handler(&test_cases[i])) {
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    for (i = 0; i < count; i += n) {
+        n = count - i < APP_SHA_MB_LANES ? count - i : APP_SHA_MB_LANES;
+        for (j = 0; j < n; j++) {
+            tc = test_cases[i + j].tc.hash;
+            if (!tc || !tc->md || tc->cipher != test_cases[0].tc.hash->cipher) {
+                printf("\nCrypto module error, bad test case in hash batch\n");
+                return 1;
+            }
+            msg[j] = tc->msg;
+            msg_len[j] = tc->msg_len;
+            md[j] = tc->md;
+        }
+        if (app_sha_mb(mb_alg, msg, msg_len, n, md)) {
+            printf("\nCrypto module error, multi-lane SHA-2 failed\n");
+            return 1;
+        }
+        for (j = 0; j < n; j++) {
+            test_cases[i + j].tc.hash->md_len = app_sha_mb_md_len(mb_alg);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,344 @@
+/*
+ * Copyright (c) 2024, Cisco Systems, Inc.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://github.com/cisco/libacvp/LICENSE
+ */
+
+/*
+ * Portable multi-lane SHA-2, used by the demo app to exercise libacvp's hash
+ * batch path.
+ *
+ * Up to APP_SHA_MB_LANES messages that pad to the same number of blocks are
+ * hashed side by side. Every step of the compression function loops over the
+ * lanes innermost, with the state and message schedule laid out lane by
+ * lane, so an optimizing compiler can turn each step into one SIMD operation
+ * across the lanes; no intrinsics or assembly are involved.
+ *
+ * This is not the module under test (OpenSSL is), so it is only used when
+ * asked for on the command line.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "app_sha_mb.h"
+
+#define ROTR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+#define ROTR64(x, n) (((x) >> (n)) | ((x) << (64 - (n))))
+
+static const uint32_t k256[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static const uint64_t k512[80] = {
+    0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL,
+    0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL,
+    0xd807aa98a3030242ULL, 0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+    0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL, 0xc19bf174cf692694ULL,
+    0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL, 0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL,
+    0x2de92c6f592b0275ULL, 0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+    0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL, 0xbf597fc7beef0ee4ULL,
+    0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL, 0x06ca6351e003826fULL, 0x142929670a0e6e70ULL,
+    0x27b70a8546d22ffcULL, 0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+    0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL, 0x92722c851482353bULL,
+    0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL, 0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL,
+    0xd192e819d6ef5218ULL, 0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+    0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL, 0x34b0bcb5e19b48a8ULL,
+    0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL, 0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL,
+    0x748f82ee5defb2fcULL, 0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+    0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL, 0xc67178f2e372532bULL,
+    0xca273eceea26619cULL, 0xd186b8c721c0c207ULL, 0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL,
+    0x06f067aa72176fbaULL, 0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+    0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL, 0x431d67c49c100d4cULL,
+    0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL, 0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL
+};
+
+static const uint32_t iv224[8] = {
+    0xc1059ed8, 0x367cd507, 0x3070dd17, 0xf70e5939, 0xffc00b31, 0x68581511, 0x64f98fa7, 0xbefa4fa4
+};
+
+static const uint32_t iv256[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+static const uint64_t iv384[8] = {
+    0xcbbb9d5dc1059ed8ULL, 0x629a292a367cd507ULL, 0x9159015a3070dd17ULL, 0x152fecd8f70e5939ULL,
+    0x67332667ffc00b31ULL, 0x8eb44a8768581511ULL, 0xdb0c2e0d64f98fa7ULL, 0x47b5481dbefa4fa4ULL
+};
+
+static const uint64_t iv512[8] = {
+    0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+    0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+};
+
+static const uint64_t iv512_224[8] = {
+    0x8c3d37c819544da2ULL, 0x73e1996689dcd4d6ULL, 0x1dfab7ae32ff9c82ULL, 0x679dd514582f9fcfULL,
+    0x0f6d2b697bd44da8ULL, 0x77e36f7304c48942ULL, 0x3f9d85a86a1d36c8ULL, 0x1112e6ad91d692a1ULL
+};
+
+static const uint64_t iv512_256[8] = {
+    0x22312194fc2bf72cULL, 0x9f555fa3c84c64c2ULL, 0x2393b86b6f53b151ULL, 0x963877195940eabdULL,
+    0x96283ee2a88effe3ULL, 0xbe5e1e2553863992ULL, 0x2b0199fc2c85b8aaULL, 0x0eb72ddc81c52ca2ULL
+};
+
+/* Blocks taken by a message of len bytes once padded (9 or 17 bytes at least) */
+static unsigned int app_sha_mb_blocks(unsigned int len, unsigned int block_size) {
+    unsigned int pad = block_size == 64 ? 9 : 17;
+
+    return (unsigned int)(((unsigned long long)len + pad + block_size - 1) / block_size);
+}
+
+/*
+ * Writes block b of the padded message: the message bytes that fall in it,
+ * the 0x80 marker after the last one and the bit length at the very end.
+ */
+static void app_sha_mb_block(unsigned char *out, unsigned int block_size,
+                             const unsigned char *msg, unsigned int len,
+                             unsigned int blocks, unsigned int b) {
+    unsigned long long off = (unsigned long long)b * block_size, bits = 0;
+    unsigned int n = 0, i = 0;
+
+    if (len > off) {
+        n = len - off < block_size ? (unsigned int)(len - off) : block_size;
+        memcpy(out, msg + off, n);
+    }
+    memset(out + n, 0, block_size - n);
+    if (len >= off && len < off + block_size) {
+        out[len - off] = 0x80;
+    }
+    if (b == blocks - 1) {
+        bits = (unsigned long long)len * 8;
+        for (i = 0; i < 8; i++) {
+            out[block_size - 1 - i] = (unsigned char)(bits >> (8 * i));
+        }
+    }
+}
+
+static void app_sha256_mb_compress(uint32_t st[8][APP_SHA_MB_LANES],
+                                   unsigned char blk[APP_SHA_MB_LANES][128]) {
+    uint32_t w[64][APP_SHA_MB_LANES];
+    uint32_t v[8][APP_SHA_MB_LANES];
+    uint32_t t1 = 0, t2 = 0;
+    int t = 0, l = 0, i = 0;
+
+    for (t = 0; t < 16; t++) {
+        for (l = 0; l < APP_SHA_MB_LANES; l++) {
+            const unsigned char *p = blk[l] + 4 * t;
+
+            w[t][l] = (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+        }
+    }
+    for (t = 16; t < 64; t++) {
+        for (l = 0; l < APP_SHA_MB_LANES; l++) {
+            uint32_t x = w[t - 15][l], y = w[t - 2][l];
+
+            w[t][l] = (ROTR32(y, 17) ^ ROTR32(y, 19) ^ (y >> 10)) + w[t - 7][l] +
+                      (ROTR32(x, 7) ^ ROTR32(x, 18) ^ (x >> 3)) + w[t - 16][l];
+        }
+    }
+
+    memcpy(v, st, sizeof(v));
+    for (t = 0; t < 64; t++) {
+        for (l = 0; l < APP_SHA_MB_LANES; l++) {
+            uint32_t a = v[0][l], e = v[4][l];
+
+            t1 = v[7][l] + (ROTR32(e, 6) ^ ROTR32(e, 11) ^ ROTR32(e, 25)) +
+                 ((e & v[5][l]) ^ (~e & v[6][l])) + k256[t] + w[t][l];
+            t2 = (ROTR32(a, 2) ^ ROTR32(a, 13) ^ ROTR32(a, 22)) +
+                 ((a & v[1][l]) ^ (a & v[2][l]) ^ (v[1][l] & v[2][l]));
+            v[7][l] = v[6][l];
+            v[6][l] = v[5][l];
+            v[5][l] = e;
+            v[4][l] = v[3][l] + t1;
+            v[3][l] = v[2][l];
+            v[2][l] = v[1][l];
+            v[1][l] = a;
+            v[0][l] = t1 + t2;
+        }
+    }
+    for (i = 0; i < 8; i++) {
+        for (l = 0; l < APP_SHA_MB_LANES; l++) {
+            st[i][l] += v[i][l];
+        }
+    }
+}
+
+static void app_sha512_mb_compress(uint64_t st[8][APP_SHA_MB_LANES],
+                                   unsigned char blk[APP_SHA_MB_LANES][128]) {
+    uint64_t w[80][APP_SHA_MB_LANES];
+    uint64_t v[8][APP_SHA_MB_LANES];
+    uint64_t t1 = 0, t2 = 0;
+    int t = 0, l = 0, i = 0, j = 0;
+
+    for (t = 0; t < 16; t++) {
+        for (l = 0; l < APP_SHA_MB_LANES; l++) {
+            const unsigned char *p = blk[l] + 8 * t;
+            uint64_t x = 0;
+
+            for (j = 0; j < 8; j++) {
+                x = x << 8 | p[j];
+            }
+            w[t][l] = x;
+        }
+    }
+    for (t = 16; t < 80; t++) {
+        for (l = 0; l < APP_SHA_MB_LANES; l++) {
+            uint64_t x = w[t - 15][l], y = w[t - 2][l];
+
+            w[t][l] = (ROTR64(y, 19) ^ ROTR64(y, 61) ^ (y >> 6)) + w[t - 7][l] +
+                      (ROTR64(x, 1) ^ ROTR64(x, 8) ^ (x >> 7)) + w[t - 16][l];
+        }
+    }
+
+    memcpy(v, st, sizeof(v));
+    for (t = 0; t < 80; t++) {
+        for (l = 0; l < APP_SHA_MB_LANES; l++) {
+            uint64_t a = v[0][l], e = v[4][l];
+
+            t1 = v[7][l] + (ROTR64(e, 14) ^ ROTR64(e, 18) ^ ROTR64(e, 41)) +
+                 ((e & v[5][l]) ^ (~e & v[6][l])) + k512[t] + w[t][l];
+            t2 = (ROTR64(a, 28) ^ ROTR64(a, 34) ^ ROTR64(a, 39)) +
+                 ((a & v[1][l]) ^ (a & v[2][l]) ^ (v[1][l] & v[2][l]));
+            v[7][l] = v[6][l];
+            v[6][l] = v[5][l];
+            v[5][l] = e;
+            v[4][l] = v[3][l] + t1;
+            v[3][l] = v[2][l];
+            v[2][l] = v[1][l];
+            v[1][l] = a;
+            v[0][l] = t1 + t2;
+        }
+    }
+    for (i = 0; i < 8; i++) {
+        for (l = 0; l < APP_SHA_MB_LANES; l++) {
+            st[i][l] += v[i][l];
+        }
+    }
+}
+
+/*
+ * Hashes up to APP_SHA_MB_LANES messages of the same padded block count. The
+ * spare lanes repeat the first message, and their results are dropped.
+ */
+static void app_sha_mb_lanes(APP_SHA_MB_ALG alg,
+                             const unsigned char *const *msg,
+                             const unsigned int *msg_len,
+                             unsigned int lanes,
+                             unsigned int blocks,
+                             unsigned char *const *md) {
+    unsigned char blk[APP_SHA_MB_LANES][128];
+    uint32_t st32[8][APP_SHA_MB_LANES];
+    uint64_t st64[8][APP_SHA_MB_LANES];
+    const uint32_t *iv32 = alg == APP_SHA_MB_SHA224 ? iv224 : iv256;
+    const uint64_t *iv64 = NULL;
+    unsigned int block_size = 0, md_len = 0, b = 0, l = 0, i = 0, src = 0;
+
+    switch (alg) {
+    case APP_SHA_MB_SHA384:
+        iv64 = iv384;
+        break;
+    case APP_SHA_MB_SHA512_224:
+        iv64 = iv512_224;
+        break;
+    case APP_SHA_MB_SHA512_256:
+        iv64 = iv512_256;
+        break;
+    case APP_SHA_MB_SHA512:
+        iv64 = iv512;
+        break;
+    case APP_SHA_MB_SHA224:
+    case APP_SHA_MB_SHA256:
+    default:
+        break;
+    }
+    block_size = iv64 ? 128 : 64;
+    md_len = app_sha_mb_md_len(alg);
+
+    for (i = 0; i < 8; i++) {
+        for (l = 0; l < APP_SHA_MB_LANES; l++) {
+            if (iv64) {
+                st64[i][l] = iv64[i];
+            } else {
+                st32[i][l] = iv32[i];
+            }
+        }
+    }
+
+    for (b = 0; b < blocks; b++) {
+        for (l = 0; l < APP_SHA_MB_LANES; l++) {
+            src = l < lanes ? l : 0;
+            app_sha_mb_block(blk[l], block_size, msg[src], msg_len[src], blocks, b);
+        }
+        if (iv64) {
+            app_sha512_mb_compress(st64, blk);
+        } else {
+            app_sha256_mb_compress(st32, blk);
+        }
+    }
+
+    for (l = 0; l < lanes; l++) {
+        for (i = 0; i < md_len; i++) {
+            if (iv64) {
+                md[l][i] = (unsigned char)(st64[i / 8][l] >> (56 - 8 * (i % 8)));
+            } else {
+                md[l][i] = (unsigned char)(st32[i / 4][l] >> (24 - 8 * (i % 4)));
+            }
+        }
+    }
+}
+
+unsigned int app_sha_mb_md_len(APP_SHA_MB_ALG alg) {
+    switch (alg) {
+    case APP_SHA_MB_SHA224:
+    case APP_SHA_MB_SHA512_224:
+        return 28;
+    case APP_SHA_MB_SHA256:
+    case APP_SHA_MB_SHA512_256:
+        return 32;
+    case APP_SHA_MB_SHA384:
+        return 48;
+    case APP_SHA_MB_SHA512:
+        return 64;
+    default:
+        return 0;
+    }
+}
+
+/*
+ * Hashes count messages, APP_SHA_MB_LANES at a time, writing each digest
+ * (app_sha_mb_md_len() bytes) to md. All of the messages must pad to the same
+ * number of blocks. Returns 0 on success.
+ */
+int app_sha_mb(APP_SHA_MB_ALG alg,
+               const unsigned char *const *msg,
+               const unsigned int *msg_len,
+               unsigned int count,
+               unsigned char *const *md) {
+    unsigned int block_size = 0, blocks = 0, i = 0, n = 0;
+
+    if (!msg || !msg_len || !md || !count || !app_sha_mb_md_len(alg)) {
+        return 1;
+    }
+    block_size = alg == APP_SHA_MB_SHA224 || alg == APP_SHA_MB_SHA256 ? 64 : 128;
+    blocks = app_sha_mb_blocks(msg_len[0], block_size);
+    for (i = 0; i < count; i++) {
+        if (!msg[i] || !md[i] || app_sha_mb_blocks(msg_len[i], block_size) != blocks) {
+            return 1;
+        }
+    }
+
+    for (i = 0; i < count; i += n) {
+        n = count - i < APP_SHA_MB_LANES ? count - i : APP_SHA_MB_LANES;
+        app_sha_mb_lanes(alg, msg + i, msg_len + i, n, blocks, md + i);
+    }
+    return 0;
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2024, Cisco Systems, Inc.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://github.com/cisco/libacvp/LICENSE
+ */
+
+#ifndef LIBACVP_APP_SHA_MB_H
+#define LIBACVP_APP_SHA_MB_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define APP_SHA_MB_LANES 8
+
+typedef enum app_sha_mb_alg {
+    APP_SHA_MB_SHA224 = 0,
+    APP_SHA_MB_SHA256,
+    APP_SHA_MB_SHA384,
+    APP_SHA_MB_SHA512,
+    APP_SHA_MB_SHA512_224,
+    APP_SHA_MB_SHA512_256
+} APP_SHA_MB_ALG;
+
+unsigned int app_sha_mb_md_len(APP_SHA_MB_ALG alg);
+int app_sha_mb(APP_SHA_MB_ALG alg,
+               const unsigned char *const *msg,
+               const unsigned int *msg_len,
+               unsigned int count,
+               unsigned char *const *md);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -73,6 +73,78 @@ typedef enum acvp_log_lvl {
     ACVP_LOG_LVL_MAX
 } ACVP_LOG_LVL;
 
+/**
+ * @enum ACVP_LOG_FLUSH
+ * @brief When libacvp flushes stdout after handing a message to the logging callback. See
+ *        acvp_set_log_flush_policy().
+ */
+typedef enum acvp_log_flush {
+    ACVP_LOG_FLUSH_EVERY = 0, /**< After every message (default) */
+    ACVP_LOG_FLUSH_BATCH,     /**< When the asynchronous log sink has caught up; never when synchronous */
+    ACVP_LOG_FLUSH_NONE       /**< Leave flushing to stdio and the application */
+} ACVP_LOG_FLUSH;
+
+/**
+ * @enum ACVP_PHASE
+ * @brief Phases of vector set processing that can be timed with acvp_enable_phase_timing().
+ *        ACVP_PHASE_DISPATCH covers the whole algorithm handler, which includes the time spent in
+ *        the application's crypto handler (ACVP_PHASE_CRYPTO); ACVP_PHASE_RESPONSE_BUILD is the
+ *        remainder, i.e. the library's own work reading test cases and building responses.
+ */
+typedef enum acvp_phase {
+    ACVP_PHASE_DOWNLOAD = 0,   /**< Retrieving the vector set from the server */
+    ACVP_PHASE_RETRY_WAIT,     /**< Waiting because the server asked us to retry later */
+    ACVP_PHASE_PARSE,          /**< Parsing the vector set JSON */
+    ACVP_PHASE_DISPATCH,       /**< Running the algorithm handler for the vector set */
+    ACVP_PHASE_CRYPTO,         /**< Inside the application's crypto handler */
+    ACVP_PHASE_RESPONSE_BUILD, /**< Dispatch time not spent in the crypto handler */
+    ACVP_PHASE_SERIALIZE,      /**< Serializing the responses */
+    ACVP_PHASE_UPLOAD,         /**< Sending the responses to the server */
+    ACVP_PHASE_MAX
+} ACVP_PHASE;
+
+/**
+ * @struct ACVP_HANDLER_STATS
+ * @brief Latency summary of the crypto handler calls for one algorithm, as returned by
+ *        acvp_get_handler_stats(). Percentiles come from a log-linear histogram and are accurate
+ *        to about 12%.
+ */
+typedef struct acvp_handler_stats_t {
+    unsigned int count; /**< Number of crypto handler calls */
+    double total_ms;    /**< Total time spent in the handler */
+    double min_us;      /**< Fastest call */
+    double mean_us;     /**< Average call */
+    double p50_us;      /**< Median call */
+    double p90_us;      /**< 90th percentile */
+    double p99_us;      /**< 99th percentile */
+    double max_us;      /**< Slowest call */
+} ACVP_HANDLER_STATS;
+
+/**
+ * @struct ACVP_PROGRESS
+ * @brief Snapshot of session progress handed to the callback registered with
+ *        acvp_set_progress_callback(). Strings are only valid for the duration of the callback.
+ */
+typedef struct acvp_progress_t {
+    int vs_total;           /**< Vector sets in the session */
+    int vs_done;            /**< Vector sets processed so far */
+    int vs_id;              /**< Vector set being processed, 0 between vector sets */
+    const char *algorithm;  /**< Algorithm of vs_id, NULL between vector sets */
+    const char *mode;       /**< Mode of vs_id, NULL if it has none */
+    int tc_total;           /**< Test cases in vs_id */
+    int tc_done;            /**< Test cases of vs_id processed so far */
+    unsigned long long int tc_done_session; /**< Test cases processed in the whole session */
+    unsigned long long int bytes_sent;      /**< HTTP request bodies sent to the server */
+    unsigned long long int bytes_received;  /**< HTTP response bodies received from the server */
+    double elapsed_seconds; /**< Time since the first vector set was started */
+    double eta_seconds;     /**< Estimated time until the last vector set is done, < 0 if unknown */
+} ACVP_PROGRESS;
+
+/**
+ * @brief Signature of the structured progress callback, see acvp_set_progress_callback().
+ */
+typedef void (*ACVP_PROGRESS_CB)(const ACVP_PROGRESS *progress, void *arg);
+
 /**
  * @struct ACVP_CTX
  * @brief This opaque structure is used to maintain the state of a session with an ACVP server.
@@ -131,6 +203,8 @@ typedef enum acvp_result {
     ACVP_JWT_EXPIRED,        /**< The provided JWT was not accepted by the server because it is expired */
     ACVP_JWT_INVALID,        /**< A provided JSON web token is invalid due to its size, encoding, or contents */
     ACVP_INTERNAL_ERR,       /**< An unexpected error occuring internally to libacvp */
+    ACVP_MEM_BUDGET_EXCEEDED, /**< A vector set could not be processed within the memory budget set with
+                                   acvp_set_mem_budget() */
     ACVP_RESULT_MAX
 } ACVP_RESULT;
 
@@ -1185,6 +1259,14 @@ typedef enum acvp_hash_expansion_method {
     ACVP_HASH_EXPANSION_REPEATING
 } ACVP_HASH_EXPANSION_METHOD;
 
+/** @enum ACVP_HASH_LDT_STAGE */
+typedef enum acvp_hash_ldt_stage {
+    ACVP_HASH_LDT_NONE = 0, /**< Not streamed, the whole test case is done in one call */
+    ACVP_HASH_LDT_INIT,     /**< Start a new digest */
+    ACVP_HASH_LDT_UPDATE,   /**< Add \ref ACVP_HASH_TC.ldt_chunk to the digest */
+    ACVP_HASH_LDT_FINAL     /**< Finish the digest into \ref ACVP_HASH_TC.md */
+} ACVP_HASH_LDT_STAGE;
+
 /**
  * @struct ACVP_SYM_CIPHER_TC
  * @brief This struct holds data that represents a single test case for a symmetric cipher, such as
@@ -1222,6 +1304,8 @@ typedef struct acvp_sym_cipher_tc_t {
     unsigned int aad_len;
     unsigned int iv_len;
     unsigned int ct_len;
+    unsigned int pt_alloc;   /**< Bytes allocated for pt. SET BY LIBACVP */
+    unsigned int ct_alloc;   /**< Bytes allocated for ct. SET BY LIBACVP */
     unsigned int tag_len;
     unsigned int salt_len;
     unsigned int mct_index;  /**< used to identify init vs. update */
@@ -1233,6 +1317,17 @@ typedef struct acvp_sym_cipher_tc_t {
     unsigned int data_unit_len; /**< for AES-XTS rev 2.0, the amount of data that can be
                                  * processed at once may be lower than the total payload
                                  * size. By default it will = payloadLen. */
+    unsigned char *mct_out;     /**< For an MCT inner loop handler: the output of each of the
+                                 * mct_count operations, in order (ct when encrypting, pt when
+                                 * decrypting), mct_out_len bytes apiece. Allocated by libacvp,
+                                 * filled in by the module. */
+    unsigned int mct_out_len;   /**< Bytes per output in mct_out. SUPPLIED BY THE MODULE: 16 for
+                                 * AES and 8 for TDES block modes, 1 for CFB8 and CFB1 (the bit
+                                 * in the most significant position) */
+    unsigned int mct_count;     /**< Number of chained operations in the inner loop */
+    int batch_rv;               /**< For a batch handler: what the crypto_handler would have
+                                 * returned for this test case, i.e. nonzero when an AEAD or key
+                                 * wrap decryption fails to authenticate. SET BY THE MODULE */
 } ACVP_SYM_CIPHER_TC;
 
 /**
@@ -1263,10 +1358,34 @@ typedef struct acvp_hash_tc_t {
                                    Only provided when \ref ACVP_HASH_TC.test_type is VOT */
     unsigned long long int exp_len; /**< The final length (in bytes) of the expanded content
                                          Only provided when \ref ACVP_HASH_TC.test_type is LDT */
+    ACVP_HASH_LDT_STAGE ldt_stage; /**< Step of a streamed LDT this call is for. Always
+                                        ACVP_HASH_LDT_NONE unless streaming was turned on with
+                                        acvp_cap_hash_set_ldt_streaming() */
+    const unsigned char *ldt_chunk; /**< The next part of the expanded content
+                                         Only provided for ACVP_HASH_LDT_UPDATE */
+    unsigned int ldt_chunk_len; /**< The length (in bytes) of \ref ACVP_HASH_TC.ldt_chunk */
+    void *ldt_state; /**< Kept by libacvp between the calls for one streamed LDT so the module
+                          can hang its digest context off it. The module frees it at
+                          ACVP_HASH_LDT_FINAL
+                          SUPPLIED BY USER */
+    void *ldt_view; /**< Set by acvp_hash_ldt_map(), not for use by the module */
     unsigned char *md; /**< The resulting digest calculated for the test case.
                             SUPPLIED BY USER */
     unsigned int md_len; /**< The length (in bytes) of \ref ACVP_HASH_TC.md
                               SUPPLIED BY USER */
+    unsigned int min_xof_bits; /**< Shortest SHAKE output (in bits) for the MCT
+                                    Provided to an MCT chain handler for SHAKE */
+    unsigned int max_xof_bits; /**< Longest SHAKE output (in bits) for the MCT
+                                    Provided to an MCT chain handler for SHAKE */
+    unsigned char *mct_md; /**< For an MCT chain handler: the digest at each of the
+                                \ref ACVP_HASH_TC.mct_count checkpoints, checkpoint i at
+                                mct_md + i * \ref ACVP_HASH_TC.mct_md_max. Allocated by libacvp.
+                                SUPPLIED BY USER */
+    unsigned int *mct_md_len; /**< The length (in bytes) of each checkpoint digest in
+                                   \ref ACVP_HASH_TC.mct_md
+                                   SUPPLIED BY USER */
+    unsigned int mct_md_max; /**< Bytes set aside for each checkpoint in \ref ACVP_HASH_TC.mct_md */
+    unsigned int mct_count; /**< Number of checkpoints (outer iterations) in the MCT */
 } ACVP_HASH_TC;
 
 /**
@@ -2592,6 +2711,21 @@ typedef struct acvp_lms_tc_t {
 
 } ACVP_LMS_TC;
 
+/**
+ * @brief Cache of values a module derives from test group parameters (keys, domain parameters,
+ *        precomputed tables and the like), owned by the test session. See acvp_group_cache_get().
+ */
+typedef struct acvp_group_cache_t ACVP_GROUP_CACHE;
+
+/**
+ * @enum ACVP_GROUP_EVENT
+ * @brief Test group boundaries reported to a group_handler, see acvp_cap_set_group_handler().
+ */
+typedef enum acvp_group_event {
+    ACVP_GROUP_BEGIN = 1, /**< Before the crypto_handler is given the group's first test case */
+    ACVP_GROUP_END        /**< After the crypto_handler has handled the group's last test case */
+} ACVP_GROUP_EVENT;
+
 /**
  * @struct ACVP_TEST_CASE
  * @brief This is the abstracted test case representation used for passing test case data to/from
@@ -2634,6 +2768,8 @@ typedef struct acvp_test_case_t {
         ACVP_SAFE_PRIMES_TC *safe_primes;
         ACVP_LMS_TC *lms;
     } tc; /**< the union abstracting the test case for passing to the user application */
+    ACVP_GROUP_CACHE *group_cache; /**< The session's group cache, for values kept across the
+                                    * test cases of a group. SET BY LIBACVP */
 } ACVP_TEST_CASE;
 
 
@@ -2724,6 +2860,61 @@ ACVP_RESULT acvp_cap_sym_cipher_set_domain(ACVP_CTX *ctx,
                                            int max,
                                            int increment);
 
+/**
+ * @brief acvp_cap_sym_cipher_set_mct_handler() allows an application to run each Monte Carlo
+ *        inner loop inside the crypto module rather than one operation per crypto_handler call.
+ *
+ *        The handler is called once per outer iteration, with mct_index 0 and the test case
+ *        holding that iteration's key, IV and first input. It performs the mct_count chained
+ *        operations as defined for the mode by NIST's MCT for AES and TDES (each operation's input
+ *        taken from the previous outputs), writes every output in order to mct_out and sets
+ *        mct_out_len, leaving the test case's key, IV and input as they were. libacvp checks these
+ *        dimensions and derives the next key, IV and text from the outputs itself, exactly as it
+ *        does after per-operation calls. For TDES the module also sets iv_ret_after as after the
+ *        last operation.
+ *
+ *        Supported for AES-ECB, CBC, OFB, CFB1, CFB8 and CFB128 and for TDES-ECB, CBC and CFB64.
+ *        TDES OFB, CFB1 and CFB8 need the module's IV after every operation, so those always use
+ *        the crypto_handler. The crypto_handler registered with acvp_cap_sym_cipher_enable() is
+ *        still used for all other test types.
+ *
+ * @param ctx Pointer to ACVP_CTX that was previously created by calling acvp_create_test_session.
+ * @param cipher ACVP_CIPHER enum value identifying the crypto capability.
+ * @param mct_handler Address of function implemented by application that runs an inner loop,
+ *        returning 0 on success and 1 for failure. NULL goes back to per-operation calls.
+ *
+ * @return ACVP_RESULT
+ */
+ACVP_RESULT acvp_cap_sym_cipher_set_mct_handler(ACVP_CTX *ctx,
+                                                ACVP_CIPHER cipher,
+                                                int (*mct_handler)(ACVP_TEST_CASE *test_case));
+
+/**
+ * @brief acvp_cap_sym_cipher_set_batch_handler() allows an application to process the AFT test
+ *        cases of an AES test group several at a time, so a module can keep many independent
+ *        streams in flight instead of one short operation per crypto_handler call.
+ *
+ *        All test cases in one call come from the same test group, so they share the mode,
+ *        direction and key length, and are in the server's order. There are up to 64 of them,
+ *        and their key, input, output, IV, tag and AAD buffers are carved one test case after
+ *        another out of a single allocation that is reused for the next batch. The handler
+ *        fills in every test case as the crypto_handler would and sets batch_rv to what the
+ *        crypto_handler would have returned for it. The crypto_handler registered with
+ *        acvp_cap_sym_cipher_enable() is still used for all other test types.
+ *
+ * @param ctx Pointer to ACVP_CTX that was previously created by calling acvp_create_test_session.
+ * @param cipher ACVP_CIPHER enum value identifying the AES mode.
+ * @param batch_handler Address of function implemented by application that processes count
+ *        test cases, returning 0 on success and 1 for a failure that ends the vector set. NULL
+ *        goes back to one crypto_handler call per test case.
+ *
+ * @return ACVP_RESULT
+ */
+ACVP_RESULT acvp_cap_sym_cipher_set_batch_handler(ACVP_CTX *ctx,
+                                                  ACVP_CIPHER cipher,
+                                                  int (*batch_handler)(ACVP_TEST_CASE *test_cases,
+                                                                       unsigned int count));
+
 /**
  * @brief acvp_cap_hash_enable() allows an application to specify a hash capability to be tested
  *        by the ACVP server.
@@ -2748,6 +2939,104 @@ ACVP_RESULT acvp_cap_hash_enable(ACVP_CTX *ctx,
                                  ACVP_CIPHER cipher,
                                  int (*crypto_handler)(ACVP_TEST_CASE *test_case));
 
+/**
+ * @brief acvp_cap_hash_set_mct_handler() allows an application to run each hash Monte Carlo test
+ *        inside the crypto module rather than one digest per crypto_handler call.
+ *
+ *        The handler is called once per MCT test case with msg and msg_len holding the seed,
+ *        and for SHAKE, min_xof_bits and max_xof_bits holding the group's output length range.
+ *        It runs all mct_count outer iterations of 1000 digests as defined for the algorithm
+ *        (SHA-1/SHA-2, SHA-3 and SHAKE each have their own) and writes the digest that ends each
+ *        outer iteration to mct_md, setting its length in mct_md_len. libacvp checks the lengths
+ *        and builds the response from the checkpoints. The crypto_handler registered with
+ *        acvp_cap_hash_enable() is still used for all other test types.
+ *
+ * @param ctx Pointer to ACVP_CTX that was previously created by calling acvp_create_test_session.
+ * @param cipher ACVP_CIPHER enum value identifying the hash algorithm.
+ * @param mct_handler Address of function implemented by application that runs the MCT,
+ *        returning 0 on success and 1 for failure. NULL goes back to per-digest calls.
+ *
+ * @return ACVP_RESULT
+ */
+ACVP_RESULT acvp_cap_hash_set_mct_handler(ACVP_CTX *ctx,
+                                          ACVP_CIPHER cipher,
+                                          int (*mct_handler)(ACVP_TEST_CASE *test_case));
+
+/**
+ * @brief acvp_cap_hash_set_ldt_streaming() has libacvp feed large data tests (LDT) to the
+ *        crypto_handler in pieces instead of leaving the module to expand the content to its
+ *        full length (up to 8 GiB).
+ *
+ *        Each LDT test case becomes one call with ldt_stage set to ACVP_HASH_LDT_INIT, calls with
+ *        ACVP_HASH_LDT_UPDATE passing consecutive pieces of the expanded content in ldt_chunk, and
+ *        a call with ACVP_HASH_LDT_FINAL that fills in md and md_len. The chunk is the content
+ *        repeated to about chunk_len bytes and is reused for every update, so memory use does not
+ *        depend on the test size. Once the INIT call has succeeded the FINAL call is always made,
+ *        even if an update failed, so the module can release ldt_state.
+ *
+ * @param ctx Pointer to ACVP_CTX that was previously created by calling acvp_create_test_session.
+ * @param cipher ACVP_CIPHER enum value identifying the hash algorithm (SHA-1, SHA-2 or SHA-3).
+ * @param chunk_len Approximate update size in bytes, rounded down to a whole number of copies
+ *        of the content (at least one). A size that fits in the CPU cache works best. Up to
+ *        64 MiB; 0 turns streaming off again.
+ *
+ * @return ACVP_RESULT
+ */
+ACVP_RESULT acvp_cap_hash_set_ldt_streaming(ACVP_CTX *ctx,
+                                            ACVP_CIPHER cipher,
+                                            unsigned int chunk_len);
+
+/**
+ * @brief acvp_cap_hash_set_batch_handler() allows an application to digest the messages of hash
+ *        AFT test groups several at a time, for modules with multi-buffer hash implementations.
+ *
+ *        libacvp reads a whole AFT group, sorts its test cases by the number of blocks their
+ *        padded messages take and calls the handler with up to 64 test cases at a time, all of the
+ *        same block count (so they can share the lanes of a multi-buffer kernel from start to
+ *        finish). The handler fills in md and md_len (and for SHAKE, honours xof_len) for every
+ *        test case in the array, exactly as the crypto_handler would for each one. The response
+ *        keeps the server's test case order. The crypto_handler registered with
+ *        acvp_cap_hash_enable() is still used for all other test types.
+ *
+ * @param ctx Pointer to ACVP_CTX that was previously created by calling acvp_create_test_session.
+ * @param cipher ACVP_CIPHER enum value identifying the hash algorithm.
+ * @param batch_handler Address of function implemented by application that digests count test
+ *        cases, returning 0 on success and 1 for failure (which fails the vector set). NULL goes
+ *        back to one crypto_handler call per test case.
+ *
+ * @return ACVP_RESULT
+ */
+ACVP_RESULT acvp_cap_hash_set_batch_handler(ACVP_CTX *ctx,
+                                            ACVP_CIPHER cipher,
+                                            int (*batch_handler)(ACVP_TEST_CASE *test_cases,
+                                                                 unsigned int count));
+
+/**
+ * @brief acvp_hash_ldt_map() gives a crypto_handler the fully expanded content of a large data
+ *        test (LDT) at one address, for hash APIs that must take the message in a single update,
+ *        without using exp_len bytes of memory.
+ *
+ *        One block holding whole copies of the content is placed in an anonymous memory file and
+ *        mapped repeatedly across a reserved address range, so all of the range shares the same
+ *        physical pages. The block is at least a page and grows with exp_len only as needed to
+ *        keep the number of mappings small (about 2 MiB for an 8 GiB test). Currently Linux only.
+ *
+ * @param tc The LDT test case passed to the crypto_handler (msg, msg_len and exp_len are used).
+ * @param data Receives the start of the exp_len bytes of expanded content, which are read only.
+ *
+ * @return ACVP_RESULT, ACVP_UNSUPPORTED_OP where the platform cannot do this, in which case the
+ *         content has to be expanded some other way.
+ */
+ACVP_RESULT acvp_hash_ldt_map(ACVP_HASH_TC *tc, const unsigned char **data);
+
+/**
+ * @brief acvp_hash_ldt_unmap() releases the view made by acvp_hash_ldt_map(). libacvp also
+ *        releases it when the test case is done if the crypto_handler does not.
+ *
+ * @param tc The LDT test case passed to acvp_hash_ldt_map().
+ */
+void acvp_hash_ldt_unmap(ACVP_HASH_TC *tc);
+
 /**
  * @brief acvp_cap_hash_set_parm() allows an application to specify operational parameters to be
  *        used for a given hash alg during a test session with the ACVP server.
@@ -3726,6 +4015,30 @@ ACVP_RESULT acvp_cap_kmac_set_domain(ACVP_CTX *ctx,
                                      int max,
                                      int increment);
 
+/**
+ * @brief acvp_cap_mac_set_batch_handler() allows an application to compute the MACs of an HMAC,
+ *        CMAC or KMAC test group several test cases at a time, so a module can run them on
+ *        parallel lanes or set up its MAC implementation once for the whole group.
+ *
+ *        All test cases in one call come from the same test group and are in the server's order,
+ *        so they share the algorithm and, for HMAC and CMAC, the message, key and MAC lengths.
+ *        There are up to 64 of them, and their message, key and MAC buffers are carved one test
+ *        case after another out of a single allocation that is reused for the next batch. The
+ *        handler fills in every test case as the crypto_handler would.
+ *
+ * @param ctx Pointer to ACVP_CTX that was previously created by calling acvp_create_test_session.
+ * @param cipher ACVP_CIPHER enum value identifying the HMAC, CMAC or KMAC algorithm.
+ * @param batch_handler Address of function implemented by application that processes count
+ *        test cases, returning 0 on success and 1 for failure. NULL goes back to one
+ *        crypto_handler call per test case.
+ *
+ * @return ACVP_RESULT
+ */
+ACVP_RESULT acvp_cap_mac_set_batch_handler(ACVP_CTX *ctx,
+                                           ACVP_CIPHER cipher,
+                                           int (*batch_handler)(ACVP_TEST_CASE *test_cases,
+                                                                unsigned int count));
+
 
 /**
  * @brief acvp_cap_kdf135_*_enable() allows an application to specify a kdf cipher capability to be
@@ -4417,6 +4730,318 @@ ACVP_RESULT acvp_set_certkey(ACVP_CTX *ctx, char *cert_file, char *key_file);
  */
 ACVP_RESULT acvp_mark_as_sample(ACVP_CTX *ctx);
 
+/**
+ * @brief acvp_set_json_output_compact() controls the layout of the vector request and response
+ *        files written during offline processing. By default these files are pretty printed;
+ *        when compact output is enabled all insignificant whitespace is omitted, which makes large
+ *        files considerably smaller and faster to write.
+ *
+ * @param ctx Pointer to ACVP_CTX that was previously created by calling acvp_create_test_session.
+ * @param compact 1 to write compact JSON, 0 to pretty print (default)
+ *
+ * @return ACVP_RESULT
+ */
+ACVP_RESULT acvp_set_json_output_compact(ACVP_CTX *ctx, int compact);
+
+/**
+ * @brief acvp_set_log_async() switches logging between synchronous mode (default), where the
+ *        logging callback is invoked from the thread that logs, and asynchronous mode, where
+ *        messages are queued on a bounded ring buffer and handed to the callback, in order, by a
+ *        background thread. Any number of threads may log concurrently in asynchronous mode; when
+ *        the ring is full, loggers wait for room rather than dropping messages. Switching back to
+ *        synchronous mode (or freeing the context) waits for threads that are logging at the
+ *        time, such as MCT workers, and delivers everything still queued first. Asynchronous mode
+ *        is not available on Windows.
+ *
+ * @param ctx Pointer to ACVP_CTX that was previously created by calling acvp_create_test_session.
+ * @param enable 1 for asynchronous logging, 0 for synchronous logging
+ * @param ring_size Number of messages the ring can hold, rounded up to a power of 2; 0 for the
+ *        default
+ *
+ * @return ACVP_RESULT
+ */
+ACVP_RESULT acvp_set_log_async(ACVP_CTX *ctx, int enable, unsigned int ring_size);
+
+/**
+ * @brief acvp_set_log_flush_policy() controls how often stdout is flushed after messages are
+ *        handed to the logging callback. Flushing every message keeps output current but makes
+ *        verbose sessions wait on terminal or file I/O.
+ *
+ * @param ctx Pointer to ACVP_CTX that was previously created by calling acvp_create_test_session.
+ * @param policy One of ACVP_LOG_FLUSH
+ *
+ * @return ACVP_RESULT
+ */
+ACVP_RESULT acvp_set_log_flush_policy(ACVP_CTX *ctx, ACVP_LOG_FLUSH policy);
+
+/**
+ * @brief acvp_log_flush() waits until every message logged so far has been handed to the logging
+ *        callback, then flushes stdout.
+ *
+ * @param ctx Pointer to ACVP_CTX that was previously created by calling acvp_create_test_session.
+ *
+ * @return ACVP_RESULT
+ */
+ACVP_RESULT acvp_log_flush(ACVP_CTX *ctx);
+
+/**
+ * @brief acvp_enable_phase_timing() turns on per vector set timing. For each vector set processed
+ *        afterwards, the time spent in each ACVP_PHASE is recorded on the context until it is freed.
+ *        The results can be queried with acvp_get_phase_timing() or written to a file with
+ *        acvp_export_phase_timing().
+ *
+ * @param ctx Pointer to ACVP_CTX that was previously created by calling acvp_create_test_session.
+ * @param enable 1 to record timing, 0 to stop recording (default)
+ *
+ * @return ACVP_RESULT
+ */
+ACVP_RESULT acvp_enable_phase_timing(ACVP_CTX *ctx, int enable);
+
+/**
+ * @brief acvp_get_phase_timing() returns the time spent in a phase for a vector set.
+ *
+ * @param ctx Pointer to ACVP_CTX that was previously created by calling acvp_create_test_session.
+ * @param vs_id The vsId to query, or 0 for the total across everything that was timed
+ * @param phase The phase to query
+ * @param seconds Receives the time spent in the phase, in seconds
+ * @param count Optional, receives the number of times the phase was entered (e.g. the number of
+ *        crypto handler calls)
+ *
+ * @return ACVP_RESULT ACVP_NO_DATA if nothing was recorded for vs_id
+ */
+ACVP_RESULT acvp_get_phase_timing(ACVP_CTX *ctx, int vs_id, ACVP_PHASE phase, double *seconds, unsigned int *count);
+
+/**
+ * @brief acvp_export_phase_timing() writes the recorded phase timing to a file, either as a JSON
+ *        summary (per vector set, per phase milliseconds and counts) or in the Chrome trace event
+ *        format, which can be loaded in chrome://tracing or Perfetto.
+ *
+ * @param ctx Pointer to ACVP_CTX that was previously created by calling acvp_create_test_session.
+ * @param filename Name of the file to write
+ * @param chrome_trace 1 for Chrome trace event format, 0 for the JSON summary
+ *
+ * @return ACVP_RESULT
+ */
+ACVP_RESULT acvp_export_phase_timing(ACVP_CTX *ctx, const char *filename, int chrome_trace);
+
+/**
+ * @brief acvp_enable_handler_stats() turns on per algorithm crypto handler statistics. Every call
+ *        into the application's crypto handler is timed and counted per capability and test type
+ *        (e.g. AES-GCM AFT vs. AES-ECB MCT) until the context is freed. A summary is logged at the
+ *        end of acvp_run() and acvp_run_vectors_from_file(); use acvp_get_handler_stats() or
+ *        acvp_export_handler_stats() to compare runs and catch performance regressions in the
+ *        module under test.
+ *
+ * @param ctx Pointer to ACVP_CTX that was previously created by calling acvp_create_test_session.
+ * @param enable 1 to record statistics, 0 to stop recording (default)
+ *
+ * @return ACVP_RESULT
+ */
+ACVP_RESULT acvp_enable_handler_stats(ACVP_CTX *ctx, int enable);
+
+/**
+ * @brief acvp_get_handler_stats() returns the crypto handler latency summary for an algorithm.
+ *
+ * @param ctx Pointer to ACVP_CTX that was previously created by calling acvp_create_test_session.
+ * @param cipher The algorithm to query
+ * @param test_type The algorithm's test type enum value (e.g. ACVP_SYM_TEST_TYPE_MCT), or 0 to
+ *        combine all test types
+ * @param stats Receives the summary
+ *
+ * @return ACVP_RESULT ACVP_NO_DATA if the handler was not called for cipher/test_type
+ */
+ACVP_RESULT acvp_get_handler_stats(ACVP_CTX *ctx, ACVP_CIPHER cipher, int test_type, ACVP_HANDLER_STATS *stats);
+
+/**
+ * @brief acvp_export_handler_stats() writes the crypto handler statistics of every algorithm to a
+ *        JSON file, including the non-empty histogram buckets so runs can be compared in detail.
+ *
+ * @param ctx Pointer to ACVP_CTX that was previously created by calling acvp_create_test_session.
+ * @param filename Name of the file to write
+ *
+ * @return ACVP_RESULT
+ */
+ACVP_RESULT acvp_export_handler_stats(ACVP_CTX *ctx, const char *filename);
+
+/**
+ * @brief acvp_set_mct_threads() spreads the Monte Carlo test cases of a vector set over several
+ *        threads. Each MCT test case chains its own state, so separate test cases can run at the
+ *        same time; the response is written in the usual order. Applies to hash algorithms, and
+ *        to AES and TDES when the module registered an MCT handler (the per-operation crypto
+ *        handler is called in chained order and always runs on one thread).
+ *
+ *        The handlers involved must then be reentrant: they may be called from several threads
+ *        at once. The log callback may also be called from those threads unless asynchronous
+ *        logging (acvp_set_log_async()) is on. With phase timing enabled, the crypto phase is the
+ *        sum of the time spent in every thread.
+ *
+ * @param ctx Pointer to ACVP_CTX that was previously created by calling acvp_create_test_session.
+ * @param threads Number of threads, including the calling one; 0 or 1 to run MCT test cases in
+ *        turn (default)
+ *
+ * @return ACVP_RESULT ACVP_UNSUPPORTED_OP where threads are not available
+ */
+ACVP_RESULT acvp_set_mct_threads(ACVP_CTX *ctx, unsigned int threads);
+
+/**
+ * @brief acvp_cap_set_group_handler() registers a handler that is told where each test group of
+ *        a DSA, RSA SigGen/SigVer, ECDSA or EdDSA vector set begins and ends, so a module can set
+ *        up what the whole group shares (a key, domain parameters, precomputed tables) once
+ *        instead of watching for a new tg_id in its crypto_handler.
+ *
+ *        ACVP_GROUP_BEGIN is given the group's first test case, filled in as it will be for the
+ *        crypto_handler, which carries the group's parameters. ACVP_GROUP_END is given the last
+ *        test case once the crypto_handler has handled it. A group abandoned because of an error
+ *        gets no ACVP_GROUP_END; whatever it put in the group cache is released with the rest
+ *        when the vector set is done. DSA PQGGen groups are not reported.
+ *
+ * @param ctx Pointer to ACVP_CTX that was previously created by calling acvp_create_test_session.
+ * @param cipher ACVP_CIPHER enum value identifying the algorithm, whose capability must already
+ *        be enabled
+ * @param group_handler Address of function implemented by application, returning 0 on success
+ *        and 1 for failure (which fails the vector set). NULL stops the reports.
+ *
+ * @return ACVP_RESULT
+ */
+ACVP_RESULT acvp_cap_set_group_handler(ACVP_CTX *ctx,
+                                       ACVP_CIPHER cipher,
+                                       int (*group_handler)(ACVP_GROUP_EVENT event,
+                                                            ACVP_TEST_CASE *test_case));
+
+/**
+ * @brief acvp_group_cache_get() looks up a value a handler stored in the group cache.
+ *
+ *        The group cache is reached through the group_cache member of the test case given to a
+ *        crypto_handler or group_handler. Entries are keyed by any bytes the module chooses,
+ *        typically the group parameters the value was derived from (e.g. L and N for DSA domain
+ *        parameters), or the tg_id for a value that belongs to one group only. They last until
+ *        removed or until the vector set is done. The cache is not for use from Monte Carlo
+ *        handlers run on several threads (acvp_set_mct_threads()).
+ *
+ * @param cache The test case's group_cache
+ * @param key The key bytes
+ * @param key_len Number of key bytes
+ *
+ * @return The stored value, or NULL if there is none for key
+ */
+void *acvp_group_cache_get(ACVP_GROUP_CACHE *cache, const void *key, size_t key_len);
+
+/**
+ * @brief acvp_group_cache_set() stores a value in the group cache under key, replacing (and
+ *        releasing) any value already stored under it. The cache takes ownership of value and
+ *        releases it with free_fn when it is removed or replaced, or when the vector set is done.
+ *
+ * @param cache The test case's group_cache
+ * @param key The key bytes, copied by the cache
+ * @param key_len Number of key bytes
+ * @param value The value to store, not NULL
+ * @param free_fn Called to release value, or NULL if the cache should not release it
+ *
+ * @return ACVP_RESULT
+ */
+ACVP_RESULT acvp_group_cache_set(ACVP_GROUP_CACHE *cache,
+                                 const void *key,
+                                 size_t key_len,
+                                 void *value,
+                                 void (*free_fn)(void *value));
+
+/**
+ * @brief acvp_group_cache_remove() releases the value stored under key, if any, e.g. when the
+ *        group it belongs to ends.
+ *
+ * @param cache The test case's group_cache
+ * @param key The key bytes
+ * @param key_len Number of key bytes
+ */
+void acvp_group_cache_remove(ACVP_GROUP_CACHE *cache, const void *key, size_t key_len);
+
+/**
+ * @brief acvp_set_progress_callback() registers a callback that receives machine readable
+ *        progress: vector sets done out of the session total, test cases done out of the current
+ *        vector set, bytes exchanged with the server and an estimate of the time remaining. The
+ *        callback is invoked when each vector set starts and finishes, and as test cases complete
+ *        but no more often than every interval_ms.
+ *
+ *        The estimate uses the throughput observed for the algorithm of the current vector set
+ *        (time per test case) for its remaining test cases, plus the average wall time of the
+ *        vector sets completed so far for each vector set not yet started. It is unknown until
+ *        the first test case, and for later vector sets until the first vector set is done.
+ *
+ * @param ctx Pointer to ACVP_CTX that was previously created by calling acvp_create_test_session.
+ * @param cb The callback, or NULL to stop reporting
+ * @param arg Passed through to cb
+ * @param interval_ms Minimum time between reports while test cases complete; 0 to report every
+ *        test case
+ *
+ * @return ACVP_RESULT
+ */
+ACVP_RESULT acvp_set_progress_callback(ACVP_CTX *ctx, ACVP_PROGRESS_CB cb, void *arg, unsigned int interval_ms);
+
+/**
+ * @brief acvp_get_progress() returns the current progress, as would be passed to the progress
+ *        callback. Progress is tracked whether or not a callback is registered, but the time
+ *        estimate is only maintained while one is.
+ *
+ * @param ctx Pointer to ACVP_CTX that was previously created by calling acvp_create_test_session.
+ * @param progress Receives the snapshot
+ *
+ * @return ACVP_RESULT
+ */
+ACVP_RESULT acvp_get_progress(ACVP_CTX *ctx, ACVP_PROGRESS *progress);
+
+/**
+ * @brief acvp_enable_mem_accounting() counts the memory libacvp holds: JSON trees (through the
+ *        parson allocator hook), the transport buffer and test case buffers. The counters are
+ *        process wide, as the JSON allocator is, and the peak for each vector set is logged when
+ *        the session completes. Not available on platforms where the allocator cannot report
+ *        block sizes.
+ *
+ * @param ctx Pointer to ACVP_CTX that was previously created by calling acvp_create_test_session.
+ * @param enable 1 to count allocations, 0 to stop
+ *
+ * @return ACVP_RESULT
+ */
+ACVP_RESULT acvp_enable_mem_accounting(ACVP_CTX *ctx, int enable);
+
+/**
+ * @brief acvp_set_mem_budget() limits the memory libacvp should hold. Before processing a vector
+ *        set, its working set is estimated from the downloaded vectors; one that would not fit is
+ *        deferred until the others have been processed and submitted, then tried once more. If it
+ *        still does not fit it is skipped, reported by the memory usage summary, and
+ *        acvp_process_tests() (or acvp_run_vectors_from_file()) returns ACVP_MEM_BUDGET_EXCEEDED.
+ *        Enables memory accounting.
+ *
+ * @param ctx Pointer to ACVP_CTX that was previously created by calling acvp_create_test_session.
+ * @param budget Budget in bytes, 0 for no limit
+ *
+ * @return ACVP_RESULT
+ */
+ACVP_RESULT acvp_set_mem_budget(ACVP_CTX *ctx, size_t budget);
+
+/**
+ * @brief acvp_get_mem_usage() returns the bytes currently held by libacvp and the high-water mark
+ *        since accounting was enabled.
+ *
+ * @param ctx Pointer to ACVP_CTX that was previously created by calling acvp_create_test_session.
+ * @param current Receives the bytes currently held, may be NULL
+ * @param peak Receives the high-water mark, may be NULL
+ *
+ * @return ACVP_RESULT
+ */
+ACVP_RESULT acvp_get_mem_usage(ACVP_CTX *ctx, size_t *current, size_t *peak);
+
+/**
+ * @brief acvp_get_vs_mem_peak() returns the most memory libacvp held while a vector set was
+ *        processed.
+ *
+ * @param ctx Pointer to ACVP_CTX that was previously created by calling acvp_create_test_session.
+ * @param vs_id ID of the vector set
+ * @param peak Receives the peak in bytes
+ *
+ * @return ACVP_RESULT, ACVP_NO_DATA if the vector set was not processed with accounting enabled
+ */
+ACVP_RESULT acvp_get_vs_mem_peak(ACVP_CTX *ctx, int vs_id, size_t *peak);
+
 /**
  * @brief acvp_mark_as_request_only() marks the registration as a request only. This function sets
  *         a flag that will allow the client to retrieve the vectors from the server and store them
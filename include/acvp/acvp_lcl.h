@@ -12,33 +12,59 @@
 
 #include "parson.h"
 
+/*
+ * True when a message at lvl would reach the application's log callback. The ACVP_LOG_* macros
+ * check this before evaluating their arguments; check it directly before building an expensive
+ * log payload (serialized JSON, hex dumps...) outside of them.
+ */
+#define ACVP_LOG_ENABLED(ctx, lvl) ((ctx) && (ctx)->test_progress_cb && (ctx)->log_lvl >= (lvl))
+
 #ifndef ACVP_LOG_ERR
 #define ACVP_LOG_ERR(msg, ...) do { \
-        acvp_log_msg(ctx, ACVP_LOG_LVL_ERR, __func__, __LINE__, msg, ##__VA_ARGS__); \
+        if (ACVP_LOG_ENABLED(ctx, ACVP_LOG_LVL_ERR)) { \
+            acvp_log_msg(ctx, ACVP_LOG_LVL_ERR, __func__, __LINE__, msg, ##__VA_ARGS__); \
+        } \
 } while (0)
 #endif
 
 #ifndef ACVP_LOG_WARN
 #define ACVP_LOG_WARN(msg, ...) do { \
-        acvp_log_msg(ctx, ACVP_LOG_LVL_WARN, __func__, __LINE__, msg, ##__VA_ARGS__); \
+        if (ACVP_LOG_ENABLED(ctx, ACVP_LOG_LVL_WARN)) { \
+            acvp_log_msg(ctx, ACVP_LOG_LVL_WARN, __func__, __LINE__, msg, ##__VA_ARGS__); \
+        } \
 } while (0)
 #endif
 
 #ifndef ACVP_LOG_STATUS
 #define ACVP_LOG_STATUS(msg, ...)  do { \
-        acvp_log_msg(ctx, ACVP_LOG_LVL_STATUS, __func__, __LINE__, msg, ##__VA_ARGS__); \
+        if (ACVP_LOG_ENABLED(ctx, ACVP_LOG_LVL_STATUS)) { \
+            acvp_log_msg(ctx, ACVP_LOG_LVL_STATUS, __func__, __LINE__, msg, ##__VA_ARGS__); \
+        } \
 } while (0)
 #endif
 
 #ifndef ACVP_LOG_INFO
 #define ACVP_LOG_INFO(msg, ...) do { \
-        acvp_log_msg(ctx, ACVP_LOG_LVL_INFO, __func__, __LINE__, msg, ##__VA_ARGS__); \
+        if (ACVP_LOG_ENABLED(ctx, ACVP_LOG_LVL_INFO)) { \
+            acvp_log_msg(ctx, ACVP_LOG_LVL_INFO, __func__, __LINE__, msg, ##__VA_ARGS__); \
+        } \
 } while (0)
 #endif
 
 #ifndef ACVP_LOG_VERBOSE
 #define ACVP_LOG_VERBOSE(msg, ...) do { \
-        acvp_log_msg(ctx, ACVP_LOG_LVL_VERBOSE, __func__, __LINE__, msg, ##__VA_ARGS__); \
+        if (ACVP_LOG_ENABLED(ctx, ACVP_LOG_LVL_VERBOSE)) { \
+            acvp_log_msg(ctx, ACVP_LOG_LVL_VERBOSE, __func__, __LINE__, msg, ##__VA_ARGS__); \
+        } \
+} while (0)
+#endif
+
+/* Pretty prints a JSON value into the log; the value is only serialized if VERBOSE is enabled */
+#ifndef ACVP_LOG_VERBOSE_JSON
+#define ACVP_LOG_VERBOSE_JSON(value) do { \
+        if (ACVP_LOG_ENABLED(ctx, ACVP_LOG_LVL_VERBOSE)) { \
+            acvp_log_json(ctx, ACVP_LOG_LVL_VERBOSE, __func__, __LINE__, value); \
+        } \
 } while (0)
 #endif
 
@@ -544,6 +570,13 @@
 #define ACVP_HASH_XOF_MD_STR_MAX (ACVP_HASH_XOF_MD_BIT_MAX >> 2) /**< 16,384 characters */
 #define ACVP_HASH_XOF_MD_BYTE_MAX (ACVP_HASH_XOF_MD_BIT_MAX >> 3) /**< 8,192 bytes */
 
+#define ACVP_HASH_LDT_CHUNK_MAX (64 * 1024 * 1024) /**< Largest chunk of a streamed LDT, 64 MiB */
+#define ACVP_HASH_BATCH_MAX 64 /**< Most AFT test cases given to a hash batch_handler at once */
+#define ACVP_SYM_BATCH_MAX 64  /**< Most AFT test cases given to an AES batch_handler at once */
+#define ACVP_SYM_BATCH_SCRATCH (256 * 1024) /**< Smallest scratch area shared by an AES batch */
+#define ACVP_MAC_BATCH_MAX 64  /**< Most test cases given to a MAC batch_handler at once */
+#define ACVP_MAC_BATCH_SCRATCH (256 * 1024) /**< Smallest scratch area shared by a MAC batch */
+
 #define ACVP_TDES_KEY_BIT_LEN 192                           /**< 192 bits */
 #define ACVP_TDES_KEY_STR_LEN (ACVP_TDES_KEY_BIT_LEN >> 2)  /**< 48 characters */
 #define ACVP_TDES_KEY_BYTE_LEN (ACVP_TDES_KEY_BIT_LEN >> 3) /**< 24 bytes */
@@ -893,6 +926,7 @@
 #define ACVP_LMS_TMP_MAX 65336 //arbitrary
 
 #define ACVP_CURL_BUF_MAX       (1024 * 1024 * 64) /**< 64 MB */
+#define ACVP_RESP_BUF_KEEP_MAX  (1024 * 1024) /**< Largest response buffer kept for the next vector set, 1 MB */
 #define ACVP_RETRY_TIME_MIN     5 /* seconds */
 #define ACVP_RETRY_TIME_MAX     300 /* 5 minutes */
 #define ACVP_MAX_WAIT_TIME      10800 /* 3 hours */
@@ -1163,6 +1197,7 @@ typedef struct acvp_hash_capability {
     ACVP_JSON_DOMAIN_OBJ out_len; /**< Required for ACVP_HASH_SHAKE_* */
     ACVP_JSON_DOMAIN_OBJ msg_length;
     ACVP_SL_LIST *large_lens;
+    unsigned int ldt_chunk_len; /* 0 unless LDTs are streamed to the module in chunks */
 } ACVP_HASH_CAP;
 
 typedef struct acvp_kdf135_snmp_capability {
@@ -1601,6 +1636,27 @@ typedef struct acvp_lms_capability_t {
     ACVP_LMS_SPECIFIC_LIST *specific_list;
 } ACVP_LMS_CAP;
 
+/*
+ * crypto_handler latency histogram for one capability and test type (see acvp_timing.c). Buckets
+ * are log-linear in nanoseconds: values below ACVP_HIST_SUB_BUCKETS are exact, above that each
+ * power of two is split into ACVP_HIST_SUB_BUCKETS linear buckets (~12% resolution). Anything
+ * beyond 2^ACVP_HIST_MAX_EXP ns (~18 minutes) lands in the last bucket.
+ */
+#define ACVP_HIST_SUB_BUCKET_BITS 3
+#define ACVP_HIST_SUB_BUCKETS (1 << ACVP_HIST_SUB_BUCKET_BITS)
+#define ACVP_HIST_MAX_EXP 40
+#define ACVP_HIST_BUCKETS ((ACVP_HIST_MAX_EXP - ACVP_HIST_SUB_BUCKET_BITS + 2) * ACVP_HIST_SUB_BUCKETS)
+
+typedef struct acvp_cap_stats_t {
+    int test_type;          /* algorithm specific test type enum, 0 if the algorithm has none */
+    unsigned int count;
+    unsigned long long int total_ns;
+    unsigned long long int min_ns;
+    unsigned long long int max_ns;
+    unsigned int buckets[ACVP_HIST_BUCKETS];
+    struct acvp_cap_stats_t *next;
+} ACVP_CAP_STATS;
+
 typedef struct acvp_caps_list_t {
     ACVP_CIPHER cipher;
     ACVP_CAP_TYPE cap_type;
@@ -1653,6 +1709,12 @@ typedef struct acvp_caps_list_t {
     } cap;
 
     int (*crypto_handler)(ACVP_TEST_CASE *test_case);
+    int (*mct_handler)(ACVP_TEST_CASE *test_case);  /* optional, runs a whole MCT inner loop */
+    int (*batch_handler)(ACVP_TEST_CASE *test_cases, unsigned int count);  /* optional, runs independent AFT test cases together */
+    int (*group_handler)(ACVP_GROUP_EVENT event, ACVP_TEST_CASE *test_case);  /* optional, told where test groups begin and end */
+    ACVP_CAP_STATS *stats;  /* crypto_handler latency per test type, when handler stats are enabled */
+    unsigned int progress_tc;            /* test cases timed for the progress estimate */
+    unsigned long long int progress_ns;  /* time they took */
 
     struct acvp_caps_list_t *next;
 } ACVP_CAPS_LIST;
@@ -1787,6 +1849,129 @@ typedef struct acvp_fips_t {
     ACVP_OE *oe; /* Pointer to the Operating Environment to use for this validation */
 } ACVP_FIPS;
 
+/*
+ * Writer for offline request/response files. The file stays open (and fully buffered) for the
+ * whole session so each vector set is streamed straight to disk instead of reopening the file
+ * and building an intermediate string per vector set.
+ */
+#define ACVP_JSON_FILE_WRITER_BUF_SIZE (1024 * 1024)
+
+typedef struct acvp_json_file_writer_t {
+    FILE *fp;
+    char *buf;      /* stdio buffer handed to setvbuf */
+    int count;      /* number of values written to the top level array so far */
+    int compact;    /* 1 to omit whitespace and indentation */
+} ACVP_JSON_FILE_WRITER;
+
+/*
+ * Phase timing for one vector set (see acvp_timing.c). Phases other than crypto are also kept as
+ * individual spans, up to ACVP_TIMING_MAX_SPANS, for trace export.
+ */
+#define ACVP_TIMING_MAX_SPANS 64
+
+typedef struct acvp_timing_span_t {
+    ACVP_PHASE phase;
+    unsigned long long int start_ns;
+    unsigned long long int dur_ns;
+} ACVP_TIMING_SPAN;
+
+typedef struct acvp_vs_timing_t {
+    int vs_id;              /* 0 for work not tied to a single vector set */
+    unsigned long long int start_ns;
+    unsigned long long int end_ns;
+    unsigned long long int phase_ns[ACVP_PHASE_MAX];
+    unsigned int phase_count[ACVP_PHASE_MAX];
+    ACVP_TIMING_SPAN spans[ACVP_TIMING_MAX_SPANS];
+    int span_count;
+    struct acvp_vs_timing_t *next;
+} ACVP_VS_TIMING;
+
+/*
+ * Progress reporting state (see acvp_progress.c). info is what the application is handed;
+ * timestamps are from the monotonic clock used for phase timing.
+ */
+typedef struct acvp_progress_state_t {
+    ACVP_PROGRESS_CB cb;
+    void *arg;
+    unsigned long long int interval_ns;
+    ACVP_PROGRESS info;
+    ACVP_CAPS_LIST *cap;                 /* capability of the vector set in progress */
+    unsigned long long int start_ns;     /* first vector set started */
+    unsigned long long int last_tc_ns;   /* previous test case finished (or vector set started) */
+    unsigned long long int last_report_ns;
+    unsigned long long int done_ns;      /* wall time from start_ns to the last vector set finishing */
+} ACVP_PROGRESS_STATE;
+
+/*
+ * Scratch memory a handler keeps for the lifetime of a vector set and carves
+ * each test case's buffers from, so they are sized to the data rather than the
+ * protocol maximums and not allocated per test case.
+ */
+#define ACVP_SCRATCH_ALIGN 16
+
+typedef struct acvp_scratch_t {
+    unsigned char *buf;
+    size_t size;                         /* bytes allocated */
+    size_t used;                         /* bytes handed out since the last reserve */
+    size_t batch_min;                    /* when set, test cases pile up until acvp_scratch_reset() */
+} ACVP_SCRATCH;
+
+/*
+ * Monte Carlo test cases collected from a vector set to be run on worker
+ * threads once the whole set has been read (see acvp_mct_pool.c). Each job
+ * is job_size bytes, laid out by the algorithm handler.
+ */
+typedef struct acvp_mct_jobs_t {
+    unsigned char *jobs;
+    size_t job_size;
+    unsigned int count;                  /* jobs added so far */
+    unsigned int max;                    /* jobs there is room for */
+} ACVP_MCT_JOBS;
+
+typedef ACVP_RESULT (*ACVP_MCT_JOB_FN)(ACVP_CTX *ctx, void *job);
+
+/*
+ * Handler time and statistics charged by one worker thread, folded into the
+ * context and capability once the workers are done (see acvp_timing.c).
+ */
+typedef struct acvp_worker_acct_t {
+    unsigned long long int crypto_ns;
+    unsigned int crypto_count;
+    ACVP_CAP_STATS *stats;
+} ACVP_WORKER_ACCT;
+
+/*
+ * Peak memory held by the library while a vector set was processed (see acvp_mem.c)
+ */
+typedef struct acvp_mem_vs_t {
+    int vs_id;
+    size_t peak;
+    size_t skipped_need;    /* estimate of a vector set left unprocessed for the budget, 0 if it ran */
+    struct acvp_mem_vs_t *next;
+} ACVP_MEM_VS;
+
+/*
+ * Asynchronous log sink (see acvp_log.c): a bounded multi-producer ring drained by one thread.
+ * Messages that fit are copied into the slot, longer ones are duplicated on the heap.
+ */
+#define ACVP_LOG_RING_DEFAULT 1024
+#define ACVP_LOG_RING_MIN 16
+#define ACVP_LOG_SLOT_INLINE 256
+
+typedef struct acvp_log_sink_t ACVP_LOG_SINK;
+
+typedef struct acvp_group_cache_entry_t {
+    unsigned char *key;
+    size_t key_len;
+    void *value;
+    void (*free_fn)(void *value);
+    struct acvp_group_cache_entry_t *next;
+} ACVP_GROUP_CACHE_ENTRY;
+
+struct acvp_group_cache_t {
+    ACVP_GROUP_CACHE_ENTRY *entries; /* most recently added first */
+};
+
 /*
  * This struct holds all the global data for a test session, such
  * as the server name, port#, etc.  Some of the values in this
@@ -1796,6 +1981,10 @@ typedef struct acvp_fips_t {
 struct acvp_ctx_t {
     /* Global config values for the session */
     ACVP_LOG_LVL log_lvl;
+    ACVP_LOG_FLUSH log_flush; /* when to fflush(stdout) after a message */
+    ACVP_LOG_SINK *log_sink;  /* asynchronous log sink, NULL when logging synchronously */
+    int log_producers;        /* threads in acvp_log_deliver(), waited on before the sink is freed */
+    int log_stopping;         /* the sink is being shut down; new producers wait it out */
     int debug;              /* Indicates if the ctx is set to run in "debug" mode for extra output */
     char *server_name;
     char *path_segment;
@@ -1820,6 +2009,20 @@ struct acvp_ctx_t {
     char *vector_req_file;  /* filename to use to store vector request JSON */
     int vector_req;         /* flag to indicate we are storing vector request JSON in a file */
     int vector_rsp;         /* flag to indicate we are storing vector responses JSON in a file */
+    ACVP_JSON_FILE_WRITER *vector_req_writer; /* open writer for vector_req_file while processing */
+    int compact_json;       /* flag to indicate request/response files are written without whitespace */
+    int timing_enabled;     /* flag to indicate per vector set phase timing is recorded */
+    ACVP_VS_TIMING *timing_list; /* timing records, in processing order */
+    ACVP_VS_TIMING *timing_cur;  /* record phases are currently charged to, NULL when not timing */
+    unsigned long long int timing_epoch_ns; /* start of the first record, origin for trace export */
+    int handler_stats_enabled; /* flag to indicate crypto_handler latency histograms are kept */
+    unsigned int mct_threads; /* threads Monte Carlo tests are spread over, 0 or 1 to run them in turn */
+    ACVP_GROUP_CACHE group_cache; /* values handlers keep per test group, emptied after each vector set */
+    ACVP_PROGRESS_STATE progress;
+    int mem_accounting;     /* flag to indicate library allocations are counted */
+    size_t mem_budget;      /* bytes the library may hold before vector sets are deferred, 0 for no limit */
+    int mem_deferring;      /* set while the deferred vector sets are being retried */
+    ACVP_MEM_VS *mem_vs_list; /* per vector set peaks, in processing order */
     int get;                /* flag to indicate we are only getting status or metadata */
     char *get_string;       /* string used for get request */
     int post;               /* flag to indicate we are only posting metadata */
@@ -1857,6 +2060,8 @@ struct acvp_ctx_t {
 
     char *curl_buf;       /**< Data buffer for inbound Curl messages */
     int curl_read_ctr;    /**< Total number of bytes written to the curl_buf */
+    char *resp_buf;       /**< Reusable buffer vector set responses are serialized into */
+    size_t resp_buf_size; /**< Allocated size of resp_buf */
     int post_size_constraint;  /**< The number of bytes that the body of an HTTP POST may contain
                                     without requiring the use of the /large endpoint. If the POST body
                                     is larger than this value, then use of the /large endpoint is necessary */
@@ -1890,7 +2095,10 @@ ACVP_RESULT acvp_retrieve_expected_result(ACVP_CTX *ctx, const char *api_url);
 ACVP_RESULT acvp_submit_vector_responses(ACVP_CTX *ctx, char *vsid_url);
 
 void acvp_log_msg(ACVP_CTX *ctx, ACVP_LOG_LVL level, const char *func, int line, const char *format, ...);
+void acvp_log_json(ACVP_CTX *ctx, ACVP_LOG_LVL level, const char *func, int line, const JSON_Value *value);
 void acvp_log_newline(ACVP_CTX *ctx);
+void acvp_log_deliver(ACVP_CTX *ctx, ACVP_LOG_LVL level, char *msg, size_t len);
+void acvp_log_sink_stop(ACVP_CTX *ctx);
 
 /*
  * These are the handler routines for each KAT operation
@@ -2103,5 +2311,50 @@ ACVP_KDF108_MODE read_mode(const char *str);
 ACVP_RESULT acvp_json_serialize_to_file_pretty_a(const JSON_Value *value, const char *filename);
 ACVP_RESULT acvp_json_serialize_to_file_pretty_w(const JSON_Value *value, const char *filename);
 
+ACVP_RESULT acvp_json_file_writer_open(ACVP_JSON_FILE_WRITER **writer, const char *filename, int compact);
+ACVP_RESULT acvp_json_file_writer_append(ACVP_JSON_FILE_WRITER *writer, const JSON_Value *value);
+ACVP_RESULT acvp_json_file_writer_close(ACVP_JSON_FILE_WRITER **writer);
+
+unsigned long long int acvp_timing_clock(void);
+unsigned long long int acvp_timing_now(ACVP_CTX *ctx);
+void acvp_timing_record(ACVP_CTX *ctx, ACVP_PHASE phase, unsigned long long int start);
+ACVP_RESULT acvp_timing_begin_vs(ACVP_CTX *ctx);
+void acvp_timing_end_vs(ACVP_CTX *ctx, int vs_id);
+void acvp_timing_free(ACVP_CTX *ctx);
+void acvp_cap_stats_free(ACVP_CAPS_LIST *cap);
+void acvp_log_handler_stats(ACVP_CTX *ctx);
+void acvp_progress_begin_session(ACVP_CTX *ctx, int vs_total);
+void acvp_progress_begin_vs(ACVP_CTX *ctx, ACVP_CIPHER cipher, int vs_id, const char *alg, const char *mode, JSON_Object *obj);
+void acvp_progress_end_vs(ACVP_CTX *ctx);
+void acvp_progress_tc_done(ACVP_CTX *ctx);
+void acvp_hex_set_simd(int enable);
+ACVP_RESULT acvp_scratch_reserve(ACVP_SCRATCH *scratch, size_t len);
+unsigned char *acvp_scratch_alloc(ACVP_SCRATCH *scratch, size_t len);
+void acvp_scratch_reset(ACVP_SCRATCH *scratch);
+size_t acvp_scratch_round(size_t len);
+void acvp_scratch_free(ACVP_SCRATCH *scratch);
+void *acvp_mem_malloc(size_t size);
+void *acvp_mem_calloc(size_t nmemb, size_t size);
+void acvp_mem_free(void *ptr);
+size_t acvp_mem_current_usage(void);
+void acvp_mem_begin_vs(ACVP_CTX *ctx);
+void acvp_mem_end_vs(ACVP_CTX *ctx, int vs_id);
+void acvp_mem_skip_vs(ACVP_CTX *ctx, int vs_id, size_t need);
+size_t acvp_mem_estimate_vs(ACVP_CTX *ctx, JSON_Object *obj, size_t tree_bytes, size_t body_len);
+int acvp_mem_over_budget(ACVP_CTX *ctx, size_t need);
+void acvp_mem_free_ctx(ACVP_CTX *ctx);
+void acvp_log_mem_usage(ACVP_CTX *ctx);
+int acvp_invoke_crypto_handler(ACVP_CTX *ctx, ACVP_CAPS_LIST *cap, ACVP_TEST_CASE *tc);
+int acvp_invoke_mct_handler(ACVP_CTX *ctx, ACVP_CAPS_LIST *cap, ACVP_TEST_CASE *tc);
+int acvp_invoke_batch_handler(ACVP_CTX *ctx, ACVP_CAPS_LIST *cap, ACVP_TEST_CASE *tcs, unsigned int count);
+void acvp_timing_worker_begin(ACVP_WORKER_ACCT *acct);
+void acvp_timing_worker_end(void);
+void acvp_timing_worker_merge(ACVP_CTX *ctx, ACVP_CAPS_LIST *cap, ACVP_WORKER_ACCT *acct);
+void *acvp_mct_jobs_next(ACVP_MCT_JOBS *list);
+ACVP_RESULT acvp_mct_jobs_run(ACVP_CTX *ctx, ACVP_CAPS_LIST *cap, ACVP_MCT_JOBS *list, ACVP_MCT_JOB_FN fn);
+void acvp_mct_jobs_free(ACVP_MCT_JOBS *list);
+int acvp_invoke_group_crypto_handler(ACVP_CTX *ctx, ACVP_CAPS_LIST *cap, ACVP_TEST_CASE *tc, int index, int count);
+void acvp_group_cache_clear(ACVP_GROUP_CACHE *cache);
+
 
 #endif
@@ -32,6 +32,7 @@ extern "C"
 #endif
 
 #include <stddef.h>   /* size_t */
+#include <stdio.h>    /* FILE */
 
 /* Types and enums */
 typedef struct json_object_t JSON_Object;
@@ -66,9 +67,18 @@ void json_set_allocation_functions(JSON_Malloc_Function malloc_fun, JSON_Free_Fu
  This function sets a global setting and is not thread safe. */
 void json_set_escape_slashes(int escape_slashes);
 
+/* Added by ACVP: sets if strings are scanned with SIMD instructions (selected at runtime, with a
+ scalar fallback) while parsing. Enabled by default. This function sets a global setting and is not
+ thread safe. */
+void json_set_simd_scan(int enable);
+
 /* Parses first JSON value in a file, returns NULL in case of error */
 JSON_Value * json_parse_file(const char *filename);
 
+/* Added by ACVP: same as json_parse_file, but maps the file into memory instead of reading it into
+   a heap buffer. The file must not be truncated while it is being parsed. */
+JSON_Value * json_parse_file_mmap(const char *filename);
+
 /* Parses first JSON value in a file and ignores comments (/ * * / and //),
    returns NULL in case of error */
 #if 0
@@ -98,6 +108,18 @@ char *      json_serialize_to_string_pretty(const JSON_Value *value, int *len);
 
 void        json_free_serialized_string(char *string); /* frees string from json_serialize_to_string and json_serialize_to_string_pretty */
 
+/* Added by ACVP: serializes into *buf, growing it (and updating *buf and *buf_size) when it is too
+ small. Pass *buf == NULL to start; the buffer can then be reused across calls so large responses do
+ not need a fresh allocation each time. Free with json_free_serialized_string. *len (optional)
+ receives the string length. */
+JSON_Status json_serialize_to_reusable_buffer(const JSON_Value *value, char **buf, size_t *buf_size, size_t *len);
+JSON_Status json_serialize_to_reusable_buffer_pretty(const JSON_Value *value, char **buf, size_t *buf_size, size_t *len);
+
+/* Added by ACVP: streams the value directly into an already open file without building an
+   intermediate string. The caller owns fp and is responsible for flushing/closing it. */
+JSON_Status json_serialize_to_fp(const JSON_Value *value, FILE *fp);
+JSON_Status json_serialize_to_fp_pretty(const JSON_Value *value, FILE *fp);
+
 /* Comparing */
 int  json_value_equals(const JSON_Value *a, const JSON_Value *b);
 
@@ -211,6 +233,10 @@ JSON_Status json_array_replace_null(JSON_Array *array, size_t i);
 /* Frees and removes all values from array */
 JSON_Status json_array_clear(JSON_Array *array);
 
+/* Added by ACVP: removes value at given index WITHOUT freeing and returns it, or NULL if index
+ * doesn't exist. Order of the remaining values is preserved. The caller owns the returned value. */
+JSON_Value * json_array_detach_value(JSON_Array *array, size_t i);
+
 /* Appends new value at the end of array.
  * json_array_append_value does not copy passed value so it shouldn't be freed afterwards. */
 JSON_Status json_array_append_value(JSON_Array *array, JSON_Value *value);
@@ -232,6 +258,9 @@ JSON_Value * json_value_init_boolean(int boolean);
 JSON_Value * json_value_init_null   (void);
 JSON_Value * json_value_deep_copy   (const JSON_Value *value);
 void         json_value_free        (JSON_Value *value);
+/* Added by ACVP: removes value from the object or array containing it WITHOUT freeing it, so it
+ * can be moved into another tree instead of copied. Returns value, or NULL on failure. */
+JSON_Value * json_value_detach      (JSON_Value *value);
 
 JSON_Value_Type json_value_get_type   (const JSON_Value *value);
 JSON_Object *   json_value_get_object (const JSON_Value *value);
@@ -38,6 +38,10 @@ static ACVP_RESULT acvp_process_vector_set(ACVP_CTX *ctx, JSON_Object *obj);
 
 static ACVP_RESULT acvp_dispatch_vector_set(ACVP_CTX *ctx, JSON_Object *obj);
 
+static void acvp_release_vs_buffers(ACVP_CTX *ctx);
+
+static ACVP_RESULT acvp_check_mem_budget(ACVP_CTX *ctx, int vs_id, size_t need);
+
 static void acvp_cap_free_sl(ACVP_SL_LIST *list);
 
 static void acvp_cap_free_nl(ACVP_NAME_LIST *list);
@@ -622,8 +626,15 @@ ACVP_RESULT acvp_free_test_session(ACVP_CTX *ctx) {
         return ACVP_SUCCESS;
     }
 
+    /* Deliver anything still queued while the rest of the ctx is intact */
+    acvp_log_sink_stop(ctx);
     if (ctx->kat_resp) { json_value_free(ctx->kat_resp); }
-    if (ctx->curl_buf) { free(ctx->curl_buf); }
+    if (ctx->vector_req_writer) { acvp_json_file_writer_close(&ctx->vector_req_writer); }
+    acvp_timing_free(ctx);
+    acvp_group_cache_clear(&ctx->group_cache);
+    if (ctx->curl_buf) { acvp_mem_free(ctx->curl_buf); }
+    if (ctx->resp_buf) { json_free_serialized_string(ctx->resp_buf); }
+    acvp_mem_free_ctx(ctx);
     if (ctx->server_name) { free(ctx->server_name); }
     if (ctx->path_segment) { free(ctx->path_segment); }
     if (ctx->api_context) { free(ctx->api_context); }
@@ -660,6 +671,7 @@ ACVP_RESULT acvp_free_test_session(ACVP_CTX *ctx) {
         cap_entry = ctx->caps_list;
         while (cap_entry) {
             cap_e2 = cap_entry->next;
+            acvp_cap_stats_free(cap_entry);
             if (cap_entry->prereq_vals) {
                 acvp_free_prereqs(cap_entry);
             }
@@ -999,6 +1011,67 @@ static void acvp_list_failing_algorithms(ACVP_CTX *ctx, ACVP_STRING_LIST **list,
     }
 }
 
+/*
+ * Processes one vector set of a request file and appends its response to the
+ * response file, which the first vector set written starts with ids_val (the
+ * session identifiers).
+ */
+static ACVP_RESULT acvp_run_vector_set_from_file(ACVP_CTX *ctx, JSON_Object *obj, JSON_Value *ids_val,
+                                                 ACVP_JSON_FILE_WRITER **writer, const char *rsp_filename) {
+    JSON_Array *kat_array;
+    JSON_Value *kat_val = NULL;
+    ACVP_RESULT rv = ACVP_SUCCESS;
+    unsigned long long int t_start = 0;
+    int vs_id = (int)json_object_get_number(obj, "vsId");
+
+    rv = acvp_timing_begin_vs(ctx);
+    if (rv != ACVP_SUCCESS) return rv;
+    acvp_mem_begin_vs(ctx);
+
+    /* The request file was parsed as a whole, only large data tests add to the estimate */
+    rv = acvp_check_mem_budget(ctx, vs_id, acvp_mem_estimate_vs(ctx, obj, 0, 0));
+    if (rv != ACVP_SUCCESS) goto end;
+
+    rv  = acvp_dispatch_vector_set(ctx, obj);
+    if (rv != ACVP_SUCCESS) {
+        ACVP_LOG_ERR("KAT dispatch error");
+        goto end;
+    }
+    ACVP_LOG_STATUS("Writing vector set responses for vector set %d...", vs_id);
+
+    kat_array = json_value_get_array(ctx->kat_resp);
+    kat_val = json_array_get_value(kat_array, 1);
+    if (!kat_val) {
+        ACVP_LOG_ERR("JSON val parse error");
+        rv = ACVP_JSON_ERR;
+        goto end;
+    }
+
+    if (!*writer) {
+        /* start the file with the '[' and identifiers array */
+        rv = acvp_json_file_writer_open(writer, rsp_filename, ctx->compact_json);
+        if (rv == ACVP_SUCCESS) {
+            rv = acvp_json_file_writer_append(*writer, ids_val);
+        }
+        if (rv != ACVP_SUCCESS) {
+            ACVP_LOG_ERR("File write error");
+            goto end;
+        }
+    }
+    /* append vector sets */
+    t_start = acvp_timing_now(ctx);
+    rv = acvp_json_file_writer_append(*writer, kat_val);
+    acvp_timing_record(ctx, ACVP_PHASE_SERIALIZE, t_start);
+    if (rv != ACVP_SUCCESS) {
+        ACVP_LOG_ERR("File write error");
+    }
+
+end:
+    acvp_timing_end_vs(ctx, vs_id);
+    acvp_mem_end_vs(ctx, vs_id);
+    return rv;
+}
+
 /*
  * Allows application to load JSON vector file(req_filename) within context
  * to be read in and used for vector testing. The results are
@@ -1008,18 +1081,17 @@ ACVP_RESULT acvp_run_vectors_from_file(ACVP_CTX *ctx, const char *req_filename,
     JSON_Object *obj = NULL;
     JSON_Value *val = NULL;
     JSON_Array *reg_array;
-    JSON_Value *file_val = NULL;
-    JSON_Value *kat_val = NULL;
-    JSON_Array *kat_array;
     JSON_Value *rsp_val = NULL;
-    ACVP_RESULT rv = ACVP_SUCCESS;
+    ACVP_JSON_FILE_WRITER *writer = NULL;
+    ACVP_RESULT rv = ACVP_SUCCESS, deferred_rv = ACVP_SUCCESS;
     int n, i;
     ACVP_STRING_LIST *vs_entry;
     JSON_Array *vect_sets = NULL;
     const char *test_session_url = NULL;
-    int vs_cnt = 0, isSample = 0;
+    int vs_cnt = 0, isSample = 0, deferred_cnt = 0;
+    char *deferred = NULL;
     const char *jwt = NULL;
-    char *json_result = NULL;
+    unsigned long long int t_start = 0;
 
     ACVP_LOG_STATUS("Beginning offline processing of vector sets...");
 
@@ -1036,7 +1108,13 @@ ACVP_RESULT acvp_run_vectors_from_file(ACVP_CTX *ctx, const char *req_filename,
         return ACVP_INVALID_ARG;
     }
 
-    val = json_parse_file(req_filename);
+    /* The request file is parsed as a whole, so time it on its own */
+    rv = acvp_timing_begin_vs(ctx);
+    if (rv != ACVP_SUCCESS) return rv;
+    t_start = acvp_timing_now(ctx);
+    val = json_parse_file_mmap(req_filename);
+    acvp_timing_record(ctx, ACVP_PHASE_PARSE, t_start);
+    acvp_timing_end_vs(ctx, 0);
 
     n = 0;
     reg_array = json_value_get_array(val);
@@ -1089,6 +1167,7 @@ ACVP_RESULT acvp_run_vectors_from_file(ACVP_CTX *ctx, const char *req_filename,
         if (rv != ACVP_SUCCESS) goto end;
         ACVP_LOG_INFO("Received vsid_url=%s", vsid_url);
     }
+    acvp_progress_begin_session(ctx, (int)vs_cnt);
 
     n++;        /* bump past the version or url, jwt, url sets */
     obj = json_array_get_object(reg_array, n);
@@ -1102,61 +1181,71 @@ ACVP_RESULT acvp_run_vectors_from_file(ACVP_CTX *ctx, const char *req_filename,
         goto end;
     }
 
+    deferred = calloc(json_array_get_count(reg_array), sizeof(char));
+    if (!deferred) {
+        rv = ACVP_MALLOC_FAIL;
+        goto end;
+    }
+    rsp_val = json_array_get_value(reg_array, 0);
     while (obj) {
         if (!vs_entry) {
             goto end;
         }
         /* Process the kat vector(s) */
-        rv  = acvp_dispatch_vector_set(ctx, obj);
-        if (rv != ACVP_SUCCESS) {
-            ACVP_LOG_ERR("KAT dispatch error");
+        rv = acvp_run_vector_set_from_file(ctx, obj, rsp_val, &writer, rsp_filename);
+        if (rv == ACVP_MEM_BUDGET_EXCEEDED) {
+            deferred[n] = 1;
+            deferred_cnt++;
+        } else if (rv != ACVP_SUCCESS) {
             goto end;
         }
-        ACVP_LOG_STATUS("Writing vector set responses for vector set %d...", ctx->vs_id);
 
-        /* 
-         * Convert the JSON from a fully qualified to a value that can be 
-         * added to the file. Kind of klumsy, but it works.
-         */
-        kat_array = json_value_get_array(ctx->kat_resp);
-        kat_val = json_array_get_value(kat_array, 1);
-        if (!kat_val) {
-            ACVP_LOG_ERR("JSON val parse error");
+        n++;
+        obj = json_array_get_object(reg_array, n);
+        vs_entry = vs_entry->next;
+    }
+
+    /*
+     * Vector sets deferred for memory get one more try once the others have
+     * been written; their responses follow the rest in the response file.
+     */
+    rv = ACVP_SUCCESS;
+    if (deferred_cnt) {
+        acvp_release_vs_buffers(ctx);
+        ctx->mem_deferring = 1;
+    }
+    for (i = 1; deferred_cnt && i < n; i++) {
+        if (!deferred[i]) {
+            continue;
+        }
+        rv = acvp_run_vector_set_from_file(ctx, json_array_get_object(reg_array, i), rsp_val,
+                                           &writer, rsp_filename);
+        if (rv == ACVP_MEM_BUDGET_EXCEEDED) {
+            deferred_rv = rv;
+            rv = ACVP_SUCCESS;
+        }
+        if (rv != ACVP_SUCCESS) {
             goto end;
         }
-        json_result = json_serialize_to_string_pretty(kat_val, NULL);
-        file_val = json_parse_string(json_result);
-        json_free_serialized_string(json_result);
-
-        /* track first vector set with file count */
-        if (n == 1) {
+    }
+    ctx->mem_deferring = 0;
 
-            rsp_val = json_array_get_value(reg_array, 0);
-            /* start the file with the '[' and identifiers array */
-            rv = acvp_json_serialize_to_file_pretty_w(rsp_val, rsp_filename);
-            if (rv != ACVP_SUCCESS) {
-                ACVP_LOG_ERR("File write error");
-                json_value_free(file_val);
-                goto end;
-            }
-        } 
-        /* append vector sets */
-        rv = acvp_json_serialize_to_file_pretty_a(file_val, rsp_filename);
+    /* append the final ']' to make the JSON work */
+    if (writer) {
+        rv = acvp_json_file_writer_close(&writer);
         if (rv != ACVP_SUCCESS) {
             ACVP_LOG_ERR("File write error");
-            json_value_free(file_val);
             goto end;
         }
-
-        json_value_free(file_val);
-        n++;
-        obj = json_array_get_object(reg_array, n);
-        vs_entry = vs_entry->next;
     }
-    /* append the final ']' to make the JSON work */ 
-    rv = acvp_json_serialize_to_file_pretty_a(NULL, rsp_filename);
     ACVP_LOG_STATUS("Completed processing of vector sets. Responses saved in specified file.");
+    acvp_log_handler_stats(ctx);
+    acvp_log_mem_usage(ctx);
+    rv = deferred_rv;
 end:
+    ctx->mem_deferring = 0;
+    if (writer) acvp_json_file_writer_close(&writer);
+    if (deferred) free(deferred);
     json_value_free(val);
     return rv;
 }
@@ -1170,12 +1259,11 @@ ACVP_RESULT acvp_upload_vectors_from_file(ACVP_CTX *ctx, const char *rsp_filenam
     JSON_Object *rsp_obj = NULL;
     JSON_Object *ver_obj = NULL;
     JSON_Value *vs_val = NULL;
-    JSON_Value *new_val = NULL;
     JSON_Value *ver_val = NULL;
     JSON_Value *val = NULL;
     ACVP_RESULT rv = ACVP_SUCCESS;
     JSON_Array *reg_array;
-    int n, i;
+    int i;
     ACVP_STRING_LIST *vs_entry;
     JSON_Array *vect_sets = NULL;
     const char *test_session_url = NULL;
@@ -1200,7 +1288,7 @@ ACVP_RESULT acvp_upload_vectors_from_file(ACVP_CTX *ctx, const char *rsp_filenam
         return ACVP_INVALID_ARG;
     }
 
-    val = json_parse_file(rsp_filename);
+    val = json_parse_file_mmap(rsp_filename);
     if (!val) {
         ACVP_LOG_ERR("JSON val parse error");
         return ACVP_MALFORMED_JSON;
@@ -1284,14 +1372,17 @@ ACVP_RESULT acvp_upload_vectors_from_file(ACVP_CTX *ctx, const char *rsp_filenam
         ctx->fips.do_validation = 0; /* Disable */
     }
 
-    n = 1;    /* start with second array index */
     reg_array = json_value_get_array(val);
-    vs_val = json_array_get_value(reg_array, n);
 
     while (vs_entry) {
+        /*
+         * Move the response out of the file array rather than copying it. Since each one is
+         * detached once sent, the next vector set is always at the second array index.
+         */
+        vs_val = json_array_detach_value(reg_array, 1);
 
         /* check vsId compared to vs URL */
-        rsp_obj = json_array_get_object(reg_array, n);
+        rsp_obj = json_value_get_object(vs_val);
         ctx->vs_id = json_object_get_number(rsp_obj, "vsId");
 
         vec_array_val = json_value_init_array();
@@ -1303,21 +1394,21 @@ ACVP_RESULT acvp_upload_vectors_from_file(ACVP_CTX *ctx, const char *rsp_filenam
         json_object_set_string(ver_obj, "acvVersion", ACVP_PROTOCOL_VERSION);
         json_array_append_value(vec_array, ver_val);
 
-        json_result = json_serialize_to_string_pretty(vs_val, NULL);
-        new_val = json_parse_string(json_result);
-        json_free_serialized_string(json_result);
-
-        json_array_append_value(vec_array, new_val);
+        if (json_array_append_value(vec_array, vs_val) != JSONSuccess) {
+            json_value_free(vs_val);
+        }
 
         ctx->kat_resp = vec_array_val;
 
-        json_result = json_serialize_to_string_pretty(ctx->kat_resp, NULL);
-        if (ctx->log_lvl == ACVP_LOG_LVL_VERBOSE) {
-            printf("\n\n%s\n\n", json_result);
-        } else {
+        /* At VERBOSE the responses always go to stdout, with or without a log callback */
+        if (ctx->log_lvl == ACVP_LOG_LVL_VERBOSE || ACVP_LOG_ENABLED(ctx, ACVP_LOG_LVL_INFO)) {
+            json_result = json_serialize_to_string_pretty(ctx->kat_resp, NULL);
+            if (ctx->log_lvl == ACVP_LOG_LVL_VERBOSE) {
+                printf("\n\n%s\n\n", json_result);
+            }
             ACVP_LOG_INFO("\n\n%s\n\n", json_result);
+            json_free_serialized_string(json_result);
         }
-        json_free_serialized_string(json_result);
         ACVP_LOG_STATUS("Sending responses for vector set %d", ctx->vs_id);
         rv = acvp_submit_vector_responses(ctx, vs_entry->string);
         if (rv != ACVP_SUCCESS) {
@@ -1326,8 +1417,6 @@ ACVP_RESULT acvp_upload_vectors_from_file(ACVP_CTX *ctx, const char *rsp_filenam
 
         json_value_free(vec_array_val);
         ctx->kat_resp = NULL;
-        n++;
-        vs_val = json_array_get_value(reg_array, n);
         vs_entry = vs_entry->next;
     }
 
@@ -1392,6 +1481,7 @@ end:
 ACVP_RESULT acvp_get_expected_results(ACVP_CTX *ctx, const char *request_filename, const char *save_filename) {
     JSON_Value *val = NULL, *fw_val = NULL;
     JSON_Object *obj = NULL, *fw_obj = NULL;
+    ACVP_JSON_FILE_WRITER *writer = NULL;
     ACVP_RESULT rv = ACVP_SUCCESS;
 
     if (!ctx) {
@@ -1469,7 +1559,10 @@ ACVP_RESULT acvp_get_expected_results(ACVP_CTX *ctx, const char *request_filenam
         }
         json_object_set_string(fw_obj, "jwt", ctx->jwt_token);
         json_object_set_string(fw_obj, "url", ctx->session_url);
-        rv = acvp_json_serialize_to_file_pretty_w(fw_val, save_filename);
+        rv = acvp_json_file_writer_open(&writer, save_filename, ctx->compact_json);
+        if (rv == ACVP_SUCCESS) {
+            rv = acvp_json_file_writer_append(writer, fw_val);
+        }
         if (rv != ACVP_SUCCESS) {
             ACVP_LOG_ERR("Error writing to provided file.");
             json_value_free(fw_val);
@@ -1516,7 +1609,7 @@ ACVP_RESULT acvp_get_expected_results(ACVP_CTX *ctx, const char *request_filenam
                 goto end;
             }
             /* append data */
-            rv = acvp_json_serialize_to_file_pretty_a(fw_val, save_filename);
+            rv = acvp_json_file_writer_append(writer, fw_val);
             if (rv != ACVP_SUCCESS) {
                 ACVP_LOG_ERR("Error writing to file");
                 goto end;
@@ -1528,9 +1621,12 @@ ACVP_RESULT acvp_get_expected_results(ACVP_CTX *ctx, const char *request_filenam
         }
     }
     //append the final ']'
-    rv = acvp_json_serialize_to_file_pretty_a(NULL, save_filename);
+    if (writer) {
+        rv = acvp_json_file_writer_close(&writer);
+    }
     ACVP_LOG_STATUS("Completed output of expected results.");
 end:
+   if (writer) acvp_json_file_writer_close(&writer);
    if (fw_val) json_value_free(fw_val);
    if (val) json_value_free(val);
    return rv;
@@ -2001,6 +2097,14 @@ ACVP_RESULT acvp_mark_as_sample(ACVP_CTX *ctx) {
     return ACVP_SUCCESS;
 }
 
+ACVP_RESULT acvp_set_json_output_compact(ACVP_CTX *ctx, int compact) {
+    if (!ctx) {
+        return ACVP_NO_CTX;
+    }
+    ctx->compact_json = compact ? 1 : 0;
+    return ACVP_SUCCESS;
+}
+
 ACVP_RESULT acvp_mark_as_request_only(ACVP_CTX *ctx, char *filename) {
     if (!ctx) {
         return ACVP_NO_CTX;
@@ -2676,7 +2780,7 @@ static ACVP_RESULT acvp_parse_session_info_file(ACVP_CTX *ctx, const char *filen
         return ACVP_INVALID_ARG;
     }
     
-    val = json_parse_file(filename);
+    val = json_parse_file_mmap(filename);
     if (!val) {
         ACVP_LOG_ERR("JSON val parse error");
         return ACVP_MALFORMED_JSON;
@@ -2727,6 +2831,38 @@ end:
     return rv;
 }
 
+/*
+ * Frees what the library keeps from one vector set to the next, so deferred
+ * vector sets are retried with as much of the budget as possible.
+ */
+static void acvp_release_vs_buffers(ACVP_CTX *ctx) {
+    acvp_group_cache_clear(&ctx->group_cache);
+    if (ctx->resp_buf) {
+        json_free_serialized_string(ctx->resp_buf);
+        ctx->resp_buf = NULL;
+        ctx->resp_buf_size = 0;
+    }
+}
+
+/*
+ * Whether a vector set estimated to need need bytes may start. One that does
+ * not fit is deferred on the first pass and skipped on the retry.
+ */
+static ACVP_RESULT acvp_check_mem_budget(ACVP_CTX *ctx, int vs_id, size_t need) {
+    if (!acvp_mem_over_budget(ctx, need)) {
+        return ACVP_SUCCESS;
+    }
+    if (ctx->mem_deferring) {
+        ACVP_LOG_ERR("Skipping vector set %d, it needs about %.1f MB, over the memory budget of %.1f MB",
+                     vs_id, (double)need / (1024.0 * 1024.0), (double)ctx->mem_budget / (1024.0 * 1024.0));
+        acvp_mem_skip_vs(ctx, vs_id, need);
+    } else {
+        ACVP_LOG_STATUS("Deferring vector set %d, it needs about %.1f MB which would exceed the memory budget",
+                        vs_id, (double)need / (1024.0 * 1024.0));
+    }
+    return ACVP_MEM_BUDGET_EXCEEDED;
+}
+
 /*
  * This function is used by the application after registration
  * to commence the testing.  All the testing will be handled
@@ -2734,8 +2870,8 @@ end:
  * it should be run on a separate thread if needed.
  */
 ACVP_RESULT acvp_process_tests(ACVP_CTX *ctx) {
-    ACVP_RESULT rv = ACVP_SUCCESS;
-    ACVP_STRING_LIST *vs_entry = NULL;
+    ACVP_RESULT rv = ACVP_SUCCESS, deferred_rv = ACVP_SUCCESS;
+    ACVP_STRING_LIST *vs_entry = NULL, *deferred = NULL;
     int count = 0;
 
     if (!ctx) {
@@ -2751,18 +2887,60 @@ ACVP_RESULT acvp_process_tests(ACVP_CTX *ctx) {
     if (!vs_entry) {
         return ACVP_MISSING_ARG;
     }
+    while (vs_entry) {
+        count++;
+        vs_entry = vs_entry->next;
+    }
+    acvp_progress_begin_session(ctx, count);
+
+    count = 0;
+    vs_entry = ctx->vsid_url_list;
     while (vs_entry) {
         rv = acvp_process_vsid(ctx, vs_entry->string, count);
+        if (rv == ACVP_MEM_BUDGET_EXCEEDED) {
+            rv = acvp_append_str_list(&deferred, vs_entry->string);
+        }
         if (rv != ACVP_SUCCESS) {
             ACVP_LOG_ERR("Unable to process vector set! Error: %d", rv);
+            acvp_free_str_list(&deferred);
             return rv;
         }
         vs_entry = vs_entry->next;
         count++;
     }
+
+    /*
+     * Vector sets deferred for memory get one more try once everything else
+     * has been submitted; any that still do not fit are skipped.
+     */
+    if (deferred) {
+        acvp_release_vs_buffers(ctx);
+        ctx->mem_deferring = 1;
+    }
+    for (vs_entry = deferred; vs_entry; vs_entry = vs_entry->next) {
+        rv = acvp_process_vsid(ctx, vs_entry->string, count);
+        if (rv == ACVP_MEM_BUDGET_EXCEEDED) {
+            deferred_rv = rv;
+            rv = ACVP_SUCCESS;
+        }
+        if (rv != ACVP_SUCCESS) {
+            ACVP_LOG_ERR("Unable to process vector set! Error: %d", rv);
+            break;
+        }
+        count++;
+    }
+    ctx->mem_deferring = 0;
+    acvp_free_str_list(&deferred);
+    if (rv != ACVP_SUCCESS) {
+        return rv;
+    }
+
     /* Need to add the ending ']' here */
-    if (ctx->vector_req) {
-        rv = acvp_json_serialize_to_file_pretty_a(NULL, ctx->vector_req_file);
+    if (ctx->vector_req_writer) {
+        rv = acvp_json_file_writer_close(&ctx->vector_req_writer);
+    }
+    if (rv == ACVP_SUCCESS) {
+        rv = deferred_rv;
     }
     return rv;
 }
@@ -2898,20 +3076,35 @@ static ACVP_RESULT acvp_process_vsid(ACVP_CTX *ctx, char *vsid_url, int count) {
     int retry_period = 0;
     int retry = 1;
     unsigned int time_waited_so_far = 0;
+    unsigned long long int t_start = 0;
+    int vs_id = 0;
+    size_t mem_before = 0, mem_parsed = 0, mem_need = 0;
+
+    rv = acvp_timing_begin_vs(ctx);
+    if (rv != ACVP_SUCCESS) return rv;
+    acvp_mem_begin_vs(ctx);
+
     while (retry) {
         /*
          * Get the KAT vector set
          */
+        t_start = acvp_timing_now(ctx);
         rv = acvp_retrieve_vector_set(ctx, vsid_url);
+        acvp_timing_record(ctx, ACVP_PHASE_DOWNLOAD, t_start);
         if (rv != ACVP_SUCCESS) goto end;
 
+        t_start = acvp_timing_now(ctx);
+        mem_before = acvp_mem_current_usage();
         val = json_parse_string(ctx->curl_buf);
+        mem_parsed = acvp_mem_current_usage();
+        acvp_timing_record(ctx, ACVP_PHASE_PARSE, t_start);
         if (!val) {
             ACVP_LOG_ERR("JSON parse error");
             rv = ACVP_JSON_ERR;
             goto end;
         }
         obj = acvp_get_obj_from_rsp(ctx, val);
+        vs_id = (int) json_object_get_number(obj, "vsId");
 
         /*
          * Check if we received a retry response
@@ -2921,11 +3114,13 @@ static ACVP_RESULT acvp_process_vsid(ACVP_CTX *ctx, char *vsid_url, int count) {
             /*
              * Wait and try again to retrieve the VectorSet
              */
+            t_start = acvp_timing_now(ctx);
             if (acvp_retry_handler(ctx, &retry_period, &time_waited_so_far, 1, ACVP_WAITING_FOR_TESTS) != ACVP_KAT_DOWNLOAD_RETRY) {
                 ACVP_LOG_STATUS("Maximum wait time with server reached! (Max: %d seconds)", ACVP_MAX_WAIT_TIME);
                 rv = ACVP_TRANSPORT_FAIL;
                 goto end;
             };
+            acvp_timing_record(ctx, ACVP_PHASE_RETRY_WAIT, t_start);
             retry = 1;
         } else {
             /*
@@ -2955,7 +3150,11 @@ static ACVP_RESULT acvp_process_vsid(ACVP_CTX *ctx, char *vsid_url, int count) {
                         vs_entry = vs_entry->next;
                     }
                     /* Start with identifiers */
-                    rv = acvp_json_serialize_to_file_pretty_w(ts_val, ctx->vector_req_file);
+                    rv = acvp_json_file_writer_open(&ctx->vector_req_writer, ctx->vector_req_file,
+                                                    ctx->compact_json);
+                    if (rv == ACVP_SUCCESS) {
+                        rv = acvp_json_file_writer_append(ctx->vector_req_writer, ts_val);
+                    }
                     if (rv != ACVP_SUCCESS) {
                         ACVP_LOG_ERR("File write error");
                         json_value_free(ts_val);
@@ -2963,10 +3162,20 @@ static ACVP_RESULT acvp_process_vsid(ACVP_CTX *ctx, char *vsid_url, int count) {
                     }
                 } 
                 /* append vector set */
-                rv = acvp_json_serialize_to_file_pretty_a(alg_val, ctx->vector_req_file);
+                rv = acvp_json_file_writer_append(ctx->vector_req_writer, alg_val);
                 json_value_free(ts_val);
                 goto end;
             }
+            /*
+             * Leave a vector set that would take us past the memory budget
+             * until the others are done
+             */
+            mem_need = acvp_mem_estimate_vs(ctx, obj,
+                                            mem_parsed > mem_before ? mem_parsed - mem_before : 0,
+                                            (size_t)ctx->curl_read_ctr);
+            rv = acvp_check_mem_budget(ctx, vs_id, mem_need);
+            if (rv != ACVP_SUCCESS) goto end;
+
             /*
              * Process the KAT VectorSet
              */
@@ -2987,7 +3196,9 @@ static ACVP_RESULT acvp_process_vsid(ACVP_CTX *ctx, char *vsid_url, int count) {
     rv = acvp_submit_vector_responses(ctx, vsid_url);
 
 end:
+    acvp_timing_end_vs(ctx, vs_id);
     if (val) json_value_free(val);
+    acvp_mem_end_vs(ctx, vs_id);
     return rv;
 }
 
@@ -3004,6 +3215,7 @@ static ACVP_RESULT acvp_dispatch_vector_set(ACVP_CTX *ctx, JSON_Object *obj) {
     const char *mode = json_object_get_string(obj, "mode");
     int vs_id = (int) json_object_get_number(obj, "vsId");
     int diff = 1;
+    unsigned long long int t_start = 0;
 
     ctx->vs_id = vs_id;
     ACVP_RESULT rv;
@@ -3029,7 +3241,12 @@ static ACVP_RESULT acvp_dispatch_vector_set(ACVP_CTX *ctx, JSON_Object *obj) {
                  alg, &diff);
         if (!diff) {
             if (mode == NULL || alg_tbl[i].cipher == ACVP_KDF108) { // KDF108-KMAC has a mode!
+                acvp_progress_begin_vs(ctx, alg_tbl[i].cipher, vs_id, alg, mode, obj);
+                t_start = acvp_timing_now(ctx);
                 rv = (alg_tbl[i].handler)(ctx, obj);
+                acvp_timing_record(ctx, ACVP_PHASE_DISPATCH, t_start);
+                acvp_group_cache_clear(&ctx->group_cache);
+                acvp_progress_end_vs(ctx);
                 return rv;
             }
 
@@ -3038,7 +3255,12 @@ static ACVP_RESULT acvp_dispatch_vector_set(ACVP_CTX *ctx, JSON_Object *obj) {
                         ACVP_ALG_MODE_MAX,
                         mode, &diff);
                 if (!diff) {
+                    acvp_progress_begin_vs(ctx, alg_tbl[i].cipher, vs_id, alg, mode, obj);
+                    t_start = acvp_timing_now(ctx);
                     rv = (alg_tbl[i].handler)(ctx, obj);
+                    acvp_timing_record(ctx, ACVP_PHASE_DISPATCH, t_start);
+                    acvp_group_cache_clear(&ctx->group_cache);
+                    acvp_progress_end_vs(ctx);
                     return rv;
                 }
             }
@@ -3356,7 +3578,6 @@ ACVP_RESULT acvp_post_data(ACVP_CTX *ctx, char *filename) {
     JSON_Object *obj = NULL;
     JSON_Value *val = NULL;
     JSON_Value *post_val = NULL;
-    JSON_Value *raw_val = NULL;
     const char *path = NULL;
     char *json_result = NULL;
     int len;
@@ -3392,13 +3613,12 @@ ACVP_RESULT acvp_post_data(ACVP_CTX *ctx, char *filename) {
         goto end;
     }
 
-    raw_val = json_array_get_value(data_array, 1);
-    json_result = json_serialize_to_string_pretty(raw_val, NULL);
-    post_val = json_parse_string(json_result);
-    json_free_serialized_string(json_result);
+    post_val = json_array_detach_value(data_array, 1);
 
     rv = acvp_create_array(&reg_obj, &reg_arry_val, &reg_arry);
-    json_array_append_value(reg_arry, post_val);
+    if (json_array_append_value(reg_arry, post_val) != JSONSuccess) {
+        json_value_free(post_val);
+    }
 
     json_result = json_serialize_to_string_pretty(reg_arry_val, &len);
     ACVP_LOG_INFO("\nPOST Data: %s\n\n", json_result);
@@ -3644,9 +3864,15 @@ ACVP_RESULT acvp_run(ACVP_CTX *ctx, int fips_validation) {
      */
     rv = acvp_process_tests(ctx);
     if (rv != ACVP_SUCCESS) {
+        if (rv == ACVP_MEM_BUDGET_EXCEEDED) {
+            /* The rest were submitted; show which vector sets were skipped */
+            acvp_log_mem_usage(ctx);
+        }
         ACVP_LOG_ERR("Failed to process vectors");
         goto end;
     }
+    acvp_log_handler_stats(ctx);
+    acvp_log_mem_usage(ctx);
     if (ctx->vector_req) {
         ACVP_LOG_STATUS("Successfully downloaded vector sets and saved to specified file.");
         return ACVP_SUCCESS;
@@ -3765,22 +3991,21 @@ ACVP_RESULT acvp_put_data_from_file(ACVP_CTX *ctx, const char *put_filename) {
         rv = ACVP_MALFORMED_JSON;
         goto end;
     }
-    json_result = json_serialize_to_string(meta_val, &len);
     if (jwt && (json_object_has_value(obj, "oe") || json_object_has_value(obj, "oeUrl")) &&
         (json_object_has_value(obj, "module") || json_object_has_value(obj, "moduleUrl"))) {
         validation = 1;
     }
 
-    put_val = json_parse_string(json_result);
-    json_free_serialized_string(json_result);
-    json_result = NULL;
+    put_val = json_value_detach(meta_val);
 
     rv = acvp_create_array(&reg_obj, &reg_arry_val, &reg_arry);
     if (rv != ACVP_SUCCESS) {
         ACVP_LOG_STATUS("Failed to create array");
         goto end;
     }
-    json_array_append_value(reg_arry, put_val);
+    if (json_array_append_value(reg_arry, put_val) == JSONSuccess) {
+        put_val = NULL; /* now owned by reg_arry_val */
+    }
     json_result = json_serialize_to_string_pretty(reg_arry_val, &len);
 
     rv = acvp_transport_put(ctx, test_session_url, json_result, len);
@@ -3805,6 +4030,7 @@ end:
     if (json_result) {json_free_serialized_string(json_result);}
     if (val) {json_value_free(val);}
     if (put_val) {json_value_free(put_val);}
+    if (reg_arry_val) {json_value_free(reg_arry_val);}
     return rv;
 }
 
@@ -3844,18 +4070,16 @@ static ACVP_RESULT acvp_put_data_from_ctx(ACVP_CTX *ctx) {
         goto end;
     }
 
-    json_result = json_serialize_to_string(meta_val, &len);
-
-    put_val = json_parse_string(json_result);
-    json_free_serialized_string(json_result);
-    json_result = NULL;
+    put_val = json_value_detach(meta_val);
 
     rv = acvp_create_array(&reg_obj, &reg_arry_val, &reg_arry);
     if (rv != ACVP_SUCCESS) {
         ACVP_LOG_STATUS("Failed to create array");
         goto end;
     }
-    json_array_append_value(reg_arry, put_val);
+    if (json_array_append_value(reg_arry, put_val) == JSONSuccess) {
+        put_val = NULL; /* now owned by reg_arry_val */
+    }
     json_result = json_serialize_to_string_pretty(reg_arry_val, &len);
 
     rv = acvp_transport_put(ctx, ctx->session_url, json_result, len);
@@ -3876,6 +4100,7 @@ static ACVP_RESULT acvp_put_data_from_ctx(ACVP_CTX *ctx) {
 end:
     if (json_result) {json_free_serialized_string(json_result);}
     if (put_val) {json_value_free(put_val);}
+    if (reg_arry_val) {json_value_free(reg_arry_val);}
     if (val) {json_value_free(val);}
     return rv;
 }
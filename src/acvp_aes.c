@@ -26,6 +26,7 @@ static ACVP_RESULT acvp_aes_output_tc(ACVP_CTX *ctx,
                                       int opt_rv);
 static ACVP_RESULT acvp_aes_init_tc(ACVP_CTX *ctx,
                                     ACVP_SYM_CIPHER_TC *stc,
+                                    ACVP_SCRATCH *scratch,
                                     unsigned int tc_id,
                                     ACVP_SYM_CIPH_TESTTYPE test_type,
                                     const char *j_key,
@@ -57,38 +58,109 @@ static ACVP_RESULT acvp_aes_init_tc(ACVP_CTX *ctx,
 
 static ACVP_RESULT acvp_aes_release_tc(ACVP_SYM_CIPHER_TC *stc);
 
-#define KEY_COL_LEN 101
 #define KEY_ROW_LEN 32
-#define IV_COL_LEN 101
 #define IV_ROW_LEN 16
-#define TEXT_COL_LEN 1001
 #define TEXT_ROW_LEN 32
-static unsigned char mkey[KEY_COL_LEN][KEY_ROW_LEN];
-static unsigned char miv[IV_COL_LEN][IV_ROW_LEN];
-static unsigned char ptext[TEXT_COL_LEN][TEXT_ROW_LEN];
-static unsigned char ctext[TEXT_COL_LEN][TEXT_ROW_LEN];
+#define MCT_OUT_LEN 16  /* largest output of one operation, a block */
 
-#define gb(a, b) (((a)[(b) / 8] >> (7 - (b) % 8)) & 1)
-#define sb(a, b, v) ((a)[(b) / 8] = ((a)[(b) / 8] & ~(1 << (7 - (b) % 8))) | (!!(v) << (7 - (b) % 8)))
+/*
+ * Chaining values for one Monte Carlo test. No step looks further back than
+ * one block for the block modes, or 255 outputs for CFB8 which produces a
+ * byte per step, so the history is kept in small rings indexed by the inner
+ * loop counter instead of a row per iteration.
+ *
+ * CFB1 produces a bit per step. Its inputs are the bits of the IV followed by
+ * its own outputs, so the IV and the outputs are kept as one 256 bit shift
+ * register: each output is shifted in at the bottom, the next input is always
+ * bit 128 and the key and IV for the next outer iteration are the low 256 or
+ * 128 bits, already in order.
+ */
+#define MCT_BLK_RING 2
+#define MCT_BYTE_RING 256
+#define MCT_CFB1_WORDS 4
+typedef struct acvp_aes_mct_state_t {
+    unsigned char key[KEY_ROW_LEN];  /* key at the start of the outer iteration */
+    unsigned char iv[IV_ROW_LEN];    /* iv at the start of the outer iteration */
+    unsigned char ptext[MCT_BLK_RING][TEXT_ROW_LEN];
+    unsigned char ctext[MCT_BLK_RING][TEXT_ROW_LEN];
+    unsigned char pbyte[MCT_BYTE_RING];
+    unsigned char cbyte[MCT_BYTE_RING];
+    unsigned long long int bits[MCT_CFB1_WORDS]; /* CFB1 shift register, most significant word first */
+} ACVP_AES_MCT_STATE;
+
+#define MCT_BLK(ring, j) ((ring)[(j) & (MCT_BLK_RING - 1)])
+#define MCT_BYTE(ring, j) ((ring)[(j) & (MCT_BYTE_RING - 1)])
+
+/* Room past the input for whatever the module appends: padding, a tag or key wrap overhead */
+#define ACVP_AES_DATA_SLACK 64
+
+/* Starts the CFB1 shift register with the outer iteration's IV in the low 128 bits */
+static void acvp_aes_cfb1_load(ACVP_AES_MCT_STATE *st) {
+    unsigned int i = 0;
+
+    st->bits[0] = 0;
+    st->bits[1] = 0;
+    st->bits[2] = 0;
+    st->bits[3] = 0;
+    for (i = 0; i < 8; i++) {
+        st->bits[2] = (st->bits[2] << 8) | st->iv[i];
+        st->bits[3] = (st->bits[3] << 8) | st->iv[i + 8];
+    }
+}
+
+/*
+ * Shifts in one CFB1 output (the most significant bit of out) and returns
+ * the next input, in the most significant bit.
+ */
+static unsigned char acvp_aes_cfb1_step(ACVP_AES_MCT_STATE *st, unsigned char out) {
+    st->bits[0] = (st->bits[0] << 1) | (st->bits[1] >> 63);
+    st->bits[1] = (st->bits[1] << 1) | (st->bits[2] >> 63);
+    st->bits[2] = (st->bits[2] << 1) | (st->bits[3] >> 63);
+    st->bits[3] = (st->bits[3] << 1) | (out >> 7);
+    return (unsigned char)((st->bits[1] & 1) << 7);
+}
+
+/* Copies the low len bytes of the CFB1 shift register, oldest first */
+static void acvp_aes_cfb1_tail(const ACVP_AES_MCT_STATE *st, unsigned char *dst, unsigned int len) {
+    unsigned int i = 0, n = MCT_CFB1_WORDS * 8 - len;
+
+    for (i = 0; i < len; i++, n++) {
+        dst[i] = (unsigned char)(st->bits[n / 8] >> (56 - 8 * (n % 8)));
+    }
+}
 
 /*
  * After each encrypt/decrypt for a Monte Carlo test the iv
  * and/or pt/ct information may need to be modified.  This function
  * performs the iteration depdedent upon the cipher type and direction.
  */
-static ACVP_RESULT acvp_aes_mct_iterate_tc(ACVP_CTX *ctx, ACVP_SYM_CIPHER_TC *stc, int i) {
+static ACVP_RESULT acvp_aes_mct_iterate_tc(ACVP_CTX *ctx, ACVP_SYM_CIPHER_TC *stc, ACVP_AES_MCT_STATE *st) {
     int j = stc->mct_index;
     ACVP_SUB_AES alg;
 
-    if (stc->cipher != ACVP_AES_CFB1) {
-        memcpy_s(ctext[j], TEXT_ROW_LEN, stc->ct, stc->ct_len);
-        memcpy_s(ptext[j], TEXT_ROW_LEN, stc->pt, stc->pt_len);
+    if (stc->cipher == ACVP_AES_CFB1) {
+        /* The output is the next bit of the register, and the bit 128 behind it the next input */
+        if (j == 0) {
+            memcpy_s(st->key, KEY_ROW_LEN, stc->key, stc->key_len / 8);
+            acvp_aes_cfb1_load(st);
+        }
+        if (stc->direction == ACVP_SYM_CIPH_DIR_ENCRYPT) {
+            stc->pt[0] = acvp_aes_cfb1_step(st, stc->ct[0]);
+        } else {
+            stc->ct[0] = acvp_aes_cfb1_step(st, stc->pt[0]);
+        }
+        return ACVP_SUCCESS;
+    }
+
+    if (stc->cipher == ACVP_AES_CFB8) {
+        MCT_BYTE(st->cbyte, j) = stc->ct[0];
+        MCT_BYTE(st->pbyte, j) = stc->pt[0];
     } else {
-        ctext[j][0] = stc->ct[0];
-        ptext[j][0] = stc->pt[0];
+        memcpy_s(MCT_BLK(st->ctext, j), TEXT_ROW_LEN, stc->ct, stc->ct_len);
+        memcpy_s(MCT_BLK(st->ptext, j), TEXT_ROW_LEN, stc->pt, stc->pt_len);
     }
     if (j == 0) {
-        memcpy_s(mkey[j], KEY_ROW_LEN, stc->key, stc->key_len / 8);
+        memcpy_s(st->key, KEY_ROW_LEN, stc->key, stc->key_len / 8);
     }
 
     alg = acvp_get_aes_alg(stc->cipher);
@@ -100,9 +172,9 @@ static ACVP_RESULT acvp_aes_mct_iterate_tc(ACVP_CTX *ctx, ACVP_SYM_CIPHER_TC *st
     switch (alg) {
     case ACVP_SUB_AES_ECB:
         if (stc->direction == ACVP_SYM_CIPH_DIR_ENCRYPT) {
-            memcpy_s(stc->pt, ACVP_SYM_PT_BYTE_MAX, ctext[j], stc->ct_len);
+            memcpy_s(stc->pt, stc->pt_alloc, MCT_BLK(st->ctext, j), stc->ct_len);
         } else {
-            memcpy_s(stc->ct, ACVP_SYM_CT_BYTE_MAX, ptext[j], stc->pt_len);
+            memcpy_s(stc->ct, stc->ct_alloc, MCT_BLK(st->ptext, j), stc->pt_len);
         }
         break;
     case ACVP_SUB_AES_CBC:
@@ -110,52 +182,36 @@ static ACVP_RESULT acvp_aes_mct_iterate_tc(ACVP_CTX *ctx, ACVP_SYM_CIPHER_TC *st
     case ACVP_SUB_AES_CFB128:
         if (j == 0) {
             if (stc->direction == ACVP_SYM_CIPH_DIR_ENCRYPT) {
-                memcpy_s(stc->pt, ACVP_SYM_PT_BYTE_MAX, stc->iv, stc->iv_len);
+                memcpy_s(stc->pt, stc->pt_alloc, stc->iv, stc->iv_len);
             } else {
-                memcpy_s(stc->ct, ACVP_SYM_CT_BYTE_MAX, stc->iv, stc->iv_len);
+                memcpy_s(stc->ct, stc->ct_alloc, stc->iv, stc->iv_len);
             }
         } else {
             if (stc->direction == ACVP_SYM_CIPH_DIR_ENCRYPT) {
-                memcpy_s(stc->pt, ACVP_SYM_PT_BYTE_MAX, ctext[j - 1], stc->ct_len);
-                memcpy_s(stc->iv, ACVP_SYM_IV_BYTE_MAX, ctext[j], stc->ct_len);
+                memcpy_s(stc->pt, stc->pt_alloc, MCT_BLK(st->ctext, j - 1), stc->ct_len);
+                memcpy_s(stc->iv, ACVP_SYM_IV_BYTE_MAX, MCT_BLK(st->ctext, j), stc->ct_len);
             } else {
-                memcpy_s(stc->ct, ACVP_SYM_CT_BYTE_MAX, ptext[j - 1], stc->pt_len);
-                memcpy_s(stc->iv, ACVP_SYM_IV_BYTE_MAX, ptext[j], stc->pt_len);
+                memcpy_s(stc->ct, stc->ct_alloc, MCT_BLK(st->ptext, j - 1), stc->pt_len);
+                memcpy_s(stc->iv, ACVP_SYM_IV_BYTE_MAX, MCT_BLK(st->ptext, j), stc->pt_len);
             }
         }
         break;
     case ACVP_SUB_AES_CFB8:
         if (stc->direction == ACVP_SYM_CIPH_DIR_ENCRYPT) {
             if (j < 16) {
-                memcpy_s(stc->pt, ACVP_SYM_PT_BYTE_MAX, &stc->iv[j], stc->iv_len);
+                memcpy_s(stc->pt, stc->pt_alloc, &stc->iv[j], stc->iv_len);
             } else {
-                memcpy_s(stc->pt, ACVP_SYM_PT_BYTE_MAX, ctext[j - 16], stc->ct_len);
+                stc->pt[0] = MCT_BYTE(st->cbyte, j - 16);
             }
         } else {
             if (j < 16) {
-                memcpy_s(stc->ct, ACVP_SYM_CT_BYTE_MAX, &stc->iv[j], stc->iv_len);
+                memcpy_s(stc->ct, stc->ct_alloc, &stc->iv[j], stc->iv_len);
             } else {
-                memcpy_s(stc->ct, ACVP_SYM_CT_BYTE_MAX, ptext[j - 16], stc->pt_len);
+                stc->ct[0] = MCT_BYTE(st->pbyte, j - 16);
             }
         }
         break;
     case ACVP_SUB_AES_CFB1:
-        if (stc->direction == ACVP_SYM_CIPH_DIR_ENCRYPT) {
-            if (j < 128) {
-                sb(ptext[j + 1], 0, gb(miv[i], j));
-            } else {
-                sb(ptext[j + 1], 0, gb(ctext[j - 128], 0));
-            }
-            stc->pt[0] = ptext[j + 1][0];
-        } else {
-            if (j < 128) {
-                sb(ctext[j + 1], 0, gb(miv[i], j));
-            } else {
-                sb(ctext[j + 1], 0, gb(ptext[j - 128], 0));
-            }
-            stc->ct[0] = ctext[j + 1][0];
-        }
-        break;
     case ACVP_SUB_AES_CBC_CS1:
     case ACVP_SUB_AES_CBC_CS2:
     case ACVP_SUB_AES_CBC_CS3:
@@ -175,21 +231,69 @@ static ACVP_RESULT acvp_aes_mct_iterate_tc(ACVP_CTX *ctx, ACVP_SYM_CIPHER_TC *st
     return ACVP_SUCCESS;
 }
 
+/*
+ * Runs one inner loop through the module's MCT handler, then replays the
+ * outputs it returned through acvp_aes_mct_iterate_tc() so the chaining values
+ * end up exactly as they would after one crypto_handler call per operation.
+ */
+static ACVP_RESULT acvp_aes_mct_module_loop(ACVP_CTX *ctx,
+                                            ACVP_CAPS_LIST *cap,
+                                            ACVP_TEST_CASE *tc,
+                                            ACVP_SYM_CIPHER_TC *stc,
+                                            ACVP_AES_MCT_STATE *st) {
+    unsigned int j = 0, out_len = 0;
+    unsigned char *out = NULL;
+    ACVP_RESULT rv = ACVP_SUCCESS;
+
+    if (!stc->mct_out) {
+        return ACVP_MISSING_ARG;
+    }
+    out_len = (stc->cipher == ACVP_AES_CFB1 || stc->cipher == ACVP_AES_CFB8) ? 1 : MCT_OUT_LEN;
+
+    stc->mct_index = 0;
+    stc->mct_count = ACVP_AES_MCT_INNER;
+    stc->mct_out_len = 0;
+    if (acvp_invoke_mct_handler(ctx, cap, tc)) {
+        ACVP_LOG_ERR("crypto module failed the operation");
+        return ACVP_CRYPTO_MODULE_FAIL;
+    }
+    if (stc->mct_out_len != out_len) {
+        ACVP_LOG_ERR("MCT handler returned %u byte outputs, expected %u", stc->mct_out_len, out_len);
+        return ACVP_CRYPTO_MODULE_FAIL;
+    }
+
+    for (j = 0; j < ACVP_AES_MCT_INNER; ++j) {
+        out = stc->mct_out + (size_t)j * out_len;
+        stc->mct_index = j;
+        if (stc->direction == ACVP_SYM_CIPH_DIR_ENCRYPT) {
+            memcpy_s(stc->ct, stc->ct_alloc, out, out_len);
+            if (stc->cipher == ACVP_AES_CFB1) stc->ct[0] &= 0x80;
+            stc->ct_len = stc->pt_len;
+        } else {
+            memcpy_s(stc->pt, stc->pt_alloc, out, out_len);
+            if (stc->cipher == ACVP_AES_CFB1) stc->pt[0] &= 0x80;
+            stc->pt_len = stc->ct_len;
+        }
+        rv = acvp_aes_mct_iterate_tc(ctx, stc, st);
+        if (rv != ACVP_SUCCESS) {
+            ACVP_LOG_ERR("Failed the MCT iteration changes");
+            return rv;
+        }
+    }
+    return ACVP_SUCCESS;
+}
+
 /*
  * After the test case has been processed by the DUT, the results
  * need to be JSON formated to be included in the vector set results
  * file that will be uploaded to the server.  This routine handles
  * the JSON processing for a single test case for MCT.
+ *
+ * tmp is the caller's hex buffer of ACVP_SYM_CT_MAX + 1 bytes; it is reused
+ * for every outer iteration rather than allocated and cleared each time.
  */
-static ACVP_RESULT acvp_aes_output_mct_tc(ACVP_CTX *ctx, ACVP_SYM_CIPHER_TC *stc, JSON_Object *r_tobj) {
+static ACVP_RESULT acvp_aes_output_mct_tc(ACVP_CTX *ctx, ACVP_SYM_CIPHER_TC *stc, JSON_Object *r_tobj, char *tmp) {
     ACVP_RESULT rv = ACVP_SUCCESS;
-    char *tmp = NULL;
-
-    tmp = calloc(ACVP_SYM_CT_MAX + 1, sizeof(char));
-    if (!tmp) {
-        ACVP_LOG_ERR("Unable to malloc in acvp_aes_output_mct_tc");
-        return ACVP_MALLOC_FAIL;
-    }
 
     rv = acvp_bin_to_hexstr(stc->key, stc->key_len / 8, tmp, ACVP_SYM_CT_MAX);
     if (rv != ACVP_SUCCESS) {
@@ -199,7 +303,6 @@ static ACVP_RESULT acvp_aes_output_mct_tc(ACVP_CTX *ctx, ACVP_SYM_CIPHER_TC *stc
     json_object_set_string(r_tobj, "key", tmp);
 
     if (stc->cipher != ACVP_AES_ECB) {
-        memzero_s(tmp, ACVP_SYM_CT_MAX);
         rv = acvp_bin_to_hexstr(stc->iv, stc->iv_len, tmp, ACVP_SYM_CT_MAX);
         if (rv != ACVP_SUCCESS) {
             ACVP_LOG_ERR("hex conversion failure (iv)");
@@ -209,8 +312,6 @@ static ACVP_RESULT acvp_aes_output_mct_tc(ACVP_CTX *ctx, ACVP_SYM_CIPHER_TC *stc
     }
 
     if (stc->direction == ACVP_SYM_CIPH_DIR_ENCRYPT) {
-        memzero_s(tmp, ACVP_SYM_CT_MAX);
-
         if (stc->cipher == ACVP_AES_CFB1) {
             rv = acvp_bin_to_hexstr(stc->pt, 1, tmp, ACVP_SYM_PT_MAX);
             if (rv != ACVP_SUCCESS) {
@@ -226,7 +327,6 @@ static ACVP_RESULT acvp_aes_output_mct_tc(ACVP_CTX *ctx, ACVP_SYM_CIPHER_TC *stc
         }
         json_object_set_string(r_tobj, "pt", tmp);
     } else {
-        memzero_s(tmp, ACVP_SYM_CT_MAX);
         if (stc->cipher == ACVP_AES_CFB1) {
             rv = acvp_bin_to_hexstr(stc->ct, 1, tmp, ACVP_SYM_CT_MAX);
             if (rv != ACVP_SUCCESS) {
@@ -244,8 +344,6 @@ static ACVP_RESULT acvp_aes_output_mct_tc(ACVP_CTX *ctx, ACVP_SYM_CIPHER_TC *stc
     }
 
 end:
-    if (tmp) free(tmp);
-
     return rv;
 }
 
@@ -267,6 +365,7 @@ static ACVP_RESULT acvp_aes_mct_tc(ACVP_CTX *ctx,
     char *tmp = NULL;
 #define MCT_CT_LEN 68 /* 64 + 4 */
     unsigned char ciphertext[MCT_CT_LEN] = { 0 };
+    ACVP_AES_MCT_STATE st;
 
     tmp = calloc(ACVP_SYM_CT_MAX + 1, sizeof(char));
     if (!tmp) {
@@ -274,8 +373,10 @@ static ACVP_RESULT acvp_aes_mct_tc(ACVP_CTX *ctx,
         return ACVP_MALLOC_FAIL;
     }
 
-    memcpy_s(miv[0], IV_ROW_LEN, stc->iv, stc->iv_len);
+    memzero_s(&st, sizeof(st));
     for (i = 0; i < ACVP_AES_MCT_OUTER; ++i) {
+        memcpy_s(st.iv, IV_ROW_LEN, stc->iv, stc->iv_len);
+
         /*
          * Create a new test case in the response
          */
@@ -285,7 +386,7 @@ static ACVP_RESULT acvp_aes_mct_tc(ACVP_CTX *ctx,
         /*
          * Output the test case request values using JSON
          */
-        rv = acvp_aes_output_mct_tc(ctx, stc, r_tobj);
+        rv = acvp_aes_output_mct_tc(ctx, stc, r_tobj, tmp);
         if (rv != ACVP_SUCCESS) {
             ACVP_LOG_ERR("JSON output failure in AES module");
             json_value_free(r_tval);
@@ -293,30 +394,38 @@ static ACVP_RESULT acvp_aes_mct_tc(ACVP_CTX *ctx,
             return rv;
         }
 
-        for (j = 0; j < ACVP_AES_MCT_INNER; ++j) {
-            stc->mct_index = j;    /* indicates init vs. update */
-            /* Process the current AES encrypt test vector... */
-            if ((cap->crypto_handler)(tc)) {
-                ACVP_LOG_ERR("crypto module failed the operation");
+        if (cap->mct_handler) {
+            rv = acvp_aes_mct_module_loop(ctx, cap, tc, stc, &st);
+            if (rv != ACVP_SUCCESS) {
                 free(tmp);
                 json_value_free(r_tval);
-                return ACVP_CRYPTO_MODULE_FAIL;
+                return rv;
             }
+        } else {
+            for (j = 0; j < ACVP_AES_MCT_INNER; ++j) {
+                stc->mct_index = j;    /* indicates init vs. update */
+                /* Process the current AES encrypt test vector... */
+                if (acvp_invoke_crypto_handler(ctx, cap, tc)) {
+                    ACVP_LOG_ERR("crypto module failed the operation");
+                    free(tmp);
+                    json_value_free(r_tval);
+                    return ACVP_CRYPTO_MODULE_FAIL;
+                }
 
-            /*
-             * Adjust the parameters for next iteration if needed.
-             */
-            rv = acvp_aes_mct_iterate_tc(ctx, stc, i);
-            if (rv != ACVP_SUCCESS) {
-                ACVP_LOG_ERR("Failed the MCT iteration changes");
-                free(tmp);
-                return rv;
+                /*
+                 * Adjust the parameters for next iteration if needed.
+                 */
+                rv = acvp_aes_mct_iterate_tc(ctx, stc, &st);
+                if (rv != ACVP_SUCCESS) {
+                    ACVP_LOG_ERR("Failed the MCT iteration changes");
+                    free(tmp);
+                    return rv;
+                }
             }
         }
 
         j = 999;
         if (stc->direction == ACVP_SYM_CIPH_DIR_ENCRYPT) {
-            memzero_s(tmp, ACVP_SYM_CT_MAX);
             if (stc->cipher == ACVP_AES_CFB1) {
                 rv = acvp_bin_to_hexstr(stc->ct, 1, tmp, ACVP_SYM_CT_MAX);
                 if (rv != ACVP_SUCCESS) {
@@ -337,37 +446,29 @@ static ACVP_RESULT acvp_aes_mct_tc(ACVP_CTX *ctx,
             if (stc->cipher == ACVP_AES_CFB8) {
                 /* ct = CT[j-15] || CT[j-14] || ... || CT[j] */
                 for (n1 = 0, n2 = stc->key_len / 8 - 1; n1 < stc->key_len / 8; ++n1, --n2) {
-                    ciphertext[n1] = ctext[j - n2][0];
+                    ciphertext[n1] = MCT_BYTE(st.cbyte, j - n2);
                 }
 
                 /* IV[i+1] = ct */
                 for (n1 = 0, n2 = 15; n1 < 16; ++n1, --n2) {
-                    stc->iv[n1] = ctext[j - n2][0];
+                    stc->iv[n1] = MCT_BYTE(st.cbyte, j - n2);
                 }
-                ptext[0][0] = ctext[j - 16][0];
             } else if (stc->cipher == ACVP_AES_CFB1) {
-                for (n1 = 0, n2 = stc->key_len - 1; n1 < stc->key_len; ++n1, --n2) {
-                    sb(ciphertext, n1, gb(ctext[j - n2], 0));
-                }
-
-                for (n1 = 0, n2 = 127; n1 < 128; ++n1, --n2) {
-                    sb(miv[i + 1], n1, gb(ctext[j - n2], 0));
-                }
-                ptext[0][0] = ctext[j - 128][0] & 0x80;
-                stc->pt[0] = ptext[0][0];
-                memcpy_s(stc->iv, ACVP_SYM_IV_BYTE_MAX, miv[i + 1], stc->iv_len);
+                /* key ^= CT[j-keylen+1] || ... || CT[j], IV[i+1] = the last 128 of them, PT[0] = CT[j-128] */
+                acvp_aes_cfb1_tail(&st, ciphertext, stc->key_len / 8);
+                acvp_aes_cfb1_tail(&st, stc->iv, IV_ROW_LEN);
             } else {
                 switch (stc->key_len) {
                 case 128:
-                    memcpy_s(ciphertext, MCT_CT_LEN, ctext[j], 16);
+                    memcpy_s(ciphertext, MCT_CT_LEN, MCT_BLK(st.ctext, j), 16);
                     break;
                 case 192:
-                    memcpy_s(ciphertext, MCT_CT_LEN, ctext[j - 1] + 8, 8);
-                    memcpy_s(ciphertext + 8, (MCT_CT_LEN - 8), ctext[j], 16);
+                    memcpy_s(ciphertext, MCT_CT_LEN, MCT_BLK(st.ctext, j - 1) + 8, 8);
+                    memcpy_s(ciphertext + 8, (MCT_CT_LEN - 8), MCT_BLK(st.ctext, j), 16);
                     break;
                 case 256:
-                    memcpy_s(ciphertext, MCT_CT_LEN, ctext[j - 1], 16);
-                    memcpy_s(ciphertext + 16, (MCT_CT_LEN - 16), ctext[j], 16);
+                    memcpy_s(ciphertext, MCT_CT_LEN, MCT_BLK(st.ctext, j - 1), 16);
+                    memcpy_s(ciphertext + 16, (MCT_CT_LEN - 16), MCT_BLK(st.ctext, j), 16);
                     break;
                 default:
                     ACVP_LOG_ERR("Illegal case switch %d", stc->key_len);
@@ -375,8 +476,6 @@ static ACVP_RESULT acvp_aes_mct_tc(ACVP_CTX *ctx,
                 }
             }
         } else {
-            memzero_s(tmp, ACVP_SYM_CT_MAX);
-
             if (stc->cipher == ACVP_AES_CFB1) {
                 rv = acvp_bin_to_hexstr(stc->pt, 1, tmp, ACVP_SYM_PT_MAX);
                 if (rv != ACVP_SUCCESS) {
@@ -399,36 +498,28 @@ static ACVP_RESULT acvp_aes_mct_tc(ACVP_CTX *ctx,
             if (stc->cipher == ACVP_AES_CFB8) {
                 /* ct = CT[j-15] || CT[j-14] || ... || CT[j] */
                 for (n1 = 0, n2 = stc->key_len / 8 - 1; n1 < stc->key_len / 8; ++n1, --n2) {
-                    ciphertext[n1] = ptext[j - n2][0];
+                    ciphertext[n1] = MCT_BYTE(st.pbyte, j - n2);
                 }
 
                 for (n1 = 0, n2 = 15; n1 < 16; ++n1, --n2) {
-                    stc->iv[n1] = ptext[j - n2][0];
+                    stc->iv[n1] = MCT_BYTE(st.pbyte, j - n2);
                 }
-                ctext[0][0] = ptext[j - 16][0];
             } else if (stc->cipher == ACVP_AES_CFB1) {
-                for (n1 = 0, n2 = stc->key_len - 1; n1 < stc->key_len; ++n1, --n2) {
-                    sb(ciphertext, n1, gb(ptext[j - n2], 0));
-                }
-
-                for (n1 = 0, n2 = 127; n1 < 128; ++n1, --n2) {
-                    sb(miv[i + 1], n1, gb(ptext[j - n2], 0));
-                }
-                ctext[0][0] = ptext[j - 128][0] & 0x80;
-                stc->ct[0] = ctext[0][0];
-                memcpy_s(stc->iv, ACVP_SYM_IV_BYTE_MAX, miv[i + 1], stc->iv_len);
+                /* key ^= PT[j-keylen+1] || ... || PT[j], IV[i+1] = the last 128 of them, CT[0] = PT[j-128] */
+                acvp_aes_cfb1_tail(&st, ciphertext, stc->key_len / 8);
+                acvp_aes_cfb1_tail(&st, stc->iv, IV_ROW_LEN);
             } else {
                 switch (stc->key_len) {
                 case 128:
-                    memcpy_s(ciphertext, MCT_CT_LEN, ptext[j], 16);
+                    memcpy_s(ciphertext, MCT_CT_LEN, MCT_BLK(st.ptext, j), 16);
                     break;
                 case 192:
-                    memcpy_s(ciphertext, MCT_CT_LEN, ptext[j - 1] + 8, 8);
-                    memcpy_s(ciphertext + 8, (MCT_CT_LEN - 8), ptext[j], 16);
+                    memcpy_s(ciphertext, MCT_CT_LEN, MCT_BLK(st.ptext, j - 1) + 8, 8);
+                    memcpy_s(ciphertext + 8, (MCT_CT_LEN - 8), MCT_BLK(st.ptext, j), 16);
                     break;
                 case 256:
-                    memcpy_s(ciphertext, MCT_CT_LEN, ptext[j - 1], 16);
-                    memcpy_s(ciphertext + 16, (MCT_CT_LEN - 16), ptext[j], 16);
+                    memcpy_s(ciphertext, MCT_CT_LEN, MCT_BLK(st.ptext, j - 1), 16);
+                    memcpy_s(ciphertext + 16, (MCT_CT_LEN - 16), MCT_BLK(st.ptext, j), 16);
                     break;
                 default:
                     ACVP_LOG_ERR("Illegal case switch %d", stc->key_len);
@@ -439,7 +530,7 @@ static ACVP_RESULT acvp_aes_mct_tc(ACVP_CTX *ctx,
 
         /* create the key for the next loop */
         for (n = 0; n < stc->key_len / 8; ++n) {
-            stc->key[n] = mkey[0][n] ^ ciphertext[n];
+            stc->key[n] = st.key[n] ^ ciphertext[n];
         }
 
         /* Append the test response value to array */
@@ -614,6 +705,102 @@ static ACVP_SYM_CIPH_DIR read_direction(const char *str) {
     return 0;
 }
 
+/*
+ * Modes whose crypto_handler returns nonzero for a decryption that does not
+ * authenticate, which is a test result rather than a module failure.
+ */
+static int acvp_aes_fail_is_result(ACVP_CIPHER alg_id) {
+    return alg_id == ACVP_AES_KW || alg_id == ACVP_AES_GCM ||
+           alg_id == ACVP_AES_GCM_SIV || alg_id == ACVP_AES_CCM ||
+           alg_id == ACVP_AES_KWP || alg_id == ACVP_AES_GMAC;
+}
+
+/*
+ * An AFT test case waiting to be handed to the batch handler, with the
+ * response object it will be written to. Its buffers are in the batch's
+ * scratch area.
+ */
+typedef struct acvp_aes_pending_t {
+    ACVP_SYM_CIPHER_TC stc;
+    JSON_Value *r_tval;
+} ACVP_AES_PENDING;
+
+/*
+ * Hands count pending AFT test cases to the batch handler in one call and
+ * writes their responses, in the server's order. Every pending test case is
+ * released, and its response either appended to r_tarr or freed.
+ */
+static ACVP_RESULT acvp_aes_run_batch(ACVP_CTX *ctx,
+                                      ACVP_CAPS_LIST *cap,
+                                      ACVP_CIPHER alg_id,
+                                      ACVP_AES_PENDING *pending,
+                                      unsigned int count,
+                                      JSON_Array *r_tarr) {
+    ACVP_RESULT rv = ACVP_SUCCESS;
+    ACVP_TEST_CASE tcs[ACVP_SYM_BATCH_MAX];
+    unsigned int i = 0;
+
+    for (i = 0; i < count; i++) {
+        tcs[i].tc.symmetric = &pending[i].stc;
+    }
+    i = 0;
+    if (acvp_invoke_batch_handler(ctx, cap, tcs, count)) {
+        ACVP_LOG_ERR("crypto module failed a batch of %u test cases", count);
+        rv = ACVP_CRYPTO_MODULE_FAIL;
+        goto end;
+    }
+
+    for (i = 0; i < count; i++) {
+        if (pending[i].stc.batch_rv && !acvp_aes_fail_is_result(alg_id)) {
+            ACVP_LOG_ERR("ERROR: crypto module failed the operation (tcId %u)", pending[i].stc.tc_id);
+            rv = ACVP_CRYPTO_MODULE_FAIL;
+            goto end;
+        }
+        rv = acvp_aes_output_tc(ctx, &pending[i].stc, json_value_get_object(pending[i].r_tval),
+                                pending[i].stc.batch_rv);
+        if (rv != ACVP_SUCCESS) {
+            ACVP_LOG_ERR("JSON output failure in AES module");
+            goto end;
+        }
+        acvp_aes_release_tc(&pending[i].stc);
+        json_array_append_value(r_tarr, pending[i].r_tval);
+        pending[i].r_tval = NULL;
+        acvp_progress_tc_done(ctx);
+    }
+
+end:
+    for (; i < count; i++) {
+        acvp_aes_release_tc(&pending[i].stc);
+        json_value_free(pending[i].r_tval);
+        pending[i].r_tval = NULL;
+    }
+    return rv;
+}
+
+/*
+ * An MCT test case set aside to run on the worker pool (acvp_mct_pool.c),
+ * with its own scratch area and the response array it fills in.
+ */
+typedef struct acvp_aes_mct_job_t {
+    ACVP_CAPS_LIST *cap;
+    ACVP_SYM_CIPHER_TC stc;
+    ACVP_SCRATCH scratch;
+    JSON_Array *res_tarr;
+} ACVP_AES_MCT_JOB;
+
+static ACVP_RESULT acvp_aes_mct_job(ACVP_CTX *ctx, void *arg) {
+    ACVP_AES_MCT_JOB *job = arg;
+    ACVP_TEST_CASE tc;
+    ACVP_RESULT rv = ACVP_SUCCESS;
+
+    tc.tc.symmetric = &job->stc;
+    rv = acvp_aes_mct_tc(ctx, job->cap, &tc, &job->stc, job->res_tarr);
+    if (rv != ACVP_SUCCESS) {
+        ACVP_LOG_ERR("crypto module failed the MCT operation (tcId %u)", job->stc.tc_id);
+    }
+    return rv;
+}
+
 /*
  * This is the handler for AES KAT values.  This will parse
  * a JSON encoded vector set for AES.  Each test case is
@@ -635,6 +822,7 @@ ACVP_RESULT acvp_aes_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
     int i, g_cnt;
     int j, t_cnt;
     int readIv = 0;
+    int batch = 0;
     JSON_Value *r_vs_val = NULL;
     JSON_Object *r_vs = NULL;
     JSON_Array *r_tarr = NULL, *r_garr = NULL;  /* Response testarray, grouparray */
@@ -643,9 +831,17 @@ ACVP_RESULT acvp_aes_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
     JSON_Object *r_tobj = NULL, *r_gobj = NULL; /* Response testobj, groupobj */
     ACVP_CAPS_LIST *cap;
     ACVP_SYM_CIPHER_TC stc;
+    ACVP_SCRATCH scratch = { 0 };
+    ACVP_SCRATCH bscratch = { 0 };     /* shared by the test cases of one batch */
+    ACVP_AES_PENDING *pending = NULL;  /* AFT test cases waiting for the batch handler */
+    unsigned int pend_cnt = 0;
+    ACVP_MCT_JOBS mct_jobs = { NULL, sizeof(ACVP_AES_MCT_JOB), 0, 0 };
+    ACVP_AES_MCT_JOB *job = NULL;
+    ACVP_SCRATCH *tc_scratch = NULL;
+    int mct_pool = 0;
+    unsigned int k = 0;
     ACVP_TEST_CASE tc;
     ACVP_RESULT rv;
-    char *json_result = NULL;
     const char *alg_str = NULL;
     const char *tw_mode = NULL;
     ACVP_CIPHER alg_id = 0;
@@ -686,6 +882,9 @@ ACVP_RESULT acvp_aes_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
     /* Determine if a specific conformance is being tested so we can make the test case aware */
     conformance = cap->cap.sym_cap->conformance;
 
+    /* The per-operation handler is called in chained order, so only an MCT handler can go wide */
+    mct_pool = ctx->mct_threads > 1 && cap->mct_handler;
+
     /* Create ACVP array for response */
     rv = acvp_create_array(&reg_obj, &reg_arry_val, &reg_arry);
     if (rv != ACVP_SUCCESS) {
@@ -971,6 +1170,17 @@ ACVP_RESULT acvp_aes_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
         tests = json_object_get_array(groupobj, "tests");
         t_cnt = json_array_get_count(tests);
 
+        batch = test_type == ACVP_SYM_TEST_TYPE_AFT && cap->batch_handler && t_cnt > 0;
+        if (batch && !pending) {
+            pending = calloc(ACVP_SYM_BATCH_MAX, sizeof(ACVP_AES_PENDING));
+            if (!pending) {
+                ACVP_LOG_ERR("Unable to malloc AES batch");
+                rv = ACVP_MALLOC_FAIL;
+                goto err;
+            }
+            bscratch.batch_min = ACVP_SYM_BATCH_SCRATCH;
+        }
+
         for (j = 0; j < t_cnt; j++) {
             const char *pt = NULL, *ct = NULL, *iv = NULL,
                        *key = NULL, *tag = NULL, *aad = NULL, *salt = NULL;
@@ -1203,16 +1413,71 @@ ACVP_RESULT acvp_aes_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
              * Setup the test case data that will be passed down to
              * the crypto module.
              */
-            rv = acvp_aes_init_tc(ctx, &stc, tc_id, test_type, key, pt, ct, iv, tag, 
-                                  aad, salt, kwcipher, keylen, ivlen, datalen, paylen,
-                                  taglen, aadlen, saltLen, dataUnitLen, conformance, alg_id, dir, iv_gen,
-                                  iv_gen_mode, incr_ctr, ovrflw_ctr, tweak_mode, seq_num, salt_src);
+            job = NULL;
+            tc_scratch = batch ? &bscratch : &scratch;
+            if (mct_pool && test_type == ACVP_SYM_TEST_TYPE_MCT) {
+                job = acvp_mct_jobs_next(&mct_jobs);
+                if (!job) {
+                    ACVP_LOG_ERR("Unable to malloc AES MCT job");
+                    json_value_free(r_tval);
+                    rv = ACVP_MALLOC_FAIL;
+                    goto err;
+                }
+                tc_scratch = &job->scratch;
+            }
+            for (;;) {
+                rv = acvp_aes_init_tc(ctx, &stc, tc_scratch, tc_id, test_type,
+                                      key, pt, ct, iv, tag, aad, salt, kwcipher, keylen, ivlen,
+                                      datalen, paylen, taglen, aadlen, saltLen, dataUnitLen,
+                                      conformance, alg_id, dir, iv_gen, iv_gen_mode, incr_ctr,
+                                      ovrflw_ctr, tweak_mode, seq_num, salt_src);
+                if (rv != ACVP_DATA_TOO_LARGE || !pend_cnt) {
+                    break;
+                }
+                /* The batch's buffers are full; run it and start the next one */
+                rv = acvp_aes_run_batch(ctx, cap, alg_id, pending, pend_cnt, r_tarr);
+                pend_cnt = 0;
+                acvp_scratch_reset(&bscratch);
+                if (rv != ACVP_SUCCESS) {
+                    json_value_free(r_tval);
+                    goto err;
+                }
+            }
             if (rv != ACVP_SUCCESS) {
                 ACVP_LOG_ERR("Init for stc (test case) failed");
                 acvp_aes_release_tc(&stc);
+                if (job) {
+                    acvp_scratch_free(&job->scratch);
+                }
                 goto err;
             }
 
+            if (batch) {
+                pending[pend_cnt].stc = stc;
+                pending[pend_cnt].r_tval = r_tval;
+                pend_cnt++;
+                if (pend_cnt == ACVP_SYM_BATCH_MAX) {
+                    rv = acvp_aes_run_batch(ctx, cap, alg_id, pending, pend_cnt, r_tarr);
+                    pend_cnt = 0;
+                    acvp_scratch_reset(&bscratch);
+                    if (rv != ACVP_SUCCESS) {
+                        goto err;
+                    }
+                }
+                continue;
+            }
+
+            if (job) {
+                /* Run with the others once the whole vector set is read; the response keeps its place */
+                json_object_set_value(r_tobj, "resultsArray", json_value_init_array());
+                job->cap = cap;
+                job->stc = stc;
+                job->res_tarr = json_object_get_array(r_tobj, "resultsArray");
+                mct_jobs.count++;
+                json_array_append_value(r_tarr, r_tval);
+                continue;
+            }
+
             /* If Monte Carlo start that here */
             if (stc.test_type == ACVP_SYM_TEST_TYPE_MCT) {
                 json_object_set_value(r_tobj, "resultsArray", json_value_init_array());
@@ -1226,11 +1491,9 @@ ACVP_RESULT acvp_aes_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
                 }
             } else {
                 /* Process the current AES KAT test vector... */
-                int t_rv = (cap->crypto_handler)(&tc);
+                int t_rv = acvp_invoke_crypto_handler(ctx, cap, &tc);
                 if (t_rv) {
-                    if (alg_id != ACVP_AES_KW && alg_id != ACVP_AES_GCM &&
-                            alg_id != ACVP_AES_GCM_SIV && alg_id != ACVP_AES_CCM 
-                            && alg_id != ACVP_AES_KWP && alg_id != ACVP_AES_GMAC) {
+                    if (!acvp_aes_fail_is_result(alg_id)) {
                         ACVP_LOG_ERR("ERROR: crypto module failed the operation");
                         acvp_aes_release_tc(&stc);
                         json_value_free(r_tval);
@@ -1258,20 +1521,54 @@ ACVP_RESULT acvp_aes_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
 
             /* Append the test response value to array */
             json_array_append_value(r_tarr, r_tval);
+            acvp_progress_tc_done(ctx);
+        }
+        if (pend_cnt) {
+            rv = acvp_aes_run_batch(ctx, cap, alg_id, pending, pend_cnt, r_tarr);
+            pend_cnt = 0;
+            acvp_scratch_reset(&bscratch);
+            if (rv != ACVP_SUCCESS) {
+                goto err;
+            }
         }
         json_array_append_value(r_garr, r_gval);
     }
+    r_gval = NULL;
+
+    if (mct_jobs.count) {
+        rv = acvp_mct_jobs_run(ctx, cap, &mct_jobs, acvp_aes_mct_job);
+        if (rv != ACVP_SUCCESS) {
+            goto err;
+        }
+        for (k = 0; k < mct_jobs.count; k++) {
+            acvp_progress_tc_done(ctx);
+        }
+    }
     json_array_append_value(reg_arry, r_vs_val);
     rv = ACVP_SUCCESS;
 
-    json_result = json_serialize_to_string_pretty(ctx->kat_resp, NULL);
-    ACVP_LOG_VERBOSE("\n\n%s\n\n", json_result);
-    json_free_serialized_string(json_result);
+    ACVP_LOG_VERBOSE_JSON(ctx->kat_resp);
 
 err:
+    for (k = 0; k < mct_jobs.count; k++) {
+        job = (ACVP_AES_MCT_JOB *)mct_jobs.jobs + k;
+        acvp_aes_release_tc(&job->stc);
+        acvp_scratch_free(&job->scratch);
+    }
+    acvp_mct_jobs_free(&mct_jobs);
+    if (pending) {
+        while (pend_cnt) {
+            pend_cnt--;
+            acvp_aes_release_tc(&pending[pend_cnt].stc);
+            json_value_free(pending[pend_cnt].r_tval);
+        }
+        free(pending);
+    }
     if (rv != ACVP_SUCCESS) {
         acvp_release_json(r_vs_val, r_gval);
     }
+    acvp_scratch_free(&scratch);
+    acvp_scratch_free(&bscratch);
     return rv;
 }
 
@@ -1395,6 +1692,7 @@ err:
  */
 static ACVP_RESULT acvp_aes_init_tc(ACVP_CTX *ctx,
                                     ACVP_SYM_CIPHER_TC *stc,
+                                    ACVP_SCRATCH *scratch,
                                     unsigned int tc_id,
                                     ACVP_SYM_CIPH_TESTTYPE test_type,
                                     const char *j_key,
@@ -1425,23 +1723,50 @@ static ACVP_RESULT acvp_aes_init_tc(ACVP_CTX *ctx,
                                     ACVP_SYM_CIPH_SALT_SRC salt_src) {
 
     ACVP_RESULT rv;
+    size_t data_max = 0, aad_max = 0, len = 0;
 
     memzero_s(stc, sizeof(ACVP_SYM_CIPHER_TC));
 
-    stc->key = calloc(ACVP_SYM_KEY_MAX_BYTES, 1);
-    if (!stc->key) { return ACVP_MALLOC_FAIL; }
-    stc->pt = calloc( ACVP_SYM_PT_BYTE_MAX, 1);
-    if (!stc->pt) { return ACVP_MALLOC_FAIL; }
-    stc->ct = calloc(ACVP_SYM_CT_BYTE_MAX, 1);
-    if (!stc->ct) { return ACVP_MALLOC_FAIL; }
-    stc->tag = calloc(ACVP_SYM_TAG_BYTE_MAX, 1);
-    if (!stc->tag) { return ACVP_MALLOC_FAIL; }
-    stc->iv = calloc(ACVP_SYM_IV_BYTE_MAX, 1);
-    if (!stc->iv) { return ACVP_MALLOC_FAIL; }
-    stc->aad = calloc(ACVP_SYM_AAD_BYTE_MAX, 1);
-    if (!stc->aad) { return ACVP_MALLOC_FAIL; }
-    stc->salt = calloc(ACVP_AES_XPN_SALTLEN, 1);
-    if (!stc->salt) { return ACVP_MALLOC_FAIL; }
+    /*
+     * The module writes its output into pt or ct, so both are sized for the
+     * larger of the two inputs plus room for padding, tags and key wrap
+     * overhead. The other buffers are small enough to always get their maximum.
+     */
+    if (j_pt) data_max = strnlen_s(j_pt, ACVP_SYM_PT_MAX + 1) / 2;
+    if (j_ct) {
+        len = strnlen_s(j_ct, ACVP_SYM_CT_MAX + 1) / 2;
+        if (len > data_max) data_max = len;
+    }
+    len = ((size_t)pt_len + 7) / 8;
+    if (len > data_max) data_max = len;
+    len = ((size_t)data_len + 7) / 8;
+    if (len > data_max) data_max = len;
+    data_max += ACVP_AES_DATA_SLACK;
+    if (data_max > ACVP_SYM_PT_BYTE_MAX) data_max = ACVP_SYM_PT_BYTE_MAX;
+    if (j_aad) aad_max = strnlen_s(j_aad, ACVP_SYM_AAD_MAX + 1) / 2;
+
+    rv = acvp_scratch_reserve(scratch, acvp_scratch_round(ACVP_SYM_KEY_MAX_BYTES) +
+                                       2 * acvp_scratch_round(data_max) +
+                                       acvp_scratch_round(ACVP_SYM_TAG_BYTE_MAX) +
+                                       acvp_scratch_round(ACVP_SYM_IV_BYTE_MAX) +
+                                       acvp_scratch_round(aad_max) +
+                                       acvp_scratch_round(ACVP_AES_XPN_SALTLEN) +
+                                       (test_type == ACVP_SYM_TEST_TYPE_MCT ?
+                                        acvp_scratch_round(ACVP_AES_MCT_INNER * MCT_OUT_LEN) : 0));
+    if (rv != ACVP_SUCCESS) { return rv; }
+    stc->key = acvp_scratch_alloc(scratch, ACVP_SYM_KEY_MAX_BYTES);
+    stc->pt = acvp_scratch_alloc(scratch, data_max);
+    stc->ct = acvp_scratch_alloc(scratch, data_max);
+    stc->pt_alloc = (unsigned int)data_max;
+    stc->ct_alloc = (unsigned int)data_max;
+    stc->tag = acvp_scratch_alloc(scratch, ACVP_SYM_TAG_BYTE_MAX);
+    stc->iv = acvp_scratch_alloc(scratch, ACVP_SYM_IV_BYTE_MAX);
+    stc->aad = acvp_scratch_alloc(scratch, aad_max);
+    stc->salt = acvp_scratch_alloc(scratch, ACVP_AES_XPN_SALTLEN);
+    if (test_type == ACVP_SYM_TEST_TYPE_MCT) {
+        /* Only written to when the capability has an MCT inner loop handler */
+        stc->mct_out = acvp_scratch_alloc(scratch, ACVP_AES_MCT_INNER * MCT_OUT_LEN);
+    }
 
     /*
      * These lengths come in as bit lengths from the ACVP server.
@@ -1478,7 +1803,7 @@ static ACVP_RESULT acvp_aes_init_tc(ACVP_CTX *ctx,
 
     if (j_pt) {
         if (alg_id == ACVP_AES_CFB1) {
-            rv = acvp_hexstr_to_bin(j_pt, stc->pt, ACVP_SYM_PT_BYTE_MAX, NULL);
+            rv = acvp_hexstr_to_bin(j_pt, stc->pt, (int)stc->pt_alloc, NULL);
             if (rv != ACVP_SUCCESS) {
                 ACVP_LOG_ERR("Hex conversion failure (pt)");
                 return rv;
@@ -1486,7 +1811,7 @@ static ACVP_RESULT acvp_aes_init_tc(ACVP_CTX *ctx,
             stc->data_len = data_len;
             stc->pt_len = data_len;
         } else {
-            rv = acvp_hexstr_to_bin(j_pt, stc->pt, ACVP_SYM_PT_BYTE_MAX, NULL);
+            rv = acvp_hexstr_to_bin(j_pt, stc->pt, (int)stc->pt_alloc, NULL);
             if (rv != ACVP_SUCCESS) {
                 ACVP_LOG_ERR("Hex conversion failure (pt)");
                 return rv;
@@ -1501,7 +1826,7 @@ static ACVP_RESULT acvp_aes_init_tc(ACVP_CTX *ctx,
 
     if (j_ct) {
         if (alg_id == ACVP_AES_CFB1) {
-            rv = acvp_hexstr_to_bin(j_ct, stc->ct, ACVP_SYM_CT_BYTE_MAX, NULL);
+            rv = acvp_hexstr_to_bin(j_ct, stc->ct, (int)stc->ct_alloc, NULL);
             if (rv != ACVP_SUCCESS) {
                 ACVP_LOG_ERR("Hex conversion failure (ct)");
                 return rv;
@@ -1509,7 +1834,7 @@ static ACVP_RESULT acvp_aes_init_tc(ACVP_CTX *ctx,
             stc->data_len = data_len;
             stc->ct_len = data_len;
         } else {
-            rv = acvp_hexstr_to_bin(j_ct, stc->ct, ACVP_SYM_CT_BYTE_MAX, NULL);
+            rv = acvp_hexstr_to_bin(j_ct, stc->ct, (int)stc->ct_alloc, NULL);
             if (rv != ACVP_SUCCESS) {
                 ACVP_LOG_ERR("Hex conversion failure (ct)");
                 return rv;
@@ -1544,7 +1869,7 @@ static ACVP_RESULT acvp_aes_init_tc(ACVP_CTX *ctx,
     }
 
     if (j_aad) {
-        rv = acvp_hexstr_to_bin(j_aad, stc->aad, ACVP_SYM_AAD_BYTE_MAX, NULL);
+        rv = acvp_hexstr_to_bin(j_aad, stc->aad, (int)aad_max, NULL);
         if (rv != ACVP_SUCCESS) {
             ACVP_LOG_ERR("Hex conversion failure (aad)");
             return rv;
@@ -1567,13 +1892,7 @@ static ACVP_RESULT acvp_aes_init_tc(ACVP_CTX *ctx,
  * a test case.
  */
 static ACVP_RESULT acvp_aes_release_tc(ACVP_SYM_CIPHER_TC *stc) {
-    if (stc->key) free(stc->key);
-    if (stc->pt) free(stc->pt);
-    if (stc->ct) free(stc->ct);
-    if (stc->tag) free(stc->tag);
-    if (stc->iv) free(stc->iv);
-    if (stc->aad) free(stc->aad);
-    if (stc->salt) free(stc->salt);
+    /* The buffers belong to the handler's scratch area */
     memzero_s(stc, sizeof(ACVP_SYM_CIPHER_TC));
 
     return ACVP_SUCCESS;
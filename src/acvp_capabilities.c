@@ -2533,6 +2533,78 @@ ACVP_RESULT acvp_cap_sym_cipher_set_domain(ACVP_CTX *ctx,
     return ACVP_SUCCESS;
 }
 
+/*
+ * Registers a handler that runs a whole MCT inner loop in the module. Only
+ * modes whose chaining can be rebuilt from the outputs alone are accepted;
+ * TDES OFB and CFB1/CFB8 also need the module's IV after every operation.
+ */
+ACVP_RESULT acvp_cap_sym_cipher_set_mct_handler(ACVP_CTX *ctx,
+                                                ACVP_CIPHER cipher,
+                                                int (*mct_handler)(ACVP_TEST_CASE *test_case)) {
+    ACVP_CAPS_LIST *cap = NULL;
+
+    if (!ctx) {
+        return ACVP_NO_CTX;
+    }
+
+    switch (cipher) {
+    case ACVP_AES_ECB:
+    case ACVP_AES_CBC:
+    case ACVP_AES_OFB:
+    case ACVP_AES_CFB1:
+    case ACVP_AES_CFB8:
+    case ACVP_AES_CFB128:
+    case ACVP_TDES_ECB:
+    case ACVP_TDES_CBC:
+    case ACVP_TDES_CFB64:
+        break;
+    case ACVP_TDES_OFB:
+    case ACVP_TDES_CFB1:
+    case ACVP_TDES_CFB8:
+        ACVP_LOG_ERR("MCT inner loop handlers are not supported for this TDES mode");
+        return ACVP_UNSUPPORTED_OP;
+    default:
+        ACVP_LOG_ERR("MCT inner loop handlers are only supported for AES and TDES modes with Monte Carlo tests");
+        return ACVP_INVALID_ARG;
+    }
+
+    cap = acvp_locate_cap_entry(ctx, cipher);
+    if (!cap) {
+        ACVP_LOG_ERR("Cap entry not found, use acvp_enable_sym_cipher_cap() first.");
+        return ACVP_NO_CAP;
+    }
+    cap->mct_handler = mct_handler;
+    return ACVP_SUCCESS;
+}
+
+/*
+ * Has the AES AFT groups for cipher handed to the module a batch of test
+ * cases at a time.
+ */
+ACVP_RESULT acvp_cap_sym_cipher_set_batch_handler(ACVP_CTX *ctx,
+                                                  ACVP_CIPHER cipher,
+                                                  int (*batch_handler)(ACVP_TEST_CASE *test_cases,
+                                                                       unsigned int count)) {
+    ACVP_CAPS_LIST *cap = NULL;
+
+    if (!ctx) {
+        return ACVP_NO_CTX;
+    }
+
+    if (cipher < ACVP_AES_GCM || cipher > ACVP_AES_XPN) {
+        ACVP_LOG_ERR("Batch handlers are only supported for AES modes");
+        return ACVP_INVALID_ARG;
+    }
+
+    cap = acvp_locate_cap_entry(ctx, cipher);
+    if (!cap) {
+        ACVP_LOG_ERR("Cap entry not found, use acvp_enable_sym_cipher_cap() first.");
+        return ACVP_NO_CAP;
+    }
+    cap->batch_handler = batch_handler;
+    return ACVP_SUCCESS;
+}
+
 /*
  * The user should call this after invoking acvp_enable_sym_cipher_cap()
  * to specify the supported key lengths, direction, etc. This is called by the 
@@ -3304,6 +3376,145 @@ ACVP_RESULT acvp_cap_hash_set_domain(ACVP_CTX *ctx,
     return ACVP_SUCCESS;
 }
 
+/*
+ * Registers a handler that runs a whole hash MCT (every outer iteration) in
+ * the module and returns the checkpoint digests.
+ */
+ACVP_RESULT acvp_cap_hash_set_mct_handler(ACVP_CTX *ctx,
+                                          ACVP_CIPHER cipher,
+                                          int (*mct_handler)(ACVP_TEST_CASE *test_case)) {
+    ACVP_CAPS_LIST *cap = NULL;
+    ACVP_SUB_HASH alg;
+
+    if (!ctx) {
+        return ACVP_NO_CTX;
+    }
+
+    alg = acvp_get_hash_alg(cipher);
+    switch (alg) {
+    case ACVP_SUB_HASH_SHA3_224:
+    case ACVP_SUB_HASH_SHA3_256:
+    case ACVP_SUB_HASH_SHA3_384:
+    case ACVP_SUB_HASH_SHA3_512:
+    case ACVP_SUB_HASH_SHAKE_128:
+    case ACVP_SUB_HASH_SHAKE_256:
+    case ACVP_SUB_HASH_SHA1:
+    case ACVP_SUB_HASH_SHA2_224:
+    case ACVP_SUB_HASH_SHA2_256:
+    case ACVP_SUB_HASH_SHA2_384:
+    case ACVP_SUB_HASH_SHA2_512:
+    case ACVP_SUB_HASH_SHA2_512_224:
+    case ACVP_SUB_HASH_SHA2_512_256:
+        break;
+    default:
+        ACVP_LOG_ERR("Invalid cipher value");
+        return ACVP_INVALID_ARG;
+    }
+
+    cap = acvp_locate_cap_entry(ctx, cipher);
+    if (!cap) {
+        ACVP_LOG_ERR("Cap entry not found, use acvp_cap_hash_enable() first.");
+        return ACVP_NO_CAP;
+    }
+    cap->mct_handler = mct_handler;
+    return ACVP_SUCCESS;
+}
+
+/*
+ * Turns on streaming of large data tests to the module, chunk_len bytes of
+ * the expanded content at a time.
+ */
+ACVP_RESULT acvp_cap_hash_set_ldt_streaming(ACVP_CTX *ctx,
+                                            ACVP_CIPHER cipher,
+                                            unsigned int chunk_len) {
+    ACVP_CAPS_LIST *cap = NULL;
+    ACVP_SUB_HASH alg;
+
+    if (!ctx) {
+        return ACVP_NO_CTX;
+    }
+
+    alg = acvp_get_hash_alg(cipher);
+    switch (alg) {
+    case ACVP_SUB_HASH_SHA3_224:
+    case ACVP_SUB_HASH_SHA3_256:
+    case ACVP_SUB_HASH_SHA3_384:
+    case ACVP_SUB_HASH_SHA3_512:
+    case ACVP_SUB_HASH_SHA1:
+    case ACVP_SUB_HASH_SHA2_224:
+    case ACVP_SUB_HASH_SHA2_256:
+    case ACVP_SUB_HASH_SHA2_384:
+    case ACVP_SUB_HASH_SHA2_512:
+    case ACVP_SUB_HASH_SHA2_512_224:
+    case ACVP_SUB_HASH_SHA2_512_256:
+        break;
+    case ACVP_SUB_HASH_SHAKE_128:
+    case ACVP_SUB_HASH_SHAKE_256:
+    default:
+        ACVP_LOG_ERR("Large data tests are only defined for SHA-1, SHA-2 and SHA-3");
+        return ACVP_INVALID_ARG;
+    }
+
+    if (chunk_len > ACVP_HASH_LDT_CHUNK_MAX) {
+        ACVP_LOG_ERR("LDT chunk length (%u) larger than the maximum of %u bytes",
+                     chunk_len, ACVP_HASH_LDT_CHUNK_MAX);
+        return ACVP_INVALID_ARG;
+    }
+
+    cap = acvp_locate_cap_entry(ctx, cipher);
+    if (!cap || !cap->cap.hash_cap) {
+        ACVP_LOG_ERR("Cap entry not found, use acvp_cap_hash_enable() first.");
+        return ACVP_NO_CAP;
+    }
+    cap->cap.hash_cap->ldt_chunk_len = chunk_len;
+    return ACVP_SUCCESS;
+}
+
+/*
+ * Has the hash AFT groups for cipher handed to the module a batch of test
+ * cases at a time.
+ */
+ACVP_RESULT acvp_cap_hash_set_batch_handler(ACVP_CTX *ctx,
+                                            ACVP_CIPHER cipher,
+                                            int (*batch_handler)(ACVP_TEST_CASE *test_cases,
+                                                                 unsigned int count)) {
+    ACVP_CAPS_LIST *cap = NULL;
+    ACVP_SUB_HASH alg;
+
+    if (!ctx) {
+        return ACVP_NO_CTX;
+    }
+
+    alg = acvp_get_hash_alg(cipher);
+    switch (alg) {
+    case ACVP_SUB_HASH_SHA3_224:
+    case ACVP_SUB_HASH_SHA3_256:
+    case ACVP_SUB_HASH_SHA3_384:
+    case ACVP_SUB_HASH_SHA3_512:
+    case ACVP_SUB_HASH_SHAKE_128:
+    case ACVP_SUB_HASH_SHAKE_256:
+    case ACVP_SUB_HASH_SHA1:
+    case ACVP_SUB_HASH_SHA2_224:
+    case ACVP_SUB_HASH_SHA2_256:
+    case ACVP_SUB_HASH_SHA2_384:
+    case ACVP_SUB_HASH_SHA2_512:
+    case ACVP_SUB_HASH_SHA2_512_224:
+    case ACVP_SUB_HASH_SHA2_512_256:
+        break;
+    default:
+        ACVP_LOG_ERR("Invalid cipher value");
+        return ACVP_INVALID_ARG;
+    }
+
+    cap = acvp_locate_cap_entry(ctx, cipher);
+    if (!cap) {
+        ACVP_LOG_ERR("Cap entry not found, use acvp_cap_hash_enable() first.");
+        return ACVP_NO_CAP;
+    }
+    cap->batch_handler = batch_handler;
+    return ACVP_SUCCESS;
+}
+
 static ACVP_RESULT acvp_validate_hmac_parm_value(ACVP_CIPHER cipher,
                                                  ACVP_HMAC_PARM parm,
                                                  int value) {
@@ -3854,6 +4065,71 @@ ACVP_RESULT acvp_cap_kmac_set_domain(ACVP_CTX *ctx,
 
 }
 
+/*
+ * Has the test groups for an HMAC, CMAC or KMAC algorithm handed to the
+ * module a batch of test cases at a time.
+ */
+ACVP_RESULT acvp_cap_mac_set_batch_handler(ACVP_CTX *ctx,
+                                           ACVP_CIPHER cipher,
+                                           int (*batch_handler)(ACVP_TEST_CASE *test_cases,
+                                                                unsigned int count)) {
+    ACVP_CAPS_LIST *cap = NULL;
+
+    if (!ctx) {
+        return ACVP_NO_CTX;
+    }
+
+    cap = acvp_locate_cap_entry(ctx, cipher);
+    if (!cap) {
+        ACVP_LOG_ERR("Cap entry not found, enable the HMAC, CMAC or KMAC capability first.");
+        return ACVP_NO_CAP;
+    }
+    if (cap->cap_type != ACVP_HMAC_TYPE && cap->cap_type != ACVP_CMAC_TYPE &&
+            cap->cap_type != ACVP_KMAC_TYPE) {
+        ACVP_LOG_ERR("Batch handlers are only supported for HMAC, CMAC and KMAC here");
+        return ACVP_INVALID_ARG;
+    }
+    cap->batch_handler = batch_handler;
+    return ACVP_SUCCESS;
+}
+
+ACVP_RESULT acvp_cap_set_group_handler(ACVP_CTX *ctx,
+                                       ACVP_CIPHER cipher,
+                                       int (*group_handler)(ACVP_GROUP_EVENT event,
+                                                            ACVP_TEST_CASE *test_case)) {
+    ACVP_CAPS_LIST *cap = NULL;
+
+    if (!ctx) {
+        return ACVP_NO_CTX;
+    }
+
+    cap = acvp_locate_cap_entry(ctx, cipher);
+    if (!cap) {
+        ACVP_LOG_ERR("Cap entry not found, enable the capability first.");
+        return ACVP_NO_CAP;
+    }
+    switch (cap->cap_type) {
+    case ACVP_DSA_TYPE:
+    case ACVP_RSA_SIGGEN_TYPE:
+    case ACVP_RSA_SIGVER_TYPE:
+    case ACVP_ECDSA_KEYGEN_TYPE:
+    case ACVP_ECDSA_KEYVER_TYPE:
+    case ACVP_ECDSA_SIGGEN_TYPE:
+    case ACVP_ECDSA_SIGVER_TYPE:
+    case ACVP_DET_ECDSA_SIGGEN_TYPE:
+    case ACVP_EDDSA_KEYGEN_TYPE:
+    case ACVP_EDDSA_KEYVER_TYPE:
+    case ACVP_EDDSA_SIGGEN_TYPE:
+    case ACVP_EDDSA_SIGVER_TYPE:
+        break;
+    default:
+        ACVP_LOG_ERR("Group handlers are only supported for DSA, RSA signatures, ECDSA and EdDSA");
+        return ACVP_INVALID_ARG;
+    }
+    cap->group_handler = group_handler;
+    return ACVP_SUCCESS;
+}
+
 /*
  * Add DRBG Length Range
  */
@@ -19,6 +19,7 @@
 
 static ACVP_RESULT acvp_cmac_init_tc(ACVP_CTX *ctx,
                                      ACVP_CMAC_TC *stc,
+                                     ACVP_SCRATCH *scratch,
                                      unsigned int tc_id,
                                      ACVP_CMAC_TESTTYPE testtype,
                                      const char *msg,
@@ -31,6 +32,7 @@ static ACVP_RESULT acvp_cmac_init_tc(ACVP_CTX *ctx,
                                      unsigned int mac_len,
                                      ACVP_CIPHER alg_id) {
     ACVP_RESULT rv;
+    size_t msg_max = 0;
 
     if (!ctx) {
         return ACVP_NO_CTX;
@@ -52,14 +54,17 @@ static ACVP_RESULT acvp_cmac_init_tc(ACVP_CTX *ctx,
 
     memzero_s(stc, sizeof(ACVP_CMAC_TC));
 
-    stc->test_type = testtype;
-    stc->msg = calloc(ACVP_CMAC_MSGLEN_MAX_STR, sizeof(unsigned char));
-    if (!stc->msg) { return ACVP_MALLOC_FAIL; }
+    /* Room for the whole message; the other buffers are small enough to always get their maximum */
+    msg_max = strnlen_s(msg, ACVP_CMAC_MSGLEN_MAX_STR + 1) / 2;
+    rv = acvp_scratch_reserve(scratch, acvp_scratch_round(msg_max) +
+                                       acvp_scratch_round(ACVP_CMAC_MACLEN_MAX) +
+                                       3 * acvp_scratch_round(ACVP_CMAC_KEY_MAX));
+    if (rv != ACVP_SUCCESS) { return rv; }
 
-    stc->mac = calloc(ACVP_CMAC_MACLEN_MAX, sizeof(unsigned char));
-    if (!stc->mac) { return ACVP_MALLOC_FAIL; }
-    stc->key = calloc(1, ACVP_CMAC_KEY_MAX);
-    if (!stc->key) { return ACVP_MALLOC_FAIL; }
+    stc->test_type = testtype;
+    stc->msg = acvp_scratch_alloc(scratch, msg_max);
+    stc->mac = acvp_scratch_alloc(scratch, ACVP_CMAC_MACLEN_MAX);
+    stc->key = acvp_scratch_alloc(scratch, ACVP_CMAC_KEY_MAX);
     stc->mac_len = mac_len;
 
     if (direction_verify) {
@@ -70,12 +75,10 @@ static ACVP_RESULT acvp_cmac_init_tc(ACVP_CTX *ctx,
         }
     }
 
-    stc->key2 = calloc(1, ACVP_CMAC_KEY_MAX);
-    if (!stc->key2) { return ACVP_MALLOC_FAIL; }
-    stc->key3 = calloc(1, ACVP_CMAC_KEY_MAX);
-    if (!stc->key3) { return ACVP_MALLOC_FAIL; }
+    stc->key2 = acvp_scratch_alloc(scratch, ACVP_CMAC_KEY_MAX);
+    stc->key3 = acvp_scratch_alloc(scratch, ACVP_CMAC_KEY_MAX);
 
-    rv = acvp_hexstr_to_bin(msg, stc->msg, ACVP_CMAC_MSGLEN_MAX_STR, NULL);
+    rv = acvp_hexstr_to_bin(msg, stc->msg, (int)msg_max, NULL);
     if (rv != ACVP_SUCCESS) {
         ACVP_LOG_ERR("Hex converstion failure (msg)");
         return rv;
@@ -154,16 +157,66 @@ end:
  * a test case.
  */
 static ACVP_RESULT acvp_cmac_release_tc(ACVP_CMAC_TC *stc) {
-    if (stc->msg) free(stc->msg);
-    if (stc->mac) free(stc->mac);
-    if (stc->key) free(stc->key);
-    if (stc->key2) free(stc->key2);
-    if (stc->key3) free(stc->key3);
+    /* The buffers belong to the handler's scratch area */
     memzero_s(stc, sizeof(ACVP_CMAC_TC));
 
     return ACVP_SUCCESS;
 }
 
+/*
+ * A test case waiting to be handed to the batch handler, with the response
+ * object it will be written to. Its buffers are in the batch's scratch area.
+ */
+typedef struct acvp_cmac_pending_t {
+    ACVP_CMAC_TC stc;
+    JSON_Value *r_tval;
+} ACVP_CMAC_PENDING;
+
+/*
+ * Hands count pending test cases to the batch handler in one call and writes
+ * their responses, in the server's order. Every pending test case is
+ * released, and its response either appended to r_tarr or freed.
+ */
+static ACVP_RESULT acvp_cmac_run_batch(ACVP_CTX *ctx,
+                                       ACVP_CAPS_LIST *cap,
+                                       ACVP_CMAC_PENDING *pending,
+                                       unsigned int count,
+                                       JSON_Array *r_tarr) {
+    ACVP_RESULT rv = ACVP_SUCCESS;
+    ACVP_TEST_CASE tcs[ACVP_MAC_BATCH_MAX];
+    unsigned int i = 0;
+
+    for (i = 0; i < count; i++) {
+        tcs[i].tc.cmac = &pending[i].stc;
+    }
+    i = 0;
+    if (acvp_invoke_batch_handler(ctx, cap, tcs, count)) {
+        ACVP_LOG_ERR("ERROR: crypto module failed a batch of %u test cases", count);
+        rv = ACVP_CRYPTO_MODULE_FAIL;
+        goto end;
+    }
+
+    for (i = 0; i < count; i++) {
+        rv = acvp_cmac_output_tc(ctx, &pending[i].stc, json_value_get_object(pending[i].r_tval));
+        if (rv != ACVP_SUCCESS) {
+            ACVP_LOG_ERR("ERROR: JSON output failure in cmac module");
+            goto end;
+        }
+        acvp_cmac_release_tc(&pending[i].stc);
+        json_array_append_value(r_tarr, pending[i].r_tval);
+        pending[i].r_tval = NULL;
+        acvp_progress_tc_done(ctx);
+    }
+
+end:
+    for (; i < count; i++) {
+        acvp_cmac_release_tc(&pending[i].stc);
+        json_value_free(pending[i].r_tval);
+        pending[i].r_tval = NULL;
+    }
+    return rv;
+}
+
 ACVP_RESULT acvp_cmac_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
     unsigned int tc_id, msglen, keyLen = 0, keyingOption = 0, maclen, verify = 0;
     const char *msg = NULL, *key1 = NULL, *key2 = NULL, *key3 = NULL, *mac = NULL;
@@ -188,11 +241,13 @@ ACVP_RESULT acvp_cmac_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
     JSON_Object *r_tobj = NULL, *r_gobj = NULL; /* Response testobj, groupobj */
     ACVP_CAPS_LIST *cap;
     ACVP_CMAC_TC stc;
+    ACVP_SCRATCH scratch = { 0 };
+    ACVP_CMAC_PENDING *pending = NULL;  /* test cases waiting for the batch handler */
+    unsigned int pend_cnt = 0;
     ACVP_TEST_CASE tc;
     ACVP_RESULT rv;
     const char *alg_str = json_object_get_string(obj, "algorithm");
     ACVP_CIPHER alg_id;
-    char *json_result;
     ACVP_CMAC_TESTTYPE testtype;
     const char *direction = NULL, *test_type_str = NULL;
     int key1_len, key2_len, key3_len, json_msglen;
@@ -249,6 +304,16 @@ ACVP_RESULT acvp_cmac_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
         return rv;
     }
 
+    if (cap->batch_handler) {
+        pending = calloc(ACVP_MAC_BATCH_MAX, sizeof(ACVP_CMAC_PENDING));
+        if (!pending) {
+            ACVP_LOG_ERR("Unable to malloc CMAC batch");
+            rv = ACVP_MALLOC_FAIL;
+            goto err;
+        }
+        scratch.batch_min = ACVP_MAC_BATCH_SCRATCH;
+    }
+
     groups = json_object_get_array(obj, "testGroups");
     g_cnt = json_array_get_count(groups);
     for (i = 0; i < g_cnt; i++) {
@@ -446,16 +511,41 @@ ACVP_RESULT acvp_cmac_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
              * Setup the test case data that will be passed down to
              * the crypto module.
              */
-            rv = acvp_cmac_init_tc(ctx, &stc, tc_id, testtype, msg, msglen, key1, key2, key3,
-                                   verify, mac, maclen, alg_id);
+            rv = acvp_cmac_init_tc(ctx, &stc, &scratch, tc_id, testtype, msg, msglen, key1, key2,
+                                   key3, verify, mac, maclen, alg_id);
+            if (rv == ACVP_DATA_TOO_LARGE && pend_cnt) {
+                /* The batch's buffers are full; run it and start the next one */
+                rv = acvp_cmac_run_batch(ctx, cap, pending, pend_cnt, r_tarr);
+                pend_cnt = 0;
+                acvp_scratch_reset(&scratch);
+                if (rv == ACVP_SUCCESS) {
+                    rv = acvp_cmac_init_tc(ctx, &stc, &scratch, tc_id, testtype, msg, msglen, key1,
+                                           key2, key3, verify, mac, maclen, alg_id);
+                }
+            }
             if (rv != ACVP_SUCCESS) {
                 acvp_cmac_release_tc(&stc);
                 json_value_free(r_tval);
                 goto err;
             }
 
+            if (pending) {
+                pending[pend_cnt].stc = stc;
+                pending[pend_cnt].r_tval = r_tval;
+                pend_cnt++;
+                if (pend_cnt == ACVP_MAC_BATCH_MAX) {
+                    rv = acvp_cmac_run_batch(ctx, cap, pending, pend_cnt, r_tarr);
+                    pend_cnt = 0;
+                    acvp_scratch_reset(&scratch);
+                    if (rv != ACVP_SUCCESS) {
+                        goto err;
+                    }
+                }
+                continue;
+            }
+
             /* Process the current test vector... */
-            if ((cap->crypto_handler)(&tc)) {
+            if (acvp_invoke_crypto_handler(ctx, cap, &tc)) {
                 ACVP_LOG_ERR("ERROR: crypto module failed the operation");
                 acvp_cmac_release_tc(&stc);
                 rv = ACVP_CRYPTO_MODULE_FAIL;
@@ -481,20 +571,36 @@ ACVP_RESULT acvp_cmac_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
 
             /* Append the test response value to array */
             json_array_append_value(r_tarr, r_tval);
+            acvp_progress_tc_done(ctx);
+        }
+        if (pend_cnt) {
+            rv = acvp_cmac_run_batch(ctx, cap, pending, pend_cnt, r_tarr);
+            pend_cnt = 0;
+            acvp_scratch_reset(&scratch);
+            if (rv != ACVP_SUCCESS) {
+                goto err;
+            }
         }
         json_array_append_value(r_garr, r_gval);
     }
 
     json_array_append_value(reg_arry, r_vs_val);
 
-    json_result = json_serialize_to_string_pretty(ctx->kat_resp, NULL);
-     ACVP_LOG_VERBOSE("\n\n%s\n\n", json_result);
-    json_free_serialized_string(json_result);
+    ACVP_LOG_VERBOSE_JSON(ctx->kat_resp);
     rv = ACVP_SUCCESS;
 
 err:
+    if (pending) {
+        while (pend_cnt) {
+            pend_cnt--;
+            acvp_cmac_release_tc(&pending[pend_cnt].stc);
+            json_value_free(pending[pend_cnt].r_tval);
+        }
+        free(pending);
+    }
     if (rv != ACVP_SUCCESS) {
         acvp_release_json(r_vs_val, r_gval);
     }
+    acvp_scratch_free(&scratch);
     return rv;
 }
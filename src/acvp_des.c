@@ -27,6 +27,7 @@ static ACVP_RESULT acvp_des_output_tc(ACVP_CTX *ctx,
 
 static ACVP_RESULT acvp_des_init_tc(ACVP_CTX *ctx,
                                     ACVP_SYM_CIPHER_TC *stc,
+                                    ACVP_SCRATCH *scratch,
                                     unsigned int tc_id,
                                     ACVP_SYM_CIPH_TESTTYPE test_type,
                                     char *j_key,
@@ -46,11 +47,27 @@ static ACVP_RESULT acvp_des_init_tc(ACVP_CTX *ctx,
 static ACVP_RESULT acvp_des_release_tc(ACVP_SYM_CIPHER_TC *stc);
 
 #define OLD_IV_LEN 8
-#define TEXT_COL_LEN 10001
 #define TEXT_ROW_LEN 8
-static unsigned char old_iv[OLD_IV_LEN];
-static unsigned char ptext[TEXT_COL_LEN][TEXT_ROW_LEN];
-static unsigned char ctext[TEXT_COL_LEN][TEXT_ROW_LEN];
+#define NK_LEN 32 /* Longest key + 8 */
+
+/*
+ * Chaining values for one Monte Carlo test. Each step only needs the
+ * current and previous block, plus the first block of the outer iteration
+ * for OFB, so these are all that is kept.
+ */
+#define MCT_BLK_RING 2
+typedef struct acvp_des_mct_state_t {
+    unsigned char old_iv[OLD_IV_LEN];
+    unsigned char ptext[MCT_BLK_RING][TEXT_ROW_LEN];
+    unsigned char ctext[MCT_BLK_RING][TEXT_ROW_LEN];
+    unsigned char first_pt[TEXT_ROW_LEN];
+    unsigned char first_ct[TEXT_ROW_LEN];
+} ACVP_DES_MCT_STATE;
+
+#define MCT_BLK(ring, j) ((ring)[(j) & (MCT_BLK_RING - 1)])
+
+/* Room past the input for anything the module writes beyond it, such as padding */
+#define ACVP_DES_DATA_SLACK 32
 
 static void shiftin(unsigned char *dst, int dst_max, unsigned char *src, int nbits) {
     int n = 0, move_bytes = 0, copy_bytes = 0;
@@ -82,13 +99,18 @@ static void shiftin(unsigned char *dst, int dst_max, unsigned char *src, int nbi
  * performs the iteration depdedent upon the cipher type and direction.
  */
 static ACVP_RESULT acvp_des_mct_iterate_tc(ACVP_CTX *ctx,
-                                           ACVP_SYM_CIPHER_TC *stc) {
+                                           ACVP_SYM_CIPHER_TC *stc,
+                                           ACVP_DES_MCT_STATE *st) {
     int j = stc->mct_index;
     int n;
     ACVP_SUB_TDES alg;
 
-    memcpy_s(ctext[j], TEXT_ROW_LEN,  stc->ct, stc->ct_len);
-    memcpy_s(ptext[j], TEXT_ROW_LEN, stc->pt, stc->pt_len);
+    memcpy_s(MCT_BLK(st->ctext, j), TEXT_ROW_LEN,  stc->ct, stc->ct_len);
+    memcpy_s(MCT_BLK(st->ptext, j), TEXT_ROW_LEN, stc->pt, stc->pt_len);
+    if (j == 0) {
+        memcpy_s(st->first_ct, TEXT_ROW_LEN, stc->ct, stc->ct_len);
+        memcpy_s(st->first_pt, TEXT_ROW_LEN, stc->pt, stc->pt_len);
+    }
 
     alg = acvp_get_tdes_alg(stc->cipher);
     if (alg == 0) {
@@ -100,22 +122,22 @@ static ACVP_RESULT acvp_des_mct_iterate_tc(ACVP_CTX *ctx,
     case ACVP_SUB_TDES_CBC:
         if (stc->direction == ACVP_SYM_CIPH_DIR_ENCRYPT) {
             if (j == 0) {
-                memcpy_s(stc->pt, ACVP_SYM_PT_BYTE_MAX, old_iv, 8);
+                memcpy_s(stc->pt, stc->pt_alloc, st->old_iv, 8);
             } else {
                 for (n = 0; n < 8; ++n) {
-                    stc->pt[n] = ctext[j - 1][n];
+                    stc->pt[n] = MCT_BLK(st->ctext, j - 1)[n];
                 }
             }
             for (n = 0; n < 8; ++n) {
-                stc->iv[n] = ctext[j][n];
+                stc->iv[n] = MCT_BLK(st->ctext, j)[n];
             }
         } else {
             for (n = 0; n < 8; ++n) {
-                stc->ct[n] = ptext[j][n];
+                stc->ct[n] = MCT_BLK(st->ptext, j)[n];
             }
             if (j != 0) {
                 for (n = 0; n < 8; ++n) {
-                    stc->iv[n] = ptext[j - 1][n];
+                    stc->iv[n] = MCT_BLK(st->ptext, j - 1)[n];
                 }
             }
         }
@@ -123,14 +145,14 @@ static ACVP_RESULT acvp_des_mct_iterate_tc(ACVP_CTX *ctx,
     case ACVP_SUB_TDES_CFB64:
         if (stc->direction == ACVP_SYM_CIPH_DIR_ENCRYPT) {
             if (j == 0) {
-                memcpy_s(stc->pt, ACVP_SYM_PT_BYTE_MAX, old_iv, 8);
+                memcpy_s(stc->pt, stc->pt_alloc, st->old_iv, 8);
             } else {
                 for (n = 0; n < 8; ++n) {
-                    stc->pt[n] = ctext[j - 1][n];
+                    stc->pt[n] = MCT_BLK(st->ctext, j - 1)[n];
                 }
             }
             for (n = 0; n < 8; ++n) {
-                stc->iv[n] = ctext[j][n];
+                stc->iv[n] = MCT_BLK(st->ctext, j)[n];
             }
         } else {
             for (n = 0; n < 8; ++n) {
@@ -145,7 +167,7 @@ static ACVP_RESULT acvp_des_mct_iterate_tc(ACVP_CTX *ctx,
     case ACVP_SUB_TDES_OFB:
         if (stc->direction == ACVP_SYM_CIPH_DIR_ENCRYPT) {
             if (j == 0) {
-                memcpy_s(stc->pt, ACVP_SYM_PT_BYTE_MAX, old_iv, 8);
+                memcpy_s(stc->pt, stc->pt_alloc, st->old_iv, 8);
             } else {
                 for (n = 0; n < 8; ++n) {
                     stc->pt[n] = stc->iv_ret[n];
@@ -153,7 +175,7 @@ static ACVP_RESULT acvp_des_mct_iterate_tc(ACVP_CTX *ctx,
             }
         } else {
             if (j == 0) {
-                memcpy_s(stc->ct, ACVP_SYM_CT_BYTE_MAX, old_iv, 8);
+                memcpy_s(stc->ct, stc->ct_alloc, st->old_iv, 8);
             } else {
                 for (n = 0; n < 8; ++n) {
                     stc->ct[n] = stc->iv_ret[n];
@@ -165,7 +187,7 @@ static ACVP_RESULT acvp_des_mct_iterate_tc(ACVP_CTX *ctx,
     case ACVP_SUB_TDES_CFB8:
         if (stc->direction == ACVP_SYM_CIPH_DIR_ENCRYPT) {
             if (j == 0) {
-                memcpy_s(stc->pt, ACVP_SYM_PT_BYTE_MAX, old_iv, 8);
+                memcpy_s(stc->pt, stc->pt_alloc, st->old_iv, 8);
             } else {
                 for (n = 0; n < 8; ++n) {
                     stc->pt[n] = stc->iv_ret[n];
@@ -183,9 +205,9 @@ static ACVP_RESULT acvp_des_mct_iterate_tc(ACVP_CTX *ctx,
 
     case ACVP_SUB_TDES_ECB:
         if (stc->direction == ACVP_SYM_CIPH_DIR_ENCRYPT) {
-            memcpy_s(stc->pt, ACVP_SYM_PT_BYTE_MAX, stc->ct, stc->ct_len);
+            memcpy_s(stc->pt, stc->pt_alloc, stc->ct, stc->ct_len);
         } else {
-            memcpy_s(stc->ct, ACVP_SYM_CT_BYTE_MAX, stc->pt, stc->pt_len);
+            memcpy_s(stc->ct, stc->ct_alloc, stc->pt, stc->pt_len);
         }
         break;
     case ACVP_SUB_TDES_CBCI:
@@ -350,6 +372,60 @@ err:
     return rv;
 }
 
+/*
+ * Runs one inner loop through the module's MCT handler, then replays the
+ * outputs it returned through acvp_des_mct_iterate_tc() so the chaining values
+ * and the key material in nk end up exactly as they would after one
+ * crypto_handler call per operation. Only used for the 64 bit modes other
+ * than OFB, whose next input does not depend on the module's IV register.
+ */
+static ACVP_RESULT acvp_des_mct_module_loop(ACVP_CTX *ctx,
+                                            ACVP_CAPS_LIST *cap,
+                                            ACVP_TEST_CASE *tc,
+                                            ACVP_SYM_CIPHER_TC *stc,
+                                            ACVP_DES_MCT_STATE *st,
+                                            unsigned char *nk) {
+    unsigned int j = 0;
+    unsigned char *out = NULL;
+    ACVP_RESULT rv = ACVP_SUCCESS;
+
+    if (!stc->mct_out) {
+        return ACVP_MISSING_ARG;
+    }
+
+    stc->mct_index = 0;
+    stc->mct_count = ACVP_DES_MCT_INNER;
+    stc->mct_out_len = 0;
+    if (acvp_invoke_mct_handler(ctx, cap, tc)) {
+        ACVP_LOG_ERR("crypto module failed the operation");
+        return ACVP_CRYPTO_MODULE_FAIL;
+    }
+    if (stc->mct_out_len != TEXT_ROW_LEN) {
+        ACVP_LOG_ERR("MCT handler returned %u byte outputs, expected %u", stc->mct_out_len, TEXT_ROW_LEN);
+        return ACVP_CRYPTO_MODULE_FAIL;
+    }
+
+    for (j = 0; j < ACVP_DES_MCT_INNER; ++j) {
+        out = stc->mct_out + (size_t)j * TEXT_ROW_LEN;
+        stc->mct_index = j;
+        if (stc->direction == ACVP_SYM_CIPH_DIR_ENCRYPT) {
+            memcpy_s(stc->ct, stc->ct_alloc, out, TEXT_ROW_LEN);
+            stc->ct_len = stc->pt_len;
+            shiftin(nk, NK_LEN, stc->ct, 64);
+        } else {
+            memcpy_s(stc->pt, stc->pt_alloc, out, TEXT_ROW_LEN);
+            stc->pt_len = stc->ct_len;
+            shiftin(nk, NK_LEN, stc->pt, 64);
+        }
+        rv = acvp_des_mct_iterate_tc(ctx, stc, st);
+        if (rv != ACVP_SUCCESS) {
+            ACVP_LOG_ERR("Failed the MCT iteration changes");
+            return rv;
+        }
+    }
+    return ACVP_SUCCESS;
+}
+
 static const unsigned char odd_parity[256] = {
     1,   1,   2,   2,   4,   4,   7,   7,   8,   8,   11,  11,  13,  13,  14,  14,
     16,  16,  19,  19,  21,  21,  22,  22,  25,  25,  26,  26,  28,  28,  31,  31,
@@ -393,9 +469,9 @@ static ACVP_RESULT acvp_des_mct_tc(ACVP_CTX *ctx,
     JSON_Value *r_tval = NULL;  /* Response testval */
     JSON_Object *r_tobj = NULL; /* Response testobj */
     char *tmp = NULL;
-#define NK_LEN 32 /* Longest key + 8 */
     unsigned char nk[NK_LEN];
     ACVP_SUB_TDES alg;
+    ACVP_DES_MCT_STATE st;
 
     tmp = calloc(1, ACVP_SYM_CT_MAX + 1);
     if (!tmp) {
@@ -436,7 +512,7 @@ static ACVP_RESULT acvp_des_mct_tc(ACVP_CTX *ctx,
         return ACVP_UNSUPPORTED_OP;
     }
 
-
+    memzero_s(&st, sizeof(st));
     for (i = 0; i < ACVP_DES_MCT_OUTER; ++i) {
         /*
          * Create a new test case in the response
@@ -455,33 +531,43 @@ static ACVP_RESULT acvp_des_mct_tc(ACVP_CTX *ctx,
             return rv;
         }
 
-        for (j = 0; j < ACVP_DES_MCT_INNER; ++j) {
-            if (j == 0) {
-                memcpy_s(old_iv, OLD_IV_LEN, stc->iv, stc->iv_len);
-            }
-            stc->mct_index = j;    /* indicates init vs. update */
-            /* Process the current DES encrypt test vector... */
-            if ((cap->crypto_handler)(tc)) {
-                ACVP_LOG_ERR("crypto module failed the operation");
-                free(tmp);
-                json_value_free(r_tval);
-                return ACVP_CRYPTO_MODULE_FAIL;
-            }
-            /*
-             * Adjust the parameters for next iteration if needed.
-             */
-            if (stc->direction == ACVP_SYM_CIPH_DIR_ENCRYPT) {
-                shiftin(nk, NK_LEN, stc->ct, bit_len);
-            } else {
-                shiftin(nk, NK_LEN, stc->pt, bit_len);
-            }
-            rv = acvp_des_mct_iterate_tc(ctx, stc);
+        if (cap->mct_handler && bit_len == 64 && alg != ACVP_SUB_TDES_OFB) {
+            memcpy_s(st.old_iv, OLD_IV_LEN, stc->iv, stc->iv_len);
+            rv = acvp_des_mct_module_loop(ctx, cap, tc, stc, &st, nk);
             if (rv != ACVP_SUCCESS) {
-                ACVP_LOG_ERR("Failed the MCT iteration changes");
                 free(tmp);
                 json_value_free(r_tval);
                 return rv;
             }
+        } else {
+            for (j = 0; j < ACVP_DES_MCT_INNER; ++j) {
+                if (j == 0) {
+                    memcpy_s(st.old_iv, OLD_IV_LEN, stc->iv, stc->iv_len);
+                }
+                stc->mct_index = j;    /* indicates init vs. update */
+                /* Process the current DES encrypt test vector... */
+                if (acvp_invoke_crypto_handler(ctx, cap, tc)) {
+                    ACVP_LOG_ERR("crypto module failed the operation");
+                    free(tmp);
+                    json_value_free(r_tval);
+                    return ACVP_CRYPTO_MODULE_FAIL;
+                }
+                /*
+                 * Adjust the parameters for next iteration if needed.
+                 */
+                if (stc->direction == ACVP_SYM_CIPH_DIR_ENCRYPT) {
+                    shiftin(nk, NK_LEN, stc->ct, bit_len);
+                } else {
+                    shiftin(nk, NK_LEN, stc->pt, bit_len);
+                }
+                rv = acvp_des_mct_iterate_tc(ctx, stc, &st);
+                if (rv != ACVP_SUCCESS) {
+                    ACVP_LOG_ERR("Failed the MCT iteration changes");
+                    free(tmp);
+                    json_value_free(r_tval);
+                    return rv;
+                }
+            }
         }
 
         for (n = 0; n < 8; ++n) {
@@ -506,11 +592,11 @@ static ACVP_RESULT acvp_des_mct_tc(ACVP_CTX *ctx,
         if (stc->cipher == ACVP_TDES_OFB) {
             if (stc->direction == ACVP_SYM_CIPH_DIR_ENCRYPT) {
                 for (n = 0; n < 8; ++n) {
-                    stc->pt[n] = ptext[0][n] ^ stc->iv_ret[n];
+                    stc->pt[n] = st.first_pt[n] ^ stc->iv_ret[n];
                 }
             } else {
                 for (n = 0; n < 8; ++n) {
-                    stc->ct[n] = ctext[0][n] ^ stc->iv_ret[n];
+                    stc->ct[n] = st.first_ct[n] ^ stc->iv_ret[n];
                 }
             }
         }
@@ -619,6 +705,29 @@ static ACVP_SYM_CIPH_DIR read_direction(const char *str) {
     return 0;
 }
 
+/*
+ * An MCT test case set aside to run on the worker pool (acvp_mct_pool.c),
+ * with its own scratch area and the response array it fills in.
+ */
+typedef struct acvp_des_mct_job_t {
+    ACVP_CAPS_LIST *cap;
+    ACVP_SYM_CIPHER_TC stc;
+    ACVP_SCRATCH scratch;
+    JSON_Array *res_tarr;
+} ACVP_DES_MCT_JOB;
+
+static ACVP_RESULT acvp_des_mct_job(ACVP_CTX *ctx, void *arg) {
+    ACVP_DES_MCT_JOB *job = arg;
+    ACVP_TEST_CASE tc;
+
+    tc.tc.symmetric = &job->stc;
+    if (acvp_des_mct_tc(ctx, job->cap, &tc, &job->stc, job->res_tarr) != ACVP_SUCCESS) {
+        ACVP_LOG_ERR("crypto module failed the DES MCT operation (tcId %u)", job->stc.tc_id);
+        return ACVP_CRYPTO_MODULE_FAIL;
+    }
+    return ACVP_SUCCESS;
+}
+
 /*
  * This is the handler for 3DES values.  This will parse
  * a JSON encoded vector set for 3DES.  Each test case is
@@ -647,6 +756,12 @@ ACVP_RESULT acvp_des_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
     JSON_Object *r_tobj = NULL, *r_gobj = NULL; /* Response testobj, groupobj */
     ACVP_CAPS_LIST *cap;
     ACVP_SYM_CIPHER_TC stc;
+    ACVP_SCRATCH scratch = { 0 };
+    ACVP_MCT_JOBS mct_jobs = { NULL, sizeof(ACVP_DES_MCT_JOB), 0, 0 };
+    ACVP_DES_MCT_JOB *job = NULL;
+    ACVP_SUB_TDES alg = 0;
+    int mct_pool = 0;
+    unsigned int k = 0;
     ACVP_TEST_CASE tc;
     ACVP_RESULT rv;
 
@@ -654,7 +769,6 @@ ACVP_RESULT acvp_des_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
     ACVP_SYM_CIPH_TESTTYPE test_type = 0;
     ACVP_SYM_CIPH_DIR dir = 0;
     ACVP_CIPHER alg_id = 0;
-    char *json_result = NULL;
     const char *test_type_str = NULL, *dir_str = NULL;
     unsigned int tc_id = 0, keylen = 0, keyingOption = 0;
     unsigned int ovrflw_ctr = 0, incr_ctr = 0;  /* assume false */
@@ -689,6 +803,14 @@ ACVP_RESULT acvp_des_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
         return ACVP_UNSUPPORTED_OP;
     }
 
+    /*
+     * Only the modes whose MCT runs in the module's MCT handler can go wide;
+     * the others chain state through the per-operation handler.
+     */
+    alg = acvp_get_tdes_alg(alg_id);
+    mct_pool = ctx->mct_threads > 1 && cap->mct_handler &&
+               (alg == ACVP_SUB_TDES_ECB || alg == ACVP_SUB_TDES_CBC || alg == ACVP_SUB_TDES_CFB64);
+
     /*
      * Create ACVP array for response
      */
@@ -963,11 +1085,25 @@ ACVP_RESULT acvp_des_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
              * Setup the test case data that will be passed down to
              * the crypto module.
              */
-            rv = acvp_des_init_tc(ctx, &stc, tc_id, test_type, key, pt, ct, iv,
-                                  keylen, ivlen, ptlen, ctlen, alg_id, dir,
+            job = NULL;
+            if (mct_pool && test_type == ACVP_SYM_TEST_TYPE_MCT) {
+                job = acvp_mct_jobs_next(&mct_jobs);
+                if (!job) {
+                    ACVP_LOG_ERR("Unable to malloc DES MCT job");
+                    json_value_free(r_tval);
+                    free(key);
+                    rv = ACVP_MALLOC_FAIL;
+                    goto err;
+                }
+            }
+            rv = acvp_des_init_tc(ctx, &stc, job ? &job->scratch : &scratch, tc_id, test_type,
+                                  key, pt, ct, iv, keylen, ivlen, ptlen, ctlen, alg_id, dir,
                                   incr_ctr, ovrflw_ctr, keyingOption);
             if (rv != ACVP_SUCCESS) {
                 acvp_des_release_tc(&stc);
+                if (job) {
+                    acvp_scratch_free(&job->scratch);
+                }
                 free(key);
                 goto err;
             }
@@ -975,6 +1111,17 @@ ACVP_RESULT acvp_des_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
             // Key has been copied, we can free here
             free(key);
 
+            if (job) {
+                /* Run with the others once the whole vector set is read; the response keeps its place */
+                json_object_set_value(r_tobj, "resultsArray", json_value_init_array());
+                job->cap = cap;
+                job->stc = stc;
+                job->res_tarr = json_object_get_array(r_tobj, "resultsArray");
+                mct_jobs.count++;
+                json_array_append_value(r_tarr, r_tval);
+                continue;
+            }
+
             /* If Monte Carlo start that here */
             if (stc.test_type == ACVP_SYM_TEST_TYPE_MCT) {
                 json_object_set_value(r_tobj, "resultsArray", json_value_init_array());
@@ -989,7 +1136,7 @@ ACVP_RESULT acvp_des_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
                 }
             } else {
                 /* Process the current DES encrypt test vector... */
-                int t_rv = (cap->crypto_handler)(&tc);
+                int t_rv = acvp_invoke_crypto_handler(ctx, cap, &tc);
                 if (t_rv) {
                     ACVP_LOG_ERR("ERROR: crypto module failed the operation");
                     json_value_free(r_tval);
@@ -1016,21 +1163,38 @@ ACVP_RESULT acvp_des_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
 
             /* Append the test response value to array */
             json_array_append_value(r_tarr, r_tval);
+            acvp_progress_tc_done(ctx);
         }
         json_array_append_value(r_garr, r_gval);
     }
+    r_gval = NULL;
+
+    if (mct_jobs.count) {
+        rv = acvp_mct_jobs_run(ctx, cap, &mct_jobs, acvp_des_mct_job);
+        if (rv != ACVP_SUCCESS) {
+            goto err;
+        }
+        for (k = 0; k < mct_jobs.count; k++) {
+            acvp_progress_tc_done(ctx);
+        }
+    }
 
     json_array_append_value(reg_arry, r_vs_val);
     rv = ACVP_SUCCESS;
 
-    json_result = json_serialize_to_string_pretty(ctx->kat_resp, NULL);
-    ACVP_LOG_VERBOSE("\n\n%s\n\n", json_result);
-    json_free_serialized_string(json_result);
+    ACVP_LOG_VERBOSE_JSON(ctx->kat_resp);
 
 err:
+    for (k = 0; k < mct_jobs.count; k++) {
+        job = (ACVP_DES_MCT_JOB *)mct_jobs.jobs + k;
+        acvp_des_release_tc(&job->stc);
+        acvp_scratch_free(&job->scratch);
+    }
+    acvp_mct_jobs_free(&mct_jobs);
     if (rv != ACVP_SUCCESS) {
         acvp_release_json(r_vs_val, r_gval);
     }
+    acvp_scratch_free(&scratch);
     return rv;
 }
 
@@ -1114,6 +1278,7 @@ static ACVP_RESULT acvp_des_output_tc(ACVP_CTX *ctx,
  */
 static ACVP_RESULT acvp_des_init_tc(ACVP_CTX *ctx,
                                     ACVP_SYM_CIPHER_TC *stc,
+                                    ACVP_SCRATCH *scratch,
                                     unsigned int tc_id,
                                     ACVP_SYM_CIPH_TESTTYPE test_type,
                                     char *j_key,
@@ -1130,21 +1295,42 @@ static ACVP_RESULT acvp_des_init_tc(ACVP_CTX *ctx,
                                     unsigned int ovrflw_ctr,
                                     unsigned int keyingOption) {
     ACVP_RESULT rv;
+    size_t data_max = 0, len = 0;
 
     memzero_s(stc, sizeof(ACVP_SYM_CIPHER_TC));
 
-    stc->key = calloc(1, ACVP_SYM_KEY_MAX_BYTES);
-    if (!stc->key) { return ACVP_MALLOC_FAIL; }
-    stc->pt = calloc(1, ACVP_SYM_PT_BYTE_MAX);
-    if (!stc->pt) { return ACVP_MALLOC_FAIL; }
-    stc->ct = calloc(1, ACVP_SYM_CT_BYTE_MAX);
-    if (!stc->ct) { return ACVP_MALLOC_FAIL; }
-    stc->iv = calloc(1, ACVP_SYM_IV_BYTE_MAX);
-    if (!stc->iv) { return ACVP_MALLOC_FAIL; }
-    stc->iv_ret = calloc(1, ACVP_SYM_IV_BYTE_MAX);
-    if (!stc->iv_ret) { return ACVP_MALLOC_FAIL; }
-    stc->iv_ret_after = calloc(1, ACVP_SYM_IV_BYTE_MAX);
-    if (!stc->iv_ret_after) { return ACVP_MALLOC_FAIL; }
+    /*
+     * pt and ct are sized for the larger input, since the module writes its
+     * output into the other one; the key and IVs always get their maximum.
+     */
+    if (j_pt) data_max = strnlen_s(j_pt, ACVP_SYM_PT_MAX + 1) / 2;
+    if (j_ct) {
+        len = strnlen_s(j_ct, ACVP_SYM_CT_MAX + 1) / 2;
+        if (len > data_max) data_max = len;
+    }
+    len = ((size_t)(pt_len > ct_len ? pt_len : ct_len) + 7) / 8;
+    if (len > data_max) data_max = len;
+    data_max += ACVP_DES_DATA_SLACK;
+    if (data_max > ACVP_SYM_PT_BYTE_MAX) data_max = ACVP_SYM_PT_BYTE_MAX;
+
+    rv = acvp_scratch_reserve(scratch, acvp_scratch_round(ACVP_SYM_KEY_MAX_BYTES) +
+                                       2 * acvp_scratch_round(data_max) +
+                                       3 * acvp_scratch_round(ACVP_SYM_IV_BYTE_MAX) +
+                                       (test_type == ACVP_SYM_TEST_TYPE_MCT ?
+                                        acvp_scratch_round(ACVP_DES_MCT_INNER * TEXT_ROW_LEN) : 0));
+    if (rv != ACVP_SUCCESS) { return rv; }
+    stc->key = acvp_scratch_alloc(scratch, ACVP_SYM_KEY_MAX_BYTES);
+    stc->pt = acvp_scratch_alloc(scratch, data_max);
+    stc->ct = acvp_scratch_alloc(scratch, data_max);
+    stc->pt_alloc = (unsigned int)data_max;
+    stc->ct_alloc = (unsigned int)data_max;
+    stc->iv = acvp_scratch_alloc(scratch, ACVP_SYM_IV_BYTE_MAX);
+    stc->iv_ret = acvp_scratch_alloc(scratch, ACVP_SYM_IV_BYTE_MAX);
+    stc->iv_ret_after = acvp_scratch_alloc(scratch, ACVP_SYM_IV_BYTE_MAX);
+    if (test_type == ACVP_SYM_TEST_TYPE_MCT) {
+        /* Only written to when the capability has an MCT inner loop handler */
+        stc->mct_out = acvp_scratch_alloc(scratch, ACVP_DES_MCT_INNER * TEXT_ROW_LEN);
+    }
 
     rv = acvp_hexstr_to_bin(j_key, stc->key, ACVP_SYM_KEY_MAX_BYTES, NULL);
     if (rv != ACVP_SUCCESS) {
@@ -1154,13 +1340,13 @@ static ACVP_RESULT acvp_des_init_tc(ACVP_CTX *ctx,
 
     if (j_pt) {
         if (alg_id == ACVP_TDES_CFB1) {
-            rv = acvp_hexstr_to_bin(j_pt, stc->pt, ACVP_SYM_PT_BYTE_MAX, NULL);
+            rv = acvp_hexstr_to_bin(j_pt, stc->pt, (int)stc->pt_alloc, NULL);
             if (rv != ACVP_SUCCESS) {
                 ACVP_LOG_ERR("Hex conversion failure (pt)");
                 return rv;
             }
         } else {
-            rv = acvp_hexstr_to_bin(j_pt, stc->pt, ACVP_SYM_PT_BYTE_MAX, NULL);
+            rv = acvp_hexstr_to_bin(j_pt, stc->pt, (int)stc->pt_alloc, NULL);
             if (rv != ACVP_SUCCESS) {
                 ACVP_LOG_ERR("Hex converstion failure (pt)");
                 return rv;
@@ -1170,13 +1356,13 @@ static ACVP_RESULT acvp_des_init_tc(ACVP_CTX *ctx,
 
     if (j_ct) {
         if (alg_id == ACVP_TDES_CFB1) {
-            rv = acvp_hexstr_to_bin(j_ct, stc->ct, ACVP_SYM_PT_BYTE_MAX, NULL);
+            rv = acvp_hexstr_to_bin(j_ct, stc->ct, (int)stc->ct_alloc, NULL);
             if (rv != ACVP_SUCCESS) {
                 ACVP_LOG_ERR("Hex conversion failure (ct)");
                 return rv;
             }
         } else {
-            rv = acvp_hexstr_to_bin(j_ct, stc->ct, ACVP_SYM_CT_BYTE_MAX, NULL);
+            rv = acvp_hexstr_to_bin(j_ct, stc->ct, (int)stc->ct_alloc, NULL);
             if (rv != ACVP_SUCCESS) {
                 ACVP_LOG_ERR("Hex converstion failure (ct)");
                 return rv;
@@ -1222,12 +1408,7 @@ static ACVP_RESULT acvp_des_init_tc(ACVP_CTX *ctx,
  * a test case.
  */
 static ACVP_RESULT acvp_des_release_tc(ACVP_SYM_CIPHER_TC *stc) {
-    if (stc->key) free(stc->key);
-    if (stc->pt) free(stc->pt);
-    if (stc->ct) free(stc->ct);
-    if (stc->iv) free(stc->iv);
-    if (stc->iv_ret) free(stc->iv_ret);
-    if (stc->iv_ret_after) free(stc->iv_ret_after);
+    /* The buffers belong to the handler's scratch area */
     memzero_s(stc, sizeof(ACVP_SYM_CIPHER_TC));
 
     return ACVP_SUCCESS;
@@ -276,9 +276,11 @@ ACVP_RESULT acvp_drbg_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
             testval = json_array_get_value(tests, j);
             testobj = json_value_get_object(testval);
 
-            json_result = json_serialize_to_string_pretty(testval, NULL);
-            ACVP_LOG_VERBOSE("json testval count: %d\n %s\n", i, json_result);
-            json_free_serialized_string(json_result);
+            if (ACVP_LOG_ENABLED(ctx, ACVP_LOG_LVL_VERBOSE)) {
+                json_result = json_serialize_to_string_pretty(testval, NULL);
+                ACVP_LOG_VERBOSE("json testval count: %d\n %s\n", i, json_result);
+                json_free_serialized_string(json_result);
+            }
 
             tc_id = json_object_get_number(testobj, "tcId");
 
@@ -533,7 +535,7 @@ ACVP_RESULT acvp_drbg_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
             }
 
             /* Process the current test vector... */
-            if ((cap->crypto_handler)(&tc)) {
+            if (acvp_invoke_crypto_handler(ctx, cap, &tc)) {
                 ACVP_LOG_ERR("crypto module failed the operation");
                 rv = ACVP_CRYPTO_MODULE_FAIL;
                 acvp_drbg_release_tc(&stc);
@@ -559,14 +561,13 @@ ACVP_RESULT acvp_drbg_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
 
             /* Append the test response value to array */
             json_array_append_value(r_tarr, r_tval);
+            acvp_progress_tc_done(ctx);
         }
         json_array_append_value(r_garr, r_gval);
     }
     json_array_append_value(reg_arry, r_vs_val);
 
-    json_result = json_serialize_to_string_pretty(ctx->kat_resp, NULL);
-    ACVP_LOG_VERBOSE("\n\n%s\n\n", json_result);
-    json_free_serialized_string(json_result);
+    ACVP_LOG_VERBOSE_JSON(ctx->kat_resp);
 
     rv = ACVP_SUCCESS;
 err:
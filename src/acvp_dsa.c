@@ -559,7 +559,7 @@ static ACVP_RESULT acvp_dsa_keygen_handler(ACVP_CTX *ctx,
         }
 
         /* Process the current DSA test vector... */
-        if ((cap->crypto_handler)(&tc)) {
+        if (acvp_invoke_group_crypto_handler(ctx, cap, &tc, j, t_cnt)) {
             ACVP_LOG_ERR("crypto module failed the operation");
             rv = ACVP_CRYPTO_MODULE_FAIL;
             goto err;
@@ -620,6 +620,7 @@ static ACVP_RESULT acvp_dsa_keygen_handler(ACVP_CTX *ctx,
     }
     /* Append the test response value to array */
     json_array_append_value(r_tarr, r_tval);
+    acvp_progress_tc_done(ctx);
     return ACVP_SUCCESS;
 
 err:
@@ -825,7 +826,7 @@ ACVP_RESULT acvp_dsa_pqggen_handler(ACVP_CTX *ctx,
             }
 
             /* Process the current DSA test vector... */
-            if ((cap->crypto_handler)(&tc)) {
+            if (acvp_invoke_crypto_handler(ctx, cap, &tc)) {
                 ACVP_LOG_ERR("crypto module failed the operation");
                 acvp_dsa_release_tc(stc);
                 json_value_free(r_tval);
@@ -866,7 +867,7 @@ ACVP_RESULT acvp_dsa_pqggen_handler(ACVP_CTX *ctx,
                 return rv;
             }
 
-            if ((cap->crypto_handler)(&tc)) {
+            if (acvp_invoke_crypto_handler(ctx, cap, &tc)) {
                 ACVP_LOG_ERR("crypto module failed the operation");
                 acvp_dsa_release_tc(stc);
                 json_value_free(r_tval);
@@ -891,6 +892,7 @@ ACVP_RESULT acvp_dsa_pqggen_handler(ACVP_CTX *ctx,
             break;
         }
         json_array_append_value(r_tarr, r_tval);
+        acvp_progress_tc_done(ctx);
         acvp_dsa_release_tc(stc);
     }
     return rv;
@@ -990,7 +992,7 @@ static ACVP_RESULT acvp_dsa_siggen_handler(ACVP_CTX *ctx,
         }
 
         /* Process the current DSA test vector... */
-        if ((cap->crypto_handler)(&tc)) {
+        if (acvp_invoke_group_crypto_handler(ctx, cap, &tc, j, t_cnt)) {
             ACVP_LOG_ERR("crypto module failed the operation");
             rv = ACVP_CRYPTO_MODULE_FAIL;
             goto err;
@@ -1060,6 +1062,7 @@ static ACVP_RESULT acvp_dsa_siggen_handler(ACVP_CTX *ctx,
     }
     /* Append the test response value to array */
     json_array_append_value(r_tarr, r_tval);
+    acvp_progress_tc_done(ctx);
     return ACVP_SUCCESS;
 
 err:
@@ -1237,7 +1240,7 @@ static ACVP_RESULT acvp_dsa_pqgver_handler(ACVP_CTX *ctx,
         }
 
         /* Process the current DSA test vector... */
-        if ((cap->crypto_handler)(&tc)) {
+        if (acvp_invoke_group_crypto_handler(ctx, cap, &tc, j, t_cnt)) {
             ACVP_LOG_ERR("crypto module failed the operation");
             acvp_dsa_release_tc(stc);
             return ACVP_CRYPTO_MODULE_FAIL;
@@ -1262,6 +1265,7 @@ static ACVP_RESULT acvp_dsa_pqgver_handler(ACVP_CTX *ctx,
     }
     /* Append the test response value to array */
     json_array_append_value(r_tarr, r_tval);
+    acvp_progress_tc_done(ctx);
     return rv;
 }
 
@@ -1398,7 +1402,7 @@ static ACVP_RESULT acvp_dsa_sigver_handler(ACVP_CTX *ctx,
         }
 
         /* Process the current DSA test vector... */
-        if ((cap->crypto_handler)(&tc)) {
+        if (acvp_invoke_group_crypto_handler(ctx, cap, &tc, j, t_cnt)) {
             ACVP_LOG_ERR("crypto module failed the operation");
             acvp_dsa_release_tc(stc);
             return ACVP_CRYPTO_MODULE_FAIL;
@@ -1423,6 +1427,7 @@ static ACVP_RESULT acvp_dsa_sigver_handler(ACVP_CTX *ctx,
     }
     /* Append the test response value to array */
     json_array_append_value(r_tarr, r_tval);
+    acvp_progress_tc_done(ctx);
     return rv;
 }
 
@@ -1442,7 +1447,6 @@ static ACVP_RESULT acvp_dsa_pqgver_kat_handler(ACVP_CTX *ctx, JSON_Object *obj)
     ACVP_RESULT rv;
     const char *alg_str = json_object_get_string(obj, "algorithm");
     ACVP_CIPHER alg_id;
-    char *json_result;
     unsigned int g_cnt, i;
 
     if (!alg_str) {
@@ -1528,16 +1532,7 @@ static ACVP_RESULT acvp_dsa_pqgver_kat_handler(ACVP_CTX *ctx, JSON_Object *obj)
     }
     memzero_s(&stc, sizeof(ACVP_DSA_TC));
     json_array_append_value(reg_arry, r_vs_val);
-    json_result = json_serialize_to_string_pretty(ctx->kat_resp, NULL);
-    if (!json_result) {
-        ACVP_LOG_ERR("JSON unable to be serialized");
-        rv = ACVP_JSON_ERR;
-        goto err;
-    }
-
-    ACVP_LOG_VERBOSE("\n\n%s\n\n", json_result);
-
-    json_free_serialized_string(json_result);
+    ACVP_LOG_VERBOSE_JSON(ctx->kat_resp);
     rv = ACVP_SUCCESS;
 
 err:
@@ -1564,7 +1559,6 @@ static ACVP_RESULT acvp_dsa_pqggen_kat_handler(ACVP_CTX *ctx, JSON_Object *obj)
     ACVP_RESULT rv;
     const char *alg_str = json_object_get_string(obj, "algorithm");
     ACVP_CIPHER alg_id;
-    char *json_result;
     unsigned int g_cnt, i;
 
     if (!alg_str) {
@@ -1650,9 +1644,7 @@ static ACVP_RESULT acvp_dsa_pqggen_kat_handler(ACVP_CTX *ctx, JSON_Object *obj)
 
     memzero_s(&stc, sizeof(ACVP_DSA_TC));
     json_array_append_value(reg_arry, r_vs_val);
-    json_result = json_serialize_to_string_pretty(ctx->kat_resp, NULL);
-    ACVP_LOG_VERBOSE("\n\n%s\n\n", json_result);
-    json_free_serialized_string(json_result);
+    ACVP_LOG_VERBOSE_JSON(ctx->kat_resp);
     rv = ACVP_SUCCESS;
 
 err:
@@ -1679,7 +1671,6 @@ static ACVP_RESULT acvp_dsa_siggen_kat_handler(ACVP_CTX *ctx, JSON_Object *obj)
     ACVP_RESULT rv;
     const char *alg_str = json_object_get_string(obj, "algorithm");
     ACVP_CIPHER alg_id;
-    char *json_result;
     unsigned int g_cnt, i;
 
     if (!alg_str) {
@@ -1766,10 +1757,7 @@ static ACVP_RESULT acvp_dsa_siggen_kat_handler(ACVP_CTX *ctx, JSON_Object *obj)
 
     memzero_s(&stc, sizeof(ACVP_DSA_TC));
     json_array_append_value(reg_arry, r_vs_val);
-    json_result = json_serialize_to_string_pretty(ctx->kat_resp, NULL);
-
-    ACVP_LOG_VERBOSE("\n\n%s\n\n", json_result);
-    json_free_serialized_string(json_result);
+    ACVP_LOG_VERBOSE_JSON(ctx->kat_resp);
     rv = ACVP_SUCCESS;
 
 err:
@@ -1796,7 +1784,6 @@ static ACVP_RESULT acvp_dsa_keygen_kat_handler(ACVP_CTX *ctx, JSON_Object *obj)
     ACVP_RESULT rv;
     const char *alg_str = json_object_get_string(obj, "algorithm");
     ACVP_CIPHER alg_id;
-    char *json_result;
     unsigned int g_cnt, i;
 
     if (!alg_str) {
@@ -1882,10 +1869,7 @@ static ACVP_RESULT acvp_dsa_keygen_kat_handler(ACVP_CTX *ctx, JSON_Object *obj)
 
     memzero_s(&stc, sizeof(ACVP_DSA_TC));
     json_array_append_value(reg_arry, r_vs_val);
-    json_result = json_serialize_to_string_pretty(ctx->kat_resp, NULL);
-
-    ACVP_LOG_VERBOSE("\n\n%s\n\n", json_result);
-    json_free_serialized_string(json_result);
+    ACVP_LOG_VERBOSE_JSON(ctx->kat_resp);
     rv = ACVP_SUCCESS;
 
 err:
@@ -1912,7 +1896,6 @@ static ACVP_RESULT acvp_dsa_sigver_kat_handler(ACVP_CTX *ctx, JSON_Object *obj)
     ACVP_RESULT rv;
     const char *alg_str = json_object_get_string(obj, "algorithm");
     ACVP_CIPHER alg_id;
-    char *json_result;
     unsigned int g_cnt, i;
 
     if (!alg_str) {
@@ -1998,15 +1981,7 @@ static ACVP_RESULT acvp_dsa_sigver_kat_handler(ACVP_CTX *ctx, JSON_Object *obj)
 
     memzero_s(&stc, sizeof(ACVP_DSA_TC));
     json_array_append_value(reg_arry, r_vs_val);
-    json_result = json_serialize_to_string_pretty(ctx->kat_resp, NULL);
-    if (!json_result) {
-        ACVP_LOG_ERR("JSON unable to be serialized");
-        rv = ACVP_JSON_ERR;
-        goto err;
-    }
-
-    ACVP_LOG_VERBOSE("\n\n%s\n\n", json_result);
-    json_free_serialized_string(json_result);
+    ACVP_LOG_VERBOSE_JSON(ctx->kat_resp);
     rv = ACVP_SUCCESS;
 
 err:
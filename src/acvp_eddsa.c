@@ -222,7 +222,6 @@ static ACVP_RESULT acvp_eddsa_kat_handler_internal(ACVP_CTX *ctx, JSON_Object *o
 
     ACVP_CIPHER alg_id;
     ACVP_EDDSA_TESTTYPE test_type;
-    char *json_result = NULL;
     const char *alg_str, *mode_str, *q = NULL, *sig = NULL, *message = NULL, *context = NULL;
 
     if (!ctx) {
@@ -441,7 +440,7 @@ static ACVP_RESULT acvp_eddsa_kat_handler_internal(ACVP_CTX *ctx, JSON_Object *o
 
             /* Process the current test vector... */
             if (rv == ACVP_SUCCESS) {
-                if ((cap->crypto_handler)(&tc)) {
+                if (acvp_invoke_group_crypto_handler(ctx, cap, &tc, j, t_cnt)) {
                     ACVP_LOG_ERR("ERROR: crypto module failed the operation");
                     rv = ACVP_CRYPTO_MODULE_FAIL;
                     json_value_free(r_tval);
@@ -481,6 +480,7 @@ static ACVP_RESULT acvp_eddsa_kat_handler_internal(ACVP_CTX *ctx, JSON_Object *o
 
             /* Append the test response value to array */
             json_array_append_value(r_tarr, r_tval);
+            acvp_progress_tc_done(ctx);
 
             /*
              * Release all the memory associated with the test case
@@ -492,9 +492,7 @@ static ACVP_RESULT acvp_eddsa_kat_handler_internal(ACVP_CTX *ctx, JSON_Object *o
 
     json_array_append_value(reg_arry, r_vs_val);
 
-    json_result = json_serialize_to_string_pretty(ctx->kat_resp, NULL);
-    ACVP_LOG_VERBOSE("\n\n%s\n\n", json_result);
-    json_free_serialized_string(json_result);
+    ACVP_LOG_VERBOSE_JSON(ctx->kat_resp);
     rv = ACVP_SUCCESS;
 
 err:
@@ -0,0 +1,159 @@
+/** @file */
+/*
+ * Copyright (c) 2024, Cisco Systems, Inc.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://github.com/cisco/libacvp/LICENSE
+ */
+
+/*
+ * Test group boundaries and the group cache.
+ *
+ * The asymmetric algorithms generate or load a key, domain parameters or
+ * similar once for a test group and use it for every test case in the group.
+ * Rather than have each handler spot a change of tgId for itself, a module can
+ * register a group handler that is told where each group begins and ends, and
+ * keep what it derives from the group's parameters in the session's group
+ * cache, under a key of its choosing. The cache is emptied once each vector set
+ * is done, so nothing left in it by an abandoned group outlives the vector set
+ * whose tgIds it was keyed by.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "acvp.h"
+#include "acvp_lcl.h"
+#include "safe_lib.h"
+
+static ACVP_GROUP_CACHE_ENTRY *acvp_group_cache_find(ACVP_GROUP_CACHE *cache,
+                                                     const void *key,
+                                                     size_t key_len,
+                                                     ACVP_GROUP_CACHE_ENTRY ***link) {
+    ACVP_GROUP_CACHE_ENTRY **e = NULL;
+
+    for (e = &cache->entries; *e; e = &(*e)->next) {
+        if ((*e)->key_len == key_len && !memcmp((*e)->key, key, key_len)) {
+            if (link) *link = e;
+            return *e;
+        }
+    }
+    return NULL;
+}
+
+static void acvp_group_cache_entry_free(ACVP_GROUP_CACHE_ENTRY *entry) {
+    if (entry->free_fn && entry->value) {
+        entry->free_fn(entry->value);
+    }
+    free(entry->key);
+    free(entry);
+}
+
+void *acvp_group_cache_get(ACVP_GROUP_CACHE *cache, const void *key, size_t key_len) {
+    ACVP_GROUP_CACHE_ENTRY *entry = NULL;
+
+    if (!cache || !key || !key_len) {
+        return NULL;
+    }
+    entry = acvp_group_cache_find(cache, key, key_len, NULL);
+    return entry ? entry->value : NULL;
+}
+
+ACVP_RESULT acvp_group_cache_set(ACVP_GROUP_CACHE *cache,
+                                 const void *key,
+                                 size_t key_len,
+                                 void *value,
+                                 void (*free_fn)(void *value)) {
+    ACVP_GROUP_CACHE_ENTRY *entry = NULL;
+
+    if (!cache || !key || !key_len || !value) {
+        return ACVP_INVALID_ARG;
+    }
+
+    entry = acvp_group_cache_find(cache, key, key_len, NULL);
+    if (entry) {
+        if (entry->value != value && entry->free_fn) {
+            entry->free_fn(entry->value);
+        }
+        entry->value = value;
+        entry->free_fn = free_fn;
+        return ACVP_SUCCESS;
+    }
+
+    entry = calloc(1, sizeof(ACVP_GROUP_CACHE_ENTRY));
+    if (!entry) {
+        return ACVP_MALLOC_FAIL;
+    }
+    entry->key = malloc(key_len);
+    if (!entry->key) {
+        free(entry);
+        return ACVP_MALLOC_FAIL;
+    }
+    memcpy_s(entry->key, key_len, key, key_len);
+    entry->key_len = key_len;
+    entry->value = value;
+    entry->free_fn = free_fn;
+    entry->next = cache->entries;
+    cache->entries = entry;
+    return ACVP_SUCCESS;
+}
+
+void acvp_group_cache_remove(ACVP_GROUP_CACHE *cache, const void *key, size_t key_len) {
+    ACVP_GROUP_CACHE_ENTRY *entry = NULL, **link = NULL;
+
+    if (!cache || !key || !key_len) {
+        return;
+    }
+    entry = acvp_group_cache_find(cache, key, key_len, &link);
+    if (entry) {
+        *link = entry->next;
+        acvp_group_cache_entry_free(entry);
+    }
+}
+
+void acvp_group_cache_clear(ACVP_GROUP_CACHE *cache) {
+    ACVP_GROUP_CACHE_ENTRY *entry = NULL;
+
+    if (!cache) {
+        return;
+    }
+    while (cache->entries) {
+        entry = cache->entries;
+        cache->entries = entry->next;
+        acvp_group_cache_entry_free(entry);
+    }
+}
+
+/*
+ * Runs the crypto handler for test case index of a group of count, telling
+ * the group handler (if any) about the group beginning before the first test
+ * case and ending after the last. A group abandoned part way gets no end.
+ */
+int acvp_invoke_group_crypto_handler(ACVP_CTX *ctx,
+                                     ACVP_CAPS_LIST *cap,
+                                     ACVP_TEST_CASE *tc,
+                                     int index,
+                                     int count) {
+    int rv = 0;
+
+    tc->group_cache = &ctx->group_cache;
+    if (cap->group_handler && index == 0) {
+        if ((cap->group_handler)(ACVP_GROUP_BEGIN, tc)) {
+            ACVP_LOG_ERR("Group handler failed to begin the test group");
+            return 1;
+        }
+    }
+    rv = acvp_invoke_crypto_handler(ctx, cap, tc);
+    if (rv) {
+        return rv;
+    }
+    if (cap->group_handler && index == count - 1) {
+        if ((cap->group_handler)(ACVP_GROUP_END, tc)) {
+            ACVP_LOG_ERR("Group handler failed to end the test group");
+            return 1;
+        }
+    }
+    return 0;
+}
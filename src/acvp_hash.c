@@ -46,10 +46,15 @@ static ACVP_RESULT acvp_hash_release_tc(ACVP_HASH_TC *stc);
  * and direction.
  */
 static ACVP_RESULT acvp_hash_mct_iterate_tc(ACVP_HASH_TC *stc) {
+    unsigned char *oldest = stc->m1;
 
-    /* feed hash into the next message for MCT */
-    memcpy_s(stc->m1, ACVP_HASH_MD_BYTE_MAX, stc->m2, stc->md_len);
-    memcpy_s(stc->m2, ACVP_HASH_MD_BYTE_MAX, stc->m3, stc->md_len);
+    /*
+     * Feed hash into the next message for MCT. The three message buffers
+     * are the same size, so rotate them and only copy the new digest.
+     */
+    stc->m1 = stc->m2;
+    stc->m2 = stc->m3;
+    stc->m3 = oldest;
     memcpy_s(stc->m3, ACVP_HASH_MD_BYTE_MAX, stc->md, stc->md_len);
 
     return ACVP_SUCCESS;
@@ -111,13 +116,6 @@ static ACVP_RESULT acvp_hash_mct_tc(ACVP_CTX *ctx,
     ACVP_RESULT rv;
     JSON_Value *r_tval = NULL;  /* Response testval */
     JSON_Object *r_tobj = NULL; /* Response testobj */
-    char *tmp = NULL;
-
-    tmp = calloc(ACVP_HASH_MSG_STR_MAX * 3, sizeof(char));
-    if (!tmp) {
-        ACVP_LOG_ERR("Unable to malloc");
-        return ACVP_MALLOC_FAIL;
-    }
 
     memcpy_s(stc->m1, ACVP_HASH_MD_BYTE_MAX, stc->msg, stc->msg_len);
     memcpy_s(stc->m2, ACVP_HASH_MD_BYTE_MAX, stc->msg, stc->msg_len);
@@ -132,10 +130,9 @@ static ACVP_RESULT acvp_hash_mct_tc(ACVP_CTX *ctx,
 
         for (j = 0; j < ACVP_HASH_MCT_INNER; ++j) {
             /* Process the current SHA test vector... */
-            rv = (cap->crypto_handler)(tc);
+            rv = acvp_invoke_crypto_handler(ctx, cap, tc);
             if (rv != ACVP_SUCCESS) {
                 ACVP_LOG_ERR("crypto module failed the operation");
-                free(tmp);
                 json_value_free(r_tval);
                 return ACVP_CRYPTO_MODULE_FAIL;
             }
@@ -146,7 +143,6 @@ static ACVP_RESULT acvp_hash_mct_tc(ACVP_CTX *ctx,
             rv = acvp_hash_mct_iterate_tc(stc);
             if (rv != ACVP_SUCCESS) {
                 ACVP_LOG_ERR("Failed the MCT iteration changes");
-                free(tmp);
                 json_value_free(r_tval);
                 return rv;
             }
@@ -157,7 +153,6 @@ static ACVP_RESULT acvp_hash_mct_tc(ACVP_CTX *ctx,
         rv = acvp_hash_output_mct_tc(ctx, stc, r_tobj);
         if (rv != ACVP_SUCCESS) {
             ACVP_LOG_ERR("JSON output failure in HASH module");
-            free(tmp);
             json_value_free(r_tval);
             return rv;
         }
@@ -170,7 +165,6 @@ static ACVP_RESULT acvp_hash_mct_tc(ACVP_CTX *ctx,
 
     }
 
-    free(tmp);
     return ACVP_SUCCESS;
 }
 
@@ -208,10 +202,12 @@ static ACVP_RESULT acvp_hash_sha3_mct(ACVP_CTX *ctx,
         for (i = 0; i <= ACVP_HASH_MCT_INNER; i++) {
             if (i != 0) {
                 /*
-                 * Use the MD[i-1] as the new Msg
-                 * Zeroize the msg buffer, and copy in the md.
+                 * Use the MD[i-1] as the new Msg. Only the tail of a
+                 * longer previous message needs clearing.
                  */
-                memzero_s(stc->msg, ACVP_HASH_MSG_BYTE_MAX);
+                if (stc->msg_len > stc->md_len) {
+                    memzero_s(stc->msg + stc->md_len, stc->msg_len - stc->md_len);
+                }
                 memcpy_s(stc->msg, ACVP_HASH_MSG_BYTE_MAX, stc->md, stc->md_len);
                 stc->msg_len = stc->md_len;
 
@@ -225,11 +221,13 @@ static ACVP_RESULT acvp_hash_sha3_mct(ACVP_CTX *ctx,
                 }
             }
 
-            /* Now clear the md buffer */
-            memzero_s(stc->md, ACVP_HASH_MD_BYTE_MAX);
+            /* Now clear the previous digest */
+            if (stc->md_len) {
+                memzero_s(stc->md, stc->md_len);
+            }
 
             /* Process the current SHA test vector... */
-            rv = (cap->crypto_handler)(tc);
+            rv = acvp_invoke_crypto_handler(ctx, cap, tc);
             if (rv != ACVP_SUCCESS) {
                 ACVP_LOG_ERR("crypto module failed the operation");
                 rv = ACVP_CRYPTO_MODULE_FAIL;
@@ -307,10 +305,12 @@ static ACVP_RESULT acvp_hash_shake_mct(ACVP_CTX *ctx,
 
             if (i != 0) {
                 /*
-                 * Use the MD[i-1] as the new Msg
-                 * Zeroize the msg buffer, and copy in the md.
+                 * Use the MD[i-1] as the new Msg. The message is always
+                 * the leftmost 128 bits, zero padded if the digest is shorter.
                  */
-                memzero_s(stc->msg, ACVP_SHAKE_MSG_BYTE_MAX);
+                if (stc->md_len < leftmost_bytes) {
+                    memzero_s(stc->msg + stc->md_len, leftmost_bytes - stc->md_len);
+                }
                 if (stc->md_len <= leftmost_bytes) {
                     memcpy_s(stc->msg, ACVP_SHAKE_MSG_BYTE_MAX, stc->md, stc->md_len);
                 } else {
@@ -329,11 +329,13 @@ static ACVP_RESULT acvp_hash_shake_mct(ACVP_CTX *ctx,
             }
             stc->msg_len = leftmost_bytes;
 
-            /* Now clear the md buffer */
-            memzero_s(stc->md, ACVP_HASH_XOF_MD_BYTE_MAX);
+            /* Now clear the previous output */
+            if (stc->md_len) {
+                memzero_s(stc->md, stc->md_len);
+            }
 
             /* Process the current SHA test vector... */
-            rv = (cap->crypto_handler)(tc);
+            rv = acvp_invoke_crypto_handler(ctx, cap, tc);
             if (rv != ACVP_SUCCESS) {
                 ACVP_LOG_ERR("crypto module failed the operation");
                 rv = ACVP_CRYPTO_MODULE_FAIL;
@@ -372,6 +374,289 @@ end:
     return rv;
 }
 
+/*
+ * Digest length (in bytes) of the fixed length hash algorithms, 0 for SHAKE.
+ */
+static unsigned int acvp_hash_md_len(ACVP_CIPHER alg_id) {
+    switch (alg_id) {
+    case ACVP_HASH_SHA1:
+        return ACVP_SHA1_BYTE_LEN;
+    case ACVP_HASH_SHA224:
+    case ACVP_HASH_SHA512_224:
+    case ACVP_HASH_SHA3_224:
+        return ACVP_SHA224_BYTE_LEN;
+    case ACVP_HASH_SHA256:
+    case ACVP_HASH_SHA512_256:
+    case ACVP_HASH_SHA3_256:
+        return ACVP_SHA256_BYTE_LEN;
+    case ACVP_HASH_SHA384:
+    case ACVP_HASH_SHA3_384:
+        return ACVP_SHA384_BYTE_LEN;
+    case ACVP_HASH_SHA512:
+    case ACVP_HASH_SHA3_512:
+        return ACVP_SHA512_BYTE_LEN;
+    default:
+        return 0;
+    }
+}
+
+/*
+ * Runs a whole MCT through the module's MCT handler. The module is given the
+ * seed (and the output length range for SHAKE) and returns the digest ending
+ * each outer iteration, which are checked and written out the same way as
+ * the per-digest loops above.
+ */
+static ACVP_RESULT acvp_hash_module_mct(ACVP_CTX *ctx,
+                                        ACVP_CAPS_LIST *cap,
+                                        ACVP_TEST_CASE *tc,
+                                        ACVP_HASH_TC *stc,
+                                        JSON_Array *res_array,
+                                        unsigned int min_xof_bits,
+                                        unsigned int max_xof_bits) {
+    ACVP_RESULT rv = ACVP_SUCCESS;
+    JSON_Value *r_tval = NULL;  /* Response testval */
+    JSON_Object *r_tobj = NULL; /* Response testobj */
+    unsigned int i = 0, md_len = 0, min_len = 0, max_len = 0;
+    int xof = stc->cipher == ACVP_HASH_SHAKE_128 || stc->cipher == ACVP_HASH_SHAKE_256;
+
+    if (xof) {
+        min_len = min_xof_bits / 8;
+        max_len = max_xof_bits / 8;
+        if (!min_len || min_len > max_len || max_len > ACVP_HASH_XOF_MD_BYTE_MAX) {
+            ACVP_LOG_ERR("Invalid SHAKE MCT output lengths (min %u, max %u bits)",
+                         min_xof_bits, max_xof_bits);
+            return ACVP_INVALID_ARG;
+        }
+        stc->min_xof_bits = min_xof_bits;
+        stc->max_xof_bits = max_xof_bits;
+    } else {
+        min_len = max_len = acvp_hash_md_len(stc->cipher);
+        if (!max_len) {
+            return ACVP_INVALID_ARG;
+        }
+    }
+
+    stc->mct_count = ACVP_HASH_MCT_OUTER;
+    stc->mct_md_max = max_len;
+    stc->mct_md = calloc(stc->mct_count, stc->mct_md_max);
+    stc->mct_md_len = calloc(stc->mct_count, sizeof(unsigned int));
+    if (!stc->mct_md || !stc->mct_md_len) {
+        ACVP_LOG_ERR("Unable to malloc MCT checkpoints");
+        return ACVP_MALLOC_FAIL;
+    }
+
+    if (acvp_invoke_mct_handler(ctx, cap, tc)) {
+        ACVP_LOG_ERR("crypto module failed the MCT");
+        return ACVP_CRYPTO_MODULE_FAIL;
+    }
+
+    for (i = 0; i < stc->mct_count; i++) {
+        md_len = stc->mct_md_len[i];
+        if (md_len < min_len || md_len > max_len) {
+            ACVP_LOG_ERR("crypto module returned a checkpoint %u of %u bytes, expected %u to %u",
+                         i, md_len, min_len, max_len);
+            return ACVP_CRYPTO_MODULE_FAIL;
+        }
+        memcpy_s(stc->md, xof ? ACVP_HASH_XOF_MD_BYTE_MAX : ACVP_HASH_MD_BYTE_MAX,
+                 stc->mct_md + (size_t)i * stc->mct_md_max, md_len);
+        stc->md_len = md_len;
+
+        r_tval = json_value_init_object();
+        r_tobj = json_value_get_object(r_tval);
+        rv = acvp_hash_output_mct_tc(ctx, stc, r_tobj);
+        if (rv != ACVP_SUCCESS) {
+            ACVP_LOG_ERR("JSON output failure");
+            json_value_free(r_tval);
+            return rv;
+        }
+        json_array_append_value(res_array, r_tval);
+    }
+
+    return ACVP_SUCCESS;
+}
+
+/*
+ * Streams a large data test to the module: the content is repeated into one
+ * chunk of about the capability's chunk length, and that chunk is passed to
+ * the module as many times as it takes to cover the full length. The last
+ * update is cut short when the full length is not a multiple of the chunk.
+ */
+static ACVP_RESULT acvp_hash_stream_ldt(ACVP_CTX *ctx,
+                                        ACVP_CAPS_LIST *cap,
+                                        ACVP_TEST_CASE *tc,
+                                        ACVP_HASH_TC *stc) {
+    ACVP_RESULT rv = ACVP_SUCCESS;
+    unsigned char *chunk = NULL;
+    unsigned long long int left = 0;
+    unsigned int i = 0, copies = 0, chunk_len = 0;
+
+    if (!stc->msg_len) {
+        ACVP_LOG_ERR("LDT content is empty");
+        return ACVP_INVALID_ARG;
+    }
+    copies = cap->cap.hash_cap->ldt_chunk_len / stc->msg_len;
+    if (!copies) {
+        copies = 1;
+    }
+    chunk_len = copies * stc->msg_len;
+
+    chunk = acvp_mem_malloc(chunk_len);
+    if (!chunk) {
+        ACVP_LOG_ERR("Unable to malloc LDT chunk of %u bytes", chunk_len);
+        return ACVP_MALLOC_FAIL;
+    }
+    for (i = 0; i < copies; i++) {
+        memcpy_s(chunk + (size_t)i * stc->msg_len, chunk_len - (size_t)i * stc->msg_len,
+                 stc->msg, stc->msg_len);
+    }
+
+    stc->ldt_stage = ACVP_HASH_LDT_INIT;
+    if (acvp_invoke_crypto_handler(ctx, cap, tc)) {
+        rv = ACVP_CRYPTO_MODULE_FAIL;
+        goto end;
+    }
+
+    stc->ldt_stage = ACVP_HASH_LDT_UPDATE;
+    stc->ldt_chunk = chunk;
+    for (left = stc->exp_len; left; left -= stc->ldt_chunk_len) {
+        stc->ldt_chunk_len = left < chunk_len ? (unsigned int)left : chunk_len;
+        if (acvp_invoke_crypto_handler(ctx, cap, tc)) {
+            rv = ACVP_CRYPTO_MODULE_FAIL;
+            break;
+        }
+    }
+
+    /* Always finish, so the module can let go of its state */
+    stc->ldt_stage = ACVP_HASH_LDT_FINAL;
+    stc->ldt_chunk = NULL;
+    stc->ldt_chunk_len = 0;
+    if (acvp_invoke_crypto_handler(ctx, cap, tc)) {
+        rv = ACVP_CRYPTO_MODULE_FAIL;
+    }
+
+end:
+    acvp_mem_free(chunk);
+    return rv;
+}
+
+/*
+ * An AFT test case waiting for its group to be handed to the batch handler,
+ * with the response object it will be written to.
+ */
+typedef struct acvp_hash_pending_t {
+    ACVP_HASH_TC stc;
+    JSON_Value *r_tval;
+    unsigned int blocks;  /* length class: blocks taken by the padded message */
+} ACVP_HASH_PENDING;
+
+/*
+ * Number of compression function (or permutation) calls needed for a message
+ * of msg_len bytes once padded, which is what decides whether messages can
+ * share the lanes of a multi-buffer implementation.
+ */
+static unsigned int acvp_hash_padded_blocks(ACVP_CIPHER alg_id, unsigned int msg_len) {
+    switch (alg_id) {
+    case ACVP_HASH_SHA1:
+    case ACVP_HASH_SHA224:
+    case ACVP_HASH_SHA256:
+        return (msg_len + 9 + 63) / 64;
+    case ACVP_HASH_SHA384:
+    case ACVP_HASH_SHA512:
+    case ACVP_HASH_SHA512_224:
+    case ACVP_HASH_SHA512_256:
+        return (msg_len + 17 + 127) / 128;
+    case ACVP_HASH_SHA3_224:
+        return msg_len / 144 + 1;
+    case ACVP_HASH_SHA3_256:
+    case ACVP_HASH_SHAKE_256:
+        return msg_len / 136 + 1;
+    case ACVP_HASH_SHA3_384:
+        return msg_len / 104 + 1;
+    case ACVP_HASH_SHA3_512:
+        return msg_len / 72 + 1;
+    case ACVP_HASH_SHAKE_128:
+        return msg_len / 168 + 1;
+    default:
+        return 1;
+    }
+}
+
+/* Shortest padded messages first; the server's order among equals */
+static int acvp_hash_pending_cmp(const void *a, const void *b) {
+    const ACVP_HASH_PENDING *pa = *(ACVP_HASH_PENDING *const *)a;
+    const ACVP_HASH_PENDING *pb = *(ACVP_HASH_PENDING *const *)b;
+
+    if (pa->blocks != pb->blocks) {
+        return pa->blocks < pb->blocks ? -1 : 1;
+    }
+    return pa < pb ? -1 : (pa > pb);
+}
+
+/*
+ * Hands a group's AFT test cases to the batch handler, at most
+ * ACVP_HASH_BATCH_MAX at a time and all of one length class per call, then
+ * writes the responses in the server's order. Every pending test case is
+ * released, and its response either appended to r_tarr or freed.
+ */
+static ACVP_RESULT acvp_hash_run_batch(ACVP_CTX *ctx,
+                                       ACVP_CAPS_LIST *cap,
+                                       ACVP_HASH_PENDING *pending,
+                                       unsigned int count,
+                                       JSON_Array *r_tarr) {
+    ACVP_RESULT rv = ACVP_SUCCESS;
+    ACVP_HASH_PENDING **order = NULL;
+    ACVP_TEST_CASE *tcs = NULL;
+    unsigned int i = 0, start = 0, n = 0;
+
+    order = calloc(count, sizeof(ACVP_HASH_PENDING *));
+    tcs = calloc(count < ACVP_HASH_BATCH_MAX ? count : ACVP_HASH_BATCH_MAX, sizeof(ACVP_TEST_CASE));
+    if (!order || !tcs) {
+        ACVP_LOG_ERR("Unable to malloc hash batch of %u test cases", count);
+        rv = ACVP_MALLOC_FAIL;
+        goto end;
+    }
+    for (i = 0; i < count; i++) {
+        pending[i].blocks = acvp_hash_padded_blocks(pending[i].stc.cipher, pending[i].stc.msg_len);
+        order[i] = &pending[i];
+    }
+    qsort(order, count, sizeof(ACVP_HASH_PENDING *), acvp_hash_pending_cmp);
+
+    i = 0;
+    for (start = 0; start < count; start += n) {
+        for (n = 0; start + n < count && n < ACVP_HASH_BATCH_MAX &&
+                    order[start + n]->blocks == order[start]->blocks; n++) {
+            tcs[n].tc.hash = &order[start + n]->stc;
+        }
+        if (acvp_invoke_batch_handler(ctx, cap, tcs, n)) {
+            ACVP_LOG_ERR("crypto module failed a batch of %u test cases", n);
+            rv = ACVP_CRYPTO_MODULE_FAIL;
+            goto end;
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+        rv = acvp_hash_output_tc(ctx, &pending[i].stc, json_value_get_object(pending[i].r_tval));
+        if (rv != ACVP_SUCCESS) {
+            ACVP_LOG_ERR("JSON output failure in hash module");
+            goto end;
+        }
+        acvp_hash_release_tc(&pending[i].stc);
+        json_array_append_value(r_tarr, pending[i].r_tval);
+        pending[i].r_tval = NULL;
+        acvp_progress_tc_done(ctx);
+    }
+
+end:
+    for (; i < count; i++) {
+        acvp_hash_release_tc(&pending[i].stc);
+        json_value_free(pending[i].r_tval);
+        pending[i].r_tval = NULL;
+    }
+    if (order) free(order);
+    if (tcs) free(tcs);
+    return rv;
+}
+
 static ACVP_HASH_TESTTYPE read_test_type(const char *tt_str) {
     int diff = 0;
 
@@ -409,6 +694,54 @@ static ACVP_HASH_EXPANSION_METHOD read_exp_method(const char *exp_str) {
     return 0;
 }
 
+/* Runs one MCT test case with whichever loop suits the algorithm and module */
+static ACVP_RESULT acvp_hash_run_mct(ACVP_CTX *ctx,
+                                     ACVP_CAPS_LIST *cap,
+                                     ACVP_TEST_CASE *tc,
+                                     ACVP_HASH_TC *stc,
+                                     JSON_Array *res_tarr,
+                                     unsigned int min_xof_len,
+                                     unsigned int max_xof_len) {
+    ACVP_CIPHER alg_id = stc->cipher;
+
+    if (cap->mct_handler) {
+        return acvp_hash_module_mct(ctx, cap, tc, stc, res_tarr, min_xof_len, max_xof_len);
+    } else if (alg_id == ACVP_HASH_SHA3_224 || alg_id == ACVP_HASH_SHA3_256 ||
+               alg_id == ACVP_HASH_SHA3_384 || alg_id == ACVP_HASH_SHA3_512) {
+        return acvp_hash_sha3_mct(ctx, cap, tc, stc, res_tarr);
+    } else if (alg_id == ACVP_HASH_SHAKE_128 || alg_id == ACVP_HASH_SHAKE_256) {
+        return acvp_hash_shake_mct(ctx, cap, tc, stc, res_tarr, min_xof_len, max_xof_len);
+    }
+    return acvp_hash_mct_tc(ctx, cap, tc, stc, res_tarr);
+}
+
+/*
+ * An MCT test case set aside to run on the worker pool (acvp_mct_pool.c),
+ * with the response array it fills in. Every hash MCT loop starts a fresh
+ * digest per handler call, so any handler can be used from the workers.
+ */
+typedef struct acvp_hash_mct_job_t {
+    ACVP_CAPS_LIST *cap;
+    ACVP_HASH_TC stc;
+    JSON_Array *res_tarr;
+    unsigned int min_xof_len;
+    unsigned int max_xof_len;
+} ACVP_HASH_MCT_JOB;
+
+static ACVP_RESULT acvp_hash_mct_job(ACVP_CTX *ctx, void *arg) {
+    ACVP_HASH_MCT_JOB *job = arg;
+    ACVP_TEST_CASE tc;
+    ACVP_RESULT rv = ACVP_SUCCESS;
+
+    tc.tc.hash = &job->stc;
+    rv = acvp_hash_run_mct(ctx, job->cap, &tc, &job->stc, job->res_tarr,
+                           job->min_xof_len, job->max_xof_len);
+    if (rv != ACVP_SUCCESS) {
+        ACVP_LOG_ERR("crypto module failed the HASH MCT operation (tcId %u)", job->stc.tc_id);
+    }
+    return rv;
+}
+
 ACVP_RESULT acvp_hash_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
     unsigned int tc_id, msglen;
     JSON_Value *groupval;
@@ -435,10 +768,14 @@ ACVP_RESULT acvp_hash_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
     ACVP_HASH_TC stc;
     ACVP_TEST_CASE tc;
     JSON_Array *res_tarr = NULL; /* Response resultsArray */
+    ACVP_HASH_PENDING *pending = NULL; /* AFT test cases waiting for the batch handler */
+    unsigned int pend_cnt = 0;
+    ACVP_MCT_JOBS mct_jobs = { NULL, sizeof(ACVP_HASH_MCT_JOB), 0, 0 };
+    ACVP_HASH_MCT_JOB *job = NULL;
+    unsigned int k = 0;
     ACVP_RESULT rv = ACVP_SUCCESS;
     ACVP_CIPHER alg_id = 0;
     ACVP_HASH_EXPANSION_METHOD exp_method = 0;
-    char *json_result = NULL;
     const char *alg_str = NULL;
     const char *test_type_str, *msg = NULL;
     const char *exp_method_str = NULL;
@@ -561,6 +898,15 @@ ACVP_RESULT acvp_hash_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
         tests = json_object_get_array(groupobj, "tests");
         t_cnt = json_array_get_count(tests);
 
+        if (test_type == ACVP_HASH_TEST_TYPE_AFT && cap->batch_handler && t_cnt > 0) {
+            pending = calloc(t_cnt, sizeof(ACVP_HASH_PENDING));
+            if (!pending) {
+                ACVP_LOG_ERR("Unable to malloc hash batch of %d test cases", t_cnt);
+                rv = ACVP_MALLOC_FAIL;
+                goto err;
+            }
+        }
+
         for (j = 0; j < t_cnt; j++) {
             unsigned int tmp_msg_len = 0;
             unsigned int xof_len = 0;
@@ -681,21 +1027,41 @@ ACVP_RESULT acvp_hash_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
                 goto err;
             }
 
+            if (pending) {
+                /* Digested together once the whole group has been read */
+                pending[pend_cnt].stc = stc;
+                pending[pend_cnt].r_tval = r_tval;
+                pend_cnt++;
+                continue;
+            }
+
+            if (stc.test_type == ACVP_HASH_TEST_TYPE_MCT && ctx->mct_threads > 1) {
+                /* Run with the others once the whole vector set is read; the response keeps its place */
+                job = acvp_mct_jobs_next(&mct_jobs);
+                if (!job) {
+                    ACVP_LOG_ERR("Unable to malloc HASH MCT job");
+                    acvp_hash_release_tc(&stc);
+                    json_value_free(r_tval);
+                    rv = ACVP_MALLOC_FAIL;
+                    goto err;
+                }
+                json_object_set_value(r_tobj, "resultsArray", json_value_init_array());
+                job->cap = cap;
+                job->stc = stc;
+                job->res_tarr = json_object_get_array(r_tobj, "resultsArray");
+                job->min_xof_len = min_xof_len;
+                job->max_xof_len = max_xof_len;
+                mct_jobs.count++;
+                json_array_append_value(r_tarr, r_tval);
+                continue;
+            }
+
             /* If Monte Carlo start that here */
             if (stc.test_type == ACVP_HASH_TEST_TYPE_MCT) {
                 json_object_set_value(r_tobj, "resultsArray", json_value_init_array());
                 res_tarr = json_object_get_array(r_tobj, "resultsArray");
 
-                if (alg_id == ACVP_HASH_SHA3_224 || alg_id == ACVP_HASH_SHA3_256 ||
-                    alg_id == ACVP_HASH_SHA3_384 || alg_id == ACVP_HASH_SHA3_512) {
-                    rv = acvp_hash_sha3_mct(ctx, cap, &tc, &stc, res_tarr);
-                } else if (alg_id == ACVP_HASH_SHAKE_128 || alg_id == ACVP_HASH_SHAKE_256) {
-                    rv = acvp_hash_shake_mct(ctx, cap, &tc, &stc,
-                                             res_tarr, min_xof_len, max_xof_len);
-                } else {
-                    rv = acvp_hash_mct_tc(ctx, cap, &tc, &stc, res_tarr);
-                }
-
+                rv = acvp_hash_run_mct(ctx, cap, &tc, &stc, res_tarr, min_xof_len, max_xof_len);
                 if (rv != ACVP_SUCCESS) {
                     ACVP_LOG_ERR("crypto module failed the HASH MCT operation");
                     acvp_hash_release_tc(&stc);
@@ -704,11 +1070,16 @@ ACVP_RESULT acvp_hash_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
                 }
             } else {
                 /* Process the current test vector... */
-                if ((cap->crypto_handler)(&tc)) {
+                if (stc.test_type == ACVP_HASH_TEST_TYPE_LDT && cap->cap.hash_cap &&
+                        cap->cap.hash_cap->ldt_chunk_len) {
+                    rv = acvp_hash_stream_ldt(ctx, cap, &tc, &stc);
+                } else if (acvp_invoke_crypto_handler(ctx, cap, &tc)) {
+                    rv = ACVP_CRYPTO_MODULE_FAIL;
+                }
+                if (rv != ACVP_SUCCESS) {
                     ACVP_LOG_ERR("crypto module failed the operation");
                     acvp_hash_release_tc(&stc);
                     json_value_free(r_tval);
-                    rv = ACVP_CRYPTO_MODULE_FAIL;
                     goto err;
                 }
 
@@ -730,18 +1101,50 @@ ACVP_RESULT acvp_hash_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
 
             /* Append the test response value to array */
             json_array_append_value(r_tarr, r_tval);
+            acvp_progress_tc_done(ctx);
+        }
+        if (pending) {
+            rv = acvp_hash_run_batch(ctx, cap, pending, pend_cnt, r_tarr);
+            free(pending);
+            pending = NULL;
+            pend_cnt = 0;
+            if (rv != ACVP_SUCCESS) {
+                goto err;
+            }
         }
         json_array_append_value(r_garr, r_gval);
     }
+    r_gval = NULL;
+
+    if (mct_jobs.count) {
+        rv = acvp_mct_jobs_run(ctx, cap, &mct_jobs, acvp_hash_mct_job);
+        if (rv != ACVP_SUCCESS) {
+            goto err;
+        }
+        for (k = 0; k < mct_jobs.count; k++) {
+            acvp_progress_tc_done(ctx);
+        }
+    }
 
     json_array_append_value(reg_arry, r_vs_val);
 
-    json_result = json_serialize_to_string_pretty(ctx->kat_resp, NULL);
-    ACVP_LOG_VERBOSE("\n\n%s\n\n", json_result);
-    json_free_serialized_string(json_result);
+    ACVP_LOG_VERBOSE_JSON(ctx->kat_resp);
     rv = ACVP_SUCCESS;
 
 err:
+    for (k = 0; k < mct_jobs.count; k++) {
+        job = (ACVP_HASH_MCT_JOB *)mct_jobs.jobs + k;
+        acvp_hash_release_tc(&job->stc);
+    }
+    acvp_mct_jobs_free(&mct_jobs);
+    if (pending) {
+        while (pend_cnt) {
+            pend_cnt--;
+            acvp_hash_release_tc(&pending[pend_cnt].stc);
+            json_value_free(pending[pend_cnt].r_tval);
+        }
+        free(pending);
+    }
     if (rv != ACVP_SUCCESS) {
         acvp_release_json(r_vs_val, r_gval);
     }
@@ -882,6 +1285,9 @@ static ACVP_RESULT acvp_hash_release_tc(ACVP_HASH_TC *stc) {
     if (stc->m1) free(stc->m1);
     if (stc->m2) free(stc->m2);
     if (stc->m3) free(stc->m3);
+    if (stc->mct_md) free(stc->mct_md);
+    if (stc->mct_md_len) free(stc->mct_md_len);
+    acvp_hash_ldt_unmap(stc);
     memzero_s(stc, sizeof(ACVP_HASH_TC));
 
     return ACVP_SUCCESS;
@@ -0,0 +1,346 @@
+/** @file */
+/*
+ * Copyright (c) 2024, Cisco Systems, Inc.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://github.com/cisco/libacvp/LICENSE
+ */
+
+/*
+ * Hex string <-> binary conversion.
+ *
+ * Every key, message and digest in every test case passes through these, so
+ * the bulk of each buffer is handled by a vector kernel picked once at
+ * runtime (AVX2 or SSSE3 on x86 with GCC/clang, NEON on aarch64) and the
+ * remainder by table driven scalar code. The kernels stop at the first block
+ * containing a character that is not a hex digit and leave it to the scalar
+ * code, which is the single place an invalid string gets rejected.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "acvp.h"
+#include "acvp_lcl.h"
+#include "safe_lib.h"
+
+#if defined(__GNUC__) && (__GNUC__ >= 5 || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define ACVP_HEX_USE_X86
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define ACVP_HEX_USE_NEON
+#endif
+
+typedef size_t (*ACVP_HEX_ENCODE_FN)(const unsigned char *src, size_t len, char *dest);
+typedef size_t (*ACVP_HEX_DECODE_FN)(const char *src, size_t len, unsigned char *dest);
+
+static int acvp_hex_simd = 1;
+static ACVP_HEX_ENCODE_FN acvp_hex_encode_fn = NULL;
+static ACVP_HEX_DECODE_FN acvp_hex_decode_fn = NULL;
+
+static const char acvp_hex_digits[] = "0123456789ABCDEF";
+
+/* Nibble value of each character, -1 for anything that is not a hex digit */
+static const signed char acvp_hex_values[256] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+    -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+
+static size_t acvp_hex_encode_none(const unsigned char *src, size_t len, char *dest) {
+    (void)src;
+    (void)len;
+    (void)dest;
+    return 0;
+}
+
+static size_t acvp_hex_decode_none(const char *src, size_t len, unsigned char *dest) {
+    (void)src;
+    (void)len;
+    (void)dest;
+    return 0;
+}
+
+#ifdef ACVP_HEX_USE_X86
+/*
+ * Nibble value of each character; ok is set to 0xFF in every lane holding a
+ * hex digit. Folding in 0x20 lower cases letters and never turns anything
+ * else into one.
+ */
+__attribute__((target("ssse3")))
+static inline __m128i acvp_hex_nibbles_ssse3(__m128i v, __m128i *ok) {
+    __m128i d = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+    __m128i l = _mm_sub_epi8(_mm_or_si128(v, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    __m128i dok = _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d);
+    __m128i lok = _mm_cmpeq_epi8(_mm_min_epu8(l, _mm_set1_epi8(5)), l);
+
+    *ok = _mm_or_si128(dok, lok);
+    return _mm_or_si128(_mm_and_si128(d, dok),
+                        _mm_and_si128(_mm_add_epi8(l, _mm_set1_epi8(10)), lok));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i acvp_hex_nibbles_avx2(__m256i v, __m256i *ok) {
+    __m256i d = _mm256_sub_epi8(v, _mm256_set1_epi8('0'));
+    __m256i l = _mm256_sub_epi8(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    __m256i dok = _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(9)), d);
+    __m256i lok = _mm256_cmpeq_epi8(_mm256_min_epu8(l, _mm256_set1_epi8(5)), l);
+
+    *ok = _mm256_or_si256(dok, lok);
+    return _mm256_or_si256(_mm256_and_si256(d, dok),
+                           _mm256_and_si256(_mm256_add_epi8(l, _mm256_set1_epi8(10)), lok));
+}
+
+__attribute__((target("ssse3")))
+static size_t acvp_hex_encode_ssse3(const unsigned char *src, size_t len, char *dest) {
+    const __m128i digits = _mm_loadu_si128((const __m128i *)acvp_hex_digits);
+    const __m128i low = _mm_set1_epi8(0x0F);
+    __m128i v, hi, lo;
+    size_t i = 0;
+
+    for (i = 0; i + 16 <= len; i += 16) {
+        v = _mm_loadu_si128((const __m128i *)(src + i));
+        hi = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(v, 4), low));
+        lo = _mm_shuffle_epi8(digits, _mm_and_si128(v, low));
+        _mm_storeu_si128((__m128i *)(dest + 2 * i), _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128((__m128i *)(dest + 2 * i + 16), _mm_unpackhi_epi8(hi, lo));
+    }
+    return i;
+}
+
+__attribute__((target("ssse3")))
+static size_t acvp_hex_decode_ssse3(const char *src, size_t len, unsigned char *dest) {
+    const __m128i weights = _mm_set1_epi16(0x0110); /* high char * 16 + low char */
+    __m128i a, b, va, vb, oka, okb;
+    size_t i = 0;
+
+    for (i = 0; i + 16 <= len; i += 16) {
+        a = _mm_loadu_si128((const __m128i *)(src + 2 * i));
+        b = _mm_loadu_si128((const __m128i *)(src + 2 * i + 16));
+        va = acvp_hex_nibbles_ssse3(a, &oka);
+        vb = acvp_hex_nibbles_ssse3(b, &okb);
+        if (_mm_movemask_epi8(_mm_and_si128(oka, okb)) != 0xFFFF) {
+            break;
+        }
+        _mm_storeu_si128((__m128i *)(dest + i),
+                         _mm_packus_epi16(_mm_maddubs_epi16(va, weights),
+                                          _mm_maddubs_epi16(vb, weights)));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t acvp_hex_encode_avx2(const unsigned char *src, size_t len, char *dest) {
+    const __m256i digits = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)acvp_hex_digits));
+    const __m256i low = _mm256_set1_epi8(0x0F);
+    __m256i v, hi, lo, first, second;
+    size_t i = 0;
+
+    for (i = 0; i + 32 <= len; i += 32) {
+        v = _mm256_loadu_si256((const __m256i *)(src + i));
+        hi = _mm256_shuffle_epi8(digits, _mm256_and_si256(_mm256_srli_epi16(v, 4), low));
+        lo = _mm256_shuffle_epi8(digits, _mm256_and_si256(v, low));
+        /* The unpacks work within each 128 bit lane; put the lanes back in order */
+        first = _mm256_unpacklo_epi8(hi, lo);
+        second = _mm256_unpackhi_epi8(hi, lo);
+        _mm256_storeu_si256((__m256i *)(dest + 2 * i), _mm256_permute2x128_si256(first, second, 0x20));
+        _mm256_storeu_si256((__m256i *)(dest + 2 * i + 32), _mm256_permute2x128_si256(first, second, 0x31));
+    }
+    return i + acvp_hex_encode_ssse3(src + i, len - i, dest + 2 * i);
+}
+
+__attribute__((target("avx2")))
+static size_t acvp_hex_decode_avx2(const char *src, size_t len, unsigned char *dest) {
+    const __m256i weights = _mm256_set1_epi16(0x0110);
+    __m256i a, b, va, vb, oka, okb, packed;
+    size_t i = 0;
+
+    for (i = 0; i + 32 <= len; i += 32) {
+        a = _mm256_loadu_si256((const __m256i *)(src + 2 * i));
+        b = _mm256_loadu_si256((const __m256i *)(src + 2 * i + 32));
+        va = acvp_hex_nibbles_avx2(a, &oka);
+        vb = acvp_hex_nibbles_avx2(b, &okb);
+        if (_mm256_movemask_epi8(_mm256_and_si256(oka, okb)) != -1) {
+            break;
+        }
+        packed = _mm256_packus_epi16(_mm256_maddubs_epi16(va, weights),
+                                     _mm256_maddubs_epi16(vb, weights));
+        _mm256_storeu_si256((__m256i *)(dest + i), _mm256_permute4x64_epi64(packed, 0xD8));
+    }
+    return i + acvp_hex_decode_ssse3(src + 2 * i, len - i, dest + i);
+}
+#endif
+
+#ifdef ACVP_HEX_USE_NEON
+static size_t acvp_hex_encode_neon(const unsigned char *src, size_t len, char *dest) {
+    const uint8x16_t digits = vld1q_u8((const uint8_t *)acvp_hex_digits);
+    const uint8x16_t low = vdupq_n_u8(0x0F);
+    uint8x16x2_t out;
+    uint8x16_t v;
+    size_t i = 0;
+
+    for (i = 0; i + 16 <= len; i += 16) {
+        v = vld1q_u8(src + i);
+        out.val[0] = vqtbl1q_u8(digits, vshrq_n_u8(v, 4));
+        out.val[1] = vqtbl1q_u8(digits, vandq_u8(v, low));
+        vst2q_u8((uint8_t *)(dest + 2 * i), out);
+    }
+    return i;
+}
+
+static uint8x16_t acvp_hex_nibbles_neon(uint8x16_t v, uint8x16_t *ok) {
+    uint8x16_t d = vsubq_u8(v, vdupq_n_u8('0'));
+    uint8x16_t l = vsubq_u8(vorrq_u8(v, vdupq_n_u8(0x20)), vdupq_n_u8('a'));
+    uint8x16_t dok = vcleq_u8(d, vdupq_n_u8(9));
+    uint8x16_t lok = vcleq_u8(l, vdupq_n_u8(5));
+
+    *ok = vorrq_u8(dok, lok);
+    return vbslq_u8(dok, d, vaddq_u8(l, vdupq_n_u8(10)));
+}
+
+static size_t acvp_hex_decode_neon(const char *src, size_t len, unsigned char *dest) {
+    uint8x16x2_t in;
+    uint8x16_t hi, lo, okh, okl;
+    size_t i = 0;
+
+    for (i = 0; i + 16 <= len; i += 16) {
+        /* De-interleaves high and low nibble characters */
+        in = vld2q_u8((const uint8_t *)(src + 2 * i));
+        hi = acvp_hex_nibbles_neon(in.val[0], &okh);
+        lo = acvp_hex_nibbles_neon(in.val[1], &okl);
+        if (vminvq_u8(vandq_u8(okh, okl)) != 0xFF) {
+            break;
+        }
+        vst1q_u8(dest + i, vorrq_u8(vshlq_n_u8(hi, 4), lo));
+    }
+    return i;
+}
+#endif
+
+static void acvp_hex_select(void) {
+    /* Selected once; racing threads would all store the same pointers */
+    if (acvp_hex_encode_fn) {
+        return;
+    }
+#if defined(ACVP_HEX_USE_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        acvp_hex_decode_fn = acvp_hex_decode_avx2;
+        acvp_hex_encode_fn = acvp_hex_encode_avx2;
+    } else if (__builtin_cpu_supports("ssse3")) {
+        acvp_hex_decode_fn = acvp_hex_decode_ssse3;
+        acvp_hex_encode_fn = acvp_hex_encode_ssse3;
+    } else {
+        acvp_hex_decode_fn = acvp_hex_decode_none;
+        acvp_hex_encode_fn = acvp_hex_encode_none;
+    }
+#elif defined(ACVP_HEX_USE_NEON)
+    acvp_hex_decode_fn = acvp_hex_decode_neon;
+    acvp_hex_encode_fn = acvp_hex_encode_neon;
+#else
+    acvp_hex_decode_fn = acvp_hex_decode_none;
+    acvp_hex_encode_fn = acvp_hex_encode_none;
+#endif
+}
+
+void acvp_hex_set_simd(int enable) {
+    acvp_hex_simd = enable;
+}
+
+/*
+ * Convert a byte array from source to a hexadecimal string which is
+ * stored in the destination.
+ */
+ACVP_RESULT acvp_bin_to_hexstr(const unsigned char *src, int src_len, char *dest, int dest_max) {
+    size_t i = 0, len = 0;
+
+    if (!src || !dest) {
+        return ACVP_CONVERT_DATA_ERR;
+    }
+
+    if ((src_len * 2) > dest_max) {
+        return ACVP_CONVERT_DATA_ERR;
+    }
+
+    len = src_len > 0 ? (size_t)src_len : 0;
+    if (acvp_hex_simd) {
+        acvp_hex_select();
+        i = acvp_hex_encode_fn(src, len, dest);
+    }
+    for (; i < len; i++) {
+        dest[2 * i] = acvp_hex_digits[src[i] >> 4];
+        dest[2 * i + 1] = acvp_hex_digits[src[i] & 0x0F];
+    }
+    dest[2 * len] = '\0';
+
+    return ACVP_SUCCESS;
+}
+
+/*
+ * Convert a source hexadecimal string to a byte array which is stored
+ * in the destination. Anything other than 0-9, a-f and A-F is rejected.
+ * TODO: Enable the function to handle odd number of hex characters
+ */
+ACVP_RESULT acvp_hexstr_to_bin(const char *src, unsigned char *dest, int dest_max, int *converted_len) {
+    const unsigned char *s = (const unsigned char *)src;
+    size_t src_len = 0, max = 0, len = 0, i = 0;
+    int hi = 0, lo = 0;
+
+    if (!src || !dest) {
+        return ACVP_INVALID_ARG;
+    }
+
+    /*
+     * Only look as far as a string that fits could reach, so an oversized
+     * value is caught without walking all of it
+     */
+    max = dest_max > 0 ? 2 * (size_t)dest_max + 1 : 1;
+    if (max > ACVP_HEXSTR_MAX) {
+        max = ACVP_HEXSTR_MAX;
+    }
+    src_len = strnlen_s(src, max);
+
+    /*
+     * Make sure the hex value isn't too large
+     */
+    if (src_len > 2 * (size_t)(dest_max > 0 ? dest_max : 0) || src[src_len] != '\0') {
+        return ACVP_DATA_TOO_LARGE;
+    }
+
+    if (src_len & 1) {
+        return ACVP_UNSUPPORTED_OP;
+    }
+
+    len = src_len / 2;
+    if (acvp_hex_simd) {
+        acvp_hex_select();
+        i = acvp_hex_decode_fn(src, len, dest);
+    }
+    for (; i < len; i++) {
+        hi = acvp_hex_values[s[2 * i]];
+        lo = acvp_hex_values[s[2 * i + 1]];
+        if ((hi | lo) < 0) {
+            return ACVP_CONVERT_DATA_ERR;
+        }
+        dest[i] = (unsigned char)((hi << 4) | lo);
+    }
+
+    if (converted_len) *converted_len = (int)len;
+    return ACVP_SUCCESS;
+}
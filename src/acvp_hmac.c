@@ -19,6 +19,7 @@
 
 static ACVP_RESULT acvp_hmac_init_tc(ACVP_CTX *ctx,
                                      ACVP_HMAC_TC *stc,
+                                     ACVP_SCRATCH *scratch,
                                      unsigned int tc_id,
                                      unsigned int msg_len,
                                      const char *msg,
@@ -30,20 +31,22 @@ static ACVP_RESULT acvp_hmac_init_tc(ACVP_CTX *ctx,
 
     memzero_s(stc, sizeof(ACVP_HMAC_TC));
 
-    stc->msg = calloc(1, ACVP_HMAC_MSG_MAX);
-    if (!stc->msg) { return ACVP_MALLOC_FAIL; }
-    stc->mac = calloc(1, ACVP_HMAC_MAC_BYTE_MAX);
-    if (!stc->mac) { return ACVP_MALLOC_FAIL; }
-    stc->key = calloc(1, ACVP_HMAC_KEY_BYTE_MAX);
-    if (!stc->key) { return ACVP_MALLOC_FAIL; }
+    /* The lengths have been checked against the strings already */
+    rv = acvp_scratch_reserve(scratch, acvp_scratch_round(msg_len / 8) +
+                                       acvp_scratch_round(ACVP_HMAC_MAC_BYTE_MAX) +
+                                       acvp_scratch_round(key_len / 8));
+    if (rv != ACVP_SUCCESS) { return rv; }
+    stc->msg = acvp_scratch_alloc(scratch, msg_len / 8);
+    stc->mac = acvp_scratch_alloc(scratch, ACVP_HMAC_MAC_BYTE_MAX);
+    stc->key = acvp_scratch_alloc(scratch, key_len / 8);
 
-    rv = acvp_hexstr_to_bin(msg, stc->msg, ACVP_HMAC_MSG_MAX, NULL);
+    rv = acvp_hexstr_to_bin(msg, stc->msg, msg_len / 8, NULL);
     if (rv != ACVP_SUCCESS) {
         ACVP_LOG_ERR("Hex converstion failure (msg)");
         return rv;
     }
 
-    rv = acvp_hexstr_to_bin(key, stc->key, ACVP_HMAC_KEY_BYTE_MAX, NULL);
+    rv = acvp_hexstr_to_bin(key, stc->key, key_len / 8, NULL);
     if (rv != ACVP_SUCCESS) {
         ACVP_LOG_ERR("Hex converstion failure (key)");
         return rv;
@@ -92,14 +95,66 @@ end:
  * a test case.
  */
 static ACVP_RESULT acvp_hmac_release_tc(ACVP_HMAC_TC *stc) {
-    free(stc->msg);
-    free(stc->mac);
-    free(stc->key);
+    /* The buffers belong to the handler's scratch area */
     memzero_s(stc, sizeof(ACVP_HMAC_TC));
 
     return ACVP_SUCCESS;
 }
 
+/*
+ * A test case waiting to be handed to the batch handler, with the response
+ * object it will be written to. Its buffers are in the batch's scratch area.
+ */
+typedef struct acvp_hmac_pending_t {
+    ACVP_HMAC_TC stc;
+    JSON_Value *r_tval;
+} ACVP_HMAC_PENDING;
+
+/*
+ * Hands count pending test cases to the batch handler in one call and writes
+ * their responses, in the server's order. Every pending test case is
+ * released, and its response either appended to r_tarr or freed.
+ */
+static ACVP_RESULT acvp_hmac_run_batch(ACVP_CTX *ctx,
+                                       ACVP_CAPS_LIST *cap,
+                                       ACVP_HMAC_PENDING *pending,
+                                       unsigned int count,
+                                       JSON_Array *r_tarr) {
+    ACVP_RESULT rv = ACVP_SUCCESS;
+    ACVP_TEST_CASE tcs[ACVP_MAC_BATCH_MAX];
+    unsigned int i = 0;
+
+    for (i = 0; i < count; i++) {
+        tcs[i].tc.hmac = &pending[i].stc;
+    }
+    i = 0;
+    if (acvp_invoke_batch_handler(ctx, cap, tcs, count)) {
+        ACVP_LOG_ERR("ERROR: crypto module failed a batch of %u test cases", count);
+        rv = ACVP_CRYPTO_MODULE_FAIL;
+        goto end;
+    }
+
+    for (i = 0; i < count; i++) {
+        rv = acvp_hmac_output_tc(ctx, &pending[i].stc, json_value_get_object(pending[i].r_tval));
+        if (rv != ACVP_SUCCESS) {
+            ACVP_LOG_ERR("ERROR: JSON output failure in hmac module");
+            goto end;
+        }
+        acvp_hmac_release_tc(&pending[i].stc);
+        json_array_append_value(r_tarr, pending[i].r_tval);
+        pending[i].r_tval = NULL;
+        acvp_progress_tc_done(ctx);
+    }
+
+end:
+    for (; i < count; i++) {
+        acvp_hmac_release_tc(&pending[i].stc);
+        json_value_free(pending[i].r_tval);
+        pending[i].r_tval = NULL;
+    }
+    return rv;
+}
+
 ACVP_RESULT acvp_hmac_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
     unsigned int tc_id = 0, msglen = 0, keylen = 0, maclen = 0;
     const char *msg = NULL, *key = NULL;
@@ -124,11 +179,13 @@ ACVP_RESULT acvp_hmac_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
     JSON_Object *r_tobj = NULL, *r_gobj = NULL; /* Response testobj, groupobj */
     ACVP_CAPS_LIST *cap;
     ACVP_HMAC_TC stc;
+    ACVP_SCRATCH scratch = { 0 };
+    ACVP_HMAC_PENDING *pending = NULL;  /* test cases waiting for the batch handler */
+    unsigned int pend_cnt = 0;
     ACVP_TEST_CASE tc;
     ACVP_RESULT rv;
     const char *alg_str = json_object_get_string(obj, "algorithm");
     ACVP_CIPHER alg_id;
-    char *json_result;
 
     if (!ctx) {
         ACVP_LOG_ERR("No ctx for handler operation");
@@ -182,6 +239,16 @@ ACVP_RESULT acvp_hmac_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
         return rv;
     }
 
+    if (cap->batch_handler) {
+        pending = calloc(ACVP_MAC_BATCH_MAX, sizeof(ACVP_HMAC_PENDING));
+        if (!pending) {
+            ACVP_LOG_ERR("Unable to malloc HMAC batch");
+            rv = ACVP_MALLOC_FAIL;
+            goto err;
+        }
+        scratch.batch_min = ACVP_MAC_BATCH_SCRATCH;
+    }
+
     groups = json_object_get_array(obj, "testGroups");
     if (!groups) {
         ACVP_LOG_ERR("Failed to include testGroups. ");
@@ -307,15 +374,40 @@ ACVP_RESULT acvp_hmac_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
              * Setup the test case data that will be passed down to
              * the crypto module.
              */
-            rv = acvp_hmac_init_tc(ctx, &stc, tc_id, msglen, msg, maclen, keylen, key, alg_id);
+            rv = acvp_hmac_init_tc(ctx, &stc, &scratch, tc_id, msglen, msg, maclen, keylen, key, alg_id);
+            if (rv == ACVP_DATA_TOO_LARGE && pend_cnt) {
+                /* The batch's buffers are full; run it and start the next one */
+                rv = acvp_hmac_run_batch(ctx, cap, pending, pend_cnt, r_tarr);
+                pend_cnt = 0;
+                acvp_scratch_reset(&scratch);
+                if (rv == ACVP_SUCCESS) {
+                    rv = acvp_hmac_init_tc(ctx, &stc, &scratch, tc_id, msglen, msg, maclen, keylen,
+                                           key, alg_id);
+                }
+            }
             if (rv != ACVP_SUCCESS) {
                 acvp_hmac_release_tc(&stc);
                 json_value_free(r_tval);
                 goto err;
             }
 
+            if (pending) {
+                pending[pend_cnt].stc = stc;
+                pending[pend_cnt].r_tval = r_tval;
+                pend_cnt++;
+                if (pend_cnt == ACVP_MAC_BATCH_MAX) {
+                    rv = acvp_hmac_run_batch(ctx, cap, pending, pend_cnt, r_tarr);
+                    pend_cnt = 0;
+                    acvp_scratch_reset(&scratch);
+                    if (rv != ACVP_SUCCESS) {
+                        goto err;
+                    }
+                }
+                continue;
+            }
+
             /* Process the current test vector... */
-            if ((cap->crypto_handler)(&tc)) {
+            if (acvp_invoke_crypto_handler(ctx, cap, &tc)) {
                 ACVP_LOG_ERR("ERROR: crypto module failed the operation");
                 acvp_hmac_release_tc(&stc);
                 json_value_free(r_tval);
@@ -340,20 +432,36 @@ ACVP_RESULT acvp_hmac_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
 
             /* Append the test response value to array */
             json_array_append_value(r_tarr, r_tval);
+            acvp_progress_tc_done(ctx);
+        }
+        if (pend_cnt) {
+            rv = acvp_hmac_run_batch(ctx, cap, pending, pend_cnt, r_tarr);
+            pend_cnt = 0;
+            acvp_scratch_reset(&scratch);
+            if (rv != ACVP_SUCCESS) {
+                goto err;
+            }
         }
         json_array_append_value(r_garr, r_gval);
     }
 
     json_array_append_value(reg_arry, r_vs_val);
 
-    json_result = json_serialize_to_string_pretty(ctx->kat_resp, NULL);
-    ACVP_LOG_VERBOSE("\n\n%s\n\n", json_result);
-    json_free_serialized_string(json_result);
+    ACVP_LOG_VERBOSE_JSON(ctx->kat_resp);
     rv = ACVP_SUCCESS;
 
 err:
+    if (pending) {
+        while (pend_cnt) {
+            pend_cnt--;
+            acvp_hmac_release_tc(&pending[pend_cnt].stc);
+            json_value_free(pending[pend_cnt].r_tval);
+        }
+        free(pending);
+    }
     if (rv != ACVP_SUCCESS) {
         acvp_release_json(r_vs_val, r_gval);
     }
+    acvp_scratch_free(&scratch);
     return rv;
 }
@@ -429,7 +429,7 @@ static ACVP_RESULT acvp_kas_ecc_cdh(ACVP_CTX *ctx,
             }
 
             /* Process the current KAT test vector... */
-            if ((cap->crypto_handler)(tc)) {
+            if (acvp_invoke_crypto_handler(ctx, cap, tc)) {
                 acvp_kas_ecc_release_tc(stc);
                 ACVP_LOG_ERR("crypto module failed the operation");
                 rv = ACVP_CRYPTO_MODULE_FAIL;
@@ -455,6 +455,7 @@ static ACVP_RESULT acvp_kas_ecc_cdh(ACVP_CTX *ctx,
 
             /* Append the test response value to array */
             json_array_append_value(r_tarr, r_tval);
+            acvp_progress_tc_done(ctx);
         }
         json_array_append_value(r_garr, r_gval);
     }
@@ -694,7 +695,7 @@ static ACVP_RESULT acvp_kas_ecc_comp(ACVP_CTX *ctx,
             }
 
             /* Process the current KAT test vector... */
-            if ((cap->crypto_handler)(tc)) {
+            if (acvp_invoke_crypto_handler(ctx, cap, tc)) {
                 acvp_kas_ecc_release_tc(stc);
                 ACVP_LOG_ERR("crypto module failed the operation");
                 rv = ACVP_CRYPTO_MODULE_FAIL;
@@ -720,6 +721,7 @@ static ACVP_RESULT acvp_kas_ecc_comp(ACVP_CTX *ctx,
 
             /* Append the test response value to array */
             json_array_append_value(r_tarr, r_tval);
+            acvp_progress_tc_done(ctx);
         }
         json_array_append_value(r_garr, r_gval);
     }
@@ -744,7 +746,6 @@ ACVP_RESULT acvp_kas_ecc_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
     ACVP_KAS_ECC_TC stc;
     ACVP_RESULT rv = ACVP_SUCCESS;
     const char *alg_str = NULL;
-    char *json_result = NULL;
     const char *mode_str = NULL;
     ACVP_SUB_KAS alg;
 
@@ -852,9 +853,7 @@ ACVP_RESULT acvp_kas_ecc_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
     }
     json_array_append_value(reg_arry, r_vs_val);
 
-    json_result = json_serialize_to_string_pretty(ctx->kat_resp, NULL);
-    ACVP_LOG_VERBOSE("\n\n%s\n\n", json_result);
-    json_free_serialized_string(json_result);
+    ACVP_LOG_VERBOSE_JSON(ctx->kat_resp);
     rv = ACVP_SUCCESS;
 
 err:
@@ -1209,7 +1208,7 @@ static ACVP_RESULT acvp_kas_ecc_ssc(ACVP_CTX *ctx,
             }
 
             /* Process the current KAT test vector... */
-            if ((cap->crypto_handler)(tc)) {
+            if (acvp_invoke_crypto_handler(ctx, cap, tc)) {
                 acvp_kas_ecc_release_tc(stc);
                 ACVP_LOG_ERR("crypto module failed the operation");
                 rv = ACVP_CRYPTO_MODULE_FAIL;
@@ -1235,6 +1234,7 @@ static ACVP_RESULT acvp_kas_ecc_ssc(ACVP_CTX *ctx,
 
             /* Append the test response value to array */
             json_array_append_value(r_tarr, r_tval);
+            acvp_progress_tc_done(ctx);
         }
         json_array_append_value(r_garr, r_gval);
     }
@@ -1259,7 +1259,6 @@ ACVP_RESULT acvp_kas_ecc_ssc_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
     ACVP_KAS_ECC_TC stc;
     ACVP_RESULT rv = ACVP_SUCCESS;
     const char *alg_str = NULL;
-    char *json_result = NULL;
 
     if (!ctx) {
         ACVP_LOG_ERR("No ctx for handler operation");
@@ -1308,9 +1307,7 @@ ACVP_RESULT acvp_kas_ecc_ssc_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
     }
     json_array_append_value(reg_arry, r_vs_val);
 
-    json_result = json_serialize_to_string_pretty(ctx->kat_resp, NULL);
-    ACVP_LOG_VERBOSE("\n\n%s\n\n", json_result);
-    json_free_serialized_string(json_result);
+    ACVP_LOG_VERBOSE_JSON(ctx->kat_resp);
     rv = ACVP_SUCCESS;
 
 err:
@@ -1401,7 +1401,7 @@ static ACVP_RESULT acvp_kda_process(ACVP_CTX *ctx,
                 goto err;
             }
             /* Process the current KAT test vector... */
-            if ((cap->crypto_handler)(tc)) {
+            if (acvp_invoke_crypto_handler(ctx, cap, tc)) {
                 if (cipher == ACVP_KDA_HKDF) {
                     acvp_kda_release_tc(ACVP_KDA_HKDF, tc);
                 } else if (cipher == ACVP_KDA_ONESTEP) {
@@ -1457,6 +1457,7 @@ static ACVP_RESULT acvp_kda_process(ACVP_CTX *ctx,
 
             /* Append the test response value to array */
             json_array_append_value(r_tarr, r_tval);
+            acvp_progress_tc_done(ctx);
         }
         json_array_append_value(r_garr, r_gval);
         if (arr) { free(arr); arr = NULL; }
@@ -1483,7 +1484,6 @@ ACVP_RESULT acvp_kda_hkdf_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
     ACVP_KDA_HKDF_TC stc;
     ACVP_RESULT rv = ACVP_SUCCESS;
     const char *alg_str = NULL;
-    char *json_result = NULL;
     const char *mode_str = NULL;
 
     if (!ctx) {
@@ -1554,9 +1554,7 @@ ACVP_RESULT acvp_kda_hkdf_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
 
     json_array_append_value(reg_arry, r_vs_val);
 
-    json_result = json_serialize_to_string_pretty(ctx->kat_resp, NULL);
-    ACVP_LOG_VERBOSE("\n\n%s\n\n", json_result);
-    json_free_serialized_string(json_result);
+    ACVP_LOG_VERBOSE_JSON(ctx->kat_resp);
     rv = ACVP_SUCCESS;
 
 err:
@@ -1579,7 +1577,6 @@ ACVP_RESULT acvp_kda_onestep_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
     ACVP_KDA_ONESTEP_TC stc;
     ACVP_RESULT rv = ACVP_SUCCESS;
     const char *alg_str = NULL;
-    char *json_result = NULL;
     const char *mode_str = NULL;
 
     if (!ctx) {
@@ -1650,9 +1647,7 @@ ACVP_RESULT acvp_kda_onestep_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
 
     json_array_append_value(reg_arry, r_vs_val);
 
-    json_result = json_serialize_to_string_pretty(ctx->kat_resp, NULL);
-    ACVP_LOG_VERBOSE("\n\n%s\n\n", json_result);
-    json_free_serialized_string(json_result);
+    ACVP_LOG_VERBOSE_JSON(ctx->kat_resp);
     rv = ACVP_SUCCESS;
 
 err:
@@ -1675,7 +1670,6 @@ ACVP_RESULT acvp_kda_twostep_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
     ACVP_KDA_TWOSTEP_TC stc;
     ACVP_RESULT rv = ACVP_SUCCESS;
     const char *alg_str = NULL;
-    char *json_result = NULL;
     const char *mode_str = NULL;
 
     if (!ctx) {
@@ -1746,9 +1740,7 @@ ACVP_RESULT acvp_kda_twostep_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
 
     json_array_append_value(reg_arry, r_vs_val);
 
-    json_result = json_serialize_to_string_pretty(ctx->kat_resp, NULL);
-    ACVP_LOG_VERBOSE("\n\n%s\n\n", json_result);
-    json_free_serialized_string(json_result);
+    ACVP_LOG_VERBOSE_JSON(ctx->kat_resp);
     rv = ACVP_SUCCESS;
 
 err:
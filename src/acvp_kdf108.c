@@ -339,7 +339,6 @@ ACVP_RESULT acvp_kdf108_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
     ACVP_RESULT rv;
     const char *alg_str = NULL;
     ACVP_CIPHER alg_id = 0;
-    char *json_result;
 
     ACVP_KDF108_MODE kdf_mode = 0;
     ACVP_KDF108_MAC_MODE_VAL mac_mode = 0;
@@ -662,7 +661,7 @@ ACVP_RESULT acvp_kdf108_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
             }
 
             /* Process the current test vector... */
-            if ((cap->crypto_handler)(&tc)) {
+            if (acvp_invoke_crypto_handler(ctx, cap, &tc)) {
                 ACVP_LOG_ERR("crypto module failed the operation");
                 acvp_kdf108_release_tc(&stc);
                 rv = ACVP_CRYPTO_MODULE_FAIL;
@@ -694,15 +693,14 @@ ACVP_RESULT acvp_kdf108_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
 
             /* Append the test response value to array */
             json_array_append_value(r_tarr, r_tval);
+            acvp_progress_tc_done(ctx);
         }
         json_array_append_value(r_garr, r_gval);
     }
 
     json_array_append_value(reg_arry, r_vs_val);
 
-    json_result = json_serialize_to_string_pretty(ctx->kat_resp, NULL);
-    ACVP_LOG_VERBOSE("\n\n%s\n\n", json_result);
-    json_free_serialized_string(json_result);
+    ACVP_LOG_VERBOSE_JSON(ctx->kat_resp);
     rv = ACVP_SUCCESS;
 
 err:
@@ -168,7 +168,6 @@ ACVP_RESULT acvp_kdf135_x942_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
                *party_v = NULL, *supp_pub = NULL, *supp_priv = NULL, *zz = NULL;
     ACVP_CIPHER alg_id;
     ACVP_KDF_X942_TYPE kdf_type;
-    char *json_result;
 
     if (!ctx) {
         ACVP_LOG_ERR("No ctx for handler operation");
@@ -440,7 +439,7 @@ ACVP_RESULT acvp_kdf135_x942_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
             }
 
             /* Process the current test vector... */
-            if ((cap->crypto_handler)(&tc)) {
+            if (acvp_invoke_crypto_handler(ctx, cap, &tc)) {
                 ACVP_LOG_ERR("crypto module failed the KDF X942 operation");
                 acvp_kdf135_x942_release_tc(&stc);
                 rv = ACVP_CRYPTO_MODULE_FAIL;
@@ -465,15 +464,14 @@ ACVP_RESULT acvp_kdf135_x942_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
 
             /* Append the test response value to array */
             json_array_append_value(r_tarr, r_tval);
+            acvp_progress_tc_done(ctx);
         }
         json_array_append_value(r_garr, r_gval);
     }
 
     json_array_append_value(reg_arry, r_vs_val);
 
-    json_result = json_serialize_to_string_pretty(ctx->kat_resp, NULL);
-    ACVP_LOG_VERBOSE("\n\n%s\n\n", json_result);
-    json_free_serialized_string(json_result);
+    ACVP_LOG_VERBOSE_JSON(ctx->kat_resp);
     rv = ACVP_SUCCESS;
 
 err:
@@ -19,6 +19,7 @@
 
 static ACVP_RESULT acvp_kmac_init_tc(ACVP_CTX *ctx,
                                      ACVP_KMAC_TC *stc,
+                                     ACVP_SCRATCH *scratch,
                                      ACVP_CIPHER alg_id,
                                      int tc_id,
                                      ACVP_KMAC_TESTTYPE type,
@@ -33,37 +34,45 @@ static ACVP_RESULT acvp_kmac_init_tc(ACVP_CTX *ctx,
                                      const char *custom) {
 
     ACVP_RESULT rv;
-    int len = 0;
+    int len = 0, mac_max = 0, custom_max = 0;
     memzero_s(stc, sizeof(ACVP_KMAC_TC));
 
-    stc->msg = calloc(1, ACVP_KMAC_MSG_BYTE_MAX);
-    if (!stc->msg) { return ACVP_MALLOC_FAIL; }
-    stc->mac = calloc(1, ACVP_KMAC_MAC_BYTE_MAX);
-    if (!stc->mac) { return ACVP_MALLOC_FAIL; }
-    stc->key = calloc(1, ACVP_KMAC_KEY_BYTE_MAX);
-    if (!stc->key) { return ACVP_MALLOC_FAIL; }
+    /*
+     * The message and key lengths have been checked against the strings
+     * already. The module writes mac_len bytes of MAC, so that is all the
+     * room it gets unless the length is out of range.
+     */
+    mac_max = mac_len / 8;
+    if (mac_max > ACVP_KMAC_MAC_BYTE_MAX) mac_max = ACVP_KMAC_MAC_BYTE_MAX;
+    custom_max = hex_customization ? ACVP_KMAC_CUSTOM_HEX_BYTE_MAX : ACVP_KMAC_CUSTOM_STR_MAX;
+    rv = acvp_scratch_reserve(scratch, acvp_scratch_round(msg_len / 8) +
+                                       acvp_scratch_round(mac_max) +
+                                       acvp_scratch_round(key_len / 8) +
+                                       acvp_scratch_round(custom_max));
+    if (rv != ACVP_SUCCESS) { return rv; }
+    stc->msg = acvp_scratch_alloc(scratch, msg_len / 8);
+    stc->mac = acvp_scratch_alloc(scratch, mac_max);
+    stc->key = acvp_scratch_alloc(scratch, key_len / 8);
     if (hex_customization) {
-        stc->custom_hex = calloc(1, ACVP_KMAC_CUSTOM_HEX_BYTE_MAX);
-        if (!stc->custom_hex) { return ACVP_MALLOC_FAIL; }
+        stc->custom_hex = acvp_scratch_alloc(scratch, custom_max);
     } else {
-        stc->custom = calloc(1, ACVP_KMAC_CUSTOM_STR_MAX);
-        if (!stc->custom) { return ACVP_MALLOC_FAIL; }
+        stc->custom = (char *)acvp_scratch_alloc(scratch, custom_max);
     }
 
-    rv = acvp_hexstr_to_bin(msg, stc->msg, ACVP_KMAC_MSG_BYTE_MAX, NULL);
+    rv = acvp_hexstr_to_bin(msg, stc->msg, msg_len / 8, NULL);
     if (rv != ACVP_SUCCESS) {
         ACVP_LOG_ERR("Hex converstion failure (msg)");
         return rv;
     }
 
-    rv = acvp_hexstr_to_bin(key, stc->key, ACVP_KMAC_KEY_BYTE_MAX, NULL);
+    rv = acvp_hexstr_to_bin(key, stc->key, key_len / 8, NULL);
     if (rv != ACVP_SUCCESS) {
         ACVP_LOG_ERR("Hex converstion failure (key)");
         return rv;
     }
 
     if (type == ACVP_KMAC_TEST_TYPE_MVT) {
-        rv = acvp_hexstr_to_bin(mac, stc->mac, ACVP_KMAC_MAC_BYTE_MAX, NULL);
+        rv = acvp_hexstr_to_bin(mac, stc->mac, mac_max, NULL);
         if (rv != ACVP_SUCCESS) {
             ACVP_LOG_ERR("Hex converstion failure (mac)");
             return rv;
@@ -138,16 +147,66 @@ end:
  * a test case.
  */
 static ACVP_RESULT acvp_kmac_release_tc(ACVP_KMAC_TC *stc) {
-    if (stc->msg) free(stc->msg);
-    if (stc->mac) free(stc->mac);
-    if (stc->key) free(stc->key);
-    if (stc->custom) free(stc->custom);
-    if (stc->custom_hex) free(stc->custom_hex);
+    /* The buffers belong to the handler's scratch area */
     memzero_s(stc, sizeof(ACVP_KMAC_TC));
 
     return ACVP_SUCCESS;
 }
 
+/*
+ * A test case waiting to be handed to the batch handler, with the response
+ * object it will be written to. Its buffers are in the batch's scratch area.
+ */
+typedef struct acvp_kmac_pending_t {
+    ACVP_KMAC_TC stc;
+    JSON_Value *r_tval;
+} ACVP_KMAC_PENDING;
+
+/*
+ * Hands count pending test cases to the batch handler in one call and writes
+ * their responses, in the server's order. Every pending test case is
+ * released, and its response either appended to r_tarr or freed.
+ */
+static ACVP_RESULT acvp_kmac_run_batch(ACVP_CTX *ctx,
+                                       ACVP_CAPS_LIST *cap,
+                                       ACVP_KMAC_PENDING *pending,
+                                       unsigned int count,
+                                       JSON_Array *r_tarr) {
+    ACVP_RESULT rv = ACVP_SUCCESS;
+    ACVP_TEST_CASE tcs[ACVP_MAC_BATCH_MAX];
+    unsigned int i = 0;
+
+    for (i = 0; i < count; i++) {
+        tcs[i].tc.kmac = &pending[i].stc;
+    }
+    i = 0;
+    if (acvp_invoke_batch_handler(ctx, cap, tcs, count)) {
+        ACVP_LOG_ERR("ERROR: crypto module failed a batch of %u test cases", count);
+        rv = ACVP_CRYPTO_MODULE_FAIL;
+        goto end;
+    }
+
+    for (i = 0; i < count; i++) {
+        rv = acvp_kmac_output_tc(ctx, &pending[i].stc, json_value_get_object(pending[i].r_tval));
+        if (rv != ACVP_SUCCESS) {
+            ACVP_LOG_ERR("ERROR: JSON output failure in kmac module");
+            goto end;
+        }
+        acvp_kmac_release_tc(&pending[i].stc);
+        json_array_append_value(r_tarr, pending[i].r_tval);
+        pending[i].r_tval = NULL;
+        acvp_progress_tc_done(ctx);
+    }
+
+end:
+    for (; i < count; i++) {
+        acvp_kmac_release_tc(&pending[i].stc);
+        json_value_free(pending[i].r_tval);
+        pending[i].r_tval = NULL;
+    }
+    return rv;
+}
+
 static ACVP_KMAC_TESTTYPE read_test_type(const char *str) {
     int diff = 1;
 
@@ -186,11 +245,13 @@ ACVP_RESULT acvp_kmac_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
     JSON_Object *r_tobj = NULL, *r_gobj = NULL; /* Response testobj, groupobj */
     ACVP_CAPS_LIST *cap;
     ACVP_KMAC_TC stc;
+    ACVP_SCRATCH scratch = { 0 };
+    ACVP_KMAC_PENDING *pending = NULL;  /* test cases waiting for the batch handler */
+    unsigned int pend_cnt = 0;
     ACVP_TEST_CASE tc;
     ACVP_RESULT rv;
     const char *alg_str = json_object_get_string(obj, "algorithm");
     ACVP_CIPHER alg_id;
-    char *json_result;
 
     if (!ctx) {
         ACVP_LOG_ERR("No ctx for handler operation");
@@ -240,6 +301,16 @@ ACVP_RESULT acvp_kmac_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
         return rv;
     }
 
+    if (cap->batch_handler) {
+        pending = calloc(ACVP_MAC_BATCH_MAX, sizeof(ACVP_KMAC_PENDING));
+        if (!pending) {
+            ACVP_LOG_ERR("Unable to malloc KMAC batch");
+            rv = ACVP_MALLOC_FAIL;
+            goto err;
+        }
+        scratch.batch_min = ACVP_MAC_BATCH_SCRATCH;
+    }
+
     groups = json_object_get_array(obj, "testGroups");
     if (!groups) {
         ACVP_LOG_ERR("Failed to include testGroups. ");
@@ -429,8 +500,19 @@ ACVP_RESULT acvp_kmac_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
              * Setup the test case data that will be passed down to
              * the crypto module.
              */
-            rv = acvp_kmac_init_tc(ctx, &stc, alg_id, tc_id, type, xof, hex_customization,
+            rv = acvp_kmac_init_tc(ctx, &stc, &scratch, alg_id, tc_id, type, xof, hex_customization,
                                      msg, msglen, mac, maclen, key, keylen, custom);
+            if (rv == ACVP_DATA_TOO_LARGE && pend_cnt) {
+                /* The batch's buffers are full; run it and start the next one */
+                rv = acvp_kmac_run_batch(ctx, cap, pending, pend_cnt, r_tarr);
+                pend_cnt = 0;
+                acvp_scratch_reset(&scratch);
+                if (rv == ACVP_SUCCESS) {
+                    rv = acvp_kmac_init_tc(ctx, &stc, &scratch, alg_id, tc_id, type, xof,
+                                           hex_customization, msg, msglen, mac, maclen, key,
+                                           keylen, custom);
+                }
+            }
             if (rv != ACVP_SUCCESS) {
                 ACVP_LOG_ERR("Error initializing KMAC test case");
                 acvp_kmac_release_tc(&stc);
@@ -438,8 +520,23 @@ ACVP_RESULT acvp_kmac_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
                 goto err;
             }
 
+            if (pending) {
+                pending[pend_cnt].stc = stc;
+                pending[pend_cnt].r_tval = r_tval;
+                pend_cnt++;
+                if (pend_cnt == ACVP_MAC_BATCH_MAX) {
+                    rv = acvp_kmac_run_batch(ctx, cap, pending, pend_cnt, r_tarr);
+                    pend_cnt = 0;
+                    acvp_scratch_reset(&scratch);
+                    if (rv != ACVP_SUCCESS) {
+                        goto err;
+                    }
+                }
+                continue;
+            }
+
             /* Process the current test vector... */
-            if ((cap->crypto_handler)(&tc)) {
+            if (acvp_invoke_crypto_handler(ctx, cap, &tc)) {
                 ACVP_LOG_ERR("ERROR: crypto module failed the operation");
                 acvp_kmac_release_tc(&stc);
                 json_value_free(r_tval);
@@ -464,20 +561,36 @@ ACVP_RESULT acvp_kmac_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
 
             /* Append the test response value to array */
             json_array_append_value(r_tarr, r_tval);
+            acvp_progress_tc_done(ctx);
+        }
+        if (pend_cnt) {
+            rv = acvp_kmac_run_batch(ctx, cap, pending, pend_cnt, r_tarr);
+            pend_cnt = 0;
+            acvp_scratch_reset(&scratch);
+            if (rv != ACVP_SUCCESS) {
+                goto err;
+            }
         }
         json_array_append_value(r_garr, r_gval);
     }
 
     json_array_append_value(reg_arry, r_vs_val);
 
-    json_result = json_serialize_to_string_pretty(ctx->kat_resp, NULL);
-    ACVP_LOG_VERBOSE("\n\n%s\n\n", json_result);
-    json_free_serialized_string(json_result);
+    ACVP_LOG_VERBOSE_JSON(ctx->kat_resp);
     rv = ACVP_SUCCESS;
 
 err:
+    if (pending) {
+        while (pend_cnt) {
+            pend_cnt--;
+            acvp_kmac_release_tc(&pending[pend_cnt].stc);
+            json_value_free(pending[pend_cnt].r_tval);
+        }
+        free(pending);
+    }
     if (rv != ACVP_SUCCESS) {
         acvp_release_json(r_vs_val, r_gval);
     }
+    acvp_scratch_free(&scratch);
     return rv;
 }
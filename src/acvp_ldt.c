@@ -0,0 +1,174 @@
+/** @file */
+/*
+ * Copyright (c) 2024, Cisco Systems, Inc.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://github.com/cisco/libacvp/LICENSE
+ */
+
+/*
+ * Repeated-content views for hash large data tests.
+ *
+ * A module whose hash API takes the whole message in one update needs the
+ * expanded content (up to 8 GiB) at one address. Rather than writing it out,
+ * one block of memory holding whole copies of the content is created in an
+ * anonymous memory file, and that block is mapped over and over across a
+ * reserved range of address space. Every mapping shares the same physical
+ * pages, so only the block is ever resident.
+ *
+ * The block is a whole number of pages and of copies of the content, so the
+ * pattern carries on unbroken from one mapping to the next. It is made large
+ * enough to keep the number of mappings well under the kernel's limit.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "acvp.h"
+#include "acvp_lcl.h"
+#include "safe_lib.h"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(SYS_memfd_create)
+#define ACVP_LDT_VIEW_SUPPORTED
+#endif
+#endif
+
+#define ACVP_LDT_VIEW_MAPS_MAX 4096 /* the default vm.max_map_count is 65530 */
+
+typedef struct acvp_ldt_view_t {
+    unsigned char *base;
+    size_t len;
+} ACVP_LDT_VIEW;
+
+#ifdef ACVP_LDT_VIEW_SUPPORTED
+static size_t acvp_ldt_gcd(size_t a, size_t b) {
+    size_t t = 0;
+
+    while (b) {
+        t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/*
+ * Creates the memory file holding block bytes of repeated content, filled
+ * through a temporary mapping. Returns the descriptor or -1.
+ */
+static int acvp_ldt_block_create(const unsigned char *content, size_t content_len, size_t block) {
+    unsigned char *fill = NULL;
+    size_t off = 0;
+    int fd = -1;
+
+    fd = (int)syscall(SYS_memfd_create, "acvp_ldt", 1 /* MFD_CLOEXEC */);
+    if (fd < 0) {
+        return -1;
+    }
+    if (ftruncate(fd, (off_t)block) != 0) {
+        close(fd);
+        return -1;
+    }
+    fill = mmap(NULL, block, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (fill == MAP_FAILED) {
+        close(fd);
+        return -1;
+    }
+    for (off = 0; off < block; off += content_len) {
+        memcpy_s(fill + off, block - off, content, content_len);
+    }
+    munmap(fill, block);
+    return fd;
+}
+#endif
+
+ACVP_RESULT acvp_hash_ldt_map(ACVP_HASH_TC *tc, const unsigned char **data) {
+#ifdef ACVP_LDT_VIEW_SUPPORTED
+    ACVP_LDT_VIEW *view = NULL;
+    unsigned char *base = NULL;
+    size_t page = 0, unit = 0, units = 0, block = 0, maps = 0, i = 0;
+    long page_size = 0;
+    int fd = -1;
+
+    if (!tc || !data) {
+        return ACVP_INVALID_ARG;
+    }
+    if (tc->test_type != ACVP_HASH_TEST_TYPE_LDT || !tc->msg || !tc->msg_len || !tc->exp_len) {
+        return ACVP_INVALID_ARG;
+    }
+    if (tc->ldt_view) {
+        /* Already mapped */
+        return ACVP_INVALID_ARG;
+    }
+    if (tc->exp_len > (unsigned long long int)(SIZE_MAX / 2)) {
+        return ACVP_DATA_TOO_LARGE;
+    }
+
+    page_size = sysconf(_SC_PAGESIZE);
+    page = page_size > 0 ? (size_t)page_size : 4096;
+
+    /* The smallest block that is both whole pages and whole copies of the content */
+    unit = tc->msg_len / acvp_ldt_gcd(tc->msg_len, page) * page;
+    units = ((size_t)tc->exp_len + unit - 1) / unit;
+    block = unit * ((units + ACVP_LDT_VIEW_MAPS_MAX - 1) / ACVP_LDT_VIEW_MAPS_MAX);
+    maps = ((size_t)tc->exp_len + block - 1) / block;
+
+    view = calloc(1, sizeof(ACVP_LDT_VIEW));
+    if (!view) {
+        return ACVP_MALLOC_FAIL;
+    }
+    fd = acvp_ldt_block_create(tc->msg, tc->msg_len, block);
+    if (fd < 0) {
+        free(view);
+        return ACVP_MALLOC_FAIL;
+    }
+
+    /* Reserve the whole range first so the mappings land side by side */
+    view->len = maps * block;
+    base = mmap(NULL, view->len, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (base == MAP_FAILED) {
+        close(fd);
+        free(view);
+        return ACVP_MALLOC_FAIL;
+    }
+    for (i = 0; i < maps; i++) {
+        if (mmap(base + i * block, block, PROT_READ, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+            munmap(base, view->len);
+            close(fd);
+            free(view);
+            return ACVP_MALLOC_FAIL;
+        }
+    }
+    /* The mappings keep the memory file alive */
+    close(fd);
+
+    view->base = base;
+    tc->ldt_view = view;
+    *data = base;
+    return ACVP_SUCCESS;
+#else
+    (void)tc;
+    (void)data;
+    return ACVP_UNSUPPORTED_OP;
+#endif
+}
+
+void acvp_hash_ldt_unmap(ACVP_HASH_TC *tc) {
+    ACVP_LDT_VIEW *view = NULL;
+
+    if (!tc || !tc->ldt_view) {
+        return;
+    }
+    view = tc->ldt_view;
+#ifdef ACVP_LDT_VIEW_SUPPORTED
+    munmap(view->base, view->len);
+#endif
+    free(view);
+    tc->ldt_view = NULL;
+}
@@ -0,0 +1,422 @@
+/** @file */
+/*
+ * Copyright (c) 2024, Cisco Systems, Inc.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://github.com/cisco/libacvp/LICENSE
+ */
+
+/*
+ * Log delivery.
+ *
+ * acvp_log_msg() formats a message on the caller's stack and hands it to
+ * acvp_log_deliver(). Synchronously, that calls the application's logging
+ * callback right away. Asynchronously, the message is copied onto a bounded
+ * ring and a background thread calls the callback, so loggers never wait on
+ * terminal or file I/O and messages from several threads come out whole and
+ * in the order they were queued.
+ *
+ * The ring is the usual sequence-numbered bounded queue: producers claim a
+ * slot by advancing enqueue_pos with a CAS, fill it, then publish it by
+ * bumping the slot's sequence; the single consumer needs no atomics on its
+ * side beyond reading that sequence. The drain thread sleeps on a condition
+ * variable when the ring is empty and producers only take the mutex to wake
+ * it when it has said it is going to sleep. A producer that finds the ring
+ * full sleeps on another until the drain thread frees a slot.
+ *
+ * Any thread may be logging (the MCT workers among them) when the sink is
+ * switched off, so acvp_log_deliver() counts itself in ctx->log_producers
+ * around its use of the sink. Stopping raises ctx->log_stopping, which holds
+ * new producers at the door, waits for the count to drop to zero, drains and
+ * frees the sink, and only then lets the waiting producers through. They
+ * find no sink and log synchronously, after everything that was queued.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "acvp.h"
+#include "acvp_lcl.h"
+#include "safe_lib.h"
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <time.h>
+#include <sys/time.h>
+
+typedef struct acvp_log_slot_t {
+    size_t sequence;
+    ACVP_LOG_LVL level;
+    char *msg;              /* text, or a heap copy for long messages */
+    char text[ACVP_LOG_SLOT_INLINE];
+} ACVP_LOG_SLOT;
+
+struct acvp_log_sink_t {
+    ACVP_CTX *ctx;
+    ACVP_LOG_SLOT *slots;
+    size_t mask;
+    size_t enqueue_pos;     /* next slot to claim, shared by producers */
+    size_t dequeue_pos;     /* next slot to drain, drain thread only */
+    size_t delivered;       /* messages handed to the callback so far */
+    int waiting;            /* drain thread is going to sleep */
+    int full_waiters;       /* producers sleeping until a slot is free */
+    int stop;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;    /* signals the drain thread */
+    pthread_cond_t drained; /* signals acvp_log_flush() */
+    pthread_cond_t room;    /* signals producers waiting on a full ring */
+};
+
+/* Where producers wait out a sink being stopped, and the stopper waits for them to leave */
+static pthread_mutex_t acvp_log_gate_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t acvp_log_gate = PTHREAD_COND_INITIALIZER;
+
+/* Safety net against a missed wakeup; normally never reached */
+#define ACVP_LOG_SLEEP_MS 100
+
+static void acvp_log_sink_timed_wait(pthread_cond_t *cond, pthread_mutex_t *lock) {
+    struct timeval now;
+    struct timespec until;
+
+    gettimeofday(&now, NULL);
+    until.tv_sec = now.tv_sec;
+    until.tv_nsec = (now.tv_usec + ACVP_LOG_SLEEP_MS * 1000) * 1000L;
+    if (until.tv_nsec >= 1000000000L) {
+        until.tv_sec++;
+        until.tv_nsec -= 1000000000L;
+    }
+    pthread_cond_timedwait(cond, lock, &until);
+}
+
+static void acvp_log_sink_wake(ACVP_LOG_SINK *sink) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&sink->waiting, __ATOMIC_RELAXED)) {
+        pthread_mutex_lock(&sink->lock);
+        pthread_cond_signal(&sink->wake);
+        pthread_mutex_unlock(&sink->lock);
+    }
+}
+
+static void acvp_log_sink_push(ACVP_LOG_SINK *sink, ACVP_LOG_LVL level, const char *msg, size_t len) {
+    ACVP_LOG_SLOT *slot = NULL;
+    size_t pos = 0, seq = 0;
+    char *copy = NULL;
+
+    /* Long messages are copied before claiming a slot to keep the critical window short */
+    if (len >= ACVP_LOG_SLOT_INLINE) {
+        copy = malloc(len + 1);
+        if (!copy) {
+            return;
+        }
+        memcpy_s(copy, len + 1, msg, len);
+        copy[len] = '\0';
+    }
+
+    pos = __atomic_load_n(&sink->enqueue_pos, __ATOMIC_RELAXED);
+    for (;;) {
+        slot = &sink->slots[pos & sink->mask];
+        seq = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        if (seq == pos) {
+            if (__atomic_compare_exchange_n(&sink->enqueue_pos, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if ((long)(seq - pos) < 0) {
+            /* Full; make sure the drain thread is running and sleep until it frees this slot */
+            acvp_log_sink_wake(sink);
+            pthread_mutex_lock(&sink->lock);
+            __atomic_add_fetch(&sink->full_waiters, 1, __ATOMIC_SEQ_CST);
+            if ((long)(__atomic_load_n(&slot->sequence, __ATOMIC_SEQ_CST) - pos) < 0) {
+                acvp_log_sink_timed_wait(&sink->room, &sink->lock);
+            }
+            __atomic_sub_fetch(&sink->full_waiters, 1, __ATOMIC_SEQ_CST);
+            pthread_mutex_unlock(&sink->lock);
+            pos = __atomic_load_n(&sink->enqueue_pos, __ATOMIC_RELAXED);
+        } else {
+            pos = __atomic_load_n(&sink->enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    slot->level = level;
+    if (copy) {
+        slot->msg = copy;
+    } else {
+        memcpy_s(slot->text, ACVP_LOG_SLOT_INLINE, msg, len);
+        slot->text[len] = '\0';
+        slot->msg = slot->text;
+    }
+    __atomic_store_n(&slot->sequence, pos + 1, __ATOMIC_RELEASE);
+    acvp_log_sink_wake(sink);
+}
+
+/* Delivers everything currently queued; returns the number of messages */
+static size_t acvp_log_sink_drain(ACVP_LOG_SINK *sink) {
+    ACVP_CTX *ctx = sink->ctx;
+    ACVP_LOG_SLOT *slot = NULL;
+    size_t n = 0;
+
+    for (;;) {
+        slot = &sink->slots[sink->dequeue_pos & sink->mask];
+        if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != sink->dequeue_pos + 1) {
+            break;
+        }
+        if (ctx->test_progress_cb) {
+            ctx->test_progress_cb(slot->msg, slot->level);
+        }
+        if (ctx->log_flush == ACVP_LOG_FLUSH_EVERY) {
+            fflush(stdout);
+        }
+        if (slot->msg != slot->text) {
+            free(slot->msg);
+        }
+        slot->msg = NULL;
+        __atomic_store_n(&slot->sequence, sink->dequeue_pos + sink->mask + 1, __ATOMIC_SEQ_CST);
+        sink->dequeue_pos++;
+        __atomic_store_n(&sink->delivered, sink->dequeue_pos, __ATOMIC_RELEASE);
+        n++;
+        if (__atomic_load_n(&sink->full_waiters, __ATOMIC_SEQ_CST)) {
+            pthread_mutex_lock(&sink->lock);
+            pthread_cond_broadcast(&sink->room);
+            pthread_mutex_unlock(&sink->lock);
+        }
+    }
+    if (n && ctx->log_flush == ACVP_LOG_FLUSH_BATCH) {
+        fflush(stdout);
+    }
+    return n;
+}
+
+static int acvp_log_sink_empty(ACVP_LOG_SINK *sink) {
+    ACVP_LOG_SLOT *slot = &sink->slots[sink->dequeue_pos & sink->mask];
+
+    return __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != sink->dequeue_pos + 1;
+}
+
+static void *acvp_log_sink_thread(void *arg) {
+    ACVP_LOG_SINK *sink = arg;
+
+    for (;;) {
+        if (acvp_log_sink_drain(sink)) {
+            continue;
+        }
+
+        pthread_mutex_lock(&sink->lock);
+        pthread_cond_broadcast(&sink->drained);
+        __atomic_store_n(&sink->waiting, 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (acvp_log_sink_empty(sink)) {
+            if (sink->stop) {
+                pthread_mutex_unlock(&sink->lock);
+                break;
+            }
+            acvp_log_sink_timed_wait(&sink->wake, &sink->lock);
+        }
+        __atomic_store_n(&sink->waiting, 0, __ATOMIC_RELAXED);
+        pthread_mutex_unlock(&sink->lock);
+    }
+    return NULL;
+}
+
+static ACVP_RESULT acvp_log_sink_start(ACVP_CTX *ctx, unsigned int ring_size) {
+    ACVP_LOG_SINK *sink = NULL;
+    size_t size = ACVP_LOG_RING_MIN, i = 0;
+
+    if (!ring_size) {
+        ring_size = ACVP_LOG_RING_DEFAULT;
+    }
+    while (size < ring_size) {
+        size <<= 1;
+    }
+
+    sink = calloc(1, sizeof(ACVP_LOG_SINK));
+    if (!sink) {
+        return ACVP_MALLOC_FAIL;
+    }
+    sink->slots = calloc(size, sizeof(ACVP_LOG_SLOT));
+    if (!sink->slots) {
+        free(sink);
+        return ACVP_MALLOC_FAIL;
+    }
+    for (i = 0; i < size; i++) {
+        sink->slots[i].sequence = i;
+    }
+    sink->mask = size - 1;
+    sink->ctx = ctx;
+    pthread_mutex_init(&sink->lock, NULL);
+    pthread_cond_init(&sink->wake, NULL);
+    pthread_cond_init(&sink->drained, NULL);
+    pthread_cond_init(&sink->room, NULL);
+
+    if (pthread_create(&sink->thread, NULL, acvp_log_sink_thread, sink)) {
+        pthread_cond_destroy(&sink->room);
+        pthread_cond_destroy(&sink->drained);
+        pthread_cond_destroy(&sink->wake);
+        pthread_mutex_destroy(&sink->lock);
+        free(sink->slots);
+        free(sink);
+        return ACVP_INTERNAL_ERR;
+    }
+    __atomic_store_n(&ctx->log_sink, sink, __ATOMIC_SEQ_CST);
+    return ACVP_SUCCESS;
+}
+
+static void acvp_log_producer_leave(ACVP_CTX *ctx) {
+    if (!__atomic_sub_fetch(&ctx->log_producers, 1, __ATOMIC_SEQ_CST) &&
+            __atomic_load_n(&ctx->log_stopping, __ATOMIC_SEQ_CST)) {
+        pthread_mutex_lock(&acvp_log_gate_lock);
+        pthread_cond_broadcast(&acvp_log_gate);
+        pthread_mutex_unlock(&acvp_log_gate_lock);
+    }
+}
+
+static void acvp_log_producer_enter(ACVP_CTX *ctx) {
+    for (;;) {
+        __atomic_add_fetch(&ctx->log_producers, 1, __ATOMIC_SEQ_CST);
+        if (!__atomic_load_n(&ctx->log_stopping, __ATOMIC_SEQ_CST)) {
+            return;
+        }
+        acvp_log_producer_leave(ctx);
+        pthread_mutex_lock(&acvp_log_gate_lock);
+        while (__atomic_load_n(&ctx->log_stopping, __ATOMIC_SEQ_CST)) {
+            acvp_log_sink_timed_wait(&acvp_log_gate, &acvp_log_gate_lock);
+        }
+        pthread_mutex_unlock(&acvp_log_gate_lock);
+    }
+}
+
+/*
+ * Waits for every thread still pushing onto the sink, delivers whatever is
+ * queued and shuts the drain thread down. Logging is synchronous again
+ * afterwards.
+ */
+void acvp_log_sink_stop(ACVP_CTX *ctx) {
+    ACVP_LOG_SINK *sink = NULL;
+
+    if (!ctx || !ctx->log_sink) {
+        return;
+    }
+    sink = ctx->log_sink;
+
+    __atomic_store_n(&ctx->log_stopping, 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_lock(&acvp_log_gate_lock);
+    while (__atomic_load_n(&ctx->log_producers, __ATOMIC_SEQ_CST)) {
+        acvp_log_sink_timed_wait(&acvp_log_gate, &acvp_log_gate_lock);
+    }
+    pthread_mutex_unlock(&acvp_log_gate_lock);
+
+    pthread_mutex_lock(&sink->lock);
+    sink->stop = 1;
+    pthread_cond_signal(&sink->wake);
+    pthread_mutex_unlock(&sink->lock);
+    pthread_join(sink->thread, NULL);
+    __atomic_store_n(&ctx->log_sink, NULL, __ATOMIC_SEQ_CST);
+
+    pthread_cond_destroy(&sink->room);
+    pthread_cond_destroy(&sink->drained);
+    pthread_cond_destroy(&sink->wake);
+    pthread_mutex_destroy(&sink->lock);
+    free(sink->slots);
+    free(sink);
+    fflush(stdout);
+
+    pthread_mutex_lock(&acvp_log_gate_lock);
+    __atomic_store_n(&ctx->log_stopping, 0, __ATOMIC_SEQ_CST);
+    pthread_cond_broadcast(&acvp_log_gate);
+    pthread_mutex_unlock(&acvp_log_gate_lock);
+}
+
+static void acvp_log_sink_wait(ACVP_LOG_SINK *sink) {
+    size_t target = __atomic_load_n(&sink->enqueue_pos, __ATOMIC_RELAXED);
+
+    pthread_mutex_lock(&sink->lock);
+    while ((long)(__atomic_load_n(&sink->delivered, __ATOMIC_ACQUIRE) - target) < 0) {
+        pthread_cond_signal(&sink->wake);
+        acvp_log_sink_timed_wait(&sink->drained, &sink->lock);
+    }
+    pthread_mutex_unlock(&sink->lock);
+}
+#else
+void acvp_log_sink_stop(ACVP_CTX *ctx) {
+    (void)ctx;
+}
+#endif
+
+/*
+ * Hands a formatted message to the application, directly or through the
+ * asynchronous sink.
+ */
+void acvp_log_deliver(ACVP_CTX *ctx, ACVP_LOG_LVL level, char *msg, size_t len) {
+#ifndef _WIN32
+    ACVP_LOG_SINK *sink = NULL;
+#endif
+
+    if (!ctx || !ctx->test_progress_cb || !msg) {
+        return;
+    }
+#ifndef _WIN32
+    /* Counted in before looking at the sink, so it is not freed while in use */
+    acvp_log_producer_enter(ctx);
+    sink = __atomic_load_n(&ctx->log_sink, __ATOMIC_SEQ_CST);
+    if (sink) {
+        acvp_log_sink_push(sink, level, msg, len);
+    }
+    acvp_log_producer_leave(ctx);
+    if (sink) {
+        return;
+    }
+#else
+    (void)len;
+#endif
+    ctx->test_progress_cb(msg, level);
+    if (ctx->log_flush == ACVP_LOG_FLUSH_EVERY) {
+        fflush(stdout);
+    }
+}
+
+ACVP_RESULT acvp_set_log_async(ACVP_CTX *ctx, int enable, unsigned int ring_size) {
+    if (!ctx) {
+        return ACVP_NO_CTX;
+    }
+    if (!enable) {
+        acvp_log_sink_stop(ctx);
+        return ACVP_SUCCESS;
+    }
+#ifdef _WIN32
+    (void)ring_size;
+    ACVP_LOG_WARN("Asynchronous logging is not supported on this platform; logging synchronously");
+    return ACVP_UNSUPPORTED_OP;
+#else
+    if (ctx->log_sink) {
+        /* Resize: let the current ring drain into the callback first */
+        acvp_log_sink_stop(ctx);
+    }
+    return acvp_log_sink_start(ctx, ring_size);
+#endif
+}
+
+ACVP_RESULT acvp_set_log_flush_policy(ACVP_CTX *ctx, ACVP_LOG_FLUSH policy) {
+    if (!ctx) {
+        return ACVP_NO_CTX;
+    }
+    if (policy < ACVP_LOG_FLUSH_EVERY || policy > ACVP_LOG_FLUSH_NONE) {
+        return ACVP_INVALID_ARG;
+    }
+    ctx->log_flush = policy;
+    return ACVP_SUCCESS;
+}
+
+ACVP_RESULT acvp_log_flush(ACVP_CTX *ctx) {
+    if (!ctx) {
+        return ACVP_NO_CTX;
+    }
+#ifndef _WIN32
+    if (ctx->log_sink) {
+        acvp_log_sink_wait(ctx->log_sink);
+    }
+#endif
+    fflush(stdout);
+    return ACVP_SUCCESS;
+}
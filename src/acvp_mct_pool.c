@@ -0,0 +1,212 @@
+/** @file */
+/*
+ * Copyright (c) 2024, Cisco Systems, Inc.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://github.com/cisco/libacvp/LICENSE
+ */
+
+/*
+ * Monte Carlo worker pool.
+ *
+ * Each MCT test case chains thousands of operations, but separate test cases
+ * of a vector set share nothing. When the application asks for more than one
+ * MCT thread, an algorithm handler sets its MCT test cases aside as jobs while
+ * it reads the vector set (their response objects already in place, so the
+ * response keeps its order) and hands them all to acvp_mct_jobs_run(). The
+ * calling thread and up to mct_threads - 1 others then take jobs in turn until
+ * none are left.
+ *
+ * Workers charge handler time to a record of their own, which is added to the
+ * context once they have all finished, and nothing else of the context is
+ * written to while they run.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "acvp.h"
+#include "acvp_lcl.h"
+#include "safe_lib.h"
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+#define ACVP_MCT_JOBS_GROW 16
+
+typedef struct acvp_mct_pool_t {
+    ACVP_CTX *ctx;
+    ACVP_MCT_JOBS *list;
+    ACVP_MCT_JOB_FN fn;
+    ACVP_RESULT *results;      /* one per job */
+    unsigned int next;         /* next job to hand out */
+    int failed;                /* set once any job fails; no more are handed out */
+} ACVP_MCT_POOL;
+
+typedef struct acvp_mct_worker_t {
+    ACVP_MCT_POOL *pool;
+    ACVP_WORKER_ACCT acct;
+#ifndef _WIN32
+    pthread_t thread;
+#endif
+    int started;
+} ACVP_MCT_WORKER;
+
+#if defined(__GNUC__)
+#define ACVP_MCT_TAKE(var) __atomic_fetch_add(&(var), 1, __ATOMIC_RELAXED)
+#define ACVP_MCT_LOAD(var) __atomic_load_n(&(var), __ATOMIC_RELAXED)
+#define ACVP_MCT_STORE(var, val) __atomic_store_n(&(var), (val), __ATOMIC_RELAXED)
+#else
+#define ACVP_MCT_TAKE(var) ((var)++)
+#define ACVP_MCT_LOAD(var) (var)
+#define ACVP_MCT_STORE(var, val) ((var) = (val))
+#endif
+
+void *acvp_mct_jobs_next(ACVP_MCT_JOBS *list) {
+    unsigned char *grown = NULL;
+    unsigned char *job = NULL;
+
+    if (!list || !list->job_size) {
+        return NULL;
+    }
+    if (list->count == list->max) {
+        grown = realloc(list->jobs, (list->max + ACVP_MCT_JOBS_GROW) * list->job_size);
+        if (!grown) {
+            return NULL;
+        }
+        list->jobs = grown;
+        list->max += ACVP_MCT_JOBS_GROW;
+    }
+    job = list->jobs + list->count * list->job_size;
+    memzero_s(job, list->job_size);
+    return job;
+}
+
+void acvp_mct_jobs_free(ACVP_MCT_JOBS *list) {
+    if (!list) {
+        return;
+    }
+    free(list->jobs);
+    list->jobs = NULL;
+    list->count = 0;
+    list->max = 0;
+}
+
+static void acvp_mct_pool_work(ACVP_MCT_WORKER *worker) {
+    ACVP_MCT_POOL *pool = worker->pool;
+    ACVP_RESULT rv = ACVP_SUCCESS;
+    unsigned int i = 0;
+
+    acvp_timing_worker_begin(&worker->acct);
+    while (!ACVP_MCT_LOAD(pool->failed)) {
+        i = ACVP_MCT_TAKE(pool->next);
+        if (i >= pool->list->count) {
+            break;
+        }
+        rv = pool->fn(pool->ctx, pool->list->jobs + i * pool->list->job_size);
+        pool->results[i] = rv;
+        if (rv != ACVP_SUCCESS) {
+            ACVP_MCT_STORE(pool->failed, 1);
+        }
+    }
+    acvp_timing_worker_end();
+}
+
+#ifndef _WIN32
+static void *acvp_mct_pool_thread(void *arg) {
+    acvp_mct_pool_work(arg);
+    return NULL;
+}
+#endif
+
+/*
+ * Runs every job in list through fn, on up to ctx->mct_threads threads.
+ * Returns the result of the first job (in list order) that did not succeed.
+ */
+ACVP_RESULT acvp_mct_jobs_run(ACVP_CTX *ctx, ACVP_CAPS_LIST *cap, ACVP_MCT_JOBS *list, ACVP_MCT_JOB_FN fn) {
+    ACVP_MCT_POOL pool;
+    ACVP_MCT_WORKER *workers = NULL;
+    ACVP_RESULT rv = ACVP_SUCCESS;
+    unsigned int threads = 0, i = 0;
+
+    if (!ctx || !list || !fn) {
+        return ACVP_INVALID_ARG;
+    }
+    if (!list->count) {
+        return ACVP_SUCCESS;
+    }
+
+    threads = ctx->mct_threads ? ctx->mct_threads : 1;
+    if (threads > list->count) {
+        threads = list->count;
+    }
+#ifdef _WIN32
+    threads = 1;
+#endif
+
+    memzero_s(&pool, sizeof(pool));
+    pool.ctx = ctx;
+    pool.list = list;
+    pool.fn = fn;
+    pool.results = calloc(list->count, sizeof(ACVP_RESULT));
+    workers = calloc(threads, sizeof(ACVP_MCT_WORKER));
+    if (!pool.results || !workers) {
+        free(pool.results);
+        free(workers);
+        return ACVP_MALLOC_FAIL;
+    }
+    for (i = 0; i < list->count; i++) {
+        pool.results[i] = ACVP_SUCCESS;
+    }
+
+    /* Worker 0 is this thread; if a thread can't be started the others take its share */
+    for (i = 0; i < threads; i++) {
+        workers[i].pool = &pool;
+    }
+#ifndef _WIN32
+    for (i = 1; i < threads; i++) {
+        if (pthread_create(&workers[i].thread, NULL, acvp_mct_pool_thread, &workers[i]) == 0) {
+            workers[i].started = 1;
+        } else {
+            ACVP_LOG_WARN("Unable to start MCT worker thread %u; continuing with fewer", i);
+            break;
+        }
+    }
+#endif
+    acvp_mct_pool_work(&workers[0]);
+    for (i = 0; i < threads; i++) {
+#ifndef _WIN32
+        if (workers[i].started) {
+            pthread_join(workers[i].thread, NULL);
+        }
+#endif
+        acvp_timing_worker_merge(ctx, cap, &workers[i].acct);
+    }
+
+    for (i = 0; i < list->count; i++) {
+        if (pool.results[i] != ACVP_SUCCESS) {
+            rv = pool.results[i];
+            break;
+        }
+    }
+    free(pool.results);
+    free(workers);
+    return rv;
+}
+
+ACVP_RESULT acvp_set_mct_threads(ACVP_CTX *ctx, unsigned int threads) {
+    if (!ctx) {
+        return ACVP_NO_CTX;
+    }
+#ifdef _WIN32
+    if (threads > 1) {
+        ACVP_LOG_WARN("MCT worker threads are not supported on this platform; running them in turn");
+        return ACVP_UNSUPPORTED_OP;
+    }
+#endif
+    ctx->mct_threads = threads;
+    return ACVP_SUCCESS;
+}
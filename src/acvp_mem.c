@@ -0,0 +1,342 @@
+/** @file */
+/*
+ * Copyright (c) 2024, Cisco Systems, Inc.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://github.com/cisco/libacvp/LICENSE
+ */
+
+/*
+ * Memory accounting.
+ *
+ * While any context has accounting enabled, parson's allocator hook and the
+ * library's larger buffers (transport and test case scratch) go through
+ * acvp_mem_malloc()/acvp_mem_free(), which keep a running total of the bytes
+ * held. Sizes are taken from the allocator itself rather than a header in
+ * front of each block, so memory allocated before accounting was switched on
+ * (or after it was switched off) can still be freed either way; at worst the
+ * totals are briefly off by those blocks.
+ *
+ * The JSON allocator is process wide, so the counters are too. Each vector
+ * set's peak is recorded in the context that processed it.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "acvp.h"
+#include "acvp_lcl.h"
+#include "parson.h"
+#include "safe_lib.h"
+
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#define acvp_mem_block_size(ptr) malloc_size(ptr)
+#elif defined(_WIN32)
+#include <malloc.h>
+#define acvp_mem_block_size(ptr) _msize(ptr)
+#elif defined(__GLIBC__) || defined(__linux__) || defined(__FreeBSD__)
+#include <malloc.h>
+#define acvp_mem_block_size(ptr) malloc_usable_size(ptr)
+#else
+#define ACVP_MEM_NO_BLOCK_SIZE
+#define acvp_mem_block_size(ptr) ((size_t)0)
+#endif
+
+#if defined(__GNUC__)
+#define ACVP_MEM_ADD(var, val) __atomic_add_fetch(&(var), (val), __ATOMIC_RELAXED)
+#define ACVP_MEM_LOAD(var) __atomic_load_n(&(var), __ATOMIC_RELAXED)
+#define ACVP_MEM_STORE(var, val) __atomic_store_n(&(var), (val), __ATOMIC_RELAXED)
+#else
+#define ACVP_MEM_ADD(var, val) ((var) += (val))
+#define ACVP_MEM_LOAD(var) (var)
+#define ACVP_MEM_STORE(var, val) ((var) = (val))
+#endif
+
+static int acvp_mem_users = 0;            /* contexts with accounting enabled */
+static long long int acvp_mem_current = 0;
+static long long int acvp_mem_peak = 0;
+static long long int acvp_mem_vs_peak = 0;
+
+static void acvp_mem_raise(long long int *peak, long long int now) {
+#if defined(__GNUC__)
+    long long int seen = __atomic_load_n(peak, __ATOMIC_RELAXED);
+
+    while (now > seen &&
+           !__atomic_compare_exchange_n(peak, &seen, now, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+#else
+    if (now > *peak) {
+        *peak = now;
+    }
+#endif
+}
+
+static size_t acvp_mem_clamp(long long int val) {
+    return val > 0 ? (size_t)val : 0;
+}
+
+void *acvp_mem_malloc(size_t size) {
+    void *ptr = malloc(size);
+    long long int now = 0;
+
+    if (ptr && ACVP_MEM_LOAD(acvp_mem_users)) {
+        now = ACVP_MEM_ADD(acvp_mem_current, (long long int)acvp_mem_block_size(ptr));
+        acvp_mem_raise(&acvp_mem_peak, now);
+        acvp_mem_raise(&acvp_mem_vs_peak, now);
+    }
+    return ptr;
+}
+
+void *acvp_mem_calloc(size_t nmemb, size_t size) {
+    void *ptr = calloc(nmemb, size);
+    long long int now = 0;
+
+    if (ptr && ACVP_MEM_LOAD(acvp_mem_users)) {
+        now = ACVP_MEM_ADD(acvp_mem_current, (long long int)acvp_mem_block_size(ptr));
+        acvp_mem_raise(&acvp_mem_peak, now);
+        acvp_mem_raise(&acvp_mem_vs_peak, now);
+    }
+    return ptr;
+}
+
+void acvp_mem_free(void *ptr) {
+    if (!ptr) {
+        return;
+    }
+    if (ACVP_MEM_LOAD(acvp_mem_users)) {
+        ACVP_MEM_ADD(acvp_mem_current, -(long long int)acvp_mem_block_size(ptr));
+    }
+    free(ptr);
+}
+
+size_t acvp_mem_current_usage(void) {
+    return acvp_mem_clamp(ACVP_MEM_LOAD(acvp_mem_current));
+}
+
+void acvp_mem_begin_vs(ACVP_CTX *ctx) {
+    if (!ctx || !ctx->mem_accounting) {
+        return;
+    }
+    ACVP_MEM_STORE(acvp_mem_vs_peak, ACVP_MEM_LOAD(acvp_mem_current));
+}
+
+/* The record of vs_id on ctx, added to the end of the list if it has none yet */
+static ACVP_MEM_VS *acvp_mem_vs_record(ACVP_CTX *ctx, int vs_id) {
+    ACVP_MEM_VS *rec = NULL, *tail = NULL;
+
+    for (rec = ctx->mem_vs_list; rec; rec = rec->next) {
+        if (rec->vs_id == vs_id) {
+            return rec;
+        }
+        tail = rec;
+    }
+    rec = calloc(1, sizeof(ACVP_MEM_VS));
+    if (!rec) {
+        return NULL;
+    }
+    rec->vs_id = vs_id;
+    if (tail) {
+        tail->next = rec;
+    } else {
+        ctx->mem_vs_list = rec;
+    }
+    return rec;
+}
+
+void acvp_mem_end_vs(ACVP_CTX *ctx, int vs_id) {
+    ACVP_MEM_VS *rec = NULL;
+
+    if (!ctx || !ctx->mem_accounting || !vs_id) {
+        return;
+    }
+
+    /* A deferred vector set is seen twice; keep the larger of its peaks */
+    rec = acvp_mem_vs_record(ctx, vs_id);
+    if (rec && acvp_mem_clamp(ACVP_MEM_LOAD(acvp_mem_vs_peak)) > rec->peak) {
+        rec->peak = acvp_mem_clamp(ACVP_MEM_LOAD(acvp_mem_vs_peak));
+    }
+}
+
+/*
+ * Notes that vs_id, estimated to need need bytes, was left unprocessed
+ * because it did not fit the budget even after the rest of the session.
+ */
+void acvp_mem_skip_vs(ACVP_CTX *ctx, int vs_id, size_t need) {
+    ACVP_MEM_VS *rec = NULL;
+
+    if (!ctx || !ctx->mem_accounting || !vs_id) {
+        return;
+    }
+    rec = acvp_mem_vs_record(ctx, vs_id);
+    if (rec) {
+        rec->skipped_need = need ? need : 1;
+    }
+}
+
+/*
+ * Rough working set for processing a vector set that has just been parsed:
+ * the response tree and its serialized form are comparable in size to the
+ * request, and large data tests are expanded to their full length by the
+ * module unless they are streamed to it a chunk at a time.
+ */
+size_t acvp_mem_estimate_vs(ACVP_CTX *ctx, JSON_Object *obj, size_t tree_bytes, size_t body_len) {
+    JSON_Array *groups = NULL, *tests = NULL;
+    JSON_Object *ldt = NULL;
+    ACVP_CAPS_LIST *cap = NULL;
+    const char *alg_str = NULL;
+    size_t i = 0, j = 0, g_cnt = 0, t_cnt = 0, need = 0, chunk = 0;
+
+    need = tree_bytes + body_len;
+    alg_str = json_object_get_string(obj, "algorithm");
+    if (ctx && alg_str) {
+        cap = acvp_locate_cap_entry(ctx, acvp_lookup_cipher_index(alg_str));
+        if (cap && cap->cap_type == ACVP_HASH_TYPE && cap->cap.hash_cap) {
+            chunk = cap->cap.hash_cap->ldt_chunk_len;
+        }
+    }
+    groups = json_object_get_array(obj, "testGroups");
+    g_cnt = json_array_get_count(groups);
+    for (i = 0; i < g_cnt; i++) {
+        tests = json_object_get_array(json_array_get_object(groups, i), "tests");
+        t_cnt = json_array_get_count(tests);
+        for (j = 0; j < t_cnt; j++) {
+            ldt = json_object_get_object(json_array_get_object(tests, j), "largeMsg");
+            if (ldt) {
+                need += chunk ? chunk : (size_t)(json_object_get_number(ldt, "fullLength") / 8);
+            }
+        }
+    }
+    return need;
+}
+
+/*
+ * Whether starting work needing an estimated need bytes would take the
+ * library past the context's budget.
+ */
+int acvp_mem_over_budget(ACVP_CTX *ctx, size_t need) {
+    if (!ctx || !ctx->mem_accounting || !ctx->mem_budget) {
+        return 0;
+    }
+    return acvp_mem_current_usage() + need > ctx->mem_budget;
+}
+
+void acvp_mem_free_ctx(ACVP_CTX *ctx) {
+    ACVP_MEM_VS *rec = NULL, *next = NULL;
+
+    if (!ctx) {
+        return;
+    }
+    for (rec = ctx->mem_vs_list; rec; rec = next) {
+        next = rec->next;
+        free(rec);
+    }
+    ctx->mem_vs_list = NULL;
+    acvp_enable_mem_accounting(ctx, 0);
+}
+
+void acvp_log_mem_usage(ACVP_CTX *ctx) {
+    ACVP_MEM_VS *rec = NULL;
+
+    if (!ctx || !ctx->mem_accounting || !ACVP_LOG_ENABLED(ctx, ACVP_LOG_LVL_STATUS)) {
+        return;
+    }
+    ACVP_LOG_STATUS("Memory held by libacvp: peak %.1f MB, currently %.1f MB%s",
+                    (double)acvp_mem_clamp(ACVP_MEM_LOAD(acvp_mem_peak)) / (1024.0 * 1024.0),
+                    (double)acvp_mem_current_usage() / (1024.0 * 1024.0),
+                    ctx->mem_budget ? "" : " (no budget set)");
+    for (rec = ctx->mem_vs_list; rec; rec = rec->next) {
+        if (rec->skipped_need) {
+            ACVP_LOG_STATUS("    vsId %d: skipped, needs about %.1f MB", rec->vs_id,
+                            (double)rec->skipped_need / (1024.0 * 1024.0));
+        } else {
+            ACVP_LOG_STATUS("    vsId %d: peak %.1f MB", rec->vs_id, (double)rec->peak / (1024.0 * 1024.0));
+        }
+    }
+}
+
+ACVP_RESULT acvp_enable_mem_accounting(ACVP_CTX *ctx, int enable) {
+    if (!ctx) {
+        return ACVP_NO_CTX;
+    }
+#ifdef ACVP_MEM_NO_BLOCK_SIZE
+    if (enable) {
+        ACVP_LOG_ERR("Memory accounting is not supported on this platform");
+        return ACVP_UNSUPPORTED_OP;
+    }
+#endif
+    enable = enable ? 1 : 0;
+    if (ctx->mem_accounting == enable) {
+        return ACVP_SUCCESS;
+    }
+    ctx->mem_accounting = enable;
+
+    /* The first context in installs the JSON allocator hook, the last one out removes it */
+    if (enable) {
+        if (ACVP_MEM_ADD(acvp_mem_users, 1) == 1) {
+            json_set_allocation_functions(acvp_mem_malloc, acvp_mem_free);
+        }
+    } else {
+        if (ACVP_MEM_ADD(acvp_mem_users, -1) == 0) {
+            json_set_allocation_functions(malloc, free);
+            ACVP_MEM_STORE(acvp_mem_current, 0);
+            ACVP_MEM_STORE(acvp_mem_peak, 0);
+        }
+    }
+    return ACVP_SUCCESS;
+}
+
+ACVP_RESULT acvp_set_mem_budget(ACVP_CTX *ctx, size_t budget) {
+    ACVP_RESULT rv = ACVP_SUCCESS;
+
+    if (!ctx) {
+        return ACVP_NO_CTX;
+    }
+    if (budget) {
+        rv = acvp_enable_mem_accounting(ctx, 1);
+        if (rv != ACVP_SUCCESS) {
+            return rv;
+        }
+    }
+    ctx->mem_budget = budget;
+    return ACVP_SUCCESS;
+}
+
+ACVP_RESULT acvp_get_mem_usage(ACVP_CTX *ctx, size_t *current, size_t *peak) {
+    if (!ctx) {
+        return ACVP_NO_CTX;
+    }
+    if (!current && !peak) {
+        return ACVP_INVALID_ARG;
+    }
+    if (!ctx->mem_accounting) {
+        return ACVP_UNSUPPORTED_OP;
+    }
+    if (current) {
+        *current = acvp_mem_current_usage();
+    }
+    if (peak) {
+        *peak = acvp_mem_clamp(ACVP_MEM_LOAD(acvp_mem_peak));
+    }
+    return ACVP_SUCCESS;
+}
+
+ACVP_RESULT acvp_get_vs_mem_peak(ACVP_CTX *ctx, int vs_id, size_t *peak) {
+    ACVP_MEM_VS *rec = NULL;
+
+    if (!ctx) {
+        return ACVP_NO_CTX;
+    }
+    if (!peak) {
+        return ACVP_INVALID_ARG;
+    }
+    for (rec = ctx->mem_vs_list; rec; rec = rec->next) {
+        if (rec->vs_id == vs_id) {
+            *peak = rec->peak;
+            return ACVP_SUCCESS;
+        }
+    }
+    return ACVP_NO_DATA;
+}
@@ -0,0 +1,200 @@
+/** @file */
+/*
+ * Copyright (c) 2024, Cisco Systems, Inc.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://github.com/cisco/libacvp/LICENSE
+ */
+
+/*
+ * Structured progress reporting.
+ *
+ * The session loops tell us how many vector sets there are, dispatch marks
+ * each vector set's start and end, and every handler calls
+ * acvp_progress_tc_done() as it appends a test case result. Counting is
+ * always on; the clock is only read when a callback is registered, in which
+ * case each test case's duration is also charged to its capability so the
+ * estimate reflects the throughput of that algorithm in the module.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "acvp.h"
+#include "acvp_lcl.h"
+#include "parson.h"
+#include "safe_lib.h"
+
+static double acvp_progress_eta(ACVP_PROGRESS_STATE *st) {
+    ACVP_PROGRESS *info = &st->info;
+    double eta = 0.0;
+    int pending = 0;
+
+    pending = info->vs_total - info->vs_done;
+    if (info->vs_id) {
+        /* Rest of the current vector set at this algorithm's observed rate */
+        if (!st->cap || !st->cap->progress_tc) {
+            return -1.0;
+        }
+        eta += (double)(info->tc_total - info->tc_done) *
+               ((double)st->cap->progress_ns / st->cap->progress_tc) / 1e9;
+        pending--;
+    }
+    if (pending > 0) {
+        if (!info->vs_done) {
+            return -1.0;
+        }
+        eta += pending * ((double)st->done_ns / info->vs_done) / 1e9;
+    }
+    return eta;
+}
+
+static void acvp_progress_report(ACVP_CTX *ctx, unsigned long long int now) {
+    ACVP_PROGRESS_STATE *st = &ctx->progress;
+
+    if (!st->cb) {
+        return;
+    }
+    if (!now) {
+        now = acvp_timing_clock();
+    }
+    st->info.elapsed_seconds = st->start_ns ? (double)(now - st->start_ns) / 1e9 : 0.0;
+    st->info.eta_seconds = acvp_progress_eta(st);
+    st->last_report_ns = now;
+    st->cb(&st->info, st->arg);
+}
+
+void acvp_progress_begin_session(ACVP_CTX *ctx, int vs_total) {
+    if (!ctx) {
+        return;
+    }
+    ctx->progress.info.vs_total = vs_total;
+    ctx->progress.info.vs_done = 0;
+}
+
+static int acvp_progress_count_tests(JSON_Object *obj) {
+    JSON_Array *groups = NULL;
+    JSON_Object *group = NULL;
+    size_t i = 0, count = 0;
+    int total = 0;
+
+    groups = json_object_get_array(obj, "testGroups");
+    count = json_array_get_count(groups);
+    for (i = 0; i < count; i++) {
+        group = json_array_get_object(groups, i);
+        total += (int)json_array_get_count(json_object_get_array(group, "tests"));
+    }
+    return total;
+}
+
+void acvp_progress_begin_vs(ACVP_CTX *ctx, ACVP_CIPHER cipher, int vs_id, const char *alg, const char *mode, JSON_Object *obj) {
+    ACVP_PROGRESS_STATE *st = NULL;
+    unsigned long long int now = 0;
+
+    if (!ctx) {
+        return;
+    }
+    st = &ctx->progress;
+    st->info.vs_id = vs_id;
+    st->info.algorithm = alg;
+    st->info.mode = mode;
+    st->info.tc_total = acvp_progress_count_tests(obj);
+    st->info.tc_done = 0;
+    st->cap = acvp_locate_cap_entry(ctx, cipher);
+    if (st->info.vs_total < st->info.vs_done + 1) {
+        /* Vector sets processed without a session total, e.g. a single set from a file */
+        st->info.vs_total = st->info.vs_done + 1;
+    }
+
+    if (!st->cb) {
+        return;
+    }
+    now = acvp_timing_clock();
+    if (!st->start_ns) {
+        st->start_ns = now;
+    }
+    st->last_tc_ns = now;
+    acvp_progress_report(ctx, now);
+}
+
+void acvp_progress_end_vs(ACVP_CTX *ctx) {
+    ACVP_PROGRESS_STATE *st = NULL;
+    unsigned long long int now = 0;
+
+    if (!ctx || !ctx->progress.info.vs_id) {
+        return;
+    }
+    st = &ctx->progress;
+    st->info.vs_done++;
+    if (st->cb) {
+        now = acvp_timing_clock();
+        if (st->start_ns) {
+            st->done_ns = now - st->start_ns;
+        }
+    }
+    st->info.vs_id = 0;
+    st->info.algorithm = NULL;
+    st->info.mode = NULL;
+    st->info.tc_total = 0;
+    st->info.tc_done = 0;
+    st->cap = NULL;
+    acvp_progress_report(ctx, now);
+}
+
+/*
+ * Called by the algorithm handlers for each test case response they build.
+ */
+void acvp_progress_tc_done(ACVP_CTX *ctx) {
+    ACVP_PROGRESS_STATE *st = NULL;
+    unsigned long long int now = 0;
+
+    if (!ctx) {
+        return;
+    }
+    st = &ctx->progress;
+    st->info.tc_done++;
+    st->info.tc_done_session++;
+    if (!st->cb) {
+        return;
+    }
+
+    now = acvp_timing_clock();
+    if (st->cap && st->last_tc_ns) {
+        st->cap->progress_ns += now - st->last_tc_ns;
+        st->cap->progress_tc++;
+    }
+    st->last_tc_ns = now;
+    if (now - st->last_report_ns >= st->interval_ns) {
+        acvp_progress_report(ctx, now);
+    }
+}
+
+ACVP_RESULT acvp_set_progress_callback(ACVP_CTX *ctx, ACVP_PROGRESS_CB cb, void *arg, unsigned int interval_ms) {
+    if (!ctx) {
+        return ACVP_NO_CTX;
+    }
+    ctx->progress.cb = cb;
+    ctx->progress.arg = arg;
+    ctx->progress.interval_ns = (unsigned long long int)interval_ms * 1000000ULL;
+    return ACVP_SUCCESS;
+}
+
+ACVP_RESULT acvp_get_progress(ACVP_CTX *ctx, ACVP_PROGRESS *progress) {
+    ACVP_PROGRESS_STATE *st = NULL;
+
+    if (!ctx) {
+        return ACVP_NO_CTX;
+    }
+    if (!progress) {
+        return ACVP_INVALID_ARG;
+    }
+    st = &ctx->progress;
+    *progress = st->info;
+    if (st->start_ns) {
+        progress->elapsed_seconds = (double)(acvp_timing_clock() - st->start_ns) / 1e9;
+    }
+    progress->eta_seconds = acvp_progress_eta(st);
+    return ACVP_SUCCESS;
+}
@@ -450,7 +450,6 @@ ACVP_RESULT acvp_rsa_decprim_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
 
     ACVP_CIPHER alg_id;
     ACVP_RSA_PUB_EXP_MODE pub_exp_mode = 0;
-    char *json_result = NULL;
     unsigned int mod = 0, total = 0, fail = 0, pass = 0;
     const char *alg_str = NULL, *mode_str = NULL, *cipher = NULL, *rev_str = NULL, *key_format = NULL, *pub_exp_mode_str = NULL,
                *e_str = NULL, *n_str = NULL, *d_str = NULL, *p_str = NULL, *q_str = NULL,
@@ -677,7 +676,7 @@ ACVP_RESULT acvp_rsa_decprim_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
                        fail = stc.fail;
                        pass = stc.pass;
                        do {
-                           if ((cap->crypto_handler)(&tc)) {
+                           if (acvp_invoke_crypto_handler(ctx, cap, &tc)) {
                                ACVP_LOG_ERR("ERROR: crypto module failed the operation");
                                rv = ACVP_CRYPTO_MODULE_FAIL;
                                json_value_free(r_tval);
@@ -756,7 +755,7 @@ ACVP_RESULT acvp_rsa_decprim_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
                 rv = acvp_rsa_decprim_init_tc_rev_56br2(ctx, &stc, keyformat, mod, keyformat, d_str, e_str, n_str, p_str,
                                                         q_str, dmp1_str, dmq1_str, iqmp_str, cipher);
                 if (rv == ACVP_SUCCESS) {
-                    if ((cap->crypto_handler)(&tc)) {
+                    if (acvp_invoke_crypto_handler(ctx, cap, &tc)) {
                         ACVP_LOG_ERR("ERROR: crypto module failed the operation");
                         rv = ACVP_CRYPTO_MODULE_FAIL;
                         json_value_free(r_tval);
@@ -778,14 +777,13 @@ ACVP_RESULT acvp_rsa_decprim_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
 
             /* Append the test response value to array */
             json_array_append_value(r_tarr, r_tval);
+            acvp_progress_tc_done(ctx);
         }
         json_array_append_value(r_garr, r_gval);
     }
     json_array_append_value(reg_arry, r_vs_val);
 
-    json_result = json_serialize_to_string_pretty(ctx->kat_resp, NULL);
-    ACVP_LOG_VERBOSE("\n\n%s\n\n", json_result);
-    json_free_serialized_string(json_result);
+    ACVP_LOG_VERBOSE_JSON(ctx->kat_resp);
     rv = ACVP_SUCCESS;
 
 err:
@@ -825,7 +823,6 @@ ACVP_RESULT acvp_rsa_sigprim_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
     unsigned int keyformat = 0;
     const char *key_format = NULL;
     ACVP_CIPHER alg_id;
-    char *json_result = NULL;
     const char *mode_str;
     const char *msg;
     const char *e_str = NULL, *n_str = NULL, *d_str = NULL, *p_str = NULL, *q_str = NULL,
@@ -1063,7 +1060,7 @@ ACVP_RESULT acvp_rsa_sigprim_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
 
             /* Process the current test vector... */
             if (rv == ACVP_SUCCESS) {
-                if ((cap->crypto_handler)(&tc)) {
+                if (acvp_invoke_crypto_handler(ctx, cap, &tc)) {
                     ACVP_LOG_ERR("ERROR: crypto module failed the operation");
                     rv = ACVP_CRYPTO_MODULE_FAIL;
                     json_value_free(r_tval);
@@ -1088,15 +1085,14 @@ ACVP_RESULT acvp_rsa_sigprim_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
 
             /* Append the test response value to array */
             json_array_append_value(r_tarr, r_tval);
+            acvp_progress_tc_done(ctx);
         }
         json_array_append_value(r_garr, r_gval);
     }
 
     json_array_append_value(reg_arry, r_vs_val);
 
-    json_result = json_serialize_to_string_pretty(ctx->kat_resp, NULL);
-    ACVP_LOG_VERBOSE("\n\n%s\n\n", json_result);
-    json_free_serialized_string(json_result);
+    ACVP_LOG_VERBOSE_JSON(ctx->kat_resp);
     rv = ACVP_SUCCESS;
 
 err:
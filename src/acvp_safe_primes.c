@@ -176,7 +176,6 @@ ACVP_RESULT acvp_safe_primes_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
     ACVP_SAFE_PRIMES_TC stc;
     ACVP_RESULT rv = ACVP_SUCCESS;
     const char *alg_str = NULL, *dgm_str = NULL, *test_type_str = NULL;
-    char *json_result = NULL;
     ACVP_CIPHER alg_id;
     ACVP_SAFE_PRIMES_PARAM dgm;
     ACVP_SAFE_PRIMES_TEST_TYPE test_type;
@@ -339,7 +338,7 @@ ACVP_RESULT acvp_safe_primes_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
                 }
 
                 /* Process the current KAT test vector... */
-                if ((cap->crypto_handler)(&tc)) {
+                if (acvp_invoke_crypto_handler(ctx, cap, &tc)) {
                     acvp_safe_primes_release_tc(&stc);
                     ACVP_LOG_ERR("crypto module failed the operation");
                     rv = ACVP_CRYPTO_MODULE_FAIL;
@@ -365,6 +364,7 @@ ACVP_RESULT acvp_safe_primes_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
 
                 /* Append the test response value to array */
                 json_array_append_value(r_tarr, r_tval);
+                acvp_progress_tc_done(ctx);
             }
             break;
         
@@ -436,7 +436,7 @@ ACVP_RESULT acvp_safe_primes_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
                 }
 
                 /* Process the current KAT test vector... */
-                if ((cap->crypto_handler)(&tc)) {
+                if (acvp_invoke_crypto_handler(ctx, cap, &tc)) {
                     acvp_safe_primes_release_tc(&stc);
                     ACVP_LOG_ERR("crypto module failed the operation");
                     rv = ACVP_CRYPTO_MODULE_FAIL;
@@ -462,6 +462,7 @@ ACVP_RESULT acvp_safe_primes_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
 
                 /* Append the test response value to array */
                 json_array_append_value(r_tarr, r_tval);
+                acvp_progress_tc_done(ctx);
             }
             break;
         case ACVP_SUB_KAS_ECC_CDH:
@@ -483,9 +484,7 @@ ACVP_RESULT acvp_safe_primes_kat_handler(ACVP_CTX *ctx, JSON_Object *obj) {
     }
     json_array_append_value(reg_arry, r_vs_val);
 
-    json_result = json_serialize_to_string_pretty(ctx->kat_resp, NULL);
-    ACVP_LOG_VERBOSE("\n\n%s\n\n", json_result);
-    json_free_serialized_string(json_result);
+    ACVP_LOG_VERBOSE_JSON(ctx->kat_resp);
     rv = ACVP_SUCCESS;
 
 err:
@@ -0,0 +1,868 @@
+/** @file */
+/*
+ * Copyright (c) 2024, Cisco Systems, Inc.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://github.com/cisco/libacvp/LICENSE
+ */
+
+/*
+ * Per vector set phase timing and per algorithm crypto_handler statistics.
+ *
+ * When enabled, acvp_process_vsid() (and the offline equivalents) open a
+ * timing record for each vector set; the transport, dispatch and handler
+ * code then charge elapsed time to the phases of the current record. Every
+ * phase other than crypto is also kept as a span so the session can be
+ * exported as a Chrome trace; crypto_handler calls are far too numerous for
+ * that and are only aggregated.
+ *
+ * Handler statistics are kept on the capability itself: one latency
+ * histogram per test type, fed by acvp_invoke_crypto_handler().
+ *
+ * Monte Carlo tests may run on worker threads (see acvp_mct_pool.c). A
+ * worker charges its handler time and statistics to a record of its own,
+ * found through a thread local pointer, and the thread that started the
+ * workers folds those into the context once they have finished.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "acvp.h"
+#include "acvp_lcl.h"
+#include "parson.h"
+#include "safe_lib.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#define ACVP_THREAD_LOCAL __declspec(thread)
+#else
+#include <time.h>
+#define ACVP_THREAD_LOCAL __thread
+#endif
+
+/* Set on worker threads while they run Monte Carlo tests */
+static ACVP_THREAD_LOCAL ACVP_WORKER_ACCT *acvp_worker_acct = NULL;
+
+static const char *acvp_phase_names[ACVP_PHASE_MAX] = {
+    "download",
+    "retryWait",
+    "parse",
+    "dispatch",
+    "crypto",
+    "responseBuild",
+    "serialize",
+    "upload"
+};
+
+unsigned long long int acvp_timing_clock(void) {
+#ifdef _WIN32
+    LARGE_INTEGER freq, count;
+
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (unsigned long long int)(count.QuadPart / freq.QuadPart) * 1000000000ULL +
+           (unsigned long long int)(count.QuadPart % freq.QuadPart) * 1000000000ULL / freq.QuadPart;
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long int)ts.tv_sec * 1000000000ULL + (unsigned long long int)ts.tv_nsec;
+#endif
+}
+
+/*
+ * Returns a timestamp (ns) to pass to acvp_timing_record(), or 0 when
+ * nothing is being timed so callers do not pay for reading the clock.
+ */
+unsigned long long int acvp_timing_now(ACVP_CTX *ctx) {
+    if (!ctx || !ctx->timing_cur) {
+        return 0;
+    }
+    return acvp_timing_clock();
+}
+
+/*
+ * Charges the time elapsed since start (from acvp_timing_now) to phase of
+ * the vector set currently being timed.
+ */
+void acvp_timing_record(ACVP_CTX *ctx, ACVP_PHASE phase, unsigned long long int start) {
+    ACVP_VS_TIMING *cur = NULL;
+    ACVP_TIMING_SPAN *span = NULL;
+    unsigned long long int now = 0;
+
+    if (!ctx || !ctx->timing_cur || !start || phase >= ACVP_PHASE_MAX) {
+        return;
+    }
+    now = acvp_timing_clock();
+    if (acvp_worker_acct) {
+        /* Workers only ever call into the module */
+        if (phase == ACVP_PHASE_CRYPTO) {
+            acvp_worker_acct->crypto_ns += now - start;
+            acvp_worker_acct->crypto_count++;
+        }
+        return;
+    }
+    cur = ctx->timing_cur;
+    cur->phase_ns[phase] += now - start;
+    cur->phase_count[phase]++;
+
+    if (phase != ACVP_PHASE_CRYPTO && cur->span_count < ACVP_TIMING_MAX_SPANS) {
+        span = &cur->spans[cur->span_count++];
+        span->phase = phase;
+        span->start_ns = start;
+        span->dur_ns = now - start;
+    }
+}
+
+/*
+ * Opens a timing record for the next vector set. Records stay on the ctx
+ * until it is freed so they can be queried/exported after the session.
+ */
+ACVP_RESULT acvp_timing_begin_vs(ACVP_CTX *ctx) {
+    ACVP_VS_TIMING *rec = NULL, *tail = NULL;
+
+    if (!ctx) {
+        return ACVP_NO_CTX;
+    }
+    if (!ctx->timing_enabled) {
+        return ACVP_SUCCESS;
+    }
+
+    rec = calloc(1, sizeof(ACVP_VS_TIMING));
+    if (!rec) {
+        return ACVP_MALLOC_FAIL;
+    }
+    rec->start_ns = acvp_timing_clock();
+    if (!ctx->timing_epoch_ns) {
+        ctx->timing_epoch_ns = rec->start_ns;
+    }
+
+    if (!ctx->timing_list) {
+        ctx->timing_list = rec;
+    } else {
+        tail = ctx->timing_list;
+        while (tail->next) {
+            tail = tail->next;
+        }
+        tail->next = rec;
+    }
+    ctx->timing_cur = rec;
+    return ACVP_SUCCESS;
+}
+
+/*
+ * Closes the current record. vs_id is 0 for work that is not tied to a
+ * single vector set (e.g. parsing a whole offline request file).
+ */
+void acvp_timing_end_vs(ACVP_CTX *ctx, int vs_id) {
+    ACVP_VS_TIMING *cur = NULL;
+
+    if (!ctx || !ctx->timing_cur) {
+        return;
+    }
+    cur = ctx->timing_cur;
+    cur->vs_id = vs_id;
+    cur->end_ns = acvp_timing_clock();
+
+    /* Whatever the handler did besides calling into the module */
+    if (cur->phase_ns[ACVP_PHASE_DISPATCH] > cur->phase_ns[ACVP_PHASE_CRYPTO]) {
+        cur->phase_ns[ACVP_PHASE_RESPONSE_BUILD] = cur->phase_ns[ACVP_PHASE_DISPATCH] -
+                                                   cur->phase_ns[ACVP_PHASE_CRYPTO];
+        cur->phase_count[ACVP_PHASE_RESPONSE_BUILD] = cur->phase_count[ACVP_PHASE_DISPATCH];
+    }
+    ctx->timing_cur = NULL;
+}
+
+void acvp_timing_free(ACVP_CTX *ctx) {
+    ACVP_VS_TIMING *rec = NULL, *next = NULL;
+
+    if (!ctx) {
+        return;
+    }
+    rec = ctx->timing_list;
+    while (rec) {
+        next = rec->next;
+        free(rec);
+        rec = next;
+    }
+    ctx->timing_list = NULL;
+    ctx->timing_cur = NULL;
+    ctx->timing_epoch_ns = 0;
+}
+
+/*
+ * The test type of a test case, for the algorithms whose test cases carry
+ * one. Every member of the tc union is a pointer, so the NULL check holds
+ * for all of them.
+ */
+static int acvp_stats_test_type(ACVP_CAPS_LIST *cap, ACVP_TEST_CASE *tc) {
+    if (!tc || !tc->tc.symmetric) {
+        return 0;
+    }
+    switch (cap->cap_type) {
+    case ACVP_SYM_TYPE:
+        return tc->tc.symmetric->test_type;
+    case ACVP_HASH_TYPE:
+        return tc->tc.hash->test_type;
+    case ACVP_CMAC_TYPE:
+        return tc->tc.cmac->test_type;
+    case ACVP_KMAC_TYPE:
+        return tc->tc.kmac->test_type;
+    case ACVP_PBKDF_TYPE:
+        return tc->tc.pbkdf->test_type;
+    case ACVP_KDF_TLS13_TYPE:
+        return tc->tc.kdf_tls13->test_type;
+    case ACVP_RSA_KEYGEN_TYPE:
+        return tc->tc.rsa_keygen->test_type;
+    case ACVP_KAS_ECC_CDH_TYPE:
+    case ACVP_KAS_ECC_COMP_TYPE:
+    case ACVP_KAS_ECC_NOCOMP_TYPE:
+    case ACVP_KAS_ECC_SSC_TYPE:
+        return tc->tc.kas_ecc->test_type;
+    case ACVP_KAS_FFC_COMP_TYPE:
+    case ACVP_KAS_FFC_SSC_TYPE:
+    case ACVP_KAS_FFC_NOCOMP_TYPE:
+        return tc->tc.kas_ffc->test_type;
+    case ACVP_KAS_IFC_TYPE:
+        return tc->tc.kas_ifc->test_type;
+    case ACVP_KTS_IFC_TYPE:
+        return tc->tc.kts_ifc->test_type;
+    case ACVP_SAFE_PRIMES_KEYGEN_TYPE:
+    case ACVP_SAFE_PRIMES_KEYVER_TYPE:
+        return tc->tc.safe_primes->test_type;
+    default:
+        return 0;
+    }
+}
+
+static const char *acvp_stats_test_type_name(ACVP_CAP_TYPE cap_type, int test_type) {
+    static const char *sym_names[] = { NULL, "AFT", "CTR", "MCT" };
+    static const char *hash_names[] = { NULL, "AFT", "MCT", "VOT", "LDT" };
+    static const char *kmac_names[] = { NULL, "AFT", "MVT" };
+    static const char *rsa_names[] = { NULL, "KAT", "AFT", "GDT" };
+    static const char *kas_names[] = { NULL, "AFT", "VAL" };
+
+    if (test_type <= 0) {
+        return NULL;
+    }
+    switch (cap_type) {
+    case ACVP_SYM_TYPE:
+        return test_type < 4 ? sym_names[test_type] : NULL;
+    case ACVP_HASH_TYPE:
+        return test_type < 5 ? hash_names[test_type] : NULL;
+    case ACVP_KMAC_TYPE:
+        return test_type < 3 ? kmac_names[test_type] : NULL;
+    case ACVP_RSA_KEYGEN_TYPE:
+        return test_type < 4 ? rsa_names[test_type] : NULL;
+    default:
+        /* CMAC, PBKDF, TLS 1.3 KDF and the KAS/KTS families: AFT = 1, VAL = 2 */
+        return test_type < 3 ? kas_names[test_type] : NULL;
+    }
+}
+
+static int acvp_hist_index(unsigned long long int ns) {
+    int exp = 0;
+
+    if (ns < ACVP_HIST_SUB_BUCKETS) {
+        return (int)ns;
+    }
+#if defined(__GNUC__) || defined(__clang__)
+    exp = 63 - __builtin_clzll(ns);
+#else
+    {
+        unsigned long long int v = ns;
+        while (v >>= 1) {
+            exp++;
+        }
+    }
+#endif
+    if (exp > ACVP_HIST_MAX_EXP) {
+        return ACVP_HIST_BUCKETS - 1;
+    }
+    return (exp - ACVP_HIST_SUB_BUCKET_BITS + 1) * ACVP_HIST_SUB_BUCKETS +
+           (int)((ns >> (exp - ACVP_HIST_SUB_BUCKET_BITS)) & (ACVP_HIST_SUB_BUCKETS - 1));
+}
+
+/* Lowest value (ns) that maps to bucket idx */
+static unsigned long long int acvp_hist_bucket_low(int idx) {
+    int group = idx / ACVP_HIST_SUB_BUCKETS;
+    int sub = idx % ACVP_HIST_SUB_BUCKETS;
+
+    if (!group) {
+        return (unsigned long long int)idx;
+    }
+    return (unsigned long long int)(ACVP_HIST_SUB_BUCKETS + sub) << (group - 1);
+}
+
+static unsigned long long int acvp_hist_bucket_width(int idx) {
+    int group = idx / ACVP_HIST_SUB_BUCKETS;
+
+    return group ? 1ULL << (group - 1) : 1ULL;
+}
+
+/* The histogram for test_type in list, added if there is none yet */
+static ACVP_CAP_STATS *acvp_cap_stats_find(ACVP_CAP_STATS **list, int test_type) {
+    ACVP_CAP_STATS *st = NULL;
+
+    for (st = *list; st; st = st->next) {
+        if (st->test_type == test_type) {
+            return st;
+        }
+    }
+    st = calloc(1, sizeof(ACVP_CAP_STATS));
+    if (!st) {
+        return NULL;
+    }
+    st->test_type = test_type;
+    st->next = *list;
+    *list = st;
+    return st;
+}
+
+static void acvp_cap_stats_record(ACVP_CAPS_LIST *cap, int test_type, unsigned long long int ns) {
+    ACVP_CAP_STATS *st = NULL;
+
+    st = acvp_cap_stats_find(acvp_worker_acct ? &acvp_worker_acct->stats : &cap->stats, test_type);
+    if (!st) {
+        return;
+    }
+
+    if (!st->count || ns < st->min_ns) {
+        st->min_ns = ns;
+    }
+    if (ns > st->max_ns) {
+        st->max_ns = ns;
+    }
+    st->count++;
+    st->total_ns += ns;
+    st->buckets[acvp_hist_index(ns)]++;
+}
+
+void acvp_cap_stats_free(ACVP_CAPS_LIST *cap) {
+    ACVP_CAP_STATS *st = NULL, *next = NULL;
+
+    if (!cap) {
+        return;
+    }
+    st = cap->stats;
+    while (st) {
+        next = st->next;
+        free(st);
+        st = next;
+    }
+    cap->stats = NULL;
+}
+
+void acvp_timing_worker_begin(ACVP_WORKER_ACCT *acct) {
+    acvp_worker_acct = acct;
+}
+
+void acvp_timing_worker_end(void) {
+    acvp_worker_acct = NULL;
+}
+
+/*
+ * Adds what a worker recorded to the current vector set's crypto phase and
+ * to cap's histograms, then empties acct. The crypto phase is the sum over
+ * the workers, so it can exceed the wall clock time of the vector set.
+ */
+void acvp_timing_worker_merge(ACVP_CTX *ctx, ACVP_CAPS_LIST *cap, ACVP_WORKER_ACCT *acct) {
+    ACVP_CAP_STATS *ws = NULL, *st = NULL;
+    int i = 0;
+
+    if (!acct) {
+        return;
+    }
+    if (ctx && ctx->timing_cur) {
+        ctx->timing_cur->phase_ns[ACVP_PHASE_CRYPTO] += acct->crypto_ns;
+        ctx->timing_cur->phase_count[ACVP_PHASE_CRYPTO] += acct->crypto_count;
+    }
+    while ((ws = acct->stats)) {
+        acct->stats = ws->next;
+        st = cap ? acvp_cap_stats_find(&cap->stats, ws->test_type) : NULL;
+        if (st && ws->count) {
+            if (!st->count || ws->min_ns < st->min_ns) {
+                st->min_ns = ws->min_ns;
+            }
+            if (ws->max_ns > st->max_ns) {
+                st->max_ns = ws->max_ns;
+            }
+            st->count += ws->count;
+            st->total_ns += ws->total_ns;
+            for (i = 0; i < ACVP_HIST_BUCKETS; i++) {
+                st->buckets[i] += ws->buckets[i];
+            }
+        }
+        free(ws);
+    }
+    acct->crypto_ns = 0;
+    acct->crypto_count = 0;
+}
+
+/*
+ * Calls the application's crypto handler for one test case, charging the
+ * time spent in it to the crypto phase of the current vector set and to the
+ * capability's latency histogram.
+ */
+int acvp_invoke_crypto_handler(ACVP_CTX *ctx, ACVP_CAPS_LIST *cap, ACVP_TEST_CASE *tc) {
+    unsigned long long int start = 0;
+    int rv = 0;
+
+    if (ctx) {
+        tc->group_cache = &ctx->group_cache;
+    }
+    if (!ctx || !ctx->handler_stats_enabled) {
+        start = acvp_timing_now(ctx);
+        rv = (cap->crypto_handler)(tc);
+        acvp_timing_record(ctx, ACVP_PHASE_CRYPTO, start);
+        return rv;
+    }
+
+    start = acvp_timing_clock();
+    rv = (cap->crypto_handler)(tc);
+    acvp_cap_stats_record(cap, acvp_stats_test_type(cap, tc), acvp_timing_clock() - start);
+    if (ctx->timing_cur) {
+        acvp_timing_record(ctx, ACVP_PHASE_CRYPTO, start);
+    }
+    return rv;
+}
+
+/*
+ * A module's MCT inner loop handler does a thousand or more operations per
+ * call, so its time counts towards the crypto phase but is kept out of the
+ * per-operation latency histograms.
+ */
+int acvp_invoke_mct_handler(ACVP_CTX *ctx, ACVP_CAPS_LIST *cap, ACVP_TEST_CASE *tc) {
+    unsigned long long int start = 0;
+    int rv = 0;
+
+    start = acvp_timing_now(ctx);
+    rv = (cap->mct_handler)(tc);
+    acvp_timing_record(ctx, ACVP_PHASE_CRYPTO, start);
+    return rv;
+}
+
+/*
+ * A batch handler works through several independent test cases in one call,
+ * so like an MCT handler its time counts towards the crypto phase only.
+ */
+int acvp_invoke_batch_handler(ACVP_CTX *ctx, ACVP_CAPS_LIST *cap, ACVP_TEST_CASE *tcs, unsigned int count) {
+    unsigned long long int start = 0;
+    int rv = 0;
+
+    start = acvp_timing_now(ctx);
+    rv = (cap->batch_handler)(tcs, count);
+    acvp_timing_record(ctx, ACVP_PHASE_CRYPTO, start);
+    return rv;
+}
+
+ACVP_RESULT acvp_enable_phase_timing(ACVP_CTX *ctx, int enable) {
+    if (!ctx) {
+        return ACVP_NO_CTX;
+    }
+    ctx->timing_enabled = enable ? 1 : 0;
+    return ACVP_SUCCESS;
+}
+
+ACVP_RESULT acvp_get_phase_timing(ACVP_CTX *ctx, int vs_id, ACVP_PHASE phase, double *seconds, unsigned int *count) {
+    ACVP_VS_TIMING *rec = NULL;
+    unsigned long long int ns = 0;
+    unsigned int calls = 0;
+    int found = 0;
+
+    if (!ctx) {
+        return ACVP_NO_CTX;
+    }
+    if (phase >= ACVP_PHASE_MAX || !seconds) {
+        return ACVP_INVALID_ARG;
+    }
+
+    for (rec = ctx->timing_list; rec; rec = rec->next) {
+        if (vs_id && rec->vs_id != vs_id) {
+            continue;
+        }
+        ns += rec->phase_ns[phase];
+        calls += rec->phase_count[phase];
+        found = 1;
+    }
+    if (!found) {
+        return ACVP_NO_DATA;
+    }
+
+    *seconds = (double)ns / 1e9;
+    if (count) {
+        *count = calls;
+    }
+    return ACVP_SUCCESS;
+}
+
+static JSON_Value *acvp_timing_summary_json(ACVP_CTX *ctx) {
+    JSON_Value *val = NULL, *rec_val = NULL, *phase_val = NULL;
+    JSON_Object *obj = NULL, *rec_obj = NULL, *phases_obj = NULL, *phase_obj = NULL;
+    JSON_Array *arr = NULL;
+    ACVP_VS_TIMING *rec = NULL;
+    int i = 0;
+
+    val = json_value_init_object();
+    obj = json_value_get_object(val);
+    json_object_set_value(obj, "vectorSets", json_value_init_array());
+    arr = json_object_get_array(obj, "vectorSets");
+
+    for (rec = ctx->timing_list; rec; rec = rec->next) {
+        rec_val = json_value_init_object();
+        rec_obj = json_value_get_object(rec_val);
+        json_object_set_number(rec_obj, "vsId", rec->vs_id);
+        json_object_set_number(rec_obj, "totalMs", (double)(rec->end_ns - rec->start_ns) / 1e6);
+        json_object_set_value(rec_obj, "phases", json_value_init_object());
+        phases_obj = json_object_get_object(rec_obj, "phases");
+        for (i = 0; i < ACVP_PHASE_MAX; i++) {
+            if (!rec->phase_count[i]) {
+                continue;
+            }
+            phase_val = json_value_init_object();
+            phase_obj = json_value_get_object(phase_val);
+            json_object_set_number(phase_obj, "ms", (double)rec->phase_ns[i] / 1e6);
+            json_object_set_number(phase_obj, "count", rec->phase_count[i]);
+            json_object_set_value(phases_obj, acvp_phase_names[i], phase_val);
+        }
+        json_array_append_value(arr, rec_val);
+    }
+    return val;
+}
+
+/*
+ * Chrome trace event format ("X" complete events, microseconds); loads in
+ * chrome://tracing and Perfetto. Each vector set gets an enclosing event
+ * with its phases nested inside; crypto time is attached as an argument.
+ */
+static JSON_Value *acvp_timing_trace_json(ACVP_CTX *ctx) {
+    JSON_Value *val = NULL, *ev_val = NULL;
+    JSON_Object *obj = NULL, *ev_obj = NULL, *args_obj = NULL;
+    JSON_Array *arr = NULL;
+    ACVP_VS_TIMING *rec = NULL;
+    ACVP_TIMING_SPAN *span = NULL;
+    char name[32];
+    int i = 0;
+
+    val = json_value_init_object();
+    obj = json_value_get_object(val);
+    json_object_set_value(obj, "traceEvents", json_value_init_array());
+    json_object_set_string(obj, "displayTimeUnit", "ms");
+    arr = json_object_get_array(obj, "traceEvents");
+
+    for (rec = ctx->timing_list; rec; rec = rec->next) {
+        ev_val = json_value_init_object();
+        ev_obj = json_value_get_object(ev_val);
+        if (rec->vs_id) {
+            snprintf(name, sizeof(name), "vsId %d", rec->vs_id);
+        } else {
+            snprintf(name, sizeof(name), "session");
+        }
+        json_object_set_string(ev_obj, "name", name);
+        json_object_set_string(ev_obj, "cat", "vectorSet");
+        json_object_set_string(ev_obj, "ph", "X");
+        json_object_set_number(ev_obj, "ts", (double)(rec->start_ns - ctx->timing_epoch_ns) / 1e3);
+        json_object_set_number(ev_obj, "dur", (double)(rec->end_ns - rec->start_ns) / 1e3);
+        json_object_set_number(ev_obj, "pid", 1);
+        json_object_set_number(ev_obj, "tid", 1);
+        json_object_set_value(ev_obj, "args", json_value_init_object());
+        args_obj = json_object_get_object(ev_obj, "args");
+        json_object_set_number(args_obj, "cryptoMs", (double)rec->phase_ns[ACVP_PHASE_CRYPTO] / 1e6);
+        json_object_set_number(args_obj, "cryptoCalls", rec->phase_count[ACVP_PHASE_CRYPTO]);
+        json_array_append_value(arr, ev_val);
+
+        for (i = 0; i < rec->span_count; i++) {
+            span = &rec->spans[i];
+            ev_val = json_value_init_object();
+            ev_obj = json_value_get_object(ev_val);
+            json_object_set_string(ev_obj, "name", acvp_phase_names[span->phase]);
+            json_object_set_string(ev_obj, "cat", "phase");
+            json_object_set_string(ev_obj, "ph", "X");
+            json_object_set_number(ev_obj, "ts", (double)(span->start_ns - ctx->timing_epoch_ns) / 1e3);
+            json_object_set_number(ev_obj, "dur", (double)span->dur_ns / 1e3);
+            json_object_set_number(ev_obj, "pid", 1);
+            json_object_set_number(ev_obj, "tid", 1);
+            json_array_append_value(arr, ev_val);
+        }
+    }
+    return val;
+}
+
+ACVP_RESULT acvp_export_phase_timing(ACVP_CTX *ctx, const char *filename, int chrome_trace) {
+    JSON_Value *val = NULL;
+    ACVP_RESULT rv = ACVP_SUCCESS;
+
+    if (!ctx) {
+        return ACVP_NO_CTX;
+    }
+    if (!filename) {
+        ACVP_LOG_ERR("Must provide value for timing filename");
+        return ACVP_MISSING_ARG;
+    }
+    if (strnlen_s(filename, ACVP_JSON_FILENAME_MAX + 1) > ACVP_JSON_FILENAME_MAX) {
+        ACVP_LOG_ERR("Provided filename length > max(%d)", ACVP_JSON_FILENAME_MAX);
+        return ACVP_INVALID_ARG;
+    }
+    if (!ctx->timing_list) {
+        ACVP_LOG_WARN("No phase timing was recorded");
+        return ACVP_NO_DATA;
+    }
+
+    if (chrome_trace) {
+        val = acvp_timing_trace_json(ctx);
+    } else {
+        val = acvp_timing_summary_json(ctx);
+    }
+    if (!val) {
+        return ACVP_JSON_ERR;
+    }
+
+    if (json_serialize_to_file_pretty(val, filename) != JSONSuccess) {
+        ACVP_LOG_ERR("Failed to write phase timing to %s", filename);
+        rv = ACVP_JSON_ERR;
+    }
+    json_value_free(val);
+    return rv;
+}
+
+ACVP_RESULT acvp_enable_handler_stats(ACVP_CTX *ctx, int enable) {
+    if (!ctx) {
+        return ACVP_NO_CTX;
+    }
+    ctx->handler_stats_enabled = enable ? 1 : 0;
+    return ACVP_SUCCESS;
+}
+
+/*
+ * Value (ns) at quantile q, taken as the midpoint of the bucket it falls in
+ * and clamped to the observed range.
+ */
+static double acvp_hist_quantile(const unsigned int *buckets, unsigned int count,
+                                 unsigned long long int min_ns, unsigned long long int max_ns,
+                                 double q) {
+    unsigned long long int rank = 0, seen = 0, val = 0;
+    int i = 0;
+
+    rank = (unsigned long long int)(q * count + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    }
+    for (i = 0; i < ACVP_HIST_BUCKETS; i++) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            break;
+        }
+    }
+    if (i == ACVP_HIST_BUCKETS) {
+        return (double)max_ns;
+    }
+    val = acvp_hist_bucket_low(i) + acvp_hist_bucket_width(i) / 2;
+    if (val < min_ns) {
+        val = min_ns;
+    }
+    if (val > max_ns) {
+        val = max_ns;
+    }
+    return (double)val;
+}
+
+/*
+ * Combines the histograms of st matching test_type (0 for all) into buckets
+ * and fills in the summary. Returns the number of calls found.
+ */
+static unsigned int acvp_cap_stats_merge(ACVP_CAP_STATS *st, int test_type, unsigned int *buckets,
+                                         ACVP_HANDLER_STATS *out) {
+    unsigned long long int total_ns = 0, min_ns = 0, max_ns = 0;
+    unsigned int count = 0;
+    int i = 0;
+
+    for (; st; st = st->next) {
+        if (test_type && st->test_type != test_type) {
+            continue;
+        }
+        if (!st->count) {
+            continue;
+        }
+        if (!count || st->min_ns < min_ns) {
+            min_ns = st->min_ns;
+        }
+        if (st->max_ns > max_ns) {
+            max_ns = st->max_ns;
+        }
+        count += st->count;
+        total_ns += st->total_ns;
+        for (i = 0; i < ACVP_HIST_BUCKETS; i++) {
+            buckets[i] += st->buckets[i];
+        }
+    }
+    if (!count) {
+        return 0;
+    }
+
+    out->count = count;
+    out->total_ms = (double)total_ns / 1e6;
+    out->min_us = (double)min_ns / 1e3;
+    out->max_us = (double)max_ns / 1e3;
+    out->mean_us = (double)total_ns / count / 1e3;
+    out->p50_us = acvp_hist_quantile(buckets, count, min_ns, max_ns, 0.50) / 1e3;
+    out->p90_us = acvp_hist_quantile(buckets, count, min_ns, max_ns, 0.90) / 1e3;
+    out->p99_us = acvp_hist_quantile(buckets, count, min_ns, max_ns, 0.99) / 1e3;
+    return count;
+}
+
+ACVP_RESULT acvp_get_handler_stats(ACVP_CTX *ctx, ACVP_CIPHER cipher, int test_type, ACVP_HANDLER_STATS *stats) {
+    ACVP_CAPS_LIST *cap = NULL;
+    ACVP_HANDLER_STATS out;
+    unsigned int buckets[ACVP_HIST_BUCKETS];
+
+    if (!ctx) {
+        return ACVP_NO_CTX;
+    }
+    if (!stats) {
+        return ACVP_INVALID_ARG;
+    }
+
+    cap = acvp_locate_cap_entry(ctx, cipher);
+    if (!cap || !cap->stats) {
+        return ACVP_NO_DATA;
+    }
+
+    memzero_s(buckets, sizeof(buckets));
+    memzero_s(&out, sizeof(out));
+    if (!acvp_cap_stats_merge(cap->stats, test_type, buckets, &out)) {
+        return ACVP_NO_DATA;
+    }
+    *stats = out;
+    return ACVP_SUCCESS;
+}
+
+static JSON_Value *acvp_handler_stats_entry_json(ACVP_CAPS_LIST *cap, ACVP_CAP_STATS *st) {
+    JSON_Value *val = NULL, *bucket_val = NULL;
+    JSON_Object *obj = NULL, *bucket_obj = NULL;
+    JSON_Array *arr = NULL;
+    ACVP_HANDLER_STATS sum;
+    unsigned int buckets[ACVP_HIST_BUCKETS];
+    const char *name = NULL;
+    int i = 0;
+
+    memzero_s(buckets, sizeof(buckets));
+    memzero_s(&sum, sizeof(sum));
+    acvp_cap_stats_merge(st, st->test_type, buckets, &sum);
+
+    val = json_value_init_object();
+    obj = json_value_get_object(val);
+    name = acvp_lookup_cipher_name(cap->cipher);
+    json_object_set_string(obj, "algorithm", name ? name : "unknown");
+    name = acvp_lookup_cipher_mode_str(cap->cipher);
+    if (name) {
+        json_object_set_string(obj, "mode", name);
+    }
+    name = acvp_stats_test_type_name(cap->cap_type, st->test_type);
+    if (name) {
+        json_object_set_string(obj, "testType", name);
+    }
+    json_object_set_number(obj, "count", sum.count);
+    json_object_set_number(obj, "totalMs", sum.total_ms);
+    json_object_set_number(obj, "minUs", sum.min_us);
+    json_object_set_number(obj, "meanUs", sum.mean_us);
+    json_object_set_number(obj, "p50Us", sum.p50_us);
+    json_object_set_number(obj, "p90Us", sum.p90_us);
+    json_object_set_number(obj, "p99Us", sum.p99_us);
+    json_object_set_number(obj, "maxUs", sum.max_us);
+
+    /* Non-empty buckets only, as [lowNs, count] pairs */
+    json_object_set_value(obj, "histogram", json_value_init_array());
+    arr = json_object_get_array(obj, "histogram");
+    for (i = 0; i < ACVP_HIST_BUCKETS; i++) {
+        if (!st->buckets[i]) {
+            continue;
+        }
+        bucket_val = json_value_init_object();
+        bucket_obj = json_value_get_object(bucket_val);
+        json_object_set_number(bucket_obj, "lowNs", (double)acvp_hist_bucket_low(i));
+        json_object_set_number(bucket_obj, "count", st->buckets[i]);
+        json_array_append_value(arr, bucket_val);
+    }
+    return val;
+}
+
+ACVP_RESULT acvp_export_handler_stats(ACVP_CTX *ctx, const char *filename) {
+    JSON_Value *val = NULL;
+    JSON_Object *obj = NULL;
+    JSON_Array *arr = NULL;
+    ACVP_CAPS_LIST *cap = NULL;
+    ACVP_CAP_STATS *st = NULL;
+    ACVP_RESULT rv = ACVP_SUCCESS;
+
+    if (!ctx) {
+        return ACVP_NO_CTX;
+    }
+    if (!filename) {
+        ACVP_LOG_ERR("Must provide value for handler stats filename");
+        return ACVP_MISSING_ARG;
+    }
+    if (strnlen_s(filename, ACVP_JSON_FILENAME_MAX + 1) > ACVP_JSON_FILENAME_MAX) {
+        ACVP_LOG_ERR("Provided filename length > max(%d)", ACVP_JSON_FILENAME_MAX);
+        return ACVP_INVALID_ARG;
+    }
+
+    val = json_value_init_object();
+    obj = json_value_get_object(val);
+    json_object_set_value(obj, "algorithms", json_value_init_array());
+    arr = json_object_get_array(obj, "algorithms");
+    for (cap = ctx->caps_list; cap; cap = cap->next) {
+        for (st = cap->stats; st; st = st->next) {
+            json_array_append_value(arr, acvp_handler_stats_entry_json(cap, st));
+        }
+    }
+    if (!json_array_get_count(arr)) {
+        ACVP_LOG_WARN("No crypto handler statistics were recorded");
+        json_value_free(val);
+        return ACVP_NO_DATA;
+    }
+
+    if (json_serialize_to_file_pretty(val, filename) != JSONSuccess) {
+        ACVP_LOG_ERR("Failed to write crypto handler statistics to %s", filename);
+        rv = ACVP_JSON_ERR;
+    }
+    json_value_free(val);
+    return rv;
+}
+
+/*
+ * Session end report, one line per capability and test type.
+ */
+void acvp_log_handler_stats(ACVP_CTX *ctx) {
+    ACVP_CAPS_LIST *cap = NULL;
+    ACVP_CAP_STATS *st = NULL;
+    ACVP_HANDLER_STATS sum;
+    unsigned int buckets[ACVP_HIST_BUCKETS];
+    const char *name = NULL, *mode = NULL, *type = NULL;
+    int header = 0;
+
+    if (!ctx || !ctx->handler_stats_enabled || !ACVP_LOG_ENABLED(ctx, ACVP_LOG_LVL_STATUS)) {
+        return;
+    }
+
+    for (cap = ctx->caps_list; cap; cap = cap->next) {
+        for (st = cap->stats; st; st = st->next) {
+            if (!header) {
+                ACVP_LOG_STATUS("Crypto handler statistics (count, total ms, mean/p50/p99/max us):");
+                header = 1;
+            }
+            memzero_s(buckets, sizeof(buckets));
+            memzero_s(&sum, sizeof(sum));
+            acvp_cap_stats_merge(st, st->test_type, buckets, &sum);
+            name = acvp_lookup_cipher_name(cap->cipher);
+            mode = acvp_lookup_cipher_mode_str(cap->cipher);
+            type = acvp_stats_test_type_name(cap->cap_type, st->test_type);
+            ACVP_LOG_STATUS("    %s%s%s%s%s: %u, %.3f, %.2f/%.2f/%.2f/%.2f",
+                            name ? name : "unknown", mode ? "/" : "", mode ? mode : "",
+                            type ? " " : "", type ? type : "",
+                            sum.count, sum.total_ms, sum.mean_us, sum.p50_us, sum.p99_us, sum.max_us);
+        }
+    }
+}
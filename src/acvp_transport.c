@@ -17,6 +17,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <limits.h>
 #include "acvp.h"
 #include "acvp_lcl.h"
 #include "safe_lib.h"
@@ -147,7 +148,7 @@ static size_t acvp_curl_write_callback(void *ptr, size_t size, size_t nmemb, voi
     }
 
     if (!ctx->curl_buf) {
-        ctx->curl_buf = calloc(ACVP_CURL_BUF_MAX, sizeof(char));
+        ctx->curl_buf = acvp_mem_calloc(ACVP_CURL_BUF_MAX, sizeof(char));
         if (!ctx->curl_buf) {
             fprintf(stderr, "\nmalloc failed in curl write reg func\n");
             return 0;
@@ -162,6 +163,7 @@ static size_t acvp_curl_write_callback(void *ptr, size_t size, size_t nmemb, voi
     memcpy_s(&ctx->curl_buf[ctx->curl_read_ctr], (ACVP_CURL_BUF_MAX - ctx->curl_read_ctr), ptr, nmemb);
     ctx->curl_buf[ctx->curl_read_ctr + nmemb] = 0;
     ctx->curl_read_ctr += nmemb;
+    ctx->progress.info.bytes_received += nmemb;
 
     return nmemb;
 }
@@ -352,6 +354,8 @@ static long acvp_curl_http_post(ACVP_CTX *ctx, const char *url, const char *data
     crv = curl_easy_perform(hnd);
     if (crv != CURLE_OK) {
         ACVP_LOG_ERR("Curl failed with code %d (%s)", crv, curl_easy_strerror(crv));
+    } else {
+        ctx->progress.info.bytes_sent += (unsigned long long int)data_len;
     }
 
     /*
@@ -461,6 +465,8 @@ static long acvp_curl_http_put(ACVP_CTX *ctx, const char *url, const char *data,
     crv = curl_easy_perform(hnd);
     if (crv != CURLE_OK) {
         ACVP_LOG_ERR("Curl failed with code %d (%s)", crv, curl_easy_strerror(crv));
+    } else {
+        ctx->progress.info.bytes_sent += (unsigned long long int)data_len;
     }
 
     /*
@@ -684,7 +690,15 @@ ACVP_RESULT acvp_submit_vector_responses(ACVP_CTX *ctx, char *vsid_url) {
             "https://%s:%d%s/results",
             ctx->server_name, ctx->server_port, vsid_url);
 
-    return acvp_network_action(ctx, ACVP_NET_POST_VS_RESP, url, NULL, 0);
+    rv = acvp_network_action(ctx, ACVP_NET_POST_VS_RESP, url, NULL, 0);
+
+    /* Only keep the serialization buffer for the next vector set while it is small */
+    if (ctx->resp_buf_size > ACVP_RESP_BUF_KEEP_MAX) {
+        json_free_serialized_string(ctx->resp_buf);
+        ctx->resp_buf = NULL;
+        ctx->resp_buf_size = 0;
+    }
+    return rv;
 #endif
 }
 
@@ -1024,6 +1038,8 @@ static ACVP_RESULT execute_network_action(ACVP_CTX *ctx,
                                           int *curl_code) {
     ACVP_RESULT result = 0;
     char *resp = NULL;
+    size_t resp_size = 0;
+    unsigned long long int t_start = 0;
 #ifdef ACVP_DEPRECATED
     char large_url[ACVP_ATTR_URL_MAX + 1] = {0};
     int large_submission = 0;
@@ -1051,11 +1067,17 @@ static ACVP_RESULT execute_network_action(ACVP_CTX *ctx,
         break;
 
     case ACVP_NET_POST_VS_RESP:
-        resp = json_serialize_to_string(ctx->kat_resp, &resp_len);
-        if (!resp) {
+        /* Serialize into the buffer kept on the ctx, it is reused for every vector set */
+        t_start = acvp_timing_now(ctx);
+        if (json_serialize_to_reusable_buffer(ctx->kat_resp, &ctx->resp_buf, &ctx->resp_buf_size,
+                                              &resp_size) != JSONSuccess || resp_size > INT_MAX) {
             ACVP_LOG_ERR("Failed to post vector set responses");
             return ACVP_JSON_ERR;
         }
+        acvp_timing_record(ctx, ACVP_PHASE_SERIALIZE, t_start);
+        resp = ctx->resp_buf;
+        resp_len = (int)resp_size;
+        t_start = acvp_timing_now(ctx);
 
 #ifdef ACVP_DEPRECATED
         if (ctx->post_size_constraint && resp_len > ctx->post_size_constraint) {
@@ -1083,6 +1105,7 @@ static ACVP_RESULT execute_network_action(ACVP_CTX *ctx,
 #ifdef ACVP_DEPRECATED
         }
 #endif
+        acvp_timing_record(ctx, ACVP_PHASE_UPLOAD, t_start);
         break;
     case ACVP_NET_DELETE:
         rc = acvp_curl_http_delete(ctx, url);
@@ -1178,8 +1201,6 @@ static ACVP_RESULT execute_network_action(ACVP_CTX *ctx,
     result = ACVP_SUCCESS;
 
 end:
-    if (resp) json_free_serialized_string(resp);
-
     *curl_code = rc;
 
     return result;
@@ -1190,6 +1211,11 @@ static void log_network_status(ACVP_CTX *ctx,
                                int curl_code,
                                const char *url) {
 
+    /* Skip formatting the (possibly large) response bodies unless they will be logged */
+    if (!ACVP_LOG_ENABLED(ctx, ACVP_LOG_LVL_VERBOSE)) {
+        goto check_code;
+    }
+
     switch(action) {
     case ACVP_NET_GET:
         ACVP_LOG_VERBOSE("GET...\n\tStatus: %d\n\tUrl: %s\n\tResp:\n%s\n",
@@ -1240,7 +1266,7 @@ static void log_network_status(ACVP_CTX *ctx,
         break;
     }
 
-
+check_code:
     if (curl_code == 0) {
         ACVP_LOG_ERR("Received no response from server.");
     } else if (curl_code < 200 || curl_code >= 300) {
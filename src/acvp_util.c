@@ -32,14 +32,12 @@
 
 extern ACVP_ALG_HANDLER alg_tbl[];
 
-static int acvp_char_to_int(char ch);
-
 /*
  * Basic logging for libacvp
  */
 void acvp_log_msg(ACVP_CTX *ctx, ACVP_LOG_LVL level, const char *func, int line, const char *fmt, ...) {
     va_list arguments;
-    int iter = 0, ret = 0;
+    int iter = 0, ret = 0, len = 0;
     //One extra char for null terminator
     char tmp[ACVP_LOG_MAX_MSG_LEN + 1];
     tmp[ACVP_LOG_MAX_MSG_LEN] = '\0';
@@ -61,14 +59,36 @@ void acvp_log_msg(ACVP_CTX *ctx, ACVP_LOG_LVL level, const char *func, int line,
                      ACVP_LOG_TRUNCATED_STR_LEN,
                      ACVP_LOG_TRUNCATED_STR, ACVP_LOG_TRUNCATED_STR_LEN);
             tmp[ACVP_LOG_MAX_MSG_LEN] = '\0';
+            len = ACVP_LOG_MAX_MSG_LEN;
         } else {
             iter += ret;
             tmp[iter] = '\0';
+            len = iter;
         }
-        ctx->test_progress_cb(tmp, level);
         va_end(arguments);
-        fflush(stdout);
+        acvp_log_deliver(ctx, level, tmp, (size_t)len);
+    }
+}
+
+/*
+ * Logs a pretty printed JSON value. Serializing a whole response is expensive, so callers
+ * should go through ACVP_LOG_VERBOSE_JSON (or check ACVP_LOG_ENABLED) to skip it entirely
+ * when the level is filtered out.
+ */
+void acvp_log_json(ACVP_CTX *ctx, ACVP_LOG_LVL level, const char *func, int line, const JSON_Value *value) {
+    char *json_result = NULL;
+
+    if (!ACVP_LOG_ENABLED(ctx, level) || !value) {
+        return;
+    }
+
+    json_result = json_serialize_to_string_pretty(value, NULL);
+    if (!json_result) {
+        acvp_log_msg(ctx, ACVP_LOG_LVL_ERR, func, line, "JSON unable to be serialized");
+        return;
     }
+    acvp_log_msg(ctx, level, func, line, "\n\n%s\n\n", json_result);
+    json_free_serialized_string(json_result);
 }
 
 /*
@@ -77,7 +97,7 @@ void acvp_log_msg(ACVP_CTX *ctx, ACVP_LOG_LVL level, const char *func, int line,
  */
 void acvp_log_newline(ACVP_CTX *ctx) {
      char tmp[] = "\n";
-     ctx->test_progress_cb(tmp, ACVP_LOG_LVL_STATUS);
+     acvp_log_deliver(ctx, ACVP_LOG_LVL_STATUS, tmp, 1);
  }
 
 /*!
@@ -868,103 +888,91 @@ const char *acvp_lookup_rsa_format_str(ACVP_RSA_KEY_FORMAT format) {
 }
 
 /*
- * Convert a byte array from source to a hexadecimal string which is
- * stored in the destination.
+ * Size a scratch request will take up once aligned; handlers sum these to
+ * reserve everything a test case needs in one go.
  */
-ACVP_RESULT acvp_bin_to_hexstr(const unsigned char *src, int src_len, char *dest, int dest_max) {
-    int i, j;
-    unsigned char nibb_a, nibb_b;
-    unsigned char hex_chars[] = "0123456789ABCDEF";
-
-    if (!src || !dest) {
-        return ACVP_CONVERT_DATA_ERR;
+size_t acvp_scratch_round(size_t len) {
+    if (!len) {
+        len = 1;
     }
-
-    if ((src_len * 2) > dest_max) {
-        return ACVP_CONVERT_DATA_ERR;
-    }
-
-    for (i = 0, j = 0; i < src_len; i++, j += 2) {
-        nibb_a = *src >> 4;   /* Get first half of byte */
-        nibb_b = *src & 0x0f; /* Get second half of byte */
-
-        *dest = hex_chars[nibb_a];
-        *(dest + 1) = hex_chars[nibb_b];
-
-        dest += 2;
-        src++;
-    }
-    *dest = '\0';
-
-    return ACVP_SUCCESS;
+    return (len + ACVP_SCRATCH_ALIGN - 1) & ~(size_t)(ACVP_SCRATCH_ALIGN - 1);
 }
 
 /*
- * Convert a source hexadecimal string to a byte array which is stored
- * in the destination.
- * TODO: Enable the function to handle odd number of hex characters
+ * Make sure the scratch area can hold len bytes and start handing it out from
+ * the beginning again. Anything previously returned by acvp_scratch_alloc()
+ * is invalid afterwards.
+ *
+ * A batch scratch area (batch_min set) instead keeps the test cases already
+ * in it, which stay valid, and gives ACVP_DATA_TOO_LARGE when len more bytes
+ * do not fit; the caller then finishes the batch, calls acvp_scratch_reset()
+ * and tries again. Once empty it grows to at least batch_min bytes.
  */
-ACVP_RESULT acvp_hexstr_to_bin(const char *src, unsigned char *dest, int dest_max, int *converted_len) {
-    int src_len;
-    int byte_a, byte_b;
-    int is_odd = 0;
-    int length_converted = 0;
+ACVP_RESULT acvp_scratch_reserve(ACVP_SCRATCH *scratch, size_t len) {
+    unsigned char *buf = NULL;
 
-    if (!src || !dest) {
+    if (!scratch) {
         return ACVP_INVALID_ARG;
     }
-
-    src_len = strnlen_s(src, ACVP_HEXSTR_MAX);
-
-    /*
-     * Make sure the hex value isn't too large
-     */
-    if (src_len > (2 * dest_max)) {
-        return ACVP_DATA_TOO_LARGE;
+    if (scratch->batch_min && scratch->used) {
+        return len <= scratch->size - scratch->used ? ACVP_SUCCESS : ACVP_DATA_TOO_LARGE;
     }
-
-    if (src_len & 1) {
-        is_odd = 1;
+    scratch->used = 0;
+    if (len < scratch->batch_min) {
+        len = scratch->batch_min;
+    }
+    if (len <= scratch->size) {
+        return ACVP_SUCCESS;
     }
 
-    if (!is_odd) {
-        while (*src && src[1]) {
-            byte_a = acvp_char_to_int((char)*src) << 4; /* Shift to left half of byte */
-            byte_b = acvp_char_to_int(*(src + 1));
+    buf = acvp_mem_malloc(len);
+    if (!buf) {
+        return ACVP_MALLOC_FAIL;
+    }
+    acvp_scratch_free(scratch);
+    scratch->buf = buf;
+    scratch->size = len;
+    return ACVP_SUCCESS;
+}
 
-            *dest = byte_a + byte_b; /* Combine left half with right half */
+/*
+ * Hand out the next len bytes of the reserved area, zeroed. Returns NULL if
+ * the reservation was too small.
+ */
+unsigned char *acvp_scratch_alloc(ACVP_SCRATCH *scratch, size_t len) {
+    unsigned char *ptr = NULL;
 
-            dest++;
-            src += 2;
-            length_converted++;
-        }
-    } else {
-        return ACVP_UNSUPPORTED_OP;
+    len = acvp_scratch_round(len);
+    if (!scratch || !scratch->buf || len > scratch->size - scratch->used) {
+        return NULL;
     }
-
-    if (converted_len) *converted_len = length_converted;
-    return ACVP_SUCCESS;
+    ptr = scratch->buf + scratch->used;
+    memzero_s(ptr, len);
+    scratch->used += len;
+    return ptr;
 }
 
 /*
- * Local - helper function for acvp_hexstring_to_bytes
- * Used to convert a hexadecimal character to it's byte
- * representation.
+ * Empties a batch scratch area for the next batch.
  */
-static int acvp_char_to_int(char ch) {
-    int ch_i;
-
-    if (ch >= '0' && ch <= '9') {
-        ch_i = ch - '0';
-    } else if (ch >= 'A' && ch <= 'F') {
-        ch_i = ch - 'A' + 10;
-    } else if (ch >= 'a' && ch <= 'f') {
-        ch_i = ch - 'a' + 10;
-    } else {
-        ch_i = 0;
+void acvp_scratch_reset(ACVP_SCRATCH *scratch) {
+    if (scratch) {
+        scratch->used = 0;
     }
+}
 
-    return ch_i;
+/*
+ * The scratch area holds keys, so clear it before giving it back.
+ */
+void acvp_scratch_free(ACVP_SCRATCH *scratch) {
+    if (!scratch || !scratch->buf) {
+        return;
+    }
+    memzero_s(scratch->buf, scratch->size);
+    acvp_mem_free(scratch->buf);
+    scratch->buf = NULL;
+    scratch->size = 0;
+    scratch->used = 0;
 }
 
 ACVP_DRBG_MODE_LIST *acvp_locate_drbg_mode_entry(ACVP_CAPS_LIST *cap, ACVP_DRBG_MODE mode) {
@@ -1132,7 +1140,8 @@ const char *acvp_lookup_error_string(ACVP_RESULT rv) {
         { ACVP_JWT_MISSING,        "Error using JWT"                                  },
         { ACVP_JWT_EXPIRED,        "Provided JWT has expired"                         },
         { ACVP_JWT_INVALID,        "Proivded JWT is not valid"                        },
-        { ACVP_INTERNAL_ERR,       "Unexpected error occured internally"              }
+        { ACVP_INTERNAL_ERR,       "Unexpected error occured internally"              },
+        { ACVP_MEM_BUDGET_EXCEEDED, "Memory budget exceeded"                          }
     };
 
     for (i = 0; i < ACVP_RESULT_MAX - 1; i++) {
@@ -1616,6 +1625,98 @@ end:
     return return_code;
 }
 
+/*
+ * Opens filename for writing and starts the top level JSON array. The file is kept open until
+ * acvp_json_file_writer_close() so that values can be streamed into it one at a time.
+ */
+ACVP_RESULT acvp_json_file_writer_open(ACVP_JSON_FILE_WRITER **writer, const char *filename, int compact) {
+    ACVP_JSON_FILE_WRITER *w = NULL;
+
+    if (!writer || !filename) {
+        return ACVP_INVALID_ARG;
+    }
+    if (*writer) {
+        return ACVP_CTX_NOT_EMPTY;
+    }
+
+    w = calloc(1, sizeof(ACVP_JSON_FILE_WRITER));
+    if (!w) {
+        return ACVP_MALLOC_FAIL;
+    }
+    w->compact = compact;
+
+    w->fp = fopen(filename, "w");
+    if (!w->fp) {
+        free(w);
+        return ACVP_JSON_ERR;
+    }
+    /* A large stdio buffer is cheap compared to the syscalls it saves; fall back to the default if it fails */
+    w->buf = malloc(ACVP_JSON_FILE_WRITER_BUF_SIZE);
+    if (w->buf && setvbuf(w->fp, w->buf, _IOFBF, ACVP_JSON_FILE_WRITER_BUF_SIZE)) {
+        free(w->buf);
+        w->buf = NULL;
+    }
+
+    if (fputs(compact ? "[" : "[ ", w->fp) == EOF) {
+        fclose(w->fp);
+        if (w->buf) free(w->buf);
+        free(w);
+        return ACVP_JSON_ERR;
+    }
+
+    *writer = w;
+    return ACVP_SUCCESS;
+}
+
+/*
+ * Appends a value as the next element of the top level array.
+ */
+ACVP_RESULT acvp_json_file_writer_append(ACVP_JSON_FILE_WRITER *writer, const JSON_Value *value) {
+    JSON_Status status = JSONFailure;
+
+    if (!writer || !writer->fp || !value) {
+        return ACVP_INVALID_ARG;
+    }
+
+    if (writer->count && fputs(writer->compact ? "," : ", ", writer->fp) == EOF) {
+        return ACVP_JSON_ERR;
+    }
+    if (writer->compact) {
+        status = json_serialize_to_fp(value, writer->fp);
+    } else {
+        status = json_serialize_to_fp_pretty(value, writer->fp);
+    }
+    if (status != JSONSuccess) {
+        return ACVP_JSON_ERR;
+    }
+    writer->count++;
+    return ACVP_SUCCESS;
+}
+
+/*
+ * Terminates the top level array, closes the file and frees the writer.
+ */
+ACVP_RESULT acvp_json_file_writer_close(ACVP_JSON_FILE_WRITER **writer) {
+    ACVP_RESULT rv = ACVP_SUCCESS;
+    ACVP_JSON_FILE_WRITER *w = NULL;
+
+    if (!writer || !*writer) {
+        return ACVP_INVALID_ARG;
+    }
+    w = *writer;
+
+    if (fputs(w->compact ? "]" : " ]", w->fp) == EOF) {
+        rv = ACVP_JSON_ERR;
+    }
+    if (fclose(w->fp) == EOF) {
+        rv = ACVP_JSON_ERR;
+    }
+    if (w->buf) free(w->buf);
+    free(w);
+    *writer = NULL;
+    return rv;
+}
+
 void acvp_sleep(int seconds) {
 #ifdef _WIN32
     Sleep(seconds * 1000);
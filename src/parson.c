@@ -38,6 +38,32 @@
 #include <errno.h>
 #include "safe_lib.h"    /* needs to be after errno.h */
 
+#if defined(__SSE2__) || defined(_M_X64)
+#include <stdint.h>
+#include <emmintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#define PARSON_USE_SSE2
+#if defined(__GNUC__) && (__GNUC__ >= 5 || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define PARSON_USE_AVX2
+#endif
+#endif
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#if defined(MAP_ANONYMOUS) && defined(MAP_FIXED)
+#define PARSON_USE_MMAP
+#endif
+#endif
+
 /* Apparently sscanf is not implemented in some "standard" libraries, so don't use it, if you
  * don't have to. */
 #define sscanf THINK_TWICE_ABOUT_USING_SSCANF
@@ -70,6 +96,8 @@ static JSON_Free_Function parson_free = free;
 
 static int parson_escape_slashes = 1;
 
+static int parson_simd_scan = 1;
+
 #define IS_CONT(b) (((unsigned char)(b) & 0xC0) == 0x80) /* is utf-8 continuation byte */
 
 typedef struct json_string {
@@ -162,6 +190,7 @@ static int    json_serialize_to_buffer_r(const JSON_Value *value, char *buf, int
 static int    json_serialize_string(const char *string, size_t len, char *buf);
 static int    append_indent(char *buf, int level);
 static int    append_string(char *buf, const char *string);
+static size_t format_number(char *num_buf, double num);
 
 /* Various */
 static char * parson_strndup(const char *string, size_t n) {
@@ -609,6 +638,119 @@ static JSON_Value * json_value_init_string_no_copy(char *string, size_t length)
     return new_value;
 }
 
+/*
+ * String scanning (Added by ACVP)
+ *
+ * Vector set strings are mostly long hex values that need no unescaping. These kernels return the
+ * offset of the first byte that ends a plain run inside a string: a quote, a backslash or any
+ * control character (which includes the terminating null byte). The vector versions only use
+ * aligned loads, which can never cross into the next page, so reading past the terminator is
+ * harmless; they are excluded from ASan instrumentation for the same reason.
+ */
+#if defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5)
+#define PARSON_NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#else
+#define PARSON_NO_SANITIZE_ADDRESS
+#endif
+
+static size_t scan_string_scalar(const char *string) {
+    const unsigned char *ptr = (const unsigned char*)string;
+    while (*ptr != '\"' && *ptr != '\\' && *ptr >= 0x20) {
+        ptr++;
+    }
+    return (size_t)(ptr - (const unsigned char*)string);
+}
+
+#ifdef PARSON_USE_SSE2
+/* Index of the lowest set bit of a non-zero mask */
+static size_t scan_mask_first(unsigned int mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index = 0;
+    _BitScanForward(&index, mask);
+    return (size_t)index;
+#else
+    return (size_t)__builtin_ctz(mask);
+#endif
+}
+
+PARSON_NO_SANITIZE_ADDRESS
+static size_t scan_string_sse2(const char *string) {
+    const __m128i quote = _mm_set1_epi8('\"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i ctrl_max = _mm_set1_epi8(0x1F);
+    size_t misalign = (size_t)((uintptr_t)string & 15);
+    const char *ptr = string - misalign;
+    __m128i chunk;
+    unsigned int mask = 0;
+
+    for (;;) {
+        chunk = _mm_load_si128((const __m128i*)ptr);
+        mask = (unsigned int)_mm_movemask_epi8(_mm_or_si128(
+                   _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+                   _mm_cmpeq_epi8(_mm_max_epu8(chunk, ctrl_max), ctrl_max)));
+        if (ptr < string) {
+            mask &= ~0U << misalign; /* ignore bytes before the start of the string */
+        }
+        if (mask) {
+            return (size_t)(ptr - string) + scan_mask_first(mask);
+        }
+        ptr += 16;
+    }
+}
+#endif
+
+#ifdef PARSON_USE_AVX2
+PARSON_NO_SANITIZE_ADDRESS __attribute__((target("avx2")))
+static size_t scan_string_avx2(const char *string) {
+    const __m256i quote = _mm256_set1_epi8('\"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i ctrl_max = _mm256_set1_epi8(0x1F);
+    size_t misalign = (size_t)((uintptr_t)string & 31);
+    const char *ptr = string - misalign;
+    __m256i chunk;
+    unsigned int mask = 0;
+
+    for (;;) {
+        chunk = _mm256_load_si256((const __m256i*)ptr);
+        mask = (unsigned int)_mm256_movemask_epi8(_mm256_or_si256(
+                   _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash)),
+                   _mm256_cmpeq_epi8(_mm256_max_epu8(chunk, ctrl_max), ctrl_max)));
+        if (ptr < string) {
+            mask &= ~0U << misalign;
+        }
+        if (mask) {
+            return (size_t)(ptr - string) + scan_mask_first(mask);
+        }
+        ptr += 32;
+    }
+}
+#endif
+
+typedef size_t (*Scan_String_Function)(const char *string);
+static Scan_String_Function scan_string_fn = NULL;
+
+static size_t scan_string(const char *string) {
+    if (!parson_simd_scan) {
+        return scan_string_scalar(string);
+    }
+    /* Selected once; racing threads would all store the same pointer */
+    if (scan_string_fn == NULL) {
+#if defined(PARSON_USE_AVX2)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            scan_string_fn = scan_string_avx2;
+        } else {
+            scan_string_fn = scan_string_sse2;
+        }
+#elif defined(PARSON_USE_SSE2)
+        scan_string_fn = scan_string_sse2;
+#else
+        scan_string_fn = scan_string_scalar;
+#endif
+    }
+    return scan_string_fn(string);
+}
+
 /* Parser */
 static JSON_Status skip_quotes(const char **string) {
     if (**string != '\"') {
@@ -616,6 +758,10 @@ static JSON_Status skip_quotes(const char **string) {
     }
     SKIP_CHAR(string);
     while (**string != '\"') {
+        *string += scan_string(*string); /* ACVP: jump over the plain run in one step */
+        if (**string == '\"') {
+            break;
+        }
         if (**string == '\0') {
             return JSONFailure;
         } else if (**string == '\\') {
@@ -738,8 +884,30 @@ error:
    skips passed argument to a matching quote. */
 static char * get_quoted_string(const char **string, size_t *output_string_len) {
     const char *string_start = *string;
-    size_t input_string_len = 0;
-    JSON_Status status = skip_quotes(string);
+    size_t input_string_len = 0, plain_len = 0;
+    char *output = NULL;
+    JSON_Status status = JSONFailure;
+
+    /* ACVP: strings that end before any escape or control character need no processing, so
+     * copy them in one go instead of going through process_string() byte by byte */
+    if (**string == '\"') {
+        plain_len = scan_string(string_start + 1);
+        if (string_start[plain_len + 1] == '\"') {
+            output = (char*)parson_malloc(plain_len + 1);
+            if (output == NULL) {
+                return NULL;
+            }
+            if (plain_len) {
+                memcpy_s(output, plain_len + 1, string_start + 1, plain_len); /* SAFEC */
+            }
+            output[plain_len] = '\0';
+            *output_string_len = plain_len;
+            *string = string_start + plain_len + 2;
+            return output;
+        }
+    }
+
+    status = skip_quotes(string);
     if (status != JSONSuccess) {
         return NULL;
     }
@@ -1179,6 +1347,286 @@ static int append_string(char *buf, const char *string) {
 #undef APPEND_STRING
 #undef APPEND_INDENT
 
+/*
+ * Single pass serialization into a growable buffer (Added by ACVP)
+ *
+ * json_serialize_to_buffer_r() has to run twice (once to size the output, once to write it) and
+ * looks at every character of every string. This variant appends straight into a buffer that
+ * doubles as needed, copies the plain runs of a string (all of a hex value) with one memcpy and
+ * formats integral numbers (tcId, tgId, vsId, lengths...) without going through sprintf.
+ * Given a FILE*, the buffer is written out whenever it would grow past GROW_BUF_FLUSH_SIZE, so
+ * a large document streams to the file without ever being held in memory whole.
+ */
+#define GROW_BUF_MIN_SIZE 4096
+#define GROW_BUF_FLUSH_SIZE 65536
+
+typedef struct json_grow_buf_t {
+    char *data;
+    size_t len;
+    size_t size;
+    FILE *fp;   /* flush target, NULL to keep everything in data */
+} JSON_Grow_Buffer;
+
+/* Precomputed escape sequences for the control characters */
+static const char *json_control_escapes[0x20] = {
+    "\\u0000", "\\u0001", "\\u0002", "\\u0003", "\\u0004", "\\u0005", "\\u0006", "\\u0007",
+    "\\b",     "\\t",     "\\n",     "\\u000b", "\\f",     "\\r",     "\\u000e", "\\u000f",
+    "\\u0010", "\\u0011", "\\u0012", "\\u0013", "\\u0014", "\\u0015", "\\u0016", "\\u0017",
+    "\\u0018", "\\u0019", "\\u001a", "\\u001b", "\\u001c", "\\u001d", "\\u001e", "\\u001f"
+};
+
+#define GB_APPEND(str, n) do { if (grow_buffer_append(gb, (str), (n)) < 0) { return -1; } } while(0)
+
+#define GB_APPEND_STRING(str) GB_APPEND((str), sizeof(str) - 1)
+
+static int grow_buffer_flush(JSON_Grow_Buffer *gb) {
+    if (gb->len && fwrite(gb->data, 1, gb->len, gb->fp) != gb->len) {
+        return -1;
+    }
+    gb->len = 0;
+    return 0;
+}
+
+static int grow_buffer_reserve(JSON_Grow_Buffer *gb, size_t extra) {
+    size_t new_size = 0;
+    char *new_data = NULL;
+
+    /* always keep room for the null terminator */
+    if (gb->len + extra < gb->size) {
+        return 0;
+    }
+    if (gb->fp != NULL && gb->len + extra >= GROW_BUF_FLUSH_SIZE) {
+        if (grow_buffer_flush(gb) < 0) {
+            return -1;
+        }
+        if (extra < gb->size) {
+            return 0;
+        }
+    }
+    new_size = gb->size ? gb->size : GROW_BUF_MIN_SIZE;
+    while (new_size <= gb->len + extra) {
+        new_size *= 2;
+    }
+    new_data = (char*)parson_malloc(new_size);
+    if (new_data == NULL) {
+        return -1;
+    }
+    if (gb->len) {
+        memcpy_s(new_data, new_size, gb->data, gb->len); /* SAFEC */
+    }
+    parson_free(gb->data);
+    gb->data = new_data;
+    gb->size = new_size;
+    return 0;
+}
+
+static int grow_buffer_append(JSON_Grow_Buffer *gb, const char *string, size_t len) {
+    if (len == 0) {
+        return 0;
+    }
+    if (grow_buffer_reserve(gb, len) < 0) {
+        return -1;
+    }
+    memcpy_s(gb->data + gb->len, gb->size - gb->len, string, len); /* SAFEC */
+    gb->len += len;
+    return 0;
+}
+
+static int append_indent_to_grow_buffer(JSON_Grow_Buffer *gb, int level) {
+    int i;
+    for (i = 0; i < level; i++) {
+        GB_APPEND_STRING("    ");
+    }
+    return 0;
+}
+
+static int json_serialize_string_to_grow_buffer(const char *string, size_t len, JSON_Grow_Buffer *gb) {
+    const char *slash = NULL;
+    size_t i = 0, run = 0;
+    unsigned char c = 0;
+
+    if (grow_buffer_reserve(gb, len + 2) < 0) {
+        return -1;
+    }
+    GB_APPEND_STRING("\"");
+    while (i < len) {
+        /* strings are null terminated, so the scan never runs past string[len] */
+        run = scan_string(string + i);
+        if (run > len - i) {
+            run = len - i;
+        }
+        if (parson_escape_slashes && run) {
+            slash = (const char*)memchr(string + i, '/', run);
+            if (slash != NULL) {
+                run = (size_t)(slash - (string + i));
+            }
+        }
+        GB_APPEND(string + i, run);
+        i += run;
+        if (i >= len) {
+            break;
+        }
+        c = (unsigned char)string[i];
+        if (c < 0x20) {
+            GB_APPEND(json_control_escapes[c], strnlen_s(json_control_escapes[c], 8));
+        } else if (c == '\"') {
+            GB_APPEND_STRING("\\\"");
+        } else if (c == '\\') {
+            GB_APPEND_STRING("\\\\");
+        } else {
+            GB_APPEND_STRING("\\/");  /* to make json embeddable in xml\/html */
+        }
+        i++;
+    }
+    GB_APPEND_STRING("\"");
+    return 0;
+}
+
+static int json_serialize_to_grow_buffer_r(const JSON_Value *value, JSON_Grow_Buffer *gb, int level, int is_pretty) {
+    const char *key = NULL, *string = NULL;
+    JSON_Array *array = NULL;
+    JSON_Object *object = NULL;
+    size_t i = 0, count = 0, len = 0;
+    char num_buf[NUM_BUF_SIZE];
+
+    switch (json_value_get_type(value)) {
+        case JSONArray:
+            array = json_value_get_array(value);
+            count = json_array_get_count(array);
+            GB_APPEND_STRING("[");
+            if (count > 0 && is_pretty) {
+                GB_APPEND_STRING("\n");
+            }
+            for (i = 0; i < count; i++) {
+                if (is_pretty && append_indent_to_grow_buffer(gb, level+1) < 0) {
+                    return -1;
+                }
+                if (json_serialize_to_grow_buffer_r(json_array_get_value(array, i), gb, level+1, is_pretty) < 0) {
+                    return -1;
+                }
+                if (i < (count - 1)) {
+                    GB_APPEND_STRING(",");
+                }
+                if (is_pretty) {
+                    GB_APPEND_STRING("\n");
+                }
+            }
+            if (count > 0 && is_pretty && append_indent_to_grow_buffer(gb, level) < 0) {
+                return -1;
+            }
+            GB_APPEND_STRING("]");
+            return 0;
+        case JSONObject:
+            object = json_value_get_object(value);
+            count  = json_object_get_count(object);
+            GB_APPEND_STRING("{");
+            if (count > 0 && is_pretty) {
+                GB_APPEND_STRING("\n");
+            }
+            for (i = 0; i < count; i++) {
+                key = json_object_get_name(object, i);
+                if (key == NULL) {
+                    return -1;
+                }
+                if (is_pretty && append_indent_to_grow_buffer(gb, level+1) < 0) {
+                    return -1;
+                }
+                /* We do not support key names with embedded \0 chars */
+                if (json_serialize_string_to_grow_buffer(key, strnlen_s(key, STRING_NAME_MAX), gb) < 0) {
+                    return -1;
+                }
+                if (is_pretty) {
+                    GB_APPEND_STRING(": ");
+                } else {
+                    GB_APPEND_STRING(":");
+                }
+                if (json_serialize_to_grow_buffer_r(json_object_get_value_at(object, i), gb, level+1, is_pretty) < 0) {
+                    return -1;
+                }
+                if (i < (count - 1)) {
+                    GB_APPEND_STRING(",");
+                }
+                if (is_pretty) {
+                    GB_APPEND_STRING("\n");
+                }
+            }
+            if (count > 0 && is_pretty && append_indent_to_grow_buffer(gb, level) < 0) {
+                return -1;
+            }
+            GB_APPEND_STRING("}");
+            return 0;
+        case JSONString:
+            string = json_value_get_string(value);
+            if (string == NULL) {
+                return -1;
+            }
+            return json_serialize_string_to_grow_buffer(string, json_value_get_string_len(value), gb);
+        case JSONBoolean:
+            if (json_value_get_boolean(value)) {
+                GB_APPEND_STRING("true");
+            } else {
+                GB_APPEND_STRING("false");
+            }
+            return 0;
+        case JSONNumber:
+            len = format_number(num_buf, json_value_get_number(value));
+            if (len == 0) {
+                return -1;
+            }
+            GB_APPEND(num_buf, len);
+            return 0;
+        case JSONNull:
+            GB_APPEND_STRING("null");
+            return 0;
+        case JSONError:
+            return -1;
+        default:
+            return -1;
+    }
+}
+
+#undef GB_APPEND
+#undef GB_APPEND_STRING
+
+/*
+ * Formats a number the way FLOAT_FORMAT would. Integral values that %1.17g prints without an
+ * exponent are converted by hand; -0 and everything else still goes through sprintf.
+ * Returns the length written to num_buf (at least NUM_BUF_SIZE bytes), 0 on error.
+ */
+static size_t format_number(char *num_buf, double num) {
+    char digits[24];
+    char *ptr = digits + sizeof(digits);
+    unsigned long long u = 0;
+    int written = -1;
+
+    if (num > -1e15 && num < 1e15 && num == (double)(long long)num && !(num == 0.0 && signbit(num))) {
+        u = num < 0 ? (unsigned long long)(-(long long)num) : (unsigned long long)num;
+        do {
+            *--ptr = (char)('0' + (u % 10));
+            u /= 10;
+        } while (u);
+        if (num < 0) {
+            *--ptr = '-';
+        }
+        written = (int)(digits + sizeof(digits) - ptr);
+        memcpy_s(num_buf, NUM_BUF_SIZE, ptr, (size_t)written); /* SAFEC */
+        num_buf[written] = '\0';
+        return (size_t)written;
+    }
+    written = sprintf(num_buf, FLOAT_FORMAT, num);
+    return written < 0 ? 0 : (size_t)written;
+}
+
+static JSON_Status json_serialize_to_grow_buffer(const JSON_Value *value, JSON_Grow_Buffer *gb, int is_pretty) {
+    gb->len = 0;
+    if (value == NULL || json_serialize_to_grow_buffer_r(value, gb, 0, is_pretty) < 0 ||
+            grow_buffer_reserve(gb, 1) < 0) {
+        return JSONFailure;
+    }
+    gb->data[gb->len] = '\0';
+    return JSONSuccess;
+}
+
 /* Parser API */
 JSON_Value * json_parse_file(const char *filename) {
     char *file_contents = read_file(filename);
@@ -1191,6 +1639,67 @@ JSON_Value * json_parse_file(const char *filename) {
     return output_value;
 }
 
+/*
+ * Added by ACVP: maps the file read-only instead of copying it into a heap buffer. The parser
+ * relies on a terminating null byte, so the file is mapped at the start of an anonymous
+ * reservation one page larger than the file; the kernel zero fills the tail of the last file page
+ * and the extra page, which guarantees the view is followed by a '\0' without copying anything.
+ * Falls back to json_parse_file() where mmap is unavailable or the file isn't a regular file.
+ */
+JSON_Value * json_parse_file_mmap(const char *filename) {
+#ifdef PARSON_USE_MMAP
+    JSON_Value *output_value = NULL;
+    struct stat st;
+    long page_size = 0;
+    size_t file_size = 0, map_size = 0;
+    char *reservation = NULL, *file_view = NULL;
+    int fd = -1;
+
+    if (filename == NULL) {
+        return NULL;
+    }
+    fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return json_parse_file(filename);
+    }
+    if (st.st_size <= 0) {
+        close(fd);
+        return NULL;
+    }
+    page_size = sysconf(_SC_PAGESIZE);
+    if (page_size <= 0) {
+        close(fd);
+        return json_parse_file(filename);
+    }
+    file_size = (size_t)st.st_size;
+    map_size = ((file_size + page_size - 1) / page_size) * page_size + page_size;
+
+    reservation = mmap(NULL, map_size, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (reservation == MAP_FAILED) {
+        close(fd);
+        return json_parse_file(filename);
+    }
+    file_view = mmap(reservation, file_size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0);
+    close(fd);
+    if (file_view == MAP_FAILED) {
+        munmap(reservation, map_size);
+        return json_parse_file(filename);
+    }
+#ifdef MADV_SEQUENTIAL
+    madvise(file_view, file_size, MADV_SEQUENTIAL);
+#endif
+    output_value = json_parse_string(file_view);
+    munmap(reservation, map_size);
+    return output_value;
+#else
+    return json_parse_file(filename);
+#endif
+}
+
 #if 0
 JSON_Value * json_parse_file_with_comments(const char *filename) {
     char *file_contents = read_file(filename);
@@ -1426,6 +1935,49 @@ int json_value_get_boolean(const JSON_Value *value) {
     return json_value_get_type(value) == JSONBoolean ? value->value.boolean : -1;
 }
 
+JSON_Value * json_value_detach(JSON_Value *value) {
+    JSON_Value *parent = NULL;
+    JSON_Array *array = NULL;
+    JSON_Object *object = NULL;
+    size_t i = 0;
+
+    if (value == NULL) {
+        return NULL;
+    }
+    parent = value->parent;
+    if (parent == NULL) {
+        return value; /* already a root */
+    }
+    switch (json_value_get_type(parent)) {
+        case JSONArray:
+            array = json_value_get_array(parent);
+            for (i = 0; i < array->count; i++) {
+                if (array->items[i] == value) {
+                    return json_array_detach_value(array, i);
+                }
+            }
+            break;
+        case JSONObject:
+            object = json_value_get_object(parent);
+            for (i = 0; i < object->count; i++) {
+                if (object->values[i] == value) {
+                    parson_free(object->names[i]);
+                    if (i != object->count - 1) { /* Replace key value pair with one from the end */
+                        object->names[i] = object->names[object->count - 1];
+                        object->values[i] = object->values[object->count - 1];
+                    }
+                    object->count -= 1;
+                    value->parent = NULL;
+                    return value;
+                }
+            }
+            break;
+        default:
+            break;
+    }
+    return NULL;
+}
+
 JSON_Value * json_value_get_parent (const JSON_Value *value) {
     return value ? value->parent : NULL;
 }
@@ -1561,6 +2113,12 @@ JSON_Value * json_value_deep_copy(const JSON_Value *value) {
                 return NULL;
             }
             temp_array_copy = json_value_get_array(return_value);
+            /* ACVP: size the copy once instead of growing it while appending */
+            if (json_array_get_count(temp_array) > 0 &&
+                json_array_resize(temp_array_copy, json_array_get_count(temp_array)) == JSONFailure) {
+                json_value_free(return_value);
+                return NULL;
+            }
             for (i = 0; i < json_array_get_count(temp_array); i++) {
                 temp_value = json_array_get_value(temp_array, i);
                 temp_value_copy = json_value_deep_copy(temp_value);
@@ -1582,19 +2140,30 @@ JSON_Value * json_value_deep_copy(const JSON_Value *value) {
                 return NULL;
             }
             temp_object_copy = json_value_get_object(return_value);
+            /* ACVP: the source keys are already unique, so size the copy once and append the
+             * pairs directly rather than looking every key up by name */
+            if (json_object_get_count(temp_object) > 0 &&
+                json_object_resize(temp_object_copy, json_object_get_count(temp_object)) == JSONFailure) {
+                json_value_free(return_value);
+                return NULL;
+            }
             for (i = 0; i < json_object_get_count(temp_object); i++) {
                 temp_key = json_object_get_name(temp_object, i);
-                temp_value = json_object_get_value(temp_object, temp_key);
+                temp_value = json_object_get_value_at(temp_object, i);
                 temp_value_copy = json_value_deep_copy(temp_value);
                 if (temp_value_copy == NULL) {
                     json_value_free(return_value);
                     return NULL;
                 }
-                if (json_object_add(temp_object_copy, temp_key, temp_value_copy) == JSONFailure) {
+                temp_object_copy->names[i] = parson_strndup(temp_key, strnlen_s(temp_key, STRING_NAME_MAX));
+                if (temp_object_copy->names[i] == NULL) {
                     json_value_free(return_value);
                     json_value_free(temp_value_copy);
                     return NULL;
                 }
+                temp_value_copy->parent = return_value;
+                temp_object_copy->values[i] = temp_value_copy;
+                temp_object_copy->count++;
             }
             return return_value;
         case JSONBoolean:
@@ -1666,29 +2235,15 @@ JSON_Status json_serialize_to_file(const JSON_Value *value, const char *filename
 }
 
 char * json_serialize_to_string(const JSON_Value *value, int *len) {
-    JSON_Status serialization_result = JSONFailure;
-    size_t buf_size_bytes = json_serialization_size(value);
-    char *buf = NULL;
-    if (buf_size_bytes == 0) {
+    JSON_Grow_Buffer gb = { NULL, 0, 0, NULL };
+    if (json_serialize_to_grow_buffer(value, &gb, 0) == JSONFailure) {
+        json_free_serialized_string(gb.data);
         return NULL;
     }
     if (len != NULL) {
-        /*
-         * The user wants to be provided with the string length
-         * Subtract by 1 to get string length (ommitting the added NULL byte).
-         */
-        *len = buf_size_bytes - 1;
-    }
-    buf = (char*)parson_malloc(buf_size_bytes);
-    if (buf == NULL) {
-        return NULL;
+        *len = (int)gb.len;
     }
-    serialization_result = json_serialize_to_buffer(value, buf, buf_size_bytes);
-    if (serialization_result == JSONFailure) {
-        json_free_serialized_string(buf);
-        return NULL;
-    }
-    return buf;
+    return gb.data;
 }
 
 size_t json_serialization_size_pretty(const JSON_Value *value) {
@@ -1733,35 +2288,70 @@ JSON_Status json_serialize_to_file_pretty(const JSON_Value *value, const char *f
 }
 
 char * json_serialize_to_string_pretty(const JSON_Value *value, int *len) {
-    JSON_Status serialization_result = JSONFailure;
-    size_t buf_size_bytes = json_serialization_size_pretty(value);
-    char *buf = NULL;
-    if (buf_size_bytes == 0) {
+    JSON_Grow_Buffer gb = { NULL, 0, 0, NULL };
+    if (json_serialize_to_grow_buffer(value, &gb, 1) == JSONFailure) {
+        json_free_serialized_string(gb.data);
         return NULL;
     }
     if (len != NULL) {
-        /*
-         * The user wants to be provided with the string length
-         * Subtract by 1 to get string length (ommitting the added NULL byte).
-         */
-        *len = buf_size_bytes - 1;
+        *len = (int)gb.len;
     }
-    buf = (char*)parson_malloc(buf_size_bytes);
-    if (buf == NULL) {
-        return NULL;
+    return gb.data;
+}
+
+static JSON_Status json_serialize_to_reusable_buffer_r(const JSON_Value *value, char **buf, size_t *buf_size,
+                                                       size_t *len, int is_pretty) {
+    JSON_Grow_Buffer gb = { NULL, 0, 0, NULL };
+    JSON_Status status = JSONFailure;
+    if (buf == NULL || buf_size == NULL) {
+        return JSONFailure;
     }
-    serialization_result = json_serialize_to_buffer_pretty(value, buf, buf_size_bytes);
-    if (serialization_result == JSONFailure) {
-        json_free_serialized_string(buf);
-        return NULL;
+    gb.data = *buf;
+    gb.size = *buf ? *buf_size : 0;
+    status = json_serialize_to_grow_buffer(value, &gb, is_pretty);
+    /* the buffer may have been replaced even if serialization failed */
+    *buf = gb.data;
+    *buf_size = gb.size;
+    if (status == JSONSuccess && len != NULL) {
+        *len = gb.len;
     }
-    return buf;
+    return status;
+}
+
+JSON_Status json_serialize_to_reusable_buffer(const JSON_Value *value, char **buf, size_t *buf_size, size_t *len) {
+    return json_serialize_to_reusable_buffer_r(value, buf, buf_size, len, 0);
+}
+
+JSON_Status json_serialize_to_reusable_buffer_pretty(const JSON_Value *value, char **buf, size_t *buf_size, size_t *len) {
+    return json_serialize_to_reusable_buffer_r(value, buf, buf_size, len, 1);
 }
 
 void json_free_serialized_string(char *string) {
     parson_free(string);
 }
 
+static JSON_Status json_serialize_to_fp_r(const JSON_Value *value, FILE *fp, int is_pretty) {
+    JSON_Grow_Buffer gb = { NULL, 0, 0, NULL };
+    JSON_Status status = JSONFailure;
+    if (value == NULL || fp == NULL) {
+        return JSONFailure;
+    }
+    gb.fp = fp;
+    if (json_serialize_to_grow_buffer_r(value, &gb, 0, is_pretty) == 0 && grow_buffer_flush(&gb) == 0) {
+        status = JSONSuccess;
+    }
+    parson_free(gb.data);
+    return status;
+}
+
+JSON_Status json_serialize_to_fp(const JSON_Value *value, FILE *fp) {
+    return json_serialize_to_fp_r(value, fp, 0);
+}
+
+JSON_Status json_serialize_to_fp_pretty(const JSON_Value *value, FILE *fp) {
+    return json_serialize_to_fp_r(value, fp, 1);
+}
+
 #if 0 /* Removed, does not currently comply with SAFEC */
 JSON_Status json_array_remove(JSON_Array *array, size_t ix) {
     size_t to_move_bytes = 0;
@@ -1846,6 +2436,22 @@ JSON_Status json_array_replace_null(JSON_Array *array, size_t i) {
     return JSONSuccess;
 }
 
+JSON_Value * json_array_detach_value(JSON_Array *array, size_t ix) {
+    JSON_Value *value = NULL;
+    size_t to_move_bytes = 0;
+    if (array == NULL || ix >= json_array_get_count(array)) {
+        return NULL;
+    }
+    value = array->items[ix];
+    if (ix < array->count - 1) {
+        to_move_bytes = (array->count - ix - 1) * sizeof(JSON_Value*);
+        memmove_s(array->items + ix, to_move_bytes, array->items + ix + 1, to_move_bytes); /* SAFEC */
+    }
+    array->count -= 1;
+    value->parent = NULL;
+    return value;
+}
+
 JSON_Status json_array_clear(JSON_Array *array) {
     size_t i = 0;
     if (array == NULL) {
@@ -2298,6 +2904,10 @@ void json_set_allocation_functions(JSON_Malloc_Function malloc_fun, JSON_Free_Fu
     parson_free = free_fun;
 }
 
+void json_set_simd_scan(int enable) {
+    parson_simd_scan = enable;
+}
+
 void json_set_escape_slashes(int escape_slashes) {
     parson_escape_slashes = escape_slashes;
 }
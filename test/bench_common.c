@@ -0,0 +1,62 @@
+/** @file */
+/*
+ * Copyright (c) 2024, Cisco Systems, Inc.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://github.com/cisco/libacvp/LICENSE
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <time.h>
+#include "bench_common.h"
+
+/* Monotonic time in seconds */
+double now_sec(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* Log handler that drops everything, so logging is not part of the timing */
+ACVP_RESULT quiet(char *msg, ACVP_LOG_LVL level) {
+    (void)msg;
+    (void)level;
+    return ACVP_SUCCESS;
+}
+
+/*
+ * Calls load for every .json file below dir. A nonzero return from load
+ * stops the walk of the directory it is in. Returns -1 if dir cannot be
+ * opened.
+ */
+int load_dir(const char *dir, int (*load)(const char *path)) {
+    DIR *d = NULL;
+    struct dirent *ent = NULL;
+    struct stat st;
+    char path[BENCH_PATH_LEN];
+    size_t len = 0;
+
+    d = opendir(dir);
+    if (!d) return -1;
+    while ((ent = readdir(d)) != NULL) {
+        if (ent->d_name[0] == '.') continue;
+        snprintf(path, sizeof(path), "%s/%s", dir, ent->d_name);
+        if (stat(path, &st)) continue;
+        if (S_ISDIR(st.st_mode)) {
+            load_dir(path, load);
+            continue;
+        }
+        len = strlen(ent->d_name);
+        if (len > 5 && !strcmp(ent->d_name + len - 5, ".json")) {
+            if (load(path)) break;
+        }
+    }
+    closedir(d);
+    return 0;
+}
@@ -0,0 +1,26 @@
+/** @file */
+/*
+ * Copyright (c) 2024, Cisco Systems, Inc.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://github.com/cisco/libacvp/LICENSE
+ */
+
+/*
+ * Helpers shared by the bench_* programs.
+ */
+
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include "acvp/acvp.h"
+
+#define BENCH_PATH_LEN 1024
+
+double now_sec(void);
+ACVP_RESULT quiet(char *msg, ACVP_LOG_LVL level);
+int load_dir(const char *dir, int (*load)(const char *path));
+
+#endif
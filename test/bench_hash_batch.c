@@ -0,0 +1,159 @@
+/** @file */
+/*
+ * Copyright (c) 2024, Cisco Systems, Inc.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://github.com/cisco/libacvp/LICENSE
+ */
+
+/*
+ * Hash AFT batch benchmark.
+ *
+ * Runs the AFT groups of a hash vector set (default: the json collateral used
+ * by the unit tests) through libacvp twice with the demo app's portable
+ * multi-lane SHA-2: once with a crypto handler that digests each test case on
+ * its own, and once with a batch handler that is given a length class of test
+ * cases at a time and fills all of the lanes. The vector set is also run as
+ * SHA2-512. Reports test cases per second for each, from the fastest of the
+ * given number of runs:
+ *
+ *   make bench_hash_batch && ./bench_hash_batch [vector set file] [runs]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "acvp/acvp.h"
+#include "acvp/acvp_lcl.h"
+#include "bench_common.h"
+#include "app_sha_mb.h"
+
+static unsigned int batch_calls = 0;
+static unsigned int batch_tcs = 0;
+
+static int digest(ACVP_TEST_CASE *test_cases, unsigned int count) {
+    APP_SHA_MB_ALG alg = APP_SHA_MB_SHA256;
+    const unsigned char *msg[APP_SHA_MB_LANES];
+    unsigned int msg_len[APP_SHA_MB_LANES];
+    unsigned char *md[APP_SHA_MB_LANES];
+    unsigned int i = 0, j = 0, n = 0;
+
+    if (test_cases[0].tc.hash->cipher == ACVP_HASH_SHA512) {
+        alg = APP_SHA_MB_SHA512;
+    }
+    for (i = 0; i < count; i += n) {
+        n = count - i < APP_SHA_MB_LANES ? count - i : APP_SHA_MB_LANES;
+        for (j = 0; j < n; j++) {
+            msg[j] = test_cases[i + j].tc.hash->msg;
+            msg_len[j] = test_cases[i + j].tc.hash->msg_len;
+            md[j] = test_cases[i + j].tc.hash->md;
+        }
+        if (app_sha_mb(alg, msg, msg_len, n, md)) {
+            return 1;
+        }
+        for (j = 0; j < n; j++) {
+            test_cases[i + j].tc.hash->md_len = app_sha_mb_md_len(alg);
+        }
+    }
+    return 0;
+}
+
+static int single_handler(ACVP_TEST_CASE *test_case) {
+    return digest(test_case, 1);
+}
+
+static int batch_handler(ACVP_TEST_CASE *test_cases, unsigned int count) {
+    batch_calls++;
+    batch_tcs += count;
+    return digest(test_cases, count);
+}
+
+/* Best of runs passes over the vector set, in seconds */
+static double run(ACVP_CTX *ctx, JSON_Object *vs, int runs) {
+    double start = 0.0, elapsed = 0.0, best = 0.0;
+    int i = 0;
+
+    for (i = 0; i < runs; i++) {
+        start = now_sec();
+        if (acvp_hash_kat_handler(ctx, vs) != ACVP_SUCCESS) {
+            fprintf(stderr, "%s: handler failed\n", json_object_get_string(vs, "algorithm"));
+            return 0.0;
+        }
+        elapsed = now_sec() - start;
+        if (!best || elapsed < best) best = elapsed;
+    }
+    return best;
+}
+
+int main(int argc, char **argv) {
+    const char *path = argc > 1 ? argv[1] : "json/hash/hash.json";
+    int runs = argc > 2 ? atoi(argv[2]) : 20;
+    static const char *algs[] = { "SHA2-256", "SHA2-512" };
+    ACVP_CTX *ctx = NULL;
+    JSON_Value *val = NULL, *aft = NULL;
+    JSON_Object *vs = NULL;
+    JSON_Array *groups = NULL;
+    const char *type = NULL;
+    double single = 0.0, batched = 0.0;
+    size_t a = 0, g = 0, tcs = 0;
+
+    if (runs <= 0) runs = 1;
+    val = json_parse_file(path);
+    if (!val) {
+        fprintf(stderr, "Unable to parse %s\n", path);
+        return 1;
+    }
+    /* Vector set files hold the version object first */
+    vs = json_array_get_object(json_value_get_array(val), 1);
+    groups = json_object_get_array(vs, "testGroups");
+    if (!groups) {
+        fprintf(stderr, "%s: no test groups\n", path);
+        json_value_free(val);
+        return 1;
+    }
+    /* Only the AFT groups are batched, so keep just those */
+    aft = json_value_init_array();
+    for (g = 0; g < json_array_get_count(groups); g++) {
+        type = json_object_get_string(json_array_get_object(groups, g), "testType");
+        if (type && !strncmp(type, "AFT", 4)) {
+            json_array_append_value(json_value_get_array(aft),
+                                    json_value_deep_copy(json_array_get_value(groups, g)));
+            tcs += json_array_get_count(json_object_get_array(json_array_get_object(groups, g), "tests"));
+        }
+    }
+    json_object_set_value(vs, "testGroups", aft);
+    if (!tcs) {
+        fprintf(stderr, "%s: no AFT test cases\n", path);
+        json_value_free(val);
+        return 1;
+    }
+    if (acvp_create_test_session(&ctx, &quiet, ACVP_LOG_LVL_ERR) != ACVP_SUCCESS) {
+        fprintf(stderr, "Unable to create a context\n");
+        json_value_free(val);
+        return 1;
+    }
+    acvp_cap_hash_enable(ctx, ACVP_HASH_SHA256, &single_handler);
+    acvp_cap_hash_enable(ctx, ACVP_HASH_SHA512, &single_handler);
+
+    printf("%u AFT test cases, best of %d runs, %d lanes\n", (unsigned int)tcs, runs, APP_SHA_MB_LANES);
+    for (a = 0; a < sizeof(algs) / sizeof(algs[0]); a++) {
+        json_object_set_string(vs, "algorithm", algs[a]);
+        acvp_cap_hash_set_batch_handler(ctx, acvp_lookup_cipher_index(algs[a]), NULL);
+        single = run(ctx, vs, runs);
+        acvp_cap_hash_set_batch_handler(ctx, acvp_lookup_cipher_index(algs[a]), &batch_handler);
+        batch_calls = batch_tcs = 0;
+        batched = run(ctx, vs, runs);
+        if (!single || !batched) {
+            continue;
+        }
+        printf("%-10s one at a time %10.0f test cases/s   batched %10.0f test cases/s"
+               "   (%.2fx, %.1f test cases per batch)\n", algs[a], tcs / single, tcs / batched,
+               single / batched, batch_calls ? (double)batch_tcs / batch_calls : 0.0);
+    }
+
+    acvp_free_test_session(ctx);
+    json_value_free(val);
+    return 0;
+}
@@ -0,0 +1,78 @@
+/** @file */
+/*
+ * Copyright (c) 2024, Cisco Systems, Inc.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://github.com/cisco/libacvp/LICENSE
+ */
+
+/*
+ * Hex conversion throughput benchmark.
+ *
+ * Encodes and decodes a buffer of the given size (default and maximum is the
+ * largest value the library accepts, 128 KB) repeatedly with the scalar code and with
+ * the vector kernels, reporting MB/s of binary data for each:
+ *
+ *   make bench_hex && ./bench_hex [bytes] [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "acvp/acvp.h"
+#include "acvp/acvp_lcl.h"
+#include "bench_common.h"
+
+static void run(int simd, int iterations, unsigned char *bin, int len, char *hex,
+                double *encode, double *decode) {
+    double start = 0.0;
+    int i = 0, conv = 0;
+
+    acvp_hex_set_simd(simd);
+    start = now_sec();
+    for (i = 0; i < iterations; i++) {
+        acvp_bin_to_hexstr(bin, len, hex, len * 2);
+    }
+    *encode = ((double)len * iterations) / (1024.0 * 1024.0) / (now_sec() - start);
+
+    start = now_sec();
+    for (i = 0; i < iterations; i++) {
+        acvp_hexstr_to_bin(hex, bin, len, &conv);
+    }
+    *decode = ((double)len * iterations) / (1024.0 * 1024.0) / (now_sec() - start);
+}
+
+int main(int argc, char **argv) {
+    int len = argc > 1 ? atoi(argv[1]) : ACVP_HEXSTR_MAX / 2;
+    int iterations = argc > 2 ? atoi(argv[2]) : 1000;
+    double enc_scalar = 0.0, dec_scalar = 0.0, enc_simd = 0.0, dec_simd = 0.0;
+    unsigned char *bin = NULL;
+    char *hex = NULL;
+    int i = 0;
+
+    if (len <= 0 || len > ACVP_HEXSTR_MAX / 2) len = ACVP_HEXSTR_MAX / 2;
+    if (iterations <= 0) iterations = 1;
+    bin = malloc(len);
+    hex = malloc((size_t)len * 2 + 1);
+    if (!bin || !hex) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    for (i = 0; i < len; i++) {
+        bin[i] = (unsigned char)rand();
+    }
+    printf("%d bytes, %d iterations\n", len, iterations);
+
+    run(1, 1, bin, len, hex, &enc_simd, &dec_simd); /* warm up */
+    run(0, iterations, bin, len, hex, &enc_scalar, &dec_scalar);
+    run(1, iterations, bin, len, hex, &enc_simd, &dec_simd);
+    printf("scalar: encode %8.1f MB/s  decode %8.1f MB/s\n", enc_scalar, dec_scalar);
+    printf("simd:   encode %8.1f MB/s (%.2fx)  decode %8.1f MB/s (%.2fx)\n",
+           enc_simd, enc_simd / enc_scalar, dec_simd, dec_simd / dec_scalar);
+
+    free(bin);
+    free(hex);
+    return 0;
+}
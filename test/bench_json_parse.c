@@ -0,0 +1,107 @@
+/** @file */
+/*
+ * Copyright (c) 2021, Cisco Systems, Inc.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://github.com/cisco/libacvp/LICENSE
+ */
+
+/*
+ * JSON parse throughput benchmark.
+ *
+ * Loads every .json file below the given directory (default: the json
+ * collateral used by the unit tests) into memory and parses the whole set
+ * repeatedly, once with scalar string scanning and once with the SIMD
+ * scanner, reporting MB/s for each. Does not need Criterion:
+ *
+ *   make bench_json_parse && ./bench_json_parse [dir] [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "acvp/parson.h"
+#include "bench_common.h"
+
+#define BENCH_MAX_FILES 4096
+
+typedef struct bench_file_t {
+    char *data;
+    size_t len;
+} BENCH_FILE;
+
+static BENCH_FILE files[BENCH_MAX_FILES];
+static int file_count = 0;
+static size_t total_bytes = 0;
+
+static int load_file(const char *path) {
+    FILE *fp = NULL;
+    struct stat st;
+    char *data = NULL;
+
+    if (file_count >= BENCH_MAX_FILES) return 0;
+    if (stat(path, &st) || st.st_size <= 0) return 0;
+
+    data = malloc((size_t)st.st_size + 1);
+    if (!data) return -1;
+    fp = fopen(path, "rb");
+    if (!fp || fread(data, 1, (size_t)st.st_size, fp) != (size_t)st.st_size) {
+        if (fp) fclose(fp);
+        free(data);
+        return 0;
+    }
+    fclose(fp);
+    data[st.st_size] = '\0';
+
+    files[file_count].data = data;
+    files[file_count].len = (size_t)st.st_size;
+    file_count++;
+    total_bytes += (size_t)st.st_size;
+    return 0;
+}
+
+static double run(int simd, int iterations) {
+    JSON_Value *val = NULL;
+    double start = 0.0, elapsed = 0.0;
+    int i = 0, j = 0;
+
+    json_set_simd_scan(simd);
+    start = now_sec();
+    for (i = 0; i < iterations; i++) {
+        for (j = 0; j < file_count; j++) {
+            val = json_parse_string(files[j].data);
+            json_value_free(val);
+        }
+    }
+    elapsed = now_sec() - start;
+    return ((double)total_bytes * iterations) / (1024.0 * 1024.0) / elapsed;
+}
+
+int main(int argc, char **argv) {
+    const char *dir = argc > 1 ? argv[1] : "json";
+    int iterations = argc > 2 ? atoi(argv[2]) : 5;
+    double scalar = 0.0, simd = 0.0;
+    int i = 0;
+
+    if (iterations <= 0) iterations = 1;
+    if (load_dir(dir, &load_file) || !file_count) {
+        fprintf(stderr, "No .json files found under %s\n", dir);
+        return 1;
+    }
+    printf("%d files, %.1f MB, %d iterations\n", file_count,
+           (double)total_bytes / (1024.0 * 1024.0), iterations);
+
+    run(1, 1); /* warm up caches and the allocator */
+    scalar = run(0, iterations);
+    simd = run(1, iterations);
+    printf("scalar scan: %8.1f MB/s\n", scalar);
+    printf("simd scan:   %8.1f MB/s (%.2fx)\n", simd, simd / scalar);
+
+    for (i = 0; i < file_count; i++) {
+        free(files[i].data);
+    }
+    return 0;
+}
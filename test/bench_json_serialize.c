@@ -0,0 +1,109 @@
+/** @file */
+/*
+ * Copyright (c) 2021, Cisco Systems, Inc.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://github.com/cisco/libacvp/LICENSE
+ */
+
+/*
+ * JSON serialization throughput benchmark.
+ *
+ * Parses every .json file below the given directory (default: the json
+ * collateral used by the unit tests) and serializes the whole set
+ * repeatedly with the two pass sizing serializer
+ * (json_serialization_size + json_serialize_to_buffer) and with the single
+ * pass reusable buffer serializer, reporting MB/s of output for each:
+ *
+ *   make bench_json_serialize && ./bench_json_serialize [dir] [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "acvp/parson.h"
+#include "bench_common.h"
+
+#define BENCH_MAX_FILES 4096
+
+static JSON_Value *values[BENCH_MAX_FILES];
+static int value_count = 0;
+
+static int load_value(const char *path) {
+    if (value_count >= BENCH_MAX_FILES) return 1;
+    values[value_count] = json_parse_file(path);
+    if (values[value_count]) value_count++;
+    return 0;
+}
+
+static double run_two_pass(int pretty, int iterations) {
+    char *buf = NULL;
+    size_t size = 0, total = 0;
+    double start = now_sec();
+    int i = 0, j = 0;
+
+    for (i = 0; i < iterations; i++) {
+        for (j = 0; j < value_count; j++) {
+            size = pretty ? json_serialization_size_pretty(values[j]) : json_serialization_size(values[j]);
+            buf = malloc(size);
+            if (!buf) return 0.0;
+            if (pretty) {
+                json_serialize_to_buffer_pretty(values[j], buf, size);
+            } else {
+                json_serialize_to_buffer(values[j], buf, size);
+            }
+            total += size - 1;
+            free(buf);
+        }
+    }
+    return (double)total / (1024.0 * 1024.0) / (now_sec() - start);
+}
+
+static double run_single_pass(int pretty, int iterations) {
+    char *buf = NULL;
+    size_t buf_size = 0, len = 0, total = 0;
+    double start = now_sec();
+    int i = 0, j = 0;
+
+    for (i = 0; i < iterations; i++) {
+        for (j = 0; j < value_count; j++) {
+            if (pretty) {
+                json_serialize_to_reusable_buffer_pretty(values[j], &buf, &buf_size, &len);
+            } else {
+                json_serialize_to_reusable_buffer(values[j], &buf, &buf_size, &len);
+            }
+            total += len;
+        }
+    }
+    json_free_serialized_string(buf);
+    return (double)total / (1024.0 * 1024.0) / (now_sec() - start);
+}
+
+int main(int argc, char **argv) {
+    const char *dir = argc > 1 ? argv[1] : "json";
+    int iterations = argc > 2 ? atoi(argv[2]) : 5;
+    double two_pass = 0.0, single_pass = 0.0;
+    int i = 0, pretty = 0;
+
+    if (iterations <= 0) iterations = 1;
+    if (load_dir(dir, &load_value) || !value_count) {
+        fprintf(stderr, "No .json files found under %s\n", dir);
+        return 1;
+    }
+    printf("%d files, %d iterations\n", value_count, iterations);
+
+    for (pretty = 0; pretty <= 1; pretty++) {
+        run_single_pass(pretty, 1); /* warm up caches and the allocator */
+        two_pass = run_two_pass(pretty, iterations);
+        single_pass = run_single_pass(pretty, iterations);
+        printf("%s two pass:    %8.1f MB/s\n", pretty ? "pretty " : "compact", two_pass);
+        printf("%s single pass: %8.1f MB/s (%.2fx)\n", pretty ? "pretty " : "compact",
+               single_pass, single_pass / two_pass);
+    }
+
+    for (i = 0; i < value_count; i++) {
+        json_value_free(values[i]);
+    }
+    return 0;
+}
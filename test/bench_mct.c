@@ -0,0 +1,216 @@
+/** @file */
+/*
+ * Copyright (c) 2024, Cisco Systems, Inc.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://github.com/cisco/libacvp/LICENSE
+ */
+
+/*
+ * Monte Carlo test throughput benchmark.
+ *
+ * Runs MCT vector sets through the library's handlers with crypto handlers
+ * that do next to no work, so the time measured is libacvp's own chaining,
+ * copying and bookkeeping. AES-CFB1, a bit per iteration, is also run with
+ * an MCT handler that returns a whole inner loop of outputs at once, which
+ * leaves only the library's replay of them through its chaining state.
+ * Reports nanoseconds per inner iteration for each algorithm, from the
+ * fastest of the given number of test cases:
+ *
+ *   make bench_mct && ./bench_mct [test cases]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "acvp/acvp.h"
+#include "acvp/acvp_lcl.h"
+#include "bench_common.h"
+
+typedef struct bench_mct_t {
+    const char *name;
+    ACVP_RESULT (*handler)(ACVP_CTX *ctx, JSON_Object *obj);
+    const char *json;
+    int calls;  /* crypto handler calls per test case */
+    ACVP_CIPHER cipher;                            /* with mct_handler: */
+    int (*mct_handler)(ACVP_TEST_CASE *test_case); /* registered for this run only */
+} BENCH_MCT;
+
+static int cfb1_mct_handler(ACVP_TEST_CASE *test_case);
+
+static BENCH_MCT benches[] = {
+    { "SHA2-256", acvp_hash_kat_handler,
+      "{\"vsId\": 1, \"algorithm\": \"SHA2-256\", \"testGroups\": [{\"tgId\": 1, \"testType\": \"MCT\","
+      " \"tests\": [{\"tcId\": 1, \"len\": 256, \"msg\": \"000102030405060708090A0B0C0D0E0F"
+      "000102030405060708090A0B0C0D0E0F\"}]}]}", ACVP_HASH_MCT_INNER * ACVP_HASH_MCT_OUTER },
+    { "SHA2-512", acvp_hash_kat_handler,
+      "{\"vsId\": 2, \"algorithm\": \"SHA2-512\", \"testGroups\": [{\"tgId\": 1, \"testType\": \"MCT\","
+      " \"tests\": [{\"tcId\": 1, \"len\": 512, \"msg\": \"000102030405060708090A0B0C0D0E0F"
+      "000102030405060708090A0B0C0D0E0F000102030405060708090A0B0C0D0E0F000102030405060708090A0B0C0D0E0F\"}]}]}",
+      ACVP_HASH_MCT_INNER * ACVP_HASH_MCT_OUTER },
+    { "SHA3-256", acvp_hash_kat_handler,
+      "{\"vsId\": 3, \"algorithm\": \"SHA3-256\", \"testGroups\": [{\"tgId\": 1, \"testType\": \"MCT\","
+      " \"tests\": [{\"tcId\": 1, \"len\": 256, \"msg\": \"000102030405060708090A0B0C0D0E0F"
+      "000102030405060708090A0B0C0D0E0F\"}]}]}", ACVP_HASH_MCT_INNER * ACVP_HASH_MCT_OUTER },
+    { "SHAKE-128", acvp_hash_kat_handler,
+      "{\"vsId\": 4, \"algorithm\": \"SHAKE-128\", \"testGroups\": [{\"tgId\": 1, \"testType\": \"MCT\","
+      " \"minOutLen\": 128, \"maxOutLen\": 4096,"
+      " \"tests\": [{\"tcId\": 1, \"len\": 128, \"msg\": \"000102030405060708090A0B0C0D0E0F\"}]}]}",
+      ACVP_HASH_MCT_INNER * ACVP_HASH_MCT_OUTER },
+    { "AES-CBC", acvp_aes_kat_handler,
+      "{\"vsId\": 5, \"algorithm\": \"ACVP-AES-CBC\", \"testGroups\": [{\"tgId\": 1, \"testType\": \"MCT\","
+      " \"direction\": \"encrypt\", \"keyLen\": 256, \"tests\": [{\"tcId\": 1,"
+      " \"key\": \"000102030405060708090A0B0C0D0E0F000102030405060708090A0B0C0D0E0F\","
+      " \"iv\": \"000102030405060708090A0B0C0D0E0F\", \"pt\": \"000102030405060708090A0B0C0D0E0F\"}]}]}",
+      ACVP_AES_MCT_INNER * ACVP_AES_MCT_OUTER },
+    { "AES-CFB8", acvp_aes_kat_handler,
+      "{\"vsId\": 6, \"algorithm\": \"ACVP-AES-CFB8\", \"testGroups\": [{\"tgId\": 1, \"testType\": \"MCT\","
+      " \"direction\": \"encrypt\", \"keyLen\": 256, \"tests\": [{\"tcId\": 1,"
+      " \"key\": \"000102030405060708090A0B0C0D0E0F000102030405060708090A0B0C0D0E0F\","
+      " \"iv\": \"000102030405060708090A0B0C0D0E0F\", \"pt\": \"A5\"}]}]}",
+      ACVP_AES_MCT_INNER * ACVP_AES_MCT_OUTER },
+    { "AES-CFB1", acvp_aes_kat_handler,
+      "{\"vsId\": 7, \"algorithm\": \"ACVP-AES-CFB1\", \"testGroups\": [{\"tgId\": 1, \"testType\": \"MCT\","
+      " \"direction\": \"encrypt\", \"keyLen\": 256, \"tests\": [{\"tcId\": 1, \"payloadLen\": 1,"
+      " \"key\": \"000102030405060708090A0B0C0D0E0F000102030405060708090A0B0C0D0E0F\","
+      " \"iv\": \"000102030405060708090A0B0C0D0E0F\", \"pt\": \"80\"}]}]}",
+      ACVP_AES_MCT_INNER * ACVP_AES_MCT_OUTER },
+    { "AES-CFB1 decrypt", acvp_aes_kat_handler,
+      "{\"vsId\": 9, \"algorithm\": \"ACVP-AES-CFB1\", \"testGroups\": [{\"tgId\": 1, \"testType\": \"MCT\","
+      " \"direction\": \"decrypt\", \"keyLen\": 128, \"tests\": [{\"tcId\": 1, \"payloadLen\": 1,"
+      " \"key\": \"000102030405060708090A0B0C0D0E0F\","
+      " \"iv\": \"000102030405060708090A0B0C0D0E0F\", \"ct\": \"00\"}]}]}",
+      ACVP_AES_MCT_INNER * ACVP_AES_MCT_OUTER },
+    { "AES-CFB1 MCT handler", acvp_aes_kat_handler,
+      "{\"vsId\": 10, \"algorithm\": \"ACVP-AES-CFB1\", \"testGroups\": [{\"tgId\": 1, \"testType\": \"MCT\","
+      " \"direction\": \"encrypt\", \"keyLen\": 256, \"tests\": [{\"tcId\": 1, \"payloadLen\": 1,"
+      " \"key\": \"000102030405060708090A0B0C0D0E0F000102030405060708090A0B0C0D0E0F\","
+      " \"iv\": \"000102030405060708090A0B0C0D0E0F\", \"pt\": \"80\"}]}]}",
+      ACVP_AES_MCT_INNER * ACVP_AES_MCT_OUTER, ACVP_AES_CFB1, cfb1_mct_handler },
+    { "TDES-CBC", acvp_des_kat_handler,
+      "{\"vsId\": 8, \"algorithm\": \"ACVP-TDES-CBC\", \"testGroups\": [{\"tgId\": 1, \"testType\": \"MCT\","
+      " \"direction\": \"encrypt\", \"keyingOption\": 1, \"tests\": [{\"tcId\": 1,"
+      " \"key1\": \"0123456789ABCDEF\", \"key2\": \"23456789ABCDEF01\", \"key3\": \"456789ABCDEF0123\","
+      " \"iv\": \"0001020304050607\", \"pt\": \"0001020304050607\"}]}]}",
+      ACVP_DES_MCT_INNER * ACVP_DES_MCT_OUTER },
+};
+
+/* Stand-in for a digest: a cheap function of the input that still changes every step */
+static int hash_handler(ACVP_TEST_CASE *test_case) {
+    ACVP_HASH_TC *tc = test_case->tc.hash;
+    const unsigned char *in = tc->m3 ? tc->m3 : tc->msg;
+    unsigned int i = 0, out_len = 0;
+
+    switch (tc->cipher) {
+    case ACVP_HASH_SHA512:
+        out_len = 64;
+        break;
+    case ACVP_HASH_SHAKE_128:
+    case ACVP_HASH_SHAKE_256:
+        out_len = tc->xof_len;
+        break;
+    default:
+        out_len = 32;
+        break;
+    }
+    for (i = 0; i < out_len; i++) {
+        tc->md[i] = (unsigned char)((i < tc->msg_len ? in[i] : 0) + i + 1);
+    }
+    tc->md_len = out_len;
+    return 0;
+}
+
+/* Stand-in for a block cipher: output is the input xor the key (never shorter than a block) */
+static int sym_handler(ACVP_TEST_CASE *test_case) {
+    ACVP_SYM_CIPHER_TC *tc = test_case->tc.symmetric;
+    unsigned int i = 0, len = 0;
+
+    if (tc->direction == ACVP_SYM_CIPH_DIR_ENCRYPT) {
+        len = tc->cipher == ACVP_AES_CFB1 || tc->cipher == ACVP_TDES_CFB1 ? 1 : tc->pt_len;
+        for (i = 0; i < len; i++) {
+            tc->ct[i] = tc->pt[i] ^ tc->key[i];
+        }
+        tc->ct_len = tc->pt_len;
+    } else {
+        len = tc->cipher == ACVP_AES_CFB1 || tc->cipher == ACVP_TDES_CFB1 ? 1 : tc->ct_len;
+        for (i = 0; i < len; i++) {
+            tc->pt[i] = tc->ct[i] ^ tc->key[i];
+        }
+        tc->pt_len = tc->ct_len;
+    }
+    return 0;
+}
+
+/* A whole CFB1 inner loop of the same stand-in cipher, with the inputs fed back as CFB1 does */
+static int cfb1_mct_handler(ACVP_TEST_CASE *test_case) {
+    ACVP_SYM_CIPHER_TC *tc = test_case->tc.symmetric;
+    unsigned char in = 0;
+    unsigned int j = 0;
+
+    in = tc->direction == ACVP_SYM_CIPH_DIR_ENCRYPT ? tc->pt[0] : tc->ct[0];
+    for (j = 0; j < tc->mct_count; j++) {
+        tc->mct_out[j] = (in ^ tc->key[0]) & 0x80;
+        in = j < 128 ? ((tc->iv[j / 8] >> (7 - j % 8)) & 1) << 7 : tc->mct_out[j - 128];
+    }
+    tc->mct_out_len = 1;
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    int count = argc > 1 ? atoi(argv[1]) : 5;
+    ACVP_CTX *ctx = NULL;
+    JSON_Value *val = NULL;
+    double start = 0.0, elapsed = 0.0, best = 0.0;
+    size_t b = 0;
+    int i = 0;
+
+    if (count <= 0) count = 1;
+    if (acvp_create_test_session(&ctx, &quiet, ACVP_LOG_LVL_ERR) != ACVP_SUCCESS) {
+        fprintf(stderr, "Unable to create a context\n");
+        return 1;
+    }
+    acvp_cap_hash_enable(ctx, ACVP_HASH_SHA256, &hash_handler);
+    acvp_cap_hash_enable(ctx, ACVP_HASH_SHA512, &hash_handler);
+    acvp_cap_hash_enable(ctx, ACVP_HASH_SHA3_256, &hash_handler);
+    acvp_cap_hash_enable(ctx, ACVP_HASH_SHAKE_128, &hash_handler);
+    acvp_cap_sym_cipher_enable(ctx, ACVP_AES_CBC, &sym_handler);
+    acvp_cap_sym_cipher_enable(ctx, ACVP_AES_CFB8, &sym_handler);
+    acvp_cap_sym_cipher_enable(ctx, ACVP_AES_CFB1, &sym_handler);
+    acvp_cap_sym_cipher_enable(ctx, ACVP_TDES_CBC, &sym_handler);
+
+    printf("%d test cases per algorithm, trivial crypto handlers\n", count);
+    for (b = 0; b < sizeof(benches) / sizeof(benches[0]); b++) {
+        val = json_parse_string(benches[b].json);
+        if (!val) {
+            fprintf(stderr, "%s: bad vector set\n", benches[b].name);
+            continue;
+        }
+        if (benches[b].mct_handler) {
+            acvp_cap_sym_cipher_set_mct_handler(ctx, benches[b].cipher, benches[b].mct_handler);
+        }
+        /* Best of count runs, as other work on the machine only ever adds time */
+        best = 0.0;
+        for (i = 0; i < count; i++) {
+            start = now_sec();
+            if (benches[b].handler(ctx, json_value_get_object(val)) != ACVP_SUCCESS) {
+                fprintf(stderr, "%s: handler failed\n", benches[b].name);
+                break;
+            }
+            elapsed = now_sec() - start;
+            if (!best || elapsed < best) best = elapsed;
+        }
+        if (benches[b].mct_handler) {
+            acvp_cap_sym_cipher_set_mct_handler(ctx, benches[b].cipher, NULL);
+        }
+        if (best) {
+            printf("%-20s %8.1f ns/iteration  %8.2f test cases/s\n", benches[b].name,
+                   best * 1e9 / benches[b].calls, 1.0 / best);
+        }
+        json_value_free(val);
+    }
+
+    acvp_free_test_session(ctx);
+    return 0;
+}
@@ -1888,3 +1888,155 @@ Test(AES_HANDLER, cryptoFail4, .init = setup_fail, .fini = teardown) {
     json_value_free(val);
 }
 
+
+/* The xor cipher for a batch of test cases; even tcIds fail to authenticate */
+static int xor_batch_handler(ACVP_TEST_CASE *test_cases, unsigned int count) {
+    ACVP_SYM_CIPHER_TC *tc = NULL;
+    unsigned int i = 0;
+
+    for (i = 0; i < count; i++) {
+        tc = test_cases[i].tc.symmetric;
+        ut_xor_sym_handler(&test_cases[i]);
+        tc->batch_rv = tc->cipher == ACVP_AES_GCM && !(tc->tc_id % 2);
+    }
+    return 0;
+}
+
+/* The per test case equivalent of xor_batch_handler() */
+static int xor_tag_handler(ACVP_TEST_CASE *test_case) {
+    ACVP_SYM_CIPHER_TC *tc = test_case->tc.symmetric;
+
+    ut_xor_sym_handler(test_case);
+    return tc->cipher == ACVP_AES_GCM && !(tc->tc_id % 2);
+}
+
+/* A batch where an unauthenticated mode reports an operation failure */
+static int bad_rv_batch_handler(ACVP_TEST_CASE *test_cases, unsigned int count) {
+    xor_batch_handler(test_cases, count);
+    test_cases[count - 1].tc.symmetric->batch_rv = 1;
+    return 0;
+}
+
+static const char *aes_gcm_batch_json =
+    "[{\"acvVersion\": \"1.0\"}, {\"vsId\": 3, \"algorithm\": \"ACVP-AES-GCM\", \"testGroups\": [{\"tgId\": 1, \"testType\": \"AFT\","
+    " \"direction\": \"decrypt\", \"keyLen\": 128, \"ivLen\": 96, \"ivGen\": \"external\", \"ivGenMode\": \"8.2.1\","
+    " \"payloadLen\": 128, \"aadLen\": 128, \"tagLen\": 128, \"tests\": ["
+    "{\"tcId\": 1, \"key\": \"2B7E151628AED2A6ABF7158809CF4F3C\", \"iv\": \"CAFEBABEFACEDBADDECAF888\","
+    " \"ct\": \"6BC1BEE22E409F96E93D7E117393172A\", \"aad\": \"FEEDFACEDEADBEEFFEEDFACEDEADBEEF\","
+    " \"tag\": \"5BC94FBC3221A5DB94FAE95AE7121A47\"},"
+    "{\"tcId\": 2, \"key\": \"8E73B0F7DA0E6452C810F32B809079E5\", \"iv\": \"CAFEBABEFACEDBADDECAF889\","
+    " \"ct\": \"AE2D8A571E03AC9C9EB76FAC45AF8E51\", \"aad\": \"FEEDFACEDEADBEEFFEEDFACEDEADBEEF\","
+    " \"tag\": \"5BC94FBC3221A5DB94FAE95AE7121A48\"},"
+    "{\"tcId\": 3, \"key\": \"603DEB1015CA71BE2B73AEF0857D7781\", \"iv\": \"CAFEBABEFACEDBADDECAF88A\","
+    " \"ct\": \"30C81C46A35CE411E5FBC1191A0A52EF\", \"aad\": \"FEEDFACEDEADBEEFFEEDFACEDEADBEEF\","
+    " \"tag\": \"5BC94FBC3221A5DB94FAE95AE7121A49\"}]}]}]";
+
+static char *run_aes_batch(JSON_Value *in, ACVP_CIPHER cipher, int (*batch_handler)(ACVP_TEST_CASE *, unsigned int),
+                           ACVP_RESULT *result) {
+    return ut_run_kat_batch(ut_get_obj_from_rsp(in), cipher,
+                            &acvp_cap_sym_cipher_enable, &xor_tag_handler,
+                            &acvp_cap_sym_cipher_set_batch_handler, batch_handler,
+                            &acvp_aes_kat_handler, result);
+}
+
+/*
+ * GCM decryptions that fail to authenticate are a test result in a batch,
+ * the same as from the crypto handler.
+ */
+Test(AES_BATCH, auth_fails) {
+    JSON_Value *in = NULL;
+    char *single = NULL, *batched = NULL;
+    ACVP_RESULT single_rv = ACVP_SUCCESS, batched_rv = ACVP_SUCCESS;
+
+    in = json_parse_string(aes_gcm_batch_json);
+    cr_assert_not_null(in);
+    single = run_aes_batch(in, ACVP_AES_GCM, NULL, &single_rv);
+    batched = run_aes_batch(in, ACVP_AES_GCM, &xor_batch_handler, &batched_rv);
+    cr_assert(single_rv == ACVP_SUCCESS);
+    cr_assert(batched_rv == ACVP_SUCCESS);
+    cr_assert_str_eq(batched, single);
+    json_free_serialized_string(single);
+    json_free_serialized_string(batched);
+    json_value_free(in);
+}
+
+/*
+ * A failed operation in a mode where that is not a test result fails the
+ * vector set.
+ */
+Test(AES_BATCH, op_fails) {
+    JSON_Value *in = NULL;
+    ACVP_RESULT result = ACVP_SUCCESS;
+    char *out = NULL;
+
+    in = json_parse_file("json/aes/aes.json");
+    cr_assert_not_null(in);
+    out = run_aes_batch(in, ACVP_AES_CBC, &bad_rv_batch_handler, &result);
+    cr_assert_null(out);
+    cr_assert(result == ACVP_CRYPTO_MODULE_FAIL);
+    json_value_free(in);
+}
+
+/*
+ * The cipher of ut_xor_sym_handler() as a whole CFB1 inner loop, worked out
+ * bit by bit: each input is the next bit of the IV, then of the outputs 128
+ * steps back.
+ */
+static int xor_cfb1_mct_handler(ACVP_TEST_CASE *test_case) {
+    ACVP_SYM_CIPHER_TC *tc = test_case->tc.symmetric;
+    unsigned char in = 0;
+    unsigned int j = 0;
+
+    in = tc->direction == ACVP_SYM_CIPH_DIR_ENCRYPT ? tc->pt[0] : tc->ct[0];
+    for (j = 0; j < tc->mct_count; j++) {
+        tc->mct_out[j] = (in ^ tc->key[0]) & 0x80;
+        if (j < 128) {
+            in = ((tc->iv[j / 8] >> (7 - j % 8)) & 1) << 7;
+        } else {
+            in = tc->mct_out[j - 128];
+        }
+    }
+    tc->mct_out_len = 1;
+    return 0;
+}
+
+static const char *aes_cfb1_mct_json =
+    "{\"vsId\": 3, \"algorithm\": \"ACVP-AES-CFB1\", \"testGroups\": [{\"tgId\": 1, \"testType\": \"MCT\","
+    " \"direction\": \"encrypt\", \"keyLen\": 128, \"tests\": [{\"tcId\": 1, \"payloadLen\": 1,"
+    " \"key\": \"8B7E151628AED2A6ABF7158809CF4F3C\", \"iv\": \"000102030405060708090A0B0C0D0E0F\","
+    " \"pt\": \"80\"}]},"
+    " {\"tgId\": 2, \"testType\": \"MCT\", \"direction\": \"decrypt\", \"keyLen\": 256, \"tests\": [{\"tcId\": 2,"
+    " \"payloadLen\": 1, \"key\": \"603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4\","
+    " \"iv\": \"F0E1D2C3B4A5968778695A4B3C2D1E0F\", \"ct\": \"00\"}]}]}";
+
+static char *run_cfb1_mct(int (*mct_handler)(ACVP_TEST_CASE *), ACVP_RESULT *result) {
+    JSON_Value *in = NULL;
+    char *out = NULL;
+
+    in = json_parse_string(aes_cfb1_mct_json);
+    cr_assert_not_null(in);
+    out = ut_run_kat(json_value_get_object(in), ACVP_AES_CFB1, 0,
+                     &acvp_cap_sym_cipher_enable, &ut_xor_sym_handler,
+                     &acvp_cap_sym_cipher_set_mct_handler, mct_handler,
+                     &acvp_aes_kat_handler, result);
+    json_value_free(in);
+    return out;
+}
+
+/*
+ * A whole CFB1 inner loop from the module, with the next key and IV taken
+ * from its output bits, gives the same response as one crypto handler call
+ * per bit.
+ */
+Test(AES_MCT_HANDLER, cfb1_history) {
+    char *slow = NULL, *fast = NULL;
+    ACVP_RESULT slow_rv = ACVP_SUCCESS, fast_rv = ACVP_SUCCESS;
+
+    slow = run_cfb1_mct(NULL, &slow_rv);
+    fast = run_cfb1_mct(&xor_cfb1_mct_handler, &fast_rv);
+    cr_assert(slow_rv == ACVP_SUCCESS);
+    cr_assert(fast_rv == ACVP_SUCCESS);
+    cr_assert_str_eq(fast, slow);
+    json_free_serialized_string(slow);
+    json_free_serialized_string(fast);
+}
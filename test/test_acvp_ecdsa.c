@@ -994,3 +994,154 @@ Test(ECDSA_HANDLER, tcFail4, .init = setup, .fini = teardown) {
 }
 
 
+static int group_begins = 0;
+static int group_ends = 0;
+static int group_frees = 0;
+static int group_missing = 0;
+
+static void count_free(void *value) {
+    group_frees++;
+    free(value);
+}
+
+static int group_handler(ACVP_GROUP_EVENT event, ACVP_TEST_CASE *test_case) {
+    ACVP_ECDSA_TC *tc = test_case->tc.ecdsa;
+    int *value = NULL;
+
+    if (event == ACVP_GROUP_BEGIN) {
+        group_begins++;
+        value = calloc(1, sizeof(int));
+        if (!value) return 1;
+        *value = tc->tg_id;
+        return acvp_group_cache_set(test_case->group_cache, &tc->tg_id, sizeof(tc->tg_id),
+                                    value, count_free) != ACVP_SUCCESS;
+    }
+    group_ends++;
+    acvp_group_cache_remove(test_case->group_cache, &tc->tg_id, sizeof(tc->tg_id));
+    return 0;
+}
+
+static int group_begin_fail(ACVP_GROUP_EVENT event, ACVP_TEST_CASE *test_case) {
+    (void)test_case;
+    if (event == ACVP_GROUP_BEGIN) group_begins++;
+    return 1;
+}
+
+static int group_crypto_handler(ACVP_TEST_CASE *test_case) {
+    ACVP_ECDSA_TC *tc = test_case->tc.ecdsa;
+    int *value = NULL;
+
+    value = acvp_group_cache_get(test_case->group_cache, &tc->tg_id, sizeof(tc->tg_id));
+    if (!value || *value != tc->tg_id) {
+        group_missing++;
+    }
+    return 0;
+}
+
+static void setup_group(void) {
+    group_begins = group_ends = group_frees = group_missing = 0;
+    setup_empty_ctx(&ctx);
+    rv = acvp_cap_ecdsa_enable(ctx, ACVP_ECDSA_SIGGEN, &group_crypto_handler);
+    cr_assert(rv == ACVP_SUCCESS);
+    rv = acvp_cap_ecdsa_set_parm(ctx, ACVP_ECDSA_SIGGEN, ACVP_ECDSA_CURVE, ACVP_EC_CURVE_P384);
+    cr_assert(rv == ACVP_SUCCESS);
+    rv = acvp_cap_ecdsa_set_parm(ctx, ACVP_ECDSA_SIGGEN, ACVP_ECDSA_HASH_ALG, ACVP_SHA224);
+    cr_assert(rv == ACVP_SUCCESS);
+}
+
+/*
+ * Test group handler registration
+ */
+Test(ECDSA_GROUP, set_handler, .init = setup_group, .fini = teardown) {
+    rv = acvp_cap_set_group_handler(NULL, ACVP_ECDSA_SIGGEN, &group_handler);
+    cr_assert(rv == ACVP_NO_CTX);
+    rv = acvp_cap_set_group_handler(ctx, ACVP_ECDSA_SIGVER, &group_handler);
+    cr_assert(rv == ACVP_NO_CAP);
+    rv = acvp_cap_set_group_handler(ctx, ACVP_ECDSA_SIGGEN, &group_handler);
+    cr_assert(rv == ACVP_SUCCESS);
+
+    rv = acvp_cap_hash_enable(ctx, ACVP_HASH_SHA256, &dummy_handler_success);
+    cr_assert(rv == ACVP_SUCCESS);
+    rv = acvp_cap_set_group_handler(ctx, ACVP_HASH_SHA256, &group_handler);
+    cr_assert(rv == ACVP_INVALID_ARG);
+}
+
+/*
+ * Each group begins before its first test case and ends after its last,
+ * and what the group handler cached is there for the test cases between.
+ */
+Test(ECDSA_GROUP, begin_end, .init = setup_group, .fini = teardown) {
+    rv = acvp_cap_set_group_handler(ctx, ACVP_ECDSA_SIGGEN, &group_handler);
+    cr_assert(rv == ACVP_SUCCESS);
+
+    val = json_parse_file("json/ecdsa/ecdsa_siggen.json");
+    obj = ut_get_obj_from_rsp(val);
+    if (!obj) {
+        ACVP_LOG_ERR("JSON obj parse error");
+        return;
+    }
+    rv = acvp_ecdsa_siggen_kat_handler(ctx, obj);
+    cr_assert(rv == ACVP_SUCCESS);
+    cr_assert(group_begins == 2);
+    cr_assert(group_ends == 2);
+    cr_assert(group_frees == 2);
+    cr_assert(group_missing == 0);
+    cr_assert(ctx->group_cache.entries == NULL);
+    json_value_free(val);
+}
+
+/*
+ * A group handler that fails to begin a group fails the vector set
+ */
+Test(ECDSA_GROUP, begin_fail, .init = setup_group, .fini = teardown) {
+    rv = acvp_cap_set_group_handler(ctx, ACVP_ECDSA_SIGGEN, &group_begin_fail);
+    cr_assert(rv == ACVP_SUCCESS);
+
+    val = json_parse_file("json/ecdsa/ecdsa_siggen.json");
+    obj = ut_get_obj_from_rsp(val);
+    if (!obj) {
+        ACVP_LOG_ERR("JSON obj parse error");
+        return;
+    }
+    rv = acvp_ecdsa_siggen_kat_handler(ctx, obj);
+    cr_assert(rv == ACVP_CRYPTO_MODULE_FAIL);
+    cr_assert(group_begins == 1);
+    json_value_free(val);
+}
+
+/*
+ * Test the group cache
+ */
+Test(ECDSA_GROUP, cache, .init = setup_group, .fini = teardown) {
+    ACVP_GROUP_CACHE *cache = &ctx->group_cache;
+    int key1 = 1, key2 = 2;
+    int *a = calloc(1, sizeof(int)), *b = calloc(1, sizeof(int)), *c = calloc(1, sizeof(int));
+
+    cr_assert(a && b && c);
+    cr_assert(acvp_group_cache_set(NULL, &key1, sizeof(key1), a, count_free) == ACVP_INVALID_ARG);
+    cr_assert(acvp_group_cache_set(cache, &key1, 0, a, count_free) == ACVP_INVALID_ARG);
+    cr_assert(acvp_group_cache_set(cache, &key1, sizeof(key1), NULL, count_free) == ACVP_INVALID_ARG);
+    cr_assert(acvp_group_cache_get(cache, &key1, sizeof(key1)) == NULL);
+
+    cr_assert(acvp_group_cache_set(cache, &key1, sizeof(key1), a, count_free) == ACVP_SUCCESS);
+    cr_assert(acvp_group_cache_set(cache, &key2, sizeof(key2), b, count_free) == ACVP_SUCCESS);
+    cr_assert(acvp_group_cache_get(cache, &key1, sizeof(key1)) == a);
+    cr_assert(acvp_group_cache_get(cache, &key2, sizeof(key2)) == b);
+
+    /* Replacing a value frees the old one */
+    cr_assert(acvp_group_cache_set(cache, &key1, sizeof(key1), c, count_free) == ACVP_SUCCESS);
+    cr_assert(group_frees == 1);
+    cr_assert(acvp_group_cache_get(cache, &key1, sizeof(key1)) == c);
+
+    acvp_group_cache_remove(cache, &key2, sizeof(key2));
+    cr_assert(group_frees == 2);
+    cr_assert(acvp_group_cache_get(cache, &key2, sizeof(key2)) == NULL);
+    acvp_group_cache_remove(cache, &key2, sizeof(key2));
+    cr_assert(group_frees == 2);
+
+    /* What is left goes with the session */
+    teardown_ctx(&ctx);
+    ctx = NULL;
+    cr_assert(group_frees == 3);
+}
+
@@ -0,0 +1,651 @@
+/** @file */
+/*
+ * Copyright (c) 2024, Cisco Systems, Inc.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://github.com/cisco/libacvp/LICENSE
+ */
+
+/*
+ * The shared ways of running a vector set other than one crypto handler
+ * call per operation. Each is tested once, over every algorithm that has it:
+ * the vector set is run both ways and must give the same response. Behavior
+ * particular to one algorithm is tested in that algorithm's file.
+ */
+
+#include <unistd.h>
+#include "ut_common.h"
+#include "acvp/acvp_lcl.h"
+
+static ACVP_CTX *ctx = NULL;
+
+/*
+ * The cipher of ut_xor_sym_handler(), a whole inner loop at a time, chained
+ * the way the library chains AES ECB and CBC and TDES CBC and CFB64.
+ */
+static int xor_mct_handler(ACVP_TEST_CASE *test_case) {
+    ACVP_SYM_CIPHER_TC *tc = test_case->tc.symmetric;
+    int tdes = tc->cipher >= ACVP_TDES_ECB && tc->cipher <= ACVP_TDES_KW;
+    int encrypt = tc->direction == ACVP_SYM_CIPH_DIR_ENCRYPT;
+    unsigned int blk = tdes ? 8 : 16, i = 0, j = 0;
+    const unsigned char *in = NULL;
+    unsigned char *out = NULL, next[8];
+
+    in = encrypt ? tc->pt : tc->ct;
+    for (j = 0; j < tc->mct_count; j++) {
+        out = tc->mct_out + j * blk;
+        for (i = 0; i < blk; i++) {
+            out[i] = in[i] ^ tc->key[i];
+        }
+        if (tc->cipher == ACVP_AES_ECB) {
+            in = out;
+        } else if (!tdes || encrypt) {
+            in = j == 0 ? tc->iv : out - blk;
+        } else if (tc->cipher == ACVP_TDES_CFB64) {
+            for (i = 0; i < blk; i++) {
+                next[i] = in[i] ^ out[i];
+            }
+            in = next;
+        } else {
+            in = out;
+        }
+    }
+    if (tdes) {
+        memcpy(tc->iv_ret_after, out, blk);
+    }
+    tc->mct_out_len = blk;
+    return 0;
+}
+
+/* Returns half the output the library expects */
+static int short_sym_mct_handler(ACVP_TEST_CASE *test_case) {
+    xor_mct_handler(test_case);
+    test_case->tc.symmetric->mct_out_len /= 2;
+    return 0;
+}
+
+/* The same chains as the library's hash MCT loops, run in one call */
+static int toy_hash_mct_handler(ACVP_TEST_CASE *test_case) {
+    ACVP_HASH_TC *tc = test_case->tc.hash;
+    unsigned char m[3][32], in[16], *out = NULL;
+    unsigned int i = 0, j = 0, h = 0, oldest = 0, len = 0, out_len = 0, min_len = 0;
+
+    for (i = 0; i < tc->mct_count; i++) {
+        out = tc->mct_md + i * tc->mct_md_max;
+        if (tc->cipher == ACVP_HASH_SHA256) {
+            memcpy(m[0], i ? tc->mct_md + (i - 1) * tc->mct_md_max : tc->msg, 32);
+            memcpy(m[1], m[0], 32);
+            memcpy(m[2], m[0], 32);
+            for (j = 0, oldest = 0; j < ACVP_HASH_MCT_INNER; j++, oldest = (oldest + 1) % 3) {
+                h = 1;
+                ut_toy_hash_update(&h, m[oldest], 32);
+                ut_toy_hash_update(&h, m[(oldest + 1) % 3], 32);
+                ut_toy_hash_update(&h, m[(oldest + 2) % 3], 32);
+                ut_toy_hash_final(h, m[oldest], 32);
+            }
+            memcpy(out, m[(oldest + 2) % 3], 32);
+            tc->mct_md_len[i] = 32;
+        } else if (tc->cipher == ACVP_HASH_SHA3_256) {
+            memcpy(m[0], i ? tc->mct_md + (i - 1) * tc->mct_md_max : tc->msg, 32);
+            for (j = 0; j < ACVP_HASH_MCT_INNER; j++) {
+                h = 1;
+                ut_toy_hash_update(&h, m[0], 32);
+                ut_toy_hash_final(h, m[0], 32);
+            }
+            memcpy(out, m[0], 32);
+            tc->mct_md_len[i] = 32;
+        } else {
+            min_len = tc->min_xof_bits / 8;
+            if (!i) {
+                memcpy(in, tc->msg, 16);
+                out_len = tc->max_xof_bits / 8;
+            }
+            for (j = 0; j < ACVP_HASH_MCT_INNER; j++) {
+                h = 1;
+                ut_toy_hash_update(&h, in, 16);
+                ut_toy_hash_final(h, out, out_len);
+                len = out_len;
+                memcpy(in, out, 16);
+                out_len = min_len + ((out[len - 2] << 8) | out[len - 1]) %
+                          (tc->max_xof_bits / 8 - min_len + 1);
+            }
+            tc->mct_md_len[i] = len;
+        }
+    }
+    return 0;
+}
+
+/* Returns checkpoints shorter than the shortest digest or XOF output allowed */
+static int short_hash_mct_handler(ACVP_TEST_CASE *test_case) {
+    ACVP_HASH_TC *tc = test_case->tc.hash;
+    unsigned int i = 0;
+
+    for (i = 0; i < tc->mct_count; i++) {
+        tc->mct_md_len[i] = tc->min_xof_bits ? tc->min_xof_bits / 8 - 1 : tc->mct_md_max - 1;
+    }
+    return 0;
+}
+
+/* A vector set with an MCT path in the module, and how to run it */
+typedef struct mct_case_t {
+    ACVP_CIPHER cipher;
+    const char *json;
+    UT_CAP_ENABLE enable;
+    int (*crypto_handler)(ACVP_TEST_CASE *test_case);
+    UT_SET_HANDLER set_handler;
+    int (*mct_handler)(ACVP_TEST_CASE *test_case);
+    int (*short_handler)(ACVP_TEST_CASE *test_case); /* mct_handler with too little output */
+    UT_KAT_HANDLER kat_handler;
+} MCT_CASE;
+
+#define SYM_MCT(cipher, json, kat_handler) \
+    { cipher, json, &acvp_cap_sym_cipher_enable, &ut_xor_sym_handler, &acvp_cap_sym_cipher_set_mct_handler, \
+      &xor_mct_handler, &short_sym_mct_handler, kat_handler }
+#define HASH_MCT(cipher, json) \
+    { cipher, json, &acvp_cap_hash_enable, &ut_toy_hash_handler, &acvp_cap_hash_set_mct_handler, \
+      &toy_hash_mct_handler, &short_hash_mct_handler, &acvp_hash_kat_handler }
+
+static const MCT_CASE mct_cases[] = {
+    SYM_MCT(ACVP_AES_ECB,
+            "{\"vsId\": 1, \"algorithm\": \"ACVP-AES-ECB\", \"testGroups\": [{\"tgId\": 1, \"testType\": \"MCT\","
+            " \"direction\": \"encrypt\", \"keyLen\": 128, \"tests\": [{\"tcId\": 1,"
+            " \"key\": \"2B7E151628AED2A6ABF7158809CF4F3C\", \"pt\": \"6BC1BEE22E409F96E93D7E117393172A\"}]}]}",
+            &acvp_aes_kat_handler),
+    SYM_MCT(ACVP_AES_CBC,
+            "{\"vsId\": 2, \"algorithm\": \"ACVP-AES-CBC\", \"testGroups\": [{\"tgId\": 1, \"testType\": \"MCT\","
+            " \"direction\": \"encrypt\", \"keyLen\": 192, \"tests\": [{\"tcId\": 1,"
+            " \"key\": \"8E73B0F7DA0E6452C810F32B809079E562F8EAD2522C6B7B\", \"iv\": \"000102030405060708090A0B0C0D0E0F\","
+            " \"pt\": \"6BC1BEE22E409F96E93D7E117393172A\"}]},"
+            " {\"tgId\": 2, \"testType\": \"MCT\", \"direction\": \"decrypt\", \"keyLen\": 256, \"tests\": [{\"tcId\": 2,"
+            " \"key\": \"603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4\","
+            " \"iv\": \"000102030405060708090A0B0C0D0E0F\", \"ct\": \"F58C4C04D6E5F1BA779EABFB5F7BFBD6\"}]}]}",
+            &acvp_aes_kat_handler),
+    SYM_MCT(ACVP_TDES_CBC,
+            "{\"vsId\": 3, \"algorithm\": \"ACVP-TDES-CBC\", \"testGroups\": [{\"tgId\": 1, \"testType\": \"MCT\","
+            " \"direction\": \"encrypt\", \"keyingOption\": 1, \"tests\": [{\"tcId\": 1,"
+            " \"key1\": \"0123456789ABCDEF\", \"key2\": \"23456789ABCDEF01\", \"key3\": \"456789ABCDEF0123\","
+            " \"iv\": \"0001020304050607\", \"pt\": \"4E6F772069732074\"}]},"
+            " {\"tgId\": 2, \"testType\": \"MCT\", \"direction\": \"decrypt\", \"keyingOption\": 1, \"tests\": [{\"tcId\": 2,"
+            " \"key1\": \"0123456789ABCDEF\", \"key2\": \"23456789ABCDEF01\", \"key3\": \"456789ABCDEF0123\","
+            " \"iv\": \"0001020304050607\", \"ct\": \"4E6F772069732074\"}]}]}",
+            &acvp_des_kat_handler),
+    SYM_MCT(ACVP_TDES_CFB64,
+            "{\"vsId\": 4, \"algorithm\": \"ACVP-TDES-CFB64\", \"testGroups\": [{\"tgId\": 1, \"testType\": \"MCT\","
+            " \"direction\": \"decrypt\", \"keyingOption\": 1, \"tests\": [{\"tcId\": 1,"
+            " \"key1\": \"0123456789ABCDEF\", \"key2\": \"23456789ABCDEF01\", \"key3\": \"456789ABCDEF0123\","
+            " \"iv\": \"0001020304050607\", \"ct\": \"4E6F772069732074\"}]}]}",
+            &acvp_des_kat_handler),
+    HASH_MCT(ACVP_HASH_SHA256,
+             "{\"vsId\": 5, \"algorithm\": \"SHA2-256\", \"testGroups\": [{\"tgId\": 1, \"testType\": \"MCT\","
+             " \"tests\": [{\"tcId\": 1, \"len\": 256, \"msg\": \"000102030405060708090A0B0C0D0E0F"
+             "101112131415161718191A1B1C1D1E1F\"}]}]}"),
+    HASH_MCT(ACVP_HASH_SHA3_256,
+             "{\"vsId\": 6, \"algorithm\": \"SHA3-256\", \"testGroups\": [{\"tgId\": 1, \"testType\": \"MCT\","
+             " \"tests\": [{\"tcId\": 1, \"len\": 256, \"msg\": \"000102030405060708090A0B0C0D0E0F"
+             "101112131415161718191A1B1C1D1E1F\"}]}]}"),
+    HASH_MCT(ACVP_HASH_SHAKE_128,
+             "{\"vsId\": 7, \"algorithm\": \"SHAKE-128\", \"testGroups\": [{\"tgId\": 1, \"testType\": \"MCT\","
+             " \"minOutLen\": 128, \"maxOutLen\": 1024,"
+             " \"tests\": [{\"tcId\": 1, \"len\": 128, \"msg\": \"000102030405060708090A0B0C0D0E0F\"}]}]}"),
+    /* MCT groups either side of an AFT group */
+    HASH_MCT(ACVP_HASH_SHA256,
+             "{\"vsId\": 8, \"algorithm\": \"SHA2-256\", \"testGroups\": [{\"tgId\": 1, \"testType\": \"MCT\","
+             " \"tests\": [{\"tcId\": 1, \"len\": 256, \"msg\": \"000102030405060708090A0B0C0D0E0F"
+             "101112131415161718191A1B1C1D1E1F\"}, {\"tcId\": 2, \"len\": 256, \"msg\": \"1F1E1D1C1B1A19181716151413121110"
+             "0F0E0D0C0B0A09080706050403020100\"}]}, {\"tgId\": 2, \"testType\": \"AFT\","
+             " \"tests\": [{\"tcId\": 3, \"len\": 8, \"msg\": \"AB\"}]}, {\"tgId\": 3, \"testType\": \"MCT\","
+             " \"tests\": [{\"tcId\": 4, \"len\": 256, \"msg\": \"FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF"
+             "00000000000000000000000000000000\"}]}]}"),
+};
+
+#define MCT_CASE_CNT (sizeof(mct_cases) / sizeof(mct_cases[0]))
+
+static char *run_mct(const MCT_CASE *mc, int (*mct_handler)(ACVP_TEST_CASE *), unsigned int threads,
+                     ACVP_RESULT *result) {
+    JSON_Value *in = NULL;
+    char *out = NULL;
+
+    in = json_parse_string(mc->json);
+    cr_assert_not_null(in);
+    out = ut_run_kat(json_value_get_object(in), mc->cipher, threads,
+                     mc->enable, mc->crypto_handler, mc->set_handler, mct_handler,
+                     mc->kat_handler, result);
+    json_value_free(in);
+    return out;
+}
+
+/*
+ * Setting an MCT handler checks the context, the algorithm and that the
+ * capability exists.
+ */
+Test(MCT_HANDLER, set_args) {
+    setup_empty_ctx(&ctx);
+
+    cr_assert(acvp_cap_sym_cipher_set_mct_handler(NULL, ACVP_AES_CBC, &xor_mct_handler) == ACVP_NO_CTX);
+    cr_assert(acvp_cap_sym_cipher_set_mct_handler(ctx, ACVP_AES_CBC, &xor_mct_handler) == ACVP_NO_CAP);
+    cr_assert(acvp_cap_sym_cipher_enable(ctx, ACVP_AES_GCM, &ut_xor_sym_handler) == ACVP_SUCCESS);
+    cr_assert(acvp_cap_sym_cipher_set_mct_handler(ctx, ACVP_AES_GCM, &xor_mct_handler) == ACVP_INVALID_ARG);
+    /* TDES OFB chains through the IV register, which a whole inner loop does not return */
+    cr_assert(acvp_cap_sym_cipher_set_mct_handler(ctx, ACVP_TDES_OFB, &xor_mct_handler) == ACVP_UNSUPPORTED_OP);
+    cr_assert(acvp_cap_sym_cipher_enable(ctx, ACVP_AES_CBC, &ut_xor_sym_handler) == ACVP_SUCCESS);
+    cr_assert(acvp_cap_sym_cipher_set_mct_handler(ctx, ACVP_AES_CBC, &xor_mct_handler) == ACVP_SUCCESS);
+
+    cr_assert(acvp_cap_hash_set_mct_handler(NULL, ACVP_HASH_SHA256, &toy_hash_mct_handler) == ACVP_NO_CTX);
+    cr_assert(acvp_cap_hash_set_mct_handler(ctx, ACVP_HASH_SHA256, &toy_hash_mct_handler) == ACVP_NO_CAP);
+    cr_assert(acvp_cap_hash_set_mct_handler(ctx, ACVP_AES_CBC, &toy_hash_mct_handler) == ACVP_INVALID_ARG);
+    cr_assert(acvp_cap_hash_enable(ctx, ACVP_HASH_SHA256, &ut_toy_hash_handler) == ACVP_SUCCESS);
+    cr_assert(acvp_cap_hash_set_mct_handler(ctx, ACVP_HASH_SHA256, &toy_hash_mct_handler) == ACVP_SUCCESS);
+
+    teardown_ctx(&ctx);
+}
+
+/*
+ * Whole inner loops from the module give the same response as one crypto
+ * handler call per operation.
+ */
+Test(MCT_HANDLER, same_results) {
+    char *slow = NULL, *fast = NULL;
+    ACVP_RESULT slow_rv = ACVP_SUCCESS, fast_rv = ACVP_SUCCESS;
+    unsigned int i = 0;
+
+    for (i = 0; i < MCT_CASE_CNT; i++) {
+        slow = run_mct(&mct_cases[i], NULL, 0, &slow_rv);
+        fast = run_mct(&mct_cases[i], mct_cases[i].mct_handler, 0, &fast_rv);
+        cr_assert(slow_rv == ACVP_SUCCESS);
+        cr_assert(fast_rv == ACVP_SUCCESS);
+        cr_assert_str_eq(fast, slow);
+        json_free_serialized_string(slow);
+        json_free_serialized_string(fast);
+    }
+}
+
+/*
+ * Output of the wrong size from the module fails the test case.
+ */
+Test(MCT_HANDLER, bad_output) {
+    ACVP_RESULT result = ACVP_SUCCESS;
+    unsigned int i = 0;
+
+    for (i = 0; i < MCT_CASE_CNT; i++) {
+        cr_assert_null(run_mct(&mct_cases[i], mct_cases[i].short_handler, 0, &result));
+        cr_assert(result == ACVP_CRYPTO_MODULE_FAIL);
+    }
+}
+
+static int mct_entered = 0;
+static int mct_overlapped = 0;
+
+/*
+ * The xor MCT handler, but the first call of each test case waits (for up to
+ * five seconds) for the other test case to be started as well.
+ */
+static int waiting_mct_handler(ACVP_TEST_CASE *test_case) {
+    int i = 0;
+
+    if (test_case->tc.symmetric->mct_index == 0 && !__atomic_load_n(&mct_overlapped, __ATOMIC_SEQ_CST)) {
+        __atomic_add_fetch(&mct_entered, 1, __ATOMIC_SEQ_CST);
+        for (i = 0; i < 5000 && __atomic_load_n(&mct_entered, __ATOMIC_SEQ_CST) < 2; i++) {
+            usleep(1000);
+        }
+        if (__atomic_load_n(&mct_entered, __ATOMIC_SEQ_CST) >= 2) {
+            __atomic_store_n(&mct_overlapped, 1, __ATOMIC_SEQ_CST);
+        }
+    }
+    return xor_mct_handler(test_case);
+}
+
+Test(MCT_POOL, set_args) {
+    cr_assert(acvp_set_mct_threads(NULL, 4) == ACVP_NO_CTX);
+    setup_empty_ctx(&ctx);
+    cr_assert(acvp_set_mct_threads(ctx, 4) == ACVP_SUCCESS);
+    cr_assert(acvp_set_mct_threads(ctx, 0) == ACVP_SUCCESS);
+    teardown_ctx(&ctx);
+}
+
+/*
+ * MCT test cases run on worker threads, by the library's loops or by the
+ * module, give the same response as running them in turn; test cases of
+ * other types between them keep their place.
+ */
+Test(MCT_POOL, same_results) {
+    char *seq = NULL, *par = NULL;
+    ACVP_RESULT seq_rv = ACVP_SUCCESS, par_rv = ACVP_SUCCESS;
+    int (*handler)(ACVP_TEST_CASE *) = NULL;
+    unsigned int i = 0, j = 0;
+
+    for (i = 0; i < MCT_CASE_CNT; i++) {
+        for (j = 0; j < 2; j++) {
+            handler = j ? mct_cases[i].mct_handler : NULL;
+            seq = run_mct(&mct_cases[i], handler, 0, &seq_rv);
+            par = run_mct(&mct_cases[i], handler, 3, &par_rv);
+            cr_assert(seq_rv == ACVP_SUCCESS);
+            cr_assert(par_rv == ACVP_SUCCESS);
+            cr_assert_str_eq(par, seq);
+            json_free_serialized_string(seq);
+            json_free_serialized_string(par);
+        }
+    }
+}
+
+/*
+ * The two MCT test cases of a vector set are in the module at the same time.
+ */
+Test(MCT_POOL, concurrent) {
+    MCT_CASE aes_cbc = mct_cases[1];
+    ACVP_RESULT result = ACVP_SUCCESS;
+
+    mct_entered = 0;
+    mct_overlapped = 0;
+    cr_assert(aes_cbc.cipher == ACVP_AES_CBC);
+    json_free_serialized_string(run_mct(&aes_cbc, &waiting_mct_handler, 2, &result));
+    cr_assert(result == ACVP_SUCCESS);
+    cr_assert(mct_overlapped);
+}
+
+/*
+ * A test case failing on a worker fails the vector set.
+ */
+Test(MCT_POOL, fails) {
+    ACVP_RESULT result = ACVP_SUCCESS;
+    unsigned int i = 0;
+
+    for (i = 0; i < MCT_CASE_CNT; i++) {
+        cr_assert_null(run_mct(&mct_cases[i], mct_cases[i].short_handler, 3, &result));
+        cr_assert(result == ACVP_CRYPTO_MODULE_FAIL);
+    }
+}
+
+/* A stand-in MAC: the key and message folded into mac_len bytes */
+static int fake_hmac_handler(ACVP_TEST_CASE *test_case) {
+    ACVP_HMAC_TC *tc = test_case->tc.hmac;
+    unsigned int i = 0;
+
+    memzero_s(tc->mac, tc->mac_len);
+    for (i = 0; i < tc->key_len; i++) {
+        tc->mac[i % tc->mac_len] ^= tc->key[i];
+    }
+    for (i = 0; i < tc->msg_len; i++) {
+        tc->mac[i % tc->mac_len] += tc->msg[i];
+    }
+    return 0;
+}
+
+/*
+ * A stand-in CMAC: generation folds the keys and message into the MAC,
+ * verification passes odd tcIds.
+ */
+static int fake_cmac_handler(ACVP_TEST_CASE *test_case) {
+    ACVP_CMAC_TC *tc = test_case->tc.cmac;
+    unsigned int i = 0;
+
+    if (tc->verify) {
+        tc->ver_disposition = tc->tc_id % 2 ? ACVP_TEST_DISPOSITION_PASS : ACVP_TEST_DISPOSITION_FAIL;
+        return 0;
+    }
+    memzero_s(tc->mac, tc->mac_len);
+    for (i = 0; i < tc->key_len; i++) {
+        tc->mac[i % tc->mac_len] ^= tc->key[i];
+    }
+    for (i = 0; tc->key2 && i < 8; i++) {
+        tc->mac[i % tc->mac_len] ^= tc->key2[i] + tc->key3[i];
+    }
+    for (i = 0; i < tc->msg_len; i++) {
+        tc->mac[i % tc->mac_len] += tc->msg[i];
+    }
+    return 0;
+}
+
+/*
+ * A stand-in KMAC: AFT folds the key, message and customization into the
+ * MAC, MVT passes odd tcIds.
+ */
+static int fake_kmac_handler(ACVP_TEST_CASE *test_case) {
+    ACVP_KMAC_TC *tc = test_case->tc.kmac;
+    unsigned char *custom = tc->hex_customization ? tc->custom_hex : (unsigned char *)tc->custom;
+    int i = 0;
+
+    if (tc->test_type == ACVP_KMAC_TEST_TYPE_MVT) {
+        tc->disposition = tc->tc_id % 2 ? ACVP_TEST_DISPOSITION_PASS : ACVP_TEST_DISPOSITION_FAIL;
+        return 0;
+    }
+    memzero_s(tc->mac, tc->mac_len);
+    for (i = 0; i < tc->key_len; i++) {
+        tc->mac[i % tc->mac_len] ^= tc->key[i];
+    }
+    for (i = 0; i < tc->msg_len; i++) {
+        tc->mac[i % tc->mac_len] += tc->msg[i];
+    }
+    for (i = 0; i < tc->custom_len; i++) {
+        tc->mac[i % tc->mac_len] ^= custom[i] + tc->xof;
+    }
+    return 0;
+}
+
+/* Hex of len bytes from a simple running pattern */
+static char *pattern_hex(unsigned int len, unsigned int *seed) {
+    char *hex = calloc(len * 2 + 1, sizeof(char));
+    unsigned int i = 0;
+
+    cr_assert_not_null(hex);
+    for (i = 0; i < len; i++) {
+        *seed = *seed * 1103515245 + 12345;
+        snprintf(hex + i * 2, 3, "%02X", (*seed >> 16) & 0xff);
+    }
+    return hex;
+}
+
+/* An HMAC-SHA2-256 vector set with one AFT group of count test cases */
+static JSON_Value *hmac_vs(unsigned int count, unsigned int key_len, unsigned int msg_len) {
+    JSON_Value *vs = json_value_init_array(), *set = json_value_init_object();
+    JSON_Value *groups = json_value_init_array(), *group = json_value_init_object();
+    JSON_Value *tests = json_value_init_array(), *test = NULL;
+    unsigned int i = 0, seed = key_len ^ msg_len;
+    char *hex = NULL;
+
+    json_array_append_value(json_value_get_array(vs), json_parse_string("{\"acvVersion\": \"1.0\"}"));
+    json_object_set_number(json_value_get_object(set), "vsId", 1);
+    json_object_set_string(json_value_get_object(set), "algorithm", "HMAC-SHA2-256");
+    json_object_set_number(json_value_get_object(group), "tgId", 1);
+    json_object_set_string(json_value_get_object(group), "testType", "AFT");
+    json_object_set_number(json_value_get_object(group), "keyLen", key_len);
+    json_object_set_number(json_value_get_object(group), "msgLen", msg_len);
+    json_object_set_number(json_value_get_object(group), "macLen", 256);
+    for (i = 0; i < count; i++) {
+        test = json_value_init_object();
+        json_object_set_number(json_value_get_object(test), "tcId", i + 1);
+        hex = pattern_hex(key_len / 8, &seed);
+        json_object_set_string(json_value_get_object(test), "key", hex);
+        free(hex);
+        hex = pattern_hex(msg_len / 8, &seed);
+        json_object_set_string(json_value_get_object(test), "msg", hex);
+        free(hex);
+        json_array_append_value(json_value_get_array(tests), test);
+    }
+    json_object_set_value(json_value_get_object(group), "tests", tests);
+    json_array_append_value(json_value_get_array(groups), group);
+    json_object_set_value(json_value_get_object(set), "testGroups", groups);
+    json_array_append_value(json_value_get_array(vs), set);
+    return vs;
+}
+
+/* A request file, with the vector set's algorithm replaced when alg_str is given */
+static JSON_Value *file_vs(const char *file, const char *alg_str) {
+    JSON_Value *in = json_parse_file(file);
+
+    cr_assert_not_null(in);
+    if (alg_str) {
+        json_object_set_string(ut_get_obj_from_rsp(in), "algorithm", alg_str);
+    }
+    return in;
+}
+
+static JSON_Value *sha256_vs(void) { return file_vs("json/hash/hash.json", NULL); }
+static JSON_Value *sha3_256_vs(void) { return file_vs("json/hash/hash.json", "SHA3-256"); }
+static JSON_Value *aes_cbc_vs(void) { return file_vs("json/aes/aes.json", NULL); }
+static JSON_Value *hmac_two_batches_vs(void) { return hmac_vs(150, 256, 512); }
+/* Keys that fill a batch's buffers before the batch is full */
+static JSON_Value *hmac_long_keys_vs(void) { return hmac_vs(40, 65536, 512); }
+static JSON_Value *cmac_aes_vs(void) { return file_vs("json/cmac/cmac_aes.json", NULL); }
+static JSON_Value *cmac_tdes_vs(void) { return file_vs("json/cmac/cmac_tdes.json", NULL); }
+static JSON_Value *kmac_vs(void) { return file_vs("json/kmac/kmac.json", NULL); }
+
+/* A vector set with a batch path in the module, and how to run it */
+typedef struct batch_case_t {
+    ACVP_CIPHER cipher;
+    JSON_Value *(*load)(void);
+    UT_CAP_ENABLE enable;
+    int (*crypto_handler)(ACVP_TEST_CASE *test_case);
+    UT_SET_BATCH_HANDLER set_handler;
+    UT_KAT_HANDLER kat_handler;
+    unsigned int min_batches;
+} BATCH_CASE;
+
+static const BATCH_CASE batch_cases[] = {
+    { ACVP_HASH_SHA256, &sha256_vs, &acvp_cap_hash_enable, &ut_toy_hash_handler,
+      &acvp_cap_hash_set_batch_handler, &acvp_hash_kat_handler, 2 },
+    { ACVP_HASH_SHA3_256, &sha3_256_vs, &acvp_cap_hash_enable, &ut_toy_hash_handler,
+      &acvp_cap_hash_set_batch_handler, &acvp_hash_kat_handler, 2 },
+    { ACVP_AES_CBC, &aes_cbc_vs, &acvp_cap_sym_cipher_enable, &ut_xor_sym_handler,
+      &acvp_cap_sym_cipher_set_batch_handler, &acvp_aes_kat_handler, 1 },
+    { ACVP_HMAC_SHA2_256, &hmac_two_batches_vs, &acvp_cap_hmac_enable, &fake_hmac_handler,
+      &acvp_cap_mac_set_batch_handler, &acvp_hmac_kat_handler, 3 },
+    { ACVP_HMAC_SHA2_256, &hmac_long_keys_vs, &acvp_cap_hmac_enable, &fake_hmac_handler,
+      &acvp_cap_mac_set_batch_handler, &acvp_hmac_kat_handler, 2 },
+    { ACVP_CMAC_AES, &cmac_aes_vs, &acvp_cap_cmac_enable, &fake_cmac_handler,
+      &acvp_cap_mac_set_batch_handler, &acvp_cmac_kat_handler, 1 },
+    { ACVP_CMAC_TDES, &cmac_tdes_vs, &acvp_cap_cmac_enable, &fake_cmac_handler,
+      &acvp_cap_mac_set_batch_handler, &acvp_cmac_kat_handler, 1 },
+    { ACVP_KMAC_128, &kmac_vs, &acvp_cap_kmac_enable, &fake_kmac_handler,
+      &acvp_cap_mac_set_batch_handler, &acvp_kmac_kat_handler, 1 },
+};
+
+#define BATCH_CASE_CNT (sizeof(batch_cases) / sizeof(batch_cases[0]))
+
+static int (*batch_crypto_handler)(ACVP_TEST_CASE *test_case) = NULL;
+static unsigned int batch_calls = 0;
+
+/* Gives each test case of the batch to the vector set's crypto handler */
+static int loop_batch_handler(ACVP_TEST_CASE *test_cases, unsigned int count) {
+    unsigned int i = 0;
+
+    batch_calls++;
+    for (i = 0; i < count; i++) {
+        if (batch_crypto_handler(&test_cases[i])) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static char *run_batch(const BATCH_CASE *bc, int (*batch_handler)(ACVP_TEST_CASE *, unsigned int),
+                       ACVP_RESULT *result) {
+    JSON_Value *in = bc->load();
+    char *out = NULL;
+
+    batch_crypto_handler = bc->crypto_handler;
+    out = ut_run_kat_batch(ut_get_obj_from_rsp(in), bc->cipher, bc->enable, bc->crypto_handler,
+                           bc->set_handler, batch_handler, bc->kat_handler, result);
+    json_value_free(in);
+    return out;
+}
+
+/*
+ * Setting a batch handler checks the context, the algorithm and that the
+ * capability exists; NULL goes back to one call per test case.
+ */
+Test(BATCH, set_args) {
+    setup_empty_ctx(&ctx);
+
+    cr_assert(acvp_cap_hash_set_batch_handler(NULL, ACVP_HASH_SHA256, &loop_batch_handler) == ACVP_NO_CTX);
+    cr_assert(acvp_cap_hash_set_batch_handler(ctx, ACVP_HASH_SHA256, &loop_batch_handler) == ACVP_NO_CAP);
+    cr_assert(acvp_cap_hash_set_batch_handler(ctx, ACVP_AES_GCM, &loop_batch_handler) == ACVP_INVALID_ARG);
+    cr_assert(acvp_cap_hash_enable(ctx, ACVP_HASH_SHA256, &ut_toy_hash_handler) == ACVP_SUCCESS);
+    cr_assert(acvp_cap_hash_set_batch_handler(ctx, ACVP_HASH_SHA256, &loop_batch_handler) == ACVP_SUCCESS);
+    cr_assert(acvp_cap_hash_set_batch_handler(ctx, ACVP_HASH_SHA256, NULL) == ACVP_SUCCESS);
+
+    cr_assert(acvp_cap_sym_cipher_set_batch_handler(NULL, ACVP_AES_CBC, &loop_batch_handler) == ACVP_NO_CTX);
+    cr_assert(acvp_cap_sym_cipher_set_batch_handler(ctx, ACVP_AES_CBC, &loop_batch_handler) == ACVP_NO_CAP);
+    cr_assert(acvp_cap_sym_cipher_set_batch_handler(ctx, ACVP_TDES_CBC, &loop_batch_handler) == ACVP_INVALID_ARG);
+    cr_assert(acvp_cap_sym_cipher_enable(ctx, ACVP_AES_CBC, &ut_xor_sym_handler) == ACVP_SUCCESS);
+    cr_assert(acvp_cap_sym_cipher_set_batch_handler(ctx, ACVP_AES_CBC, &loop_batch_handler) == ACVP_SUCCESS);
+    cr_assert(acvp_cap_sym_cipher_set_batch_handler(ctx, ACVP_AES_CBC, NULL) == ACVP_SUCCESS);
+
+    cr_assert(acvp_cap_mac_set_batch_handler(NULL, ACVP_HMAC_SHA1, &loop_batch_handler) == ACVP_NO_CTX);
+    cr_assert(acvp_cap_mac_set_batch_handler(ctx, ACVP_HMAC_SHA1, &loop_batch_handler) == ACVP_NO_CAP);
+    cr_assert(acvp_cap_mac_set_batch_handler(ctx, ACVP_HASH_SHA256, &loop_batch_handler) == ACVP_INVALID_ARG);
+    cr_assert(acvp_cap_hmac_enable(ctx, ACVP_HMAC_SHA1, &fake_hmac_handler) == ACVP_SUCCESS);
+    cr_assert(acvp_cap_mac_set_batch_handler(ctx, ACVP_HMAC_SHA1, &loop_batch_handler) == ACVP_SUCCESS);
+    cr_assert(acvp_cap_mac_set_batch_handler(ctx, ACVP_HMAC_SHA1, NULL) == ACVP_SUCCESS);
+
+    teardown_ctx(&ctx);
+}
+
+/*
+ * Batches, including groups larger than one batch, give the same response
+ * as one crypto handler call per test case.
+ */
+Test(BATCH, same_results) {
+    char *single = NULL, *batched = NULL;
+    ACVP_RESULT single_rv = ACVP_SUCCESS, batched_rv = ACVP_SUCCESS;
+    unsigned int i = 0;
+
+    for (i = 0; i < BATCH_CASE_CNT; i++) {
+        single = run_batch(&batch_cases[i], NULL, &single_rv);
+        batch_calls = 0;
+        batched = run_batch(&batch_cases[i], &loop_batch_handler, &batched_rv);
+        cr_assert(single_rv == ACVP_SUCCESS);
+        cr_assert(batched_rv == ACVP_SUCCESS);
+        cr_assert(batch_calls >= batch_cases[i].min_batches);
+        cr_assert_str_eq(batched, single);
+        json_free_serialized_string(single);
+        json_free_serialized_string(batched);
+    }
+}
+
+/*
+ * A failed batch fails the vector set.
+ */
+Test(BATCH, fails) {
+    ACVP_RESULT result = ACVP_SUCCESS;
+    unsigned int i = 0;
+
+    for (i = 0; i < BATCH_CASE_CNT; i++) {
+        cr_assert_null(run_batch(&batch_cases[i], &ut_fail_batch_handler, &result));
+        cr_assert(result == ACVP_CRYPTO_MODULE_FAIL);
+    }
+}
+
+/*
+ * With memory accounting on, everything built for the test cases of a
+ * failed batch, including those still waiting for the next batch, is given
+ * back.
+ */
+Test(BATCH, fails_releases) {
+    const BATCH_CASE *bc = NULL;
+    ACVP_CTX *batch_ctx = NULL;
+    JSON_Value *in = NULL;
+    size_t before = 0, after = 0;
+    unsigned int i = 0;
+
+    for (i = 0; i < BATCH_CASE_CNT; i++) {
+        bc = &batch_cases[i];
+        batch_ctx = NULL;
+        setup_empty_ctx(&batch_ctx);
+        cr_assert(bc->enable(batch_ctx, bc->cipher, bc->crypto_handler) == ACVP_SUCCESS);
+        cr_assert(bc->set_handler(batch_ctx, bc->cipher, &ut_fail_batch_handler) == ACVP_SUCCESS);
+        cr_assert(acvp_enable_mem_accounting(batch_ctx, 1) == ACVP_SUCCESS);
+        in = bc->load();
+        cr_assert(acvp_get_mem_usage(batch_ctx, &before, NULL) == ACVP_SUCCESS);
+
+        cr_assert(bc->kat_handler(batch_ctx, ut_get_obj_from_rsp(in)) == ACVP_CRYPTO_MODULE_FAIL);
+        json_value_free(batch_ctx->kat_resp);
+        batch_ctx->kat_resp = NULL;
+        cr_assert(acvp_get_mem_usage(batch_ctx, &after, NULL) == ACVP_SUCCESS);
+        cr_assert(after == before);
+
+        json_value_free(in);
+        teardown_ctx(&batch_ctx);
+    }
+}
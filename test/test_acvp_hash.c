@@ -353,3 +353,259 @@ Test(HASH_HANDLER, cryptoFail4, .init = fail_setup, .fini = teardown) {
 }
 
 
+
+static const char *hash_ldt_json =
+    "{\"vsId\": 1, \"algorithm\": \"SHA2-256\", \"testGroups\": [{\"tgId\": 1, \"testType\": \"LDT\","
+    " \"tests\": [{\"tcId\": 1, \"largeMsg\": {\"content\": \"0102030405\", \"contentLength\": 40,"
+    " \"fullLength\": 8000, \"expansionTechnique\": \"repeating\"}}]}]}";
+
+typedef struct ldt_record_t {
+    unsigned int h;
+    int inits, updates, finals, fail_at;
+    unsigned int max_chunk;
+    int bad_chunk;
+} LDT_RECORD;
+
+static LDT_RECORD ldt_rec;
+
+/* Digests streamed LDTs with the stand-in digest, noting each stage */
+static int toy_ldt_handler(ACVP_TEST_CASE *test_case) {
+    ACVP_HASH_TC *tc = test_case->tc.hash;
+    LDT_RECORD *rec = tc->ldt_state;
+
+    switch (tc->ldt_stage) {
+    case ACVP_HASH_LDT_INIT:
+        tc->ldt_state = &ldt_rec;
+        ldt_rec.h = 1;
+        ldt_rec.inits++;
+        return 0;
+    case ACVP_HASH_LDT_UPDATE:
+        if (!rec || rec->updates == rec->fail_at) return 1;
+        rec->updates++;
+        if (tc->ldt_chunk_len > rec->max_chunk) rec->max_chunk = tc->ldt_chunk_len;
+        if (memcmp(tc->ldt_chunk, tc->msg, tc->msg_len)) rec->bad_chunk = 1;
+        ut_toy_hash_update(&rec->h, tc->ldt_chunk, tc->ldt_chunk_len);
+        return 0;
+    case ACVP_HASH_LDT_FINAL:
+        if (!rec) return 1;
+        rec->finals++;
+        tc->md_len = 32;
+        ut_toy_hash_final(rec->h, tc->md, tc->md_len);
+        tc->ldt_state = NULL;
+        return 0;
+    case ACVP_HASH_LDT_NONE:
+    default:
+        return 1;
+    }
+}
+
+static unsigned int ldt_chunk_len = 0;
+
+/* Turns on streaming in ldt_chunk_len pieces; LDTs have no handler of their own to set */
+static ACVP_RESULT set_ldt_streaming(ACVP_CTX *ctx, ACVP_CIPHER cipher, int (*handler)(ACVP_TEST_CASE *)) {
+    (void)handler;
+    return acvp_cap_hash_set_ldt_streaming(ctx, cipher, ldt_chunk_len);
+}
+
+static ACVP_RESULT run_hash_ldt(unsigned int chunk_len) {
+    JSON_Value *in = NULL;
+    ACVP_RESULT result = ACVP_SUCCESS;
+    char *out = NULL;
+
+    ldt_chunk_len = chunk_len;
+    in = json_parse_string(hash_ldt_json);
+    cr_assert_not_null(in);
+    out = ut_run_kat(json_value_get_object(in), ACVP_HASH_SHA256, 0,
+                     &acvp_cap_hash_enable, &toy_ldt_handler,
+                     &set_ldt_streaming, NULL,
+                     &acvp_hash_kat_handler, &result);
+    json_free_serialized_string(out);
+    json_value_free(in);
+    return result;
+}
+
+/*
+ * Turning on LDT streaming checks the context, the algorithm, the chunk
+ * length and that the capability exists.
+ */
+Test(HASH_LDT_STREAM, set_args) {
+    setup_empty_ctx(&ctx);
+
+    rv = acvp_cap_hash_set_ldt_streaming(NULL, ACVP_HASH_SHA256, 4096);
+    cr_assert(rv == ACVP_NO_CTX);
+    rv = acvp_cap_hash_set_ldt_streaming(ctx, ACVP_HASH_SHA256, 4096);
+    cr_assert(rv == ACVP_NO_CAP);
+    rv = acvp_cap_hash_set_ldt_streaming(ctx, ACVP_HASH_SHAKE_128, 4096);
+    cr_assert(rv == ACVP_INVALID_ARG);
+    rv = acvp_cap_hash_enable(ctx, ACVP_HASH_SHA256, &ut_toy_hash_handler);
+    cr_assert(rv == ACVP_SUCCESS);
+    rv = acvp_cap_hash_set_ldt_streaming(ctx, ACVP_HASH_SHA256, ACVP_HASH_LDT_CHUNK_MAX + 1);
+    cr_assert(rv == ACVP_INVALID_ARG);
+    rv = acvp_cap_hash_set_ldt_streaming(ctx, ACVP_HASH_SHA256, 4096);
+    cr_assert(rv == ACVP_SUCCESS);
+
+    teardown_ctx(&ctx);
+}
+
+/*
+ * The pieces cover the expanded content exactly, each starting on a copy of
+ * the content and none longer than asked for.
+ */
+Test(HASH_LDT_STREAM, whole_message) {
+    unsigned char content[5] = { 1, 2, 3, 4, 5 };
+    unsigned int h = 1, i = 0;
+
+    for (i = 0; i < 1000 / 5; i++) {
+        ut_toy_hash_update(&h, content, 5);
+    }
+
+    memset(&ldt_rec, 0, sizeof(ldt_rec));
+    ldt_rec.fail_at = -1;
+    cr_assert(run_hash_ldt(64) == ACVP_SUCCESS);
+    cr_assert(ldt_rec.inits == 1 && ldt_rec.finals == 1);
+    cr_assert(ldt_rec.updates == 17); /* 16 of 60 bytes and one of 40 */
+    cr_assert(ldt_rec.max_chunk == 60);
+    cr_assert(!ldt_rec.bad_chunk);
+    cr_assert(ldt_rec.h == h);
+
+    /* A chunk shorter than the content still passes one whole copy */
+    memset(&ldt_rec, 0, sizeof(ldt_rec));
+    ldt_rec.fail_at = -1;
+    cr_assert(run_hash_ldt(3) == ACVP_SUCCESS);
+    cr_assert(ldt_rec.updates == 200);
+    cr_assert(ldt_rec.max_chunk == 5);
+    cr_assert(ldt_rec.h == h);
+}
+
+/*
+ * A failed update fails the test case, but the module still gets its final
+ * call to clean up.
+ */
+Test(HASH_LDT_STREAM, update_fails) {
+    memset(&ldt_rec, 0, sizeof(ldt_rec));
+    ldt_rec.fail_at = 3;
+    cr_assert(run_hash_ldt(64) == ACVP_CRYPTO_MODULE_FAIL);
+    cr_assert(ldt_rec.updates == 3);
+    cr_assert(ldt_rec.finals == 1);
+}
+
+/*
+ * A mapped LDT view reads as the content repeated to the full length,
+ * across the joins between mappings and up to a cut-short last copy.
+ */
+Test(HASH_LDT_VIEW, content) {
+    unsigned char content[5] = { 1, 2, 3, 4, 5 };
+    ACVP_HASH_TC tc;
+    const unsigned char *data = NULL;
+    unsigned long long int i = 0;
+    ACVP_RESULT result = ACVP_SUCCESS;
+
+    memset(&tc, 0, sizeof(tc));
+    tc.test_type = ACVP_HASH_TEST_TYPE_LDT;
+    tc.msg = content;
+    tc.msg_len = sizeof(content);
+    tc.exp_len = 64 * 1024 * 1024 + 3;
+
+    result = acvp_hash_ldt_map(&tc, &data);
+    if (result == ACVP_UNSUPPORTED_OP) {
+        return;
+    }
+    cr_assert(result == ACVP_SUCCESS);
+    cr_assert_not_null(data);
+    for (i = 0; i < tc.exp_len; i++) {
+        if (data[i] != content[i % sizeof(content)]) {
+            cr_assert_fail("Byte %llu of the view is wrong", i);
+        }
+    }
+
+    /* One view per test case */
+    cr_assert(acvp_hash_ldt_map(&tc, &data) == ACVP_INVALID_ARG);
+    acvp_hash_ldt_unmap(&tc);
+    cr_assert_null(tc.ldt_view);
+    acvp_hash_ldt_unmap(&tc);
+}
+
+/*
+ * Only LDT test cases with content can be mapped.
+ */
+Test(HASH_LDT_VIEW, bad_args) {
+    unsigned char content[5] = { 1, 2, 3, 4, 5 };
+    ACVP_HASH_TC tc;
+    const unsigned char *data = NULL;
+
+    memset(&tc, 0, sizeof(tc));
+    tc.test_type = ACVP_HASH_TEST_TYPE_AFT;
+    tc.msg = content;
+    tc.msg_len = sizeof(content);
+    tc.exp_len = 1024;
+
+    if (acvp_hash_ldt_map(&tc, &data) == ACVP_UNSUPPORTED_OP) {
+        return;
+    }
+    cr_assert(acvp_hash_ldt_map(NULL, &data) == ACVP_INVALID_ARG);
+    cr_assert(acvp_hash_ldt_map(&tc, &data) == ACVP_INVALID_ARG);
+    tc.test_type = ACVP_HASH_TEST_TYPE_LDT;
+    cr_assert(acvp_hash_ldt_map(&tc, NULL) == ACVP_INVALID_ARG);
+    tc.msg_len = 0;
+    cr_assert(acvp_hash_ldt_map(&tc, &data) == ACVP_INVALID_ARG);
+}
+
+static unsigned int batch_calls = 0;
+static unsigned int batch_tcs = 0;
+static int batch_mixed = 0;
+
+/* Digests each test case with the stand-in digest, noting calls that mix length classes */
+static int toy_batch_handler(ACVP_TEST_CASE *test_cases, unsigned int count) {
+    unsigned int i = 0, blocks = 0, first = 0;
+
+    batch_calls++;
+    batch_tcs += count;
+    for (i = 0; i < count; i++) {
+        /* SHA2-256 pads with at least 9 bytes into 64 byte blocks, SHA3-256 absorbs 136 at a time */
+        if (test_cases[i].tc.hash->cipher == ACVP_HASH_SHA256) {
+            blocks = (test_cases[i].tc.hash->msg_len + 9 + 63) / 64;
+        } else {
+            blocks = test_cases[i].tc.hash->msg_len / 136 + 1;
+        }
+        if (!i) {
+            first = blocks;
+        } else if (blocks != first) {
+            batch_mixed = 1;
+        }
+        if (ut_toy_hash_handler(&test_cases[i])) {
+            return 1;
+        }
+    }
+    return count > ACVP_HASH_BATCH_MAX;
+}
+
+/*
+ * Each batch of an AFT group holds test cases of one length class, no more
+ * than ACVP_HASH_BATCH_MAX of them, and every AFT test case goes through a
+ * batch.
+ */
+Test(HASH_BATCH, length_classes) {
+    static const char *algs[] = { "SHA2-256", "SHA3-256" };
+    JSON_Value *in = NULL;
+    JSON_Object *vs = NULL;
+    ACVP_RESULT result = ACVP_SUCCESS;
+    int i = 0;
+
+    for (i = 0; i < 2; i++) {
+        batch_calls = batch_tcs = 0;
+        batch_mixed = 0;
+        in = json_parse_file("json/hash/hash.json");
+        cr_assert_not_null(in);
+        vs = ut_get_obj_from_rsp(in);
+        json_object_set_string(vs, "algorithm", algs[i]);
+        json_free_serialized_string(ut_run_kat_batch(vs, acvp_lookup_cipher_index(algs[i]),
+                                                     &acvp_cap_hash_enable, &ut_toy_hash_handler,
+                                                     &acvp_cap_hash_set_batch_handler, &toy_batch_handler,
+                                                     &acvp_hash_kat_handler, &result));
+        cr_assert(result == ACVP_SUCCESS);
+        cr_assert(batch_tcs == 129);
+        cr_assert(batch_calls < batch_tcs);
+        cr_assert(!batch_mixed);
+        json_value_free(in);
+    }
+}
@@ -0,0 +1,195 @@
+/** @file */
+/*
+ * Copyright (c) 2024, Cisco Systems, Inc.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://github.com/cisco/libacvp/LICENSE
+ */
+
+
+#include "ut_common.h"
+#include "acvp/acvp_lcl.h"
+
+static ACVP_CTX *ctx = NULL;
+
+Test(MemAccounting, args) {
+    size_t cur = 0, peak = 0;
+
+    cr_assert(acvp_enable_mem_accounting(NULL, 1) == ACVP_NO_CTX);
+    cr_assert(acvp_set_mem_budget(NULL, 1) == ACVP_NO_CTX);
+    cr_assert(acvp_get_mem_usage(NULL, &cur, &peak) == ACVP_NO_CTX);
+    cr_assert(acvp_get_vs_mem_peak(NULL, 1, &peak) == ACVP_NO_CTX);
+
+    setup_empty_ctx(&ctx);
+    cr_assert(acvp_get_mem_usage(ctx, NULL, NULL) == ACVP_INVALID_ARG);
+    cr_assert(acvp_get_vs_mem_peak(ctx, 1, NULL) == ACVP_INVALID_ARG);
+
+    /* Nothing to report until accounting is switched on */
+    cr_assert(acvp_get_mem_usage(ctx, &cur, &peak) == ACVP_UNSUPPORTED_OP);
+    cr_assert(acvp_get_vs_mem_peak(ctx, 1, &peak) == ACVP_NO_DATA);
+    cr_assert(!strcmp(acvp_lookup_error_string(ACVP_MEM_BUDGET_EXCEEDED), "Memory budget exceeded"));
+    acvp_free_test_session(ctx);
+}
+
+/*
+ * Parsed JSON is counted while it is held and the high-water mark stays put
+ * once it is released
+ */
+Test(MemAccounting, json_tree) {
+    JSON_Value *val = NULL;
+    size_t before = 0, held = 0, after = 0, peak = 0;
+
+    setup_empty_ctx(&ctx);
+    cr_assert(acvp_enable_mem_accounting(ctx, 1) == ACVP_SUCCESS);
+    cr_assert(acvp_get_mem_usage(ctx, &before, NULL) == ACVP_SUCCESS);
+
+    acvp_mem_begin_vs(ctx);
+    val = json_parse_string("{\"vsId\": 5, \"testGroups\": [{\"tests\": [{\"tcId\": 1, \"msg\": \"00112233\"}]}]}");
+    cr_assert(val != NULL);
+    cr_assert(acvp_get_mem_usage(ctx, &held, NULL) == ACVP_SUCCESS);
+    cr_assert(held > before);
+
+    json_value_free(val);
+    acvp_mem_end_vs(ctx, 5);
+    cr_assert(acvp_get_mem_usage(ctx, &after, &peak) == ACVP_SUCCESS);
+    cr_assert(after == before);
+    cr_assert(peak >= held);
+
+    cr_assert(acvp_get_vs_mem_peak(ctx, 5, &peak) == ACVP_SUCCESS);
+    cr_assert(peak >= held);
+    cr_assert(acvp_get_vs_mem_peak(ctx, 6, &peak) == ACVP_NO_DATA);
+
+    cr_assert(acvp_enable_mem_accounting(ctx, 0) == ACVP_SUCCESS);
+    cr_assert(acvp_get_mem_usage(ctx, &after, NULL) == ACVP_UNSUPPORTED_OP);
+    acvp_free_test_session(ctx);
+}
+
+/*
+ * Setting a budget turns accounting on; large data tests count at their
+ * full length when deciding whether a vector set fits
+ */
+Test(MemAccounting, budget) {
+    JSON_Value *val = NULL;
+    size_t need = 0, cur = 0;
+
+    setup_empty_ctx(&ctx);
+    cr_assert(acvp_set_mem_budget(ctx, 1024 * 1024) == ACVP_SUCCESS);
+    cr_assert(acvp_get_mem_usage(ctx, &cur, NULL) == ACVP_SUCCESS);
+
+    val = json_parse_string("{\"testGroups\": [{\"tests\": [{\"largeMsg\": {\"fullLength\": 8388608}}]}]}");
+    need = acvp_mem_estimate_vs(ctx, json_value_get_object(val), 100, 200);
+    cr_assert(need == 300 + 1024 * 1024);
+    cr_assert(acvp_mem_over_budget(ctx, need));
+    cr_assert(!acvp_mem_over_budget(ctx, 300));
+
+    /* A zero budget means no limit */
+    cr_assert(acvp_set_mem_budget(ctx, 0) == ACVP_SUCCESS);
+    cr_assert(!acvp_mem_over_budget(ctx, need));
+
+    json_value_free(val);
+    acvp_free_test_session(ctx);
+}
+
+/*
+ * An offline vector set that fails to dispatch still has its peak recorded
+ */
+Test(MemAccounting, offline_failure) {
+    FILE *fp = NULL;
+    size_t peak = 0;
+
+    fp = fopen("mem_req_test.json", "w");
+    cr_assert_not_null(fp);
+    fputs("[{\"url\": \"/acvp/v1/testSessions/1\", \"jwt\": \"abc\", \"isSample\": true,"
+          " \"vectorSetUrls\": [\"/acvp/v1/testSessions/1/vectorSets/7\"]},"
+          " {\"vsId\": 7, \"algorithm\": \"SHA2-256\", \"testGroups\": []}]", fp);
+    fclose(fp);
+
+    setup_empty_ctx(&ctx);
+    cr_assert(acvp_enable_mem_accounting(ctx, 1) == ACVP_SUCCESS);
+    cr_assert(acvp_run_vectors_from_file(ctx, "mem_req_test.json", "mem_rsp_test.json") != ACVP_SUCCESS);
+    cr_assert(acvp_get_vs_mem_peak(ctx, 7, &peak) == ACVP_SUCCESS);
+
+    remove("mem_req_test.json");
+    remove("mem_rsp_test.json");
+    acvp_free_test_session(ctx);
+}
+
+static int mem_skipped_logged = 0;
+
+static ACVP_RESULT mem_log_cb(char *msg, ACVP_LOG_LVL level) {
+    (void)level;
+    if (strstr(msg, "vsId 2: skipped")) {
+        mem_skipped_logged = 1;
+    }
+    return ACVP_SUCCESS;
+}
+
+/*
+ * A vector set over the budget is deferred, then skipped, while the others
+ * are still processed; the skipped set is reported and fails the session
+ */
+Test(MemAccounting, offline_budget) {
+    JSON_Value *rsp = NULL;
+    JSON_Array *sets = NULL;
+    FILE *fp = NULL;
+
+    fp = fopen("mem_req_test.json", "w");
+    cr_assert_not_null(fp);
+    fputs("[{\"url\": \"/acvp/v1/testSessions/1\", \"jwt\": \"abc\", \"isSample\": true,"
+          " \"vectorSetUrls\": [\"/acvp/v1/testSessions/1/vectorSets/1\","
+          " \"/acvp/v1/testSessions/1/vectorSets/2\", \"/acvp/v1/testSessions/1/vectorSets/3\"]},"
+          " {\"vsId\": 1, \"algorithm\": \"SHA2-256\", \"testGroups\": [{\"tgId\": 1, \"testType\": \"AFT\","
+          " \"tests\": [{\"tcId\": 1, \"msg\": \"EC\", \"len\": 8}]}]},"
+          " {\"vsId\": 2, \"algorithm\": \"SHA2-256\", \"testGroups\": [{\"tgId\": 1, \"testType\": \"LDT\","
+          " \"tests\": [{\"tcId\": 2, \"largeMsg\": {\"content\": \"01\", \"contentLength\": 8,"
+          " \"fullLength\": 8589934592, \"expansionTechnique\": \"repeating\"}}]}]},"
+          " {\"vsId\": 3, \"algorithm\": \"SHA2-256\", \"testGroups\": [{\"tgId\": 1, \"testType\": \"AFT\","
+          " \"tests\": [{\"tcId\": 3, \"msg\": \"2C2C\", \"len\": 16}]}]}]", fp);
+    fclose(fp);
+
+    mem_skipped_logged = 0;
+    cr_assert(acvp_create_test_session(&ctx, &mem_log_cb, ACVP_LOG_LVL_STATUS) == ACVP_SUCCESS);
+    cr_assert(acvp_cap_hash_enable(ctx, ACVP_HASH_SHA256, &dummy_handler_success) == ACVP_SUCCESS);
+    cr_assert(acvp_set_mem_budget(ctx, 16 * 1024 * 1024) == ACVP_SUCCESS);
+    cr_assert(acvp_run_vectors_from_file(ctx, "mem_req_test.json", "mem_rsp_test.json") ==
+              ACVP_MEM_BUDGET_EXCEEDED);
+    cr_assert(mem_skipped_logged);
+
+    /* The sets around the skipped one were written */
+    rsp = json_parse_file("mem_rsp_test.json");
+    cr_assert_not_null(rsp);
+    sets = json_value_get_array(rsp);
+    cr_assert(json_array_get_count(sets) == 3);
+    cr_assert(json_object_get_number(json_array_get_object(sets, 1), "vsId") == 1);
+    cr_assert(json_object_get_number(json_array_get_object(sets, 2), "vsId") == 3);
+
+    json_value_free(rsp);
+    remove("mem_req_test.json");
+    remove("mem_rsp_test.json");
+    acvp_free_test_session(ctx);
+}
+
+/*
+ * Large data tests streamed to the module only count one chunk
+ */
+Test(MemAccounting, streamed_ldt) {
+    JSON_Value *val = NULL;
+    size_t need = 0;
+
+    setup_empty_ctx(&ctx);
+    cr_assert(acvp_cap_hash_enable(ctx, ACVP_HASH_SHA256, &dummy_handler_success) == ACVP_SUCCESS);
+
+    val = json_parse_string("{\"algorithm\": \"SHA2-256\", \"testGroups\": [{\"tests\": ["
+                            "{\"largeMsg\": {\"fullLength\": 8388608}}]}]}");
+    need = acvp_mem_estimate_vs(ctx, json_value_get_object(val), 100, 200);
+    cr_assert(need == 300 + 1024 * 1024);
+
+    cr_assert(acvp_cap_hash_set_ldt_streaming(ctx, ACVP_HASH_SHA256, 4096) == ACVP_SUCCESS);
+    need = acvp_mem_estimate_vs(ctx, json_value_get_object(val), 100, 200);
+    cr_assert(need == 300 + 4096);
+
+    json_value_free(val);
+    acvp_free_test_session(ctx);
+}
@@ -0,0 +1,108 @@
+/** @file */
+/*
+ * Copyright (c) 2024, Cisco Systems, Inc.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://github.com/cisco/libacvp/LICENSE
+ */
+
+
+#include "ut_common.h"
+#include "acvp/acvp_lcl.h"
+
+static ACVP_CTX *ctx = NULL;
+static int reports = 0;
+static ACVP_PROGRESS last;
+
+static void record_progress(const ACVP_PROGRESS *progress, void *arg) {
+    reports++;
+    last = *progress;
+    *(int *)arg = 1;
+}
+
+/*
+ * Counts are tracked without a callback; nothing is reported
+ */
+Test(Progress, no_callback) {
+    ACVP_PROGRESS p;
+    JSON_Value *val = NULL;
+
+    cr_assert(acvp_get_progress(NULL, &p) == ACVP_NO_CTX);
+    cr_assert(acvp_set_progress_callback(NULL, NULL, NULL, 0) == ACVP_NO_CTX);
+
+    setup_empty_ctx(&ctx);
+    cr_assert(acvp_get_progress(ctx, NULL) == ACVP_INVALID_ARG);
+
+    val = json_parse_string("{\"vsId\": 1, \"testGroups\": [{\"tests\": [{}, {}]}, {\"tests\": [{}]}]}");
+    acvp_progress_begin_session(ctx, 3);
+    acvp_progress_begin_vs(ctx, ACVP_AES_ECB, 1, "ACVP-AES-ECB", NULL, json_value_get_object(val));
+    acvp_progress_tc_done(ctx);
+
+    cr_assert(acvp_get_progress(ctx, &p) == ACVP_SUCCESS);
+    cr_assert(p.vs_total == 3);
+    cr_assert(p.vs_id == 1);
+    cr_assert(p.tc_total == 3);
+    cr_assert(p.tc_done == 1);
+    cr_assert(p.eta_seconds < 0);
+
+    acvp_progress_end_vs(ctx);
+    cr_assert(acvp_get_progress(ctx, &p) == ACVP_SUCCESS);
+    cr_assert(p.vs_done == 1);
+    cr_assert(p.vs_id == 0);
+    cr_assert(p.tc_done_session == 1);
+    cr_assert(reports == 0);
+
+    json_value_free(val);
+    acvp_free_test_session(ctx);
+}
+
+/*
+ * The callback sees each vector set start and finish, and test cases as they
+ * complete; the estimate becomes known once there is something to go on
+ */
+Test(Progress, callback) {
+    JSON_Value *val = NULL;
+    int called = 0, i = 0;
+
+    setup_empty_ctx(&ctx);
+    cr_assert(acvp_cap_sym_cipher_enable(ctx, ACVP_AES_ECB, &dummy_handler_success) == ACVP_SUCCESS);
+    cr_assert(acvp_set_progress_callback(ctx, &record_progress, &called, 0) == ACVP_SUCCESS);
+
+    val = json_parse_string("{\"vsId\": 7, \"testGroups\": [{\"tests\": [{}, {}, {}, {}]}]}");
+    acvp_progress_begin_session(ctx, 2);
+
+    reports = 0;
+    acvp_progress_begin_vs(ctx, ACVP_AES_ECB, 7, "ACVP-AES-ECB", NULL, json_value_get_object(val));
+    cr_assert(called);
+    cr_assert(reports == 1);
+    cr_assert(last.vs_id == 7);
+    cr_assert(last.tc_total == 4);
+    cr_assert(last.eta_seconds < 0);
+
+    for (i = 0; i < 4; i++) {
+        acvp_progress_tc_done(ctx);
+    }
+    cr_assert(reports == 5);
+    cr_assert(last.tc_done == 4);
+    /* Rate for this algorithm is known, but not yet how long a whole vector set takes */
+    cr_assert(last.eta_seconds < 0);
+
+    acvp_progress_end_vs(ctx);
+    cr_assert(reports == 6);
+    cr_assert(last.vs_done == 1);
+    cr_assert(last.vs_id == 0);
+    cr_assert(last.eta_seconds >= 0);
+
+    acvp_progress_begin_vs(ctx, ACVP_AES_ECB, 8, "ACVP-AES-ECB", NULL, json_value_get_object(val));
+    acvp_progress_tc_done(ctx);
+    cr_assert(last.eta_seconds >= 0);
+    acvp_progress_end_vs(ctx);
+    cr_assert(last.vs_done == 2);
+    cr_assert(last.tc_done_session == 5);
+    cr_assert(last.eta_seconds == 0);
+
+    json_value_free(val);
+    acvp_free_test_session(ctx);
+}
@@ -0,0 +1,129 @@
+/** @file */
+/*
+ * Copyright (c) 2024, Cisco Systems, Inc.
+ *
+ * Licensed under the Apache License 2.0 (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://github.com/cisco/libacvp/LICENSE
+ */
+
+
+#include "ut_common.h"
+#include "acvp/acvp_lcl.h"
+
+static ACVP_CTX *ctx = NULL;
+
+/*
+ * Nothing is recorded unless timing was enabled
+ */
+Test(PhaseTiming, disabled) {
+    double seconds = 0.0;
+
+    cr_assert(acvp_enable_phase_timing(NULL, 1) == ACVP_NO_CTX);
+
+    setup_empty_ctx(&ctx);
+    cr_assert(acvp_timing_begin_vs(ctx) == ACVP_SUCCESS);
+    cr_assert_null(ctx->timing_cur);
+    cr_assert(acvp_timing_now(ctx) == 0);
+    acvp_timing_end_vs(ctx, 1);
+
+    cr_assert(acvp_get_phase_timing(ctx, 0, ACVP_PHASE_PARSE, &seconds, NULL) == ACVP_NO_DATA);
+    cr_assert(acvp_export_phase_timing(ctx, "timing.json", 0) == ACVP_NO_DATA);
+    acvp_free_test_session(ctx);
+}
+
+/*
+ * Phases are charged to the vector set that was open and summed for vs_id 0
+ */
+Test(PhaseTiming, record_and_query) {
+    unsigned long long int start = 0;
+    double seconds = 0.0;
+    unsigned int count = 0;
+
+    setup_empty_ctx(&ctx);
+    cr_assert(acvp_enable_phase_timing(ctx, 1) == ACVP_SUCCESS);
+
+    cr_assert(acvp_timing_begin_vs(ctx) == ACVP_SUCCESS);
+    start = acvp_timing_now(ctx);
+    cr_assert(start != 0);
+    acvp_timing_record(ctx, ACVP_PHASE_CRYPTO, acvp_timing_now(ctx));
+    acvp_timing_record(ctx, ACVP_PHASE_CRYPTO, acvp_timing_now(ctx));
+    acvp_timing_record(ctx, ACVP_PHASE_DISPATCH, start);
+    acvp_timing_end_vs(ctx, 1234);
+
+    cr_assert(acvp_timing_begin_vs(ctx) == ACVP_SUCCESS);
+    acvp_timing_record(ctx, ACVP_PHASE_PARSE, acvp_timing_now(ctx));
+    acvp_timing_end_vs(ctx, 5678);
+
+    cr_assert(acvp_get_phase_timing(ctx, 1234, ACVP_PHASE_CRYPTO, &seconds, &count) == ACVP_SUCCESS);
+    cr_assert(count == 2);
+    cr_assert(acvp_get_phase_timing(ctx, 1234, ACVP_PHASE_RESPONSE_BUILD, &seconds, &count) == ACVP_SUCCESS);
+    cr_assert(count == 1);
+    cr_assert(acvp_get_phase_timing(ctx, 5678, ACVP_PHASE_CRYPTO, &seconds, &count) == ACVP_SUCCESS);
+    cr_assert(count == 0);
+    cr_assert(acvp_get_phase_timing(ctx, 0, ACVP_PHASE_PARSE, &seconds, &count) == ACVP_SUCCESS);
+    cr_assert(count == 1);
+    cr_assert(acvp_get_phase_timing(ctx, 99, ACVP_PHASE_PARSE, &seconds, &count) == ACVP_NO_DATA);
+    cr_assert(acvp_get_phase_timing(ctx, 0, ACVP_PHASE_MAX, &seconds, &count) == ACVP_INVALID_ARG);
+    cr_assert(acvp_get_phase_timing(ctx, 0, ACVP_PHASE_PARSE, NULL, &count) == ACVP_INVALID_ARG);
+
+    cr_assert(acvp_export_phase_timing(ctx, NULL, 0) == ACVP_MISSING_ARG);
+    cr_assert(acvp_export_phase_timing(ctx, "timing.json", 0) == ACVP_SUCCESS);
+    cr_assert(acvp_export_phase_timing(ctx, "timing_trace.json", 1) == ACVP_SUCCESS);
+    remove("timing.json");
+    remove("timing_trace.json");
+
+    acvp_free_test_session(ctx);
+}
+
+/*
+ * Handler calls are counted per capability and test type only when enabled
+ */
+Test(HandlerStats, record_and_query) {
+    ACVP_CAPS_LIST *cap = NULL;
+    ACVP_TEST_CASE test_case;
+    ACVP_SYM_CIPHER_TC stc;
+    ACVP_HANDLER_STATS stats;
+    int i = 0;
+
+    setup_empty_ctx(&ctx);
+    cr_assert(acvp_cap_sym_cipher_enable(ctx, ACVP_AES_ECB, &dummy_handler_success) == ACVP_SUCCESS);
+    cap = acvp_locate_cap_entry(ctx, ACVP_AES_ECB);
+    cr_assert_not_null(cap);
+
+    memset(&stc, 0x0, sizeof(stc));
+    test_case.tc.symmetric = &stc;
+
+    stc.test_type = ACVP_SYM_TEST_TYPE_AFT;
+    cr_assert(acvp_invoke_crypto_handler(ctx, cap, &test_case) == 0);
+    cr_assert_null(cap->stats);
+    cr_assert(acvp_get_handler_stats(ctx, ACVP_AES_ECB, 0, &stats) == ACVP_NO_DATA);
+
+    cr_assert(acvp_enable_handler_stats(NULL, 1) == ACVP_NO_CTX);
+    cr_assert(acvp_enable_handler_stats(ctx, 1) == ACVP_SUCCESS);
+    for (i = 0; i < 10; i++) {
+        acvp_invoke_crypto_handler(ctx, cap, &test_case);
+    }
+    stc.test_type = ACVP_SYM_TEST_TYPE_MCT;
+    for (i = 0; i < 3; i++) {
+        acvp_invoke_crypto_handler(ctx, cap, &test_case);
+    }
+
+    cr_assert(acvp_get_handler_stats(ctx, ACVP_AES_ECB, ACVP_SYM_TEST_TYPE_AFT, &stats) == ACVP_SUCCESS);
+    cr_assert(stats.count == 10);
+    cr_assert(stats.min_us <= stats.p50_us && stats.p50_us <= stats.p99_us && stats.p99_us <= stats.max_us);
+    cr_assert(acvp_get_handler_stats(ctx, ACVP_AES_ECB, ACVP_SYM_TEST_TYPE_MCT, &stats) == ACVP_SUCCESS);
+    cr_assert(stats.count == 3);
+    cr_assert(acvp_get_handler_stats(ctx, ACVP_AES_ECB, 0, &stats) == ACVP_SUCCESS);
+    cr_assert(stats.count == 13);
+    cr_assert(acvp_get_handler_stats(ctx, ACVP_AES_ECB, ACVP_SYM_TEST_TYPE_CTR, &stats) == ACVP_NO_DATA);
+    cr_assert(acvp_get_handler_stats(ctx, ACVP_AES_CBC, 0, &stats) == ACVP_NO_DATA);
+    cr_assert(acvp_get_handler_stats(ctx, ACVP_AES_ECB, 0, NULL) == ACVP_INVALID_ARG);
+
+    cr_assert(acvp_export_handler_stats(ctx, NULL) == ACVP_MISSING_ARG);
+    cr_assert(acvp_export_handler_stats(ctx, "handler_stats.json") == ACVP_SUCCESS);
+    remove("handler_stats.json");
+
+    acvp_free_test_session(ctx);
+}
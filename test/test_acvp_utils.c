@@ -33,6 +33,151 @@ Test(LogMsg, null_ctx) {
     acvp_cleanup(ctx);
 }
 
+/*
+ * Log payloads are only built for levels that reach the callback
+ */
+Test(LogEnabled, levels) {
+    JSON_Value *val = NULL;
+
+    cr_assert(!ACVP_LOG_ENABLED((ACVP_CTX *)NULL, ACVP_LOG_LVL_ERR));
+
+    setup_empty_ctx(&ctx);
+    cr_assert(ACVP_LOG_ENABLED(ctx, ACVP_LOG_LVL_ERR));
+    cr_assert(ACVP_LOG_ENABLED(ctx, ACVP_LOG_LVL_STATUS));
+    cr_assert(!ACVP_LOG_ENABLED(ctx, ACVP_LOG_LVL_INFO));
+    cr_assert(!ACVP_LOG_ENABLED(ctx, ACVP_LOG_LVL_VERBOSE));
+
+    val = json_parse_string("[{\"vsId\": 1}]");
+    acvp_log_json(ctx, ACVP_LOG_LVL_STATUS, __func__, __LINE__, val);
+    acvp_log_json(ctx, ACVP_LOG_LVL_VERBOSE, __func__, __LINE__, val);
+    acvp_log_json(ctx, ACVP_LOG_LVL_STATUS, __func__, __LINE__, NULL);
+
+    json_value_free(val);
+    acvp_cleanup(ctx);
+}
+
+#ifndef _WIN32
+#include <pthread.h>
+
+#define LOG_ASYNC_THREADS 4
+#define LOG_ASYNC_MSGS 500
+
+static int log_async_count = 0;
+static int log_async_long = 0;
+static int log_async_last[LOG_ASYNC_THREADS];
+static int log_async_order_ok = 1;
+
+static ACVP_RESULT log_async_cb(char *msg, ACVP_LOG_LVL level) {
+    int t = 0, n = 0;
+
+    (void)level;
+    __atomic_add_fetch(&log_async_count, 1, __ATOMIC_RELAXED);
+    if (strnlen_s(msg, ACVP_LOG_MAX_MSG_LEN + 1) > ACVP_LOG_SLOT_INLINE) {
+        log_async_long++;
+        return ACVP_SUCCESS;
+    }
+    if (sscanf(msg, "t%d %d", &t, &n) == 2 && t >= 0 && t < LOG_ASYNC_THREADS) {
+        if (n != log_async_last[t] + 1) {
+            log_async_order_ok = 0;
+        }
+        log_async_last[t] = n;
+    }
+    return ACVP_SUCCESS;
+}
+
+static void *log_async_worker(void *arg) {
+    int t = (int)(size_t)arg, i = 0;
+
+    for (i = 0; i < LOG_ASYNC_MSGS; i++) {
+        ACVP_LOG_STATUS("t%d %d", t, i);
+    }
+    return NULL;
+}
+
+/*
+ * Messages from several threads all reach the callback, each thread's in order
+ */
+Test(LogAsync, threads) {
+    pthread_t threads[LOG_ASYNC_THREADS];
+    char long_msg[ACVP_LOG_SLOT_INLINE * 2];
+    size_t i = 0;
+
+    cr_assert(acvp_set_log_async(NULL, 1, 0) == ACVP_NO_CTX);
+    cr_assert(acvp_set_log_flush_policy(NULL, ACVP_LOG_FLUSH_BATCH) == ACVP_NO_CTX);
+
+    acvp_create_test_session(&ctx, &log_async_cb, ACVP_LOG_LVL_STATUS);
+    cr_assert(acvp_set_log_flush_policy(ctx, (ACVP_LOG_FLUSH)99) == ACVP_INVALID_ARG);
+    cr_assert(acvp_set_log_flush_policy(ctx, ACVP_LOG_FLUSH_BATCH) == ACVP_SUCCESS);
+    /* A tiny ring so producers have to wait for room */
+    cr_assert(acvp_set_log_async(ctx, 1, 2) == ACVP_SUCCESS);
+    cr_assert_not_null(ctx->log_sink);
+
+    for (i = 0; i < LOG_ASYNC_THREADS; i++) {
+        log_async_last[i] = -1;
+        pthread_create(&threads[i], NULL, log_async_worker, (void *)i);
+    }
+    for (i = 0; i < LOG_ASYNC_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    memset(long_msg, 'a', sizeof(long_msg) - 1);
+    long_msg[sizeof(long_msg) - 1] = '\0';
+    ACVP_LOG_STATUS("%s", long_msg);
+    ACVP_LOG_INFO("filtered out");
+
+    cr_assert(acvp_log_flush(ctx) == ACVP_SUCCESS);
+    cr_assert(log_async_count == LOG_ASYNC_THREADS * LOG_ASYNC_MSGS + 1);
+    cr_assert(log_async_long == 1);
+    cr_assert(log_async_order_ok);
+
+    /* Back to synchronous delivery */
+    cr_assert(acvp_set_log_async(ctx, 0, 0) == ACVP_SUCCESS);
+    cr_assert_null(ctx->log_sink);
+    ACVP_LOG_STATUS("t0 %d", LOG_ASYNC_MSGS);
+    cr_assert(log_async_count == LOG_ASYNC_THREADS * LOG_ASYNC_MSGS + 2);
+
+    /* Queued messages are delivered when the ctx is freed */
+    cr_assert(acvp_set_log_async(ctx, 1, 0) == ACVP_SUCCESS);
+    ACVP_LOG_STATUS("t0 %d", LOG_ASYNC_MSGS + 1);
+    acvp_cleanup(ctx);
+    cr_assert(log_async_count == LOG_ASYNC_THREADS * LOG_ASYNC_MSGS + 3);
+    cr_assert(log_async_order_ok);
+}
+
+/*
+ * Switching the sink off and on while other threads are logging loses
+ * nothing and keeps each thread's messages in order
+ */
+Test(LogAsync, toggle_while_logging) {
+    pthread_t threads[LOG_ASYNC_THREADS];
+    size_t i = 0;
+
+    log_async_count = 0;
+    log_async_long = 0;
+    log_async_order_ok = 1;
+    acvp_create_test_session(&ctx, &log_async_cb, ACVP_LOG_LVL_STATUS);
+    cr_assert(acvp_set_log_async(ctx, 1, 2) == ACVP_SUCCESS);
+
+    for (i = 0; i < LOG_ASYNC_THREADS; i++) {
+        log_async_last[i] = -1;
+        pthread_create(&threads[i], NULL, log_async_worker, (void *)i);
+    }
+    for (i = 0; i < 20; i++) {
+        cr_assert(acvp_set_log_async(ctx, 0, 0) == ACVP_SUCCESS);
+        cr_assert(acvp_set_log_async(ctx, 1, 2) == ACVP_SUCCESS);
+    }
+    for (i = 0; i < LOG_ASYNC_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    cr_assert(acvp_set_log_async(ctx, 0, 0) == ACVP_SUCCESS);
+    cr_assert(ctx->log_producers == 0);
+    cr_assert(log_async_count == LOG_ASYNC_THREADS * LOG_ASYNC_MSGS);
+    cr_assert(log_async_order_ok);
+    acvp_cleanup(ctx);
+}
+#endif
+
 /*
  * Try to pass NULL to acvp_cleanup
  */
@@ -137,6 +282,193 @@ Test(JsonSerializeToFilePrettyA, null_param) {
     json_value_free(value);
 }
 
+/*
+ * Exercise the streaming file writer in both layouts and make sure the output parses back
+ */
+Test(JsonFileWriter, pretty_and_compact) {
+    ACVP_RESULT rv = ACVP_SUCCESS;
+    ACVP_JSON_FILE_WRITER *writer = NULL;
+    JSON_Value *value = NULL, *read_val = NULL;
+    int compact = 0;
+
+    rv = acvp_json_file_writer_open(NULL, "test", 0);
+    cr_assert(rv == ACVP_INVALID_ARG);
+    rv = acvp_json_file_writer_open(&writer, NULL, 0);
+    cr_assert(rv == ACVP_INVALID_ARG);
+    rv = acvp_json_file_writer_append(NULL, NULL);
+    cr_assert(rv == ACVP_INVALID_ARG);
+    rv = acvp_json_file_writer_close(&writer);
+    cr_assert(rv == ACVP_INVALID_ARG);
+
+    value = json_parse_string("{\"vsId\": 1, \"url\": \"/acvp/v1\", \"tests\": [\"00FF\", true, null]}");
+    cr_assert(value != NULL);
+
+    for (compact = 0; compact <= 1; compact++) {
+        rv = acvp_json_file_writer_open(&writer, "writer_test", compact);
+        cr_assert(rv == ACVP_SUCCESS);
+        rv = acvp_json_file_writer_append(writer, NULL);
+        cr_assert(rv == ACVP_INVALID_ARG);
+        rv = acvp_json_file_writer_append(writer, value);
+        cr_assert(rv == ACVP_SUCCESS);
+        rv = acvp_json_file_writer_append(writer, value);
+        cr_assert(rv == ACVP_SUCCESS);
+        rv = acvp_json_file_writer_close(&writer);
+        cr_assert(rv == ACVP_SUCCESS);
+        cr_assert(writer == NULL);
+
+        read_val = json_parse_file("writer_test");
+        cr_assert(read_val != NULL);
+        cr_assert(json_array_get_count(json_value_get_array(read_val)) == 2);
+        cr_assert(json_value_equals(json_array_get_value(json_value_get_array(read_val), 1), value));
+        json_value_free(read_val);
+        remove("writer_test");
+    }
+
+    json_value_free(value);
+}
+
+/*
+ * Values larger than the writer's flush size, including one string larger on its own,
+ * reach the file exactly as json_serialize_to_string() lays them out
+ */
+Test(JsonFileWriter, flushes_large_values) {
+    JSON_Value *value = NULL;
+    JSON_Array *arr = NULL;
+    char *expected = NULL, *read_back = NULL, *big = NULL;
+    FILE *fp = NULL;
+    size_t len = 0, i = 0;
+    int pretty = 0;
+
+    value = json_value_init_array();
+    arr = json_value_get_array(value);
+    for (i = 0; i < 4000; i++) {
+        json_array_append_string(arr, "00112233445566778899AABBCCDDEEFF");
+        json_array_append_number(arr, (double)i);
+    }
+    big = calloc(200000, 1);
+    cr_assert_not_null(big);
+    memset(big, 'A', 200000 - 1);
+    json_array_append_string(arr, big);
+    free(big);
+
+    for (pretty = 0; pretty <= 1; pretty++) {
+        expected = pretty ? json_serialize_to_string_pretty(value, NULL) : json_serialize_to_string(value, NULL);
+        cr_assert_not_null(expected);
+        len = strlen(expected);
+        fp = tmpfile();
+        cr_assert_not_null(fp);
+        cr_assert((pretty ? json_serialize_to_fp_pretty(value, fp) : json_serialize_to_fp(value, fp)) == JSONSuccess);
+        cr_assert((size_t)ftell(fp) == len);
+        rewind(fp);
+        read_back = calloc(len + 1, 1);
+        cr_assert_not_null(read_back);
+        cr_assert(fread(read_back, 1, len, fp) == len);
+        cr_assert(!memcmp(read_back, expected, len));
+        free(read_back);
+        fclose(fp);
+        json_free_serialized_string(expected);
+    }
+    json_value_free(value);
+}
+
+/*
+ * Detached values must leave the source tree intact and be independently owned
+ */
+Test(JsonDetach, move_values) {
+    JSON_Value *val = NULL, *detached = NULL, *copy = NULL;
+    JSON_Array *arr = NULL;
+    JSON_Object *obj = NULL;
+
+    cr_assert_null(json_value_detach(NULL));
+    cr_assert_null(json_array_detach_value(NULL, 0));
+
+    val = json_parse_string("[{\"acvVersion\": \"1.0\"}, {\"vsId\": 1, \"tests\": [1, 2]}, {\"vsId\": 2}]");
+    cr_assert(val != NULL);
+    arr = json_value_get_array(val);
+
+    copy = json_value_deep_copy(json_array_get_value(arr, 1));
+    cr_assert(copy != NULL);
+
+    detached = json_array_detach_value(arr, 1);
+    cr_assert(detached != NULL);
+    cr_assert_null(json_value_get_parent(detached));
+    cr_assert(json_value_equals(detached, copy));
+    cr_assert(json_array_get_count(arr) == 2);
+    /* order of the remaining values is preserved */
+    cr_assert(json_object_get_number(json_array_get_object(arr, 1), "vsId") == 2);
+    cr_assert_null(json_array_detach_value(arr, 2));
+
+    obj = json_value_get_object(detached);
+    json_value_free(copy);
+    copy = json_value_detach(json_object_get_value(obj, "tests"));
+    cr_assert(copy != NULL);
+    cr_assert(json_array_get_count(json_value_get_array(copy)) == 2);
+    cr_assert(!json_object_has_value(obj, "tests"));
+
+    json_value_free(copy);
+    json_value_free(detached);
+    json_value_free(val);
+}
+
+/*
+ * The mapped parse path must produce the same tree as the buffered one
+ */
+Test(JsonParseFileMmap, matches_read) {
+    JSON_Value *mapped = NULL, *read_val = NULL;
+
+    cr_assert_null(json_parse_file_mmap(NULL));
+    cr_assert_null(json_parse_file_mmap("json/does_not_exist.json"));
+
+    mapped = json_parse_file_mmap("json/req.json");
+    read_val = json_parse_file("json/req.json");
+    cr_assert(mapped != NULL);
+    cr_assert(read_val != NULL);
+    cr_assert(json_array_get_count(json_value_get_array(mapped)) ==
+              json_array_get_count(json_value_get_array(read_val)));
+    cr_assert(json_object_get_number(json_array_get_object(json_value_get_array(mapped), 1), "vsId") ==
+              json_object_get_number(json_array_get_object(json_value_get_array(read_val), 1), "vsId"));
+
+    json_value_free(mapped);
+    json_value_free(read_val);
+}
+
+/*
+ * The single pass serializer must match the sized one and reuse its buffer
+ */
+Test(JsonReusableBuffer, matches_sized) {
+    JSON_Value *val = NULL;
+    char *buf = NULL, *first = NULL, *sized = NULL;
+    size_t buf_size = 0, len = 0, sized_len = 0;
+
+    val = json_parse_string("[{\"vsId\": 1234, \"tgId\": -1, \"pt\": \"00AABB\", "
+                            "\"n\": 1.5, \"z\": -0, \"s\": \"a/b\\\"c\\n\"}]");
+    cr_assert(val != NULL);
+    cr_assert(json_serialize_to_reusable_buffer(val, NULL, &buf_size, &len) == JSONFailure);
+
+    sized_len = json_serialization_size(val);
+    sized = calloc(sized_len, 1);
+    cr_assert(json_serialize_to_buffer(val, sized, sized_len) == JSONSuccess);
+
+    cr_assert(json_serialize_to_reusable_buffer(val, &buf, &buf_size, &len) == JSONSuccess);
+    cr_assert(len == sized_len - 1);
+    cr_assert(!strcmp(buf, sized));
+    first = buf;
+    cr_assert(json_serialize_to_reusable_buffer(val, &buf, &buf_size, &len) == JSONSuccess);
+    cr_assert(buf == first);
+    cr_assert(!strcmp(buf, sized));
+
+    free(sized);
+    sized_len = json_serialization_size_pretty(val);
+    sized = calloc(sized_len, 1);
+    cr_assert(json_serialize_to_buffer_pretty(val, sized, sized_len) == JSONSuccess);
+    cr_assert(json_serialize_to_reusable_buffer_pretty(val, &buf, &buf_size, &len) == JSONSuccess);
+    cr_assert(!strcmp(buf, sized));
+
+    free(sized);
+    json_free_serialized_string(buf);
+    json_value_free(val);
+}
+
 /*
  * Exercise string_fits logic
  */
@@ -178,6 +510,113 @@ Test(LookupErrorString, null_ctx) {
     cr_assert(!strncmp(str, ukn, strlen(ukn)));
 }
 
+/*
+ * Round trip every byte value through the hex converters, at lengths that
+ * exercise both the vector kernels and the scalar tail, and check the
+ * vector and scalar paths agree
+ */
+Test(HexConvert, round_trip) {
+    unsigned char bin[300], out[300], ref[300];
+    char hex[601], hex_ref[601];
+    int len = 0, conv = 0, i = 0;
+
+    for (i = 0; i < 300; i++) {
+        bin[i] = (unsigned char)(i * 7 + 3);
+    }
+    for (len = 0; len <= 300; len += (len < 70 ? 1 : 23)) {
+        acvp_hex_set_simd(1);
+        cr_assert(acvp_bin_to_hexstr(bin, len, hex, 600) == ACVP_SUCCESS);
+        acvp_hex_set_simd(0);
+        cr_assert(acvp_bin_to_hexstr(bin, len, hex_ref, 600) == ACVP_SUCCESS);
+        cr_assert(!strcmp(hex, hex_ref));
+        cr_assert(strlen(hex) == (size_t)len * 2);
+
+        acvp_hex_set_simd(1);
+        cr_assert(acvp_hexstr_to_bin(hex, out, 300, &conv) == ACVP_SUCCESS);
+        cr_assert(conv == len);
+        cr_assert(!memcmp(out, bin, len));
+        acvp_hex_set_simd(0);
+        cr_assert(acvp_hexstr_to_bin(hex, ref, 300, &conv) == ACVP_SUCCESS);
+        cr_assert(!memcmp(ref, bin, len));
+    }
+    acvp_hex_set_simd(1);
+
+    cr_assert(acvp_hexstr_to_bin("00aAfF9f", out, 4, &conv) == ACVP_SUCCESS);
+    cr_assert(conv == 4);
+    cr_assert(out[0] == 0x00 && out[1] == 0xAA && out[2] == 0xFF && out[3] == 0x9F);
+}
+
+/*
+ * Characters that are not hex digits are rejected wherever they appear,
+ * rather than being read as 0
+ */
+Test(HexConvert, invalid) {
+    unsigned char out[64];
+    char hex[129];
+    const char bad[] = "gG/:@`xz -\x80";
+    int i = 0, pos = 0, simd = 0;
+
+    cr_assert(acvp_hexstr_to_bin(NULL, out, 64, NULL) == ACVP_INVALID_ARG);
+    cr_assert(acvp_hexstr_to_bin("00", NULL, 64, NULL) == ACVP_INVALID_ARG);
+    cr_assert(acvp_bin_to_hexstr(NULL, 1, hex, 128) == ACVP_CONVERT_DATA_ERR);
+    cr_assert(acvp_bin_to_hexstr(out, 65, hex, 128) == ACVP_CONVERT_DATA_ERR);
+
+    for (simd = 0; simd < 2; simd++) {
+        acvp_hex_set_simd(simd);
+        for (pos = 0; pos < 128; pos += 9) {
+            for (i = 0; bad[i]; i++) {
+                memset(hex, 'a', 128);
+                hex[128] = '\0';
+                hex[pos] = bad[i];
+                cr_assert(acvp_hexstr_to_bin(hex, out, 64, NULL) == ACVP_CONVERT_DATA_ERR);
+            }
+        }
+    }
+    acvp_hex_set_simd(1);
+
+    /* Odd length and oversized input */
+    cr_assert(acvp_hexstr_to_bin("abc", out, 64, NULL) == ACVP_UNSUPPORTED_OP);
+    memset(hex, 'a', 128);
+    hex[128] = '\0';
+    cr_assert(acvp_hexstr_to_bin(hex, out, 63, NULL) == ACVP_DATA_TOO_LARGE);
+}
+
+
+/*
+ * Scratch areas hand out zeroed, aligned, non-overlapping pieces of one
+ * reservation and only reallocate when a larger one is asked for
+ */
+Test(Scratch, reserve_alloc) {
+    ACVP_SCRATCH scratch = { 0 };
+    unsigned char *a = NULL, *b = NULL, *buf = NULL;
+
+    cr_assert(acvp_scratch_alloc(&scratch, 16) == NULL);
+    cr_assert(acvp_scratch_reserve(NULL, 16) == ACVP_INVALID_ARG);
+    cr_assert(acvp_scratch_round(0) == ACVP_SCRATCH_ALIGN);
+    cr_assert(acvp_scratch_round(17) == 2 * ACVP_SCRATCH_ALIGN);
+
+    cr_assert(acvp_scratch_reserve(&scratch, 64) == ACVP_SUCCESS);
+    buf = scratch.buf;
+    a = acvp_scratch_alloc(&scratch, 20);
+    b = acvp_scratch_alloc(&scratch, 32);
+    cr_assert(a == buf && b == buf + 32);
+    cr_assert(acvp_scratch_alloc(&scratch, 1) == NULL);
+    memset(a, 0xAA, 20);
+
+    /* A smaller reservation reuses the buffer and the pieces come back zeroed */
+    cr_assert(acvp_scratch_reserve(&scratch, 32) == ACVP_SUCCESS);
+    cr_assert(scratch.buf == buf);
+    a = acvp_scratch_alloc(&scratch, 20);
+    cr_assert(a == buf && a[0] == 0 && a[19] == 0);
+
+    cr_assert(acvp_scratch_reserve(&scratch, 4096) == ACVP_SUCCESS);
+    cr_assert(scratch.size == 4096);
+    cr_assert(acvp_scratch_alloc(&scratch, 4096) != NULL);
+
+    acvp_scratch_free(&scratch);
+    cr_assert(scratch.buf == NULL && scratch.size == 0);
+    acvp_scratch_free(&scratch);
+}
 
 /*
  * Exercise acvp_kv_list_append, acvp_kvlist_free and acvp_free_str_list logic
@@ -10,6 +10,7 @@
 
 
 #include "ut_common.h"
+#include "acvp/acvp_lcl.h"
 
 int counter_set = 0;
 int counter_fail = 0;
@@ -50,6 +51,132 @@ int dummy_handler_failure(ACVP_TEST_CASE *test_case) {
     return 0;
 }
 
+/*
+ * Stand-in block cipher for tests that compare two ways of driving the
+ * module: each output is the input xor the key. A TDES IV register ends up
+ * holding the output.
+ */
+int ut_xor_sym_handler(ACVP_TEST_CASE *test_case) {
+    ACVP_SYM_CIPHER_TC *tc = test_case->tc.symmetric;
+    unsigned int i = 0;
+
+    if (tc->direction == ACVP_SYM_CIPH_DIR_ENCRYPT) {
+        for (i = 0; i < tc->pt_len; i++) {
+            tc->ct[i] = tc->pt[i] ^ tc->key[i];
+        }
+        tc->ct_len = tc->pt_len;
+    } else {
+        for (i = 0; i < tc->ct_len; i++) {
+            tc->pt[i] = tc->ct[i] ^ tc->key[i];
+        }
+        tc->pt_len = tc->ct_len;
+    }
+    if (tc->cipher == ACVP_AES_CFB1) {
+        /* A single bit, in the most significant bit */
+        tc->ct[0] &= 0x80;
+        tc->pt[0] &= 0x80;
+    }
+    if (tc->cipher >= ACVP_TDES_ECB && tc->cipher <= ACVP_TDES_KW) {
+        memcpy(tc->iv_ret_after, tc->direction == ACVP_SYM_CIPH_DIR_ENCRYPT ? tc->ct : tc->pt, 8);
+    }
+    return 0;
+}
+
+/* Stand-in digest: a running mix of the input, spread over the output */
+void ut_toy_hash_update(unsigned int *h, const unsigned char *in, unsigned int len) {
+    unsigned int i = 0;
+
+    for (i = 0; i < len; i++) {
+        *h = *h * 31 + in[i];
+    }
+}
+
+void ut_toy_hash_final(unsigned int h, unsigned char *out, unsigned int len) {
+    unsigned int i = 0;
+
+    for (i = 0; i < len; i++) {
+        h = h * 1103515245 + 12345;
+        out[i] = (unsigned char)(h >> 16);
+    }
+}
+
+/* The stand-in digest of a hash test case's message, or of its three MCT messages */
+int ut_toy_hash_handler(ACVP_TEST_CASE *test_case) {
+    ACVP_HASH_TC *tc = test_case->tc.hash;
+    unsigned int h = 1;
+
+    if (tc->m1) {
+        ut_toy_hash_update(&h, tc->m1, tc->msg_len);
+        ut_toy_hash_update(&h, tc->m2, tc->msg_len);
+        ut_toy_hash_update(&h, tc->m3, tc->msg_len);
+    } else {
+        ut_toy_hash_update(&h, tc->msg, tc->msg_len);
+    }
+    tc->md_len = tc->cipher == ACVP_HASH_SHAKE_128 ? tc->xof_len : 32;
+    ut_toy_hash_final(h, tc->md, tc->md_len);
+    return 0;
+}
+
+int ut_fail_batch_handler(ACVP_TEST_CASE *test_cases, unsigned int count) {
+    (void)test_cases;
+    (void)count;
+    return 1;
+}
+
+static ACVP_CTX *ut_kat_ctx(ACVP_CIPHER cipher, UT_CAP_ENABLE enable,
+                            int (*crypto_handler)(ACVP_TEST_CASE *test_case)) {
+    ACVP_CTX *ctx = NULL;
+
+    setup_empty_ctx(&ctx);
+    cr_assert(enable(ctx, cipher, crypto_handler) == ACVP_SUCCESS);
+    return ctx;
+}
+
+/* Runs obj through kat_handler and frees ctx; the response, on success, is the caller's to free */
+static char *ut_kat_run_ctx(ACVP_CTX *ctx, JSON_Object *obj, UT_KAT_HANDLER kat_handler,
+                            ACVP_RESULT *result) {
+    char *out = NULL;
+
+    *result = kat_handler(ctx, obj);
+    if (*result == ACVP_SUCCESS) {
+        out = json_serialize_to_string(ctx->kat_resp, NULL);
+    }
+    teardown_ctx(&ctx);
+    return out;
+}
+
+/*
+ * Runs one vector set on a fresh context with cipher enabled through
+ * crypto_handler and, when set_handler is given, handler set through it
+ * (NULL handlers are passed on, for the setters that take them).
+ */
+char *ut_run_kat(JSON_Object *obj, ACVP_CIPHER cipher, unsigned int mct_threads,
+                 UT_CAP_ENABLE enable, int (*crypto_handler)(ACVP_TEST_CASE *test_case),
+                 UT_SET_HANDLER set_handler, int (*handler)(ACVP_TEST_CASE *test_case),
+                 UT_KAT_HANDLER kat_handler, ACVP_RESULT *result) {
+    ACVP_CTX *ctx = ut_kat_ctx(cipher, enable, crypto_handler);
+
+    cr_assert(acvp_set_mct_threads(ctx, mct_threads) == ACVP_SUCCESS);
+    if (set_handler) {
+        cr_assert(set_handler(ctx, cipher, handler) == ACVP_SUCCESS);
+    }
+    return ut_kat_run_ctx(ctx, obj, kat_handler, result);
+}
+
+/* ut_run_kat() with a batch handler */
+char *ut_run_kat_batch(JSON_Object *obj, ACVP_CIPHER cipher,
+                       UT_CAP_ENABLE enable, int (*crypto_handler)(ACVP_TEST_CASE *test_case),
+                       UT_SET_BATCH_HANDLER set_handler,
+                       int (*batch_handler)(ACVP_TEST_CASE *test_cases, unsigned int count),
+                       UT_KAT_HANDLER kat_handler, ACVP_RESULT *result) {
+    ACVP_CTX *ctx = ut_kat_ctx(cipher, enable, crypto_handler);
+
+    if (set_handler) {
+        cr_assert(set_handler(ctx, cipher, batch_handler) == ACVP_SUCCESS);
+    }
+    return ut_kat_run_ctx(ctx, obj, kat_handler, result);
+}
+
 /*
  * get JSON Object from response
  */
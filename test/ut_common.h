@@ -29,6 +29,29 @@ JSON_Object *ut_get_obj_from_rsp (JSON_Value *arry_val);
 unsigned int base64_decode(const char *in, unsigned int inlen, unsigned char *out);
 unsigned int dummy_totp(char **token, int token_max);
 
+typedef ACVP_RESULT (*UT_CAP_ENABLE)(ACVP_CTX *ctx, ACVP_CIPHER cipher,
+                                     int (*crypto_handler)(ACVP_TEST_CASE *test_case));
+typedef ACVP_RESULT (*UT_SET_HANDLER)(ACVP_CTX *ctx, ACVP_CIPHER cipher,
+                                      int (*handler)(ACVP_TEST_CASE *test_case));
+typedef ACVP_RESULT (*UT_SET_BATCH_HANDLER)(ACVP_CTX *ctx, ACVP_CIPHER cipher,
+                                            int (*batch_handler)(ACVP_TEST_CASE *test_cases, unsigned int count));
+typedef ACVP_RESULT (*UT_KAT_HANDLER)(ACVP_CTX *ctx, JSON_Object *obj);
+
+char *ut_run_kat(JSON_Object *obj, ACVP_CIPHER cipher, unsigned int mct_threads,
+                 UT_CAP_ENABLE enable, int (*crypto_handler)(ACVP_TEST_CASE *test_case),
+                 UT_SET_HANDLER set_handler, int (*handler)(ACVP_TEST_CASE *test_case),
+                 UT_KAT_HANDLER kat_handler, ACVP_RESULT *result);
+char *ut_run_kat_batch(JSON_Object *obj, ACVP_CIPHER cipher,
+                       UT_CAP_ENABLE enable, int (*crypto_handler)(ACVP_TEST_CASE *test_case),
+                       UT_SET_BATCH_HANDLER set_handler,
+                       int (*batch_handler)(ACVP_TEST_CASE *test_cases, unsigned int count),
+                       UT_KAT_HANDLER kat_handler, ACVP_RESULT *result);
+int ut_xor_sym_handler(ACVP_TEST_CASE *test_case);
+void ut_toy_hash_update(unsigned int *h, const unsigned char *in, unsigned int len);
+void ut_toy_hash_final(unsigned int h, unsigned char *out, unsigned int len);
+int ut_toy_hash_handler(ACVP_TEST_CASE *test_case);
+int ut_fail_batch_handler(ACVP_TEST_CASE *test_cases, unsigned int count);
+
 #define ACVP_TEST_STRING_TOO_LONG "TestStringTooLongTestStringTooLongTestStringTooLongTestStringTooLong"\
                                   "TestStringTooLongTestStringTooLongTestStringTooLongTestStringTooLong"\
                                   "TestStringTooLongTestStringTooLongTestStringTooLongTestStringTooLong"\